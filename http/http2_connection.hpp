@@ -0,0 +1,781 @@
+#pragma once
+#include "bmcweb_config.h"
+
+#include "async_resp.hpp"
+#include "authorization.hpp"
+#include "http_connection.hpp"
+#include "http_request.hpp"
+#include "http_response.hpp"
+#include "logging.hpp"
+#include "nghttp2_adapters.hpp"
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/container/flat_map.hpp>
+#include <security_headers.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace crow
+{
+
+// Streams a single HTTP/2 client may have open at once.  Each open stream
+// holds a request and response in memory.
+constexpr uint32_t http2MaxConcurrentStreams = 32;
+
+// Request body bytes all streams of a connection may buffer together, which
+// is as much as a single HTTP/1.1 connection can hold
+constexpr size_t http2BufferedBodyLimit = httpReqBodyLimit;
+
+// A connection that receives no frames for this long is closed, unless a
+// handler is still working on one of its streams
+constexpr std::chrono::seconds http2IdleTimeout(120);
+
+struct Http2StreamData
+{
+    boost::beast::http::request<boost::beast::http::string_body> beastReq;
+    std::optional<crow::Request> req;
+    crow::Response res;
+    // Set from the request headers, before any of the body is read
+    std::shared_ptr<persistent_data::UserSession> session;
+    bool handling = false;
+    // Reset for a body over its limit; the rest of it is never dispatched
+    bool refused = false;
+    // Body bytes this stream counts against the connection
+    size_t bodyBytes = 0;
+    size_t sentSofar = 0;
+};
+
+/**
+ * HTTP2Connection
+ * Serves HTTP/2 over a TLS stream that negotiated "h2" through ALPN.  Every
+ * stream is dispatched through the same Handler::handle / AsyncResp path as
+ * HTTP/1.1 requests, so routes don't know which protocol they were called
+ * over.  Framing and HPACK header compression are done by nghttp2.
+ */
+template <typename Adaptor, typename Handler>
+class HTTP2Connection :
+    public std::enable_shared_from_this<HTTP2Connection<Adaptor, Handler>>
+{
+    using self_type = HTTP2Connection<Adaptor, Handler>;
+
+  public:
+    HTTP2Connection(
+        Adaptor&& adaptorIn, Handler* handlerIn,
+        std::function<std::string()>& getCachedDateStrF,
+        const boost::asio::ip::address& ipAddressIn,
+        std::shared_ptr<persistent_data::UserSession> tlsSessionIn) :
+        adaptor(std::move(adaptorIn)),
+        ngSession(initializeCallbacks(), this),
+        timer(adaptor.get_executor()), handler(handlerIn),
+        getCachedDateStr(getCachedDateStrF), ipAddress(ipAddressIn),
+        tlsSession(std::move(tlsSessionIn))
+    {
+        connectionCount++;
+        BMCWEB_LOG_DEBUG << this << " HTTP/2 connection open, total "
+                         << connectionCount;
+    }
+
+    ~HTTP2Connection()
+    {
+        // nghttp2 doesn't report the streams still open as closed
+        for (auto& [streamId, stream] : streams)
+        {
+            cleanupUndispatchedSession(*stream);
+        }
+        connectionCount--;
+        BMCWEB_LOG_DEBUG << this << " HTTP/2 connection closed, total "
+                         << connectionCount;
+    }
+
+    HTTP2Connection(const HTTP2Connection&) = delete;
+    HTTP2Connection(HTTP2Connection&&) = delete;
+    HTTP2Connection& operator=(const HTTP2Connection&) = delete;
+    HTTP2Connection& operator=(HTTP2Connection&&) = delete;
+
+    void start()
+    {
+        if (!ngSession.valid() || sendServerConnectionHeader() != 0)
+        {
+            close();
+            return;
+        }
+        startIdleTimer();
+        doRead();
+    }
+
+  private:
+    Nghttp2SessionCallbacks& initializeCallbacks()
+    {
+        callbacks.setOnFrameRecvCallback(onFrameRecvCallbackStatic);
+        callbacks.setOnStreamCloseCallback(onStreamCloseCallbackStatic);
+        callbacks.setOnHeaderCallback(onHeaderCallbackStatic);
+        callbacks.setOnBeginHeadersCallback(onBeginHeadersCallbackStatic);
+        callbacks.setOnDataChunkRecvCallback(onDataChunkRecvCallbackStatic);
+        return callbacks;
+    }
+
+    int sendServerConnectionHeader()
+    {
+        BMCWEB_LOG_DEBUG << this << " Sending HTTP/2 server settings";
+        std::array<nghttp2_settings_entry, 2> iv = {
+            {{NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS,
+              http2MaxConcurrentStreams},
+             {NGHTTP2_SETTINGS_ENABLE_PUSH, 0}}};
+        int rv = ngSession.submitSettings(iv);
+        if (rv != 0)
+        {
+            BMCWEB_LOG_ERROR << this << " Fatal error: "
+                             << nghttp2_strerror(rv);
+            return -1;
+        }
+        writeBuffer();
+        return 0;
+    }
+
+    static ssize_t
+        bodyReadCallback(nghttp2_session* /* session */, int32_t streamId,
+                         uint8_t* buf, size_t length, uint32_t* dataFlags,
+                         nghttp2_data_source* /*source*/, void* userPtr)
+    {
+        self_type& self = userPtrToSelf(userPtr);
+        auto streamIt = self.streams.find(streamId);
+        if (streamIt == self.streams.end())
+        {
+            return NGHTTP2_ERR_CALLBACK_FAILURE;
+        }
+        Http2StreamData& stream = *streamIt->second;
+        std::string_view body = stream.res.payload();
+        size_t toSend = std::min(body.size() - stream.sentSofar, length);
+        auto start =
+            body.begin() + static_cast<std::ptrdiff_t>(stream.sentSofar);
+        std::copy_n(start, toSend, buf);
+        stream.sentSofar += toSend;
+        if (stream.sentSofar >= body.size())
+        {
+            *dataFlags |= NGHTTP2_DATA_FLAG_EOF;
+        }
+        return static_cast<ssize_t>(toSend);
+    }
+
+    static nghttp2_nv headerFromStringViews(std::string_view name,
+                                           std::string_view value)
+    {
+        // nghttp2 copies the header block on submit, and never writes
+        // through these pointers
+        uint8_t* nameData =
+            reinterpret_cast<uint8_t*>(const_cast<char*>(name.data()));
+        uint8_t* valueData =
+            reinterpret_cast<uint8_t*>(const_cast<char*>(value.data()));
+        return {nameData, valueData, name.size(), value.size(),
+                NGHTTP2_NV_FLAG_NONE};
+    }
+
+    // Does the final processing that Connection::completeRequest does for
+    // HTTP/1.1, minus anything connection specific
+    void completeResponse(Http2StreamData& stream)
+    {
+        crow::Response& res = stream.res;
+        if (stream.req)
+        {
+            addSecurityHeaders(*stream.req, res);
+            crow::authorization::cleanupTempSession(*stream.req);
+
+            if (res.body().empty() && !res.jsonValue.empty())
+            {
+                encodeJsonBody(
+                    res, http_helpers::getPreferredEncoding(*stream.req));
+            }
+        }
+        if (res.resultInt() >= 400 && res.body().empty())
+        {
+            res.body() = std::string(res.reason());
+        }
+        if (res.result() == boost::beast::http::status::no_content ||
+            res.result() == boost::beast::http::status::not_modified)
+        {
+            res.body().clear();
+            res.staticBody = {};
+        }
+        if (stream.req)
+        {
+            http_helpers::ContentEncoding encoding =
+                getResponseContentEncoding(*stream.req, res, false);
+            if (setResponseETag(*stream.req, res,
+                                http_helpers::getPreferredEncoding(*stream.req),
+                                encoding))
+            {
+                encoding = http_helpers::ContentEncoding::Identity;
+            }
+            if (encoding != http_helpers::ContentEncoding::Identity)
+            {
+                compressResponseBody(res, encoding);
+            }
+        }
+        res.addHeader(boost::beast::http::field::date, getCachedDateStr());
+    }
+
+    void sendResponse(int32_t streamId)
+    {
+        auto streamIt = streams.find(streamId);
+        if (streamIt == streams.end())
+        {
+            // The client reset the stream while the handler was running
+            BMCWEB_LOG_DEBUG << this << " Stream " << streamId
+                             << " closed before the response was ready";
+            return;
+        }
+        Http2StreamData& stream = *streamIt->second;
+        stream.handling = false;
+        completeResponse(stream);
+
+        crow::Response& res = stream.res;
+        BMCWEB_LOG_INFO << "Response: " << this << " stream " << streamId
+                        << ' ' << res.resultInt();
+
+        std::string code = std::to_string(res.resultInt());
+        std::string contentLength = std::to_string(res.payload().size());
+        boost::beast::http::fields& fields = res.stringResponse->base();
+
+        // HTTP/2 requires lower case header names, and forbids the
+        // connection specific ones
+        std::vector<std::string> names;
+        names.reserve(static_cast<size_t>(
+            std::distance(fields.begin(), fields.end())));
+        std::vector<nghttp2_nv> headers;
+        headers.reserve(names.capacity() + 2);
+        headers.push_back(headerFromStringViews(":status", code));
+        if (res.result() != boost::beast::http::status::not_modified)
+        {
+            headers.push_back(
+                headerFromStringViews("content-length", contentLength));
+        }
+        for (const boost::beast::http::fields::value_type& header : fields)
+        {
+            using boost::beast::http::field;
+            field name = header.name();
+            if (name == field::connection || name == field::keep_alive ||
+                name == field::transfer_encoding || name == field::upgrade ||
+                name == field::content_length)
+            {
+                continue;
+            }
+            names.emplace_back(boost::algorithm::to_lower_copy(
+                std::string(header.name_string())));
+            headers.push_back(
+                headerFromStringViews(names.back(), header.value()));
+        }
+
+        stream.sentSofar = 0;
+        nghttp2_data_provider dataPrd{};
+        dataPrd.read_callback = bodyReadCallback;
+        bool isHead = stream.req &&
+                      stream.req->method() == boost::beast::http::verb::head;
+        bool hasBody = !res.payload().empty() && !isHead;
+        int rv = ngSession.submitResponse(streamId, headers,
+                                          hasBody ? &dataPrd : nullptr);
+        if (rv != 0)
+        {
+            BMCWEB_LOG_ERROR << this << " Fatal error: "
+                             << nghttp2_strerror(rv);
+            close();
+            return;
+        }
+        writeBuffer();
+    }
+
+    int onRequestRecv(int32_t streamId)
+    {
+        BMCWEB_LOG_DEBUG << this << " on_request_recv stream " << streamId;
+
+        auto streamIt = streams.find(streamId);
+        if (streamIt == streams.end())
+        {
+            close();
+            return -1;
+        }
+        std::shared_ptr<Http2StreamData> stream = streamIt->second;
+        if (stream->refused)
+        {
+            BMCWEB_LOG_DEBUG << this << " Not dispatching refused stream "
+                             << streamId;
+            return 0;
+        }
+
+        std::error_code reqEc;
+        crow::Request& thisReq =
+            stream->req.emplace(std::move(stream->beastReq), reqEc);
+        if (reqEc)
+        {
+            BMCWEB_LOG_DEBUG << "Request failed to construct" << reqEc;
+            stream->res.result(boost::beast::http::status::bad_request);
+            stream->req.reset();
+            sendResponse(streamId);
+            return 0;
+        }
+        thisReq.isSecure = true;
+        thisReq.ipAddress = ipAddress;
+        thisReq.ioService = static_cast<decltype(thisReq.ioService)>(
+            &adaptor.get_executor().context());
+
+        BMCWEB_LOG_INFO << "Request: " << this << " HTTP/2 stream "
+                        << streamId << ' ' << thisReq.methodString() << ' '
+                        << thisReq.target() << ' ' << thisReq.ipAddress;
+
+        thisReq.session = stream->session;
+        if (!crow::authorization::isOnWhitelist(thisReq.url,
+                                                thisReq.method()) &&
+            thisReq.session == nullptr)
+        {
+            BMCWEB_LOG_WARNING << "[AuthMiddleware] authorization failed";
+            forward_unauthorized::sendUnauthorized(
+                thisReq.url, thisReq.getHeaderValue("User-Agent"),
+                thisReq.getHeaderValue("Accept"), stream->res);
+            sendResponse(streamId);
+            return 0;
+        }
+
+        // The completion handler holds the stream, so the response stays
+        // valid for the AsyncResp even if the client resets the stream
+        stream->res.setCompleteRequestHandler(
+            [self(shared_from_this()), streamId, stream] {
+                boost::asio::post(self->adaptor.get_executor(),
+                                  [self, streamId, stream] {
+                                      self->sendResponse(streamId);
+                                      // delete lambda with self shared_ptr
+                                      // to enable stream destruction
+                                      stream->res.setCompleteRequestHandler(
+                                          nullptr);
+                                  });
+            });
+        stream->handling = true;
+        auto asyncResp = std::make_shared<bmcweb::AsyncResp>(stream->res);
+        handler->handle(thisReq, asyncResp);
+        return 0;
+    }
+
+    // Unlike HTTP/1.1 keep-alive, every stream carries its own credentials.
+    // They are checked as soon as the headers are in, so that the body limit
+    // of a stream depends on whether it is logged in.
+    void authenticateStream(int32_t streamId)
+    {
+        auto streamIt = streams.find(streamId);
+        if (streamIt == streams.end())
+        {
+            return;
+        }
+        Http2StreamData& stream = *streamIt->second;
+        stream.session = crow::authorization::authenticate(
+            ipAddress, stream.res, stream.beastReq.method(),
+            stream.beastReq.base(), tlsSession);
+    }
+
+    // Dispatched requests remove their single request session once they
+    // complete.  A stream that closes before that, such as one the client
+    // resets right after its HEADERS, would leave it in the SessionStore.
+    static void cleanupUndispatchedSession(Http2StreamData& stream)
+    {
+        if (stream.req || stream.handling || stream.session == nullptr ||
+            stream.session->persistence !=
+                persistent_data::PersistenceType::SINGLE_REQUEST)
+        {
+            return;
+        }
+        persistent_data::SessionStore::getInstance().removeSession(
+            stream.session);
+        stream.session = nullptr;
+    }
+
+    int onFrameRecvCallback(const nghttp2_frame& frame)
+    {
+        BMCWEB_LOG_DEBUG << this << " frame type "
+                         << static_cast<int>(frame.hd.type);
+        switch (frame.hd.type)
+        {
+            case NGHTTP2_HEADERS:
+                if (frame.headers.cat == NGHTTP2_HCAT_REQUEST)
+                {
+                    authenticateStream(frame.hd.stream_id);
+                }
+                [[fallthrough]];
+            case NGHTTP2_DATA:
+                // Check that the client request has finished
+                if ((frame.hd.flags & NGHTTP2_FLAG_END_STREAM) != 0)
+                {
+                    return onRequestRecv(frame.hd.stream_id);
+                }
+                break;
+            default:
+                break;
+        }
+        return 0;
+    }
+
+    static int onFrameRecvCallbackStatic(nghttp2_session* /* session */,
+                                         const nghttp2_frame* frame,
+                                         void* userData)
+    {
+        if (frame == nullptr || userData == nullptr)
+        {
+            return NGHTTP2_ERR_CALLBACK_FAILURE;
+        }
+        return userPtrToSelf(userData).onFrameRecvCallback(*frame);
+    }
+
+    static self_type& userPtrToSelf(void* userData)
+    {
+        // This method exists to keep the unsafe reinterpret cast in one
+        // place.
+        return *reinterpret_cast<self_type*>(userData);
+    }
+
+    static int onStreamCloseCallbackStatic(nghttp2_session* /* session */,
+                                           int32_t streamId,
+                                           uint32_t /*errorCode*/,
+                                           void* userData)
+    {
+        if (userData == nullptr)
+        {
+            return NGHTTP2_ERR_CALLBACK_FAILURE;
+        }
+        BMCWEB_LOG_DEBUG << "on_stream_close_callback stream " << streamId;
+        self_type& self = userPtrToSelf(userData);
+        auto streamIt = self.streams.find(streamId);
+        if (streamIt == self.streams.end())
+        {
+            return 0;
+        }
+        self.bufferedBodyBytes -= streamIt->second->bodyBytes;
+        cleanupUndispatchedSession(*streamIt->second);
+        self.streams.erase(streamIt);
+        return 0;
+    }
+
+    int onHeaderCallback(const nghttp2_frame& frame,
+                         std::span<const uint8_t> name,
+                         std::span<const uint8_t> value)
+    {
+        std::string_view nameSv(reinterpret_cast<const char*>(name.data()),
+                                name.size());
+        std::string_view valueSv(reinterpret_cast<const char*>(value.data()),
+                                 value.size());
+
+        if (frame.hd.type != NGHTTP2_HEADERS ||
+            frame.headers.cat != NGHTTP2_HCAT_REQUEST)
+        {
+            return 0;
+        }
+        auto streamIt = streams.find(frame.hd.stream_id);
+        if (streamIt == streams.end())
+        {
+            return 0;
+        }
+        boost::beast::http::request<boost::beast::http::string_body>& req =
+            streamIt->second->beastReq;
+        if (nameSv == ":path")
+        {
+            req.target(valueSv);
+        }
+        else if (nameSv == ":method")
+        {
+            boost::beast::http::verb verb =
+                boost::beast::http::string_to_verb(valueSv);
+            if (verb == boost::beast::http::verb::unknown)
+            {
+                BMCWEB_LOG_ERROR << "Unknown http verb " << valueSv;
+                return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+            }
+            req.method(verb);
+        }
+        else if (nameSv == ":authority")
+        {
+            req.set(boost::beast::http::field::host, valueSv);
+        }
+        else if (nameSv == ":scheme")
+        {
+            // Always https, as only TLS connections negotiate h2
+        }
+        else
+        {
+            req.insert(nameSv, valueSv);
+        }
+        return 0;
+    }
+
+    static int onHeaderCallbackStatic(nghttp2_session* /* session */,
+                                      const nghttp2_frame* frame,
+                                      const uint8_t* name, size_t namelen,
+                                      const uint8_t* value, size_t vallen,
+                                      uint8_t /* flags */, void* userData)
+    {
+        if (frame == nullptr || userData == nullptr)
+        {
+            return NGHTTP2_ERR_CALLBACK_FAILURE;
+        }
+        return userPtrToSelf(userData).onHeaderCallback(
+            *frame, {name, namelen}, {value, vallen});
+    }
+
+    int onBeginHeadersCallback(const nghttp2_frame& frame)
+    {
+        if (frame.hd.type == NGHTTP2_HEADERS &&
+            frame.headers.cat == NGHTTP2_HCAT_REQUEST)
+        {
+            BMCWEB_LOG_DEBUG << this << " create stream "
+                             << frame.hd.stream_id;
+            std::shared_ptr<Http2StreamData> stream =
+                std::make_shared<Http2StreamData>();
+            // HTTP/2 has no keep-alive semantics; the version only keeps
+            // crow::Request helpers behaving as they do for HTTP/1.1
+            stream->beastReq.version(11);
+            streams.emplace(frame.hd.stream_id, std::move(stream));
+        }
+        return 0;
+    }
+
+    static int onBeginHeadersCallbackStatic(nghttp2_session* /* session */,
+                                            const nghttp2_frame* frame,
+                                            void* userData)
+    {
+        if (frame == nullptr || userData == nullptr)
+        {
+            return NGHTTP2_ERR_CALLBACK_FAILURE;
+        }
+        return userPtrToSelf(userData).onBeginHeadersCallback(*frame);
+    }
+
+    // Frames of the stream may still be in the buffer being parsed, so it
+    // stays in streams until nghttp2 closes it, but nothing more of it is
+    // kept or dispatched
+    void refuseStream(int32_t streamId, Http2StreamData& stream)
+    {
+        stream.refused = true;
+        bufferedBodyBytes -= stream.bodyBytes;
+        stream.bodyBytes = 0;
+        stream.beastReq.body().clear();
+        stream.beastReq.body().shrink_to_fit();
+        cleanupUndispatchedSession(stream);
+        ngSession.submitRstStream(streamId, NGHTTP2_REFUSED_STREAM);
+    }
+
+    int onDataChunkRecvCallback(int32_t streamId, std::span<const uint8_t> data)
+    {
+        auto streamIt = streams.find(streamId);
+        if (streamIt == streams.end())
+        {
+            return 0;
+        }
+        Http2StreamData& stream = *streamIt->second;
+        // Streams that aren't logged in get the same small limit as HTTP/1.1
+        // requests that aren't
+        size_t limit = stream.session != nullptr ? httpReqBodyLimit
+                                                 : loggedOutPostBodyLimit;
+        if (stream.refused)
+        {
+            return 0;
+        }
+        if (stream.bodyBytes + data.size() > limit)
+        {
+            BMCWEB_LOG_WARNING << this << " Request body too large on stream "
+                               << streamId;
+            refuseStream(streamId, stream);
+            return 0;
+        }
+        if (bufferedBodyBytes + data.size() > http2BufferedBodyLimit)
+        {
+            BMCWEB_LOG_WARNING << this
+                               << " Too much request body buffered, refusing "
+                               << "stream " << streamId;
+            refuseStream(streamId, stream);
+            return 0;
+        }
+        stream.bodyBytes += data.size();
+        bufferedBodyBytes += data.size();
+        stream.beastReq.body().append(
+            reinterpret_cast<const char*>(data.data()), data.size());
+        return 0;
+    }
+
+    static int onDataChunkRecvCallbackStatic(nghttp2_session* /* session */,
+                                             uint8_t /* flags */,
+                                             int32_t streamId,
+                                             const uint8_t* data, size_t len,
+                                             void* userData)
+    {
+        if (userData == nullptr)
+        {
+            return NGHTTP2_ERR_CALLBACK_FAILURE;
+        }
+        return userPtrToSelf(userData).onDataChunkRecvCallback(streamId,
+                                                               {data, len});
+    }
+
+    void writeBuffer()
+    {
+        if (isWriting)
+        {
+            return;
+        }
+        std::string_view data = ngSession.memSend();
+        if (data.empty())
+        {
+            if (!ngSession.wantRead() && !ngSession.wantWrite())
+            {
+                close();
+            }
+            return;
+        }
+        // memSend data is only valid until the next call into the session,
+        // which can happen from a read while this write is in progress
+        outBuffer.assign(data);
+        isWriting = true;
+        boost::asio::async_write(
+            adaptor, boost::asio::buffer(outBuffer),
+            [self(shared_from_this())](const boost::system::error_code& ec,
+                                       size_t sendLength) {
+                self->isWriting = false;
+                BMCWEB_LOG_DEBUG << self.get() << " Sent " << sendLength;
+                if (ec)
+                {
+                    self->close();
+                    return;
+                }
+                self->writeBuffer();
+            });
+    }
+
+    void startIdleTimer()
+    {
+        timer.expires_after(http2IdleTimeout);
+        std::weak_ptr<self_type> weakSelf = weak_from_this();
+        timer.async_wait([weakSelf](const boost::system::error_code& ec) {
+            std::shared_ptr<self_type> self = weakSelf.lock();
+            if (!self || ec == boost::asio::error::operation_aborted)
+            {
+                return;
+            }
+            if (ec)
+            {
+                BMCWEB_LOG_CRITICAL << self << " timer failed " << ec;
+            }
+            if (self->isHandling())
+            {
+                self->startIdleTimer();
+                return;
+            }
+            BMCWEB_LOG_WARNING << self << " HTTP/2 connection timed out, "
+                               << "closing";
+            self->close();
+        });
+    }
+
+    bool isHandling() const
+    {
+        return std::any_of(streams.begin(), streams.end(), [](const auto& it) {
+            return it.second->handling;
+        });
+    }
+
+    void close()
+    {
+        timer.cancel();
+        if constexpr (std::is_same_v<Adaptor,
+                                     boost::beast::ssl_stream<
+                                         boost::asio::ip::tcp::socket>>)
+        {
+            ensuressl::keepSessionResumable(adaptor.native_handle());
+            adaptor.next_layer().close();
+#ifdef BMCWEB_ENABLE_MUTUAL_TLS_AUTHENTICATION
+            if (tlsSession != nullptr)
+            {
+                BMCWEB_LOG_DEBUG
+                    << this
+                    << " Removing TLS session: " << tlsSession->uniqueId;
+                persistent_data::SessionStore::getInstance().removeSession(
+                    tlsSession);
+                tlsSession = nullptr;
+            }
+#endif // BMCWEB_ENABLE_MUTUAL_TLS_AUTHENTICATION
+        }
+        else
+        {
+            adaptor.close();
+        }
+    }
+
+    void doRead()
+    {
+        BMCWEB_LOG_DEBUG << this << " doRead";
+        adaptor.async_read_some(
+            boost::asio::buffer(inBuffer),
+            [self(shared_from_this())](const boost::system::error_code& ec,
+                                       size_t bytesTransferred) {
+                BMCWEB_LOG_DEBUG << self.get() << " async_read_some "
+                                 << bytesTransferred << " Bytes";
+
+                if (ec)
+                {
+                    BMCWEB_LOG_DEBUG << self.get()
+                                     << " Error while reading: "
+                                     << ec.message();
+                    self->close();
+                    return;
+                }
+                // Any frame from the client counts as activity
+                self->startIdleTimer();
+                std::span<const uint8_t> bufferSpan{
+                    self->inBuffer.data(), bytesTransferred};
+
+                ssize_t readLen = self->ngSession.memRecv(bufferSpan);
+                if (readLen < 0)
+                {
+                    BMCWEB_LOG_ERROR << self.get() << " nghttp2 error: "
+                                     << nghttp2_strerror(
+                                            static_cast<int>(readLen));
+                    self->close();
+                    return;
+                }
+                self->writeBuffer();
+                self->doRead();
+            });
+    }
+
+    // A mapping from http2 stream ID to Stream Data
+    boost::container::flat_map<int32_t, std::shared_ptr<Http2StreamData>>
+        streams;
+
+    std::array<uint8_t, 8192> inBuffer{};
+    std::string outBuffer;
+    bool isWriting = false;
+    // Sum of bodyBytes over all streams
+    size_t bufferedBodyBytes = 0;
+
+    Adaptor adaptor;
+    Nghttp2SessionCallbacks callbacks;
+    Nghttp2Session ngSession;
+    boost::asio::steady_timer timer;
+
+    Handler* handler;
+    std::function<std::string()>& getCachedDateStr;
+    boost::asio::ip::address ipAddress;
+    std::shared_ptr<persistent_data::UserSession> tlsSession;
+
+    using std::enable_shared_from_this<
+        HTTP2Connection<Adaptor, Handler>>::shared_from_this;
+
+    using std::enable_shared_from_this<
+        HTTP2Connection<Adaptor, Handler>>::weak_from_this;
+};
+
+} // namespace crow
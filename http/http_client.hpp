@@ -14,251 +14,941 @@
 // limitations under the License.
 */
 #pragma once
+#include "bmcweb_config.h"
+
+#include "logging.hpp"
+
+#include <openssl/ssl.h>
+
 #include <boost/asio/ip/address.hpp>
 #include <boost/asio/ip/basic_endpoint.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/ssl/context.hpp>
 #include <boost/asio/steady_timer.hpp>
-#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/flat_static_buffer.hpp>
 #include <boost/beast/core/tcp_stream.hpp>
 #include <boost/beast/http/message.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/span_body.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
 #include <boost/beast/ssl/ssl_stream.hpp>
 #include <boost/beast/version.hpp>
-#include <boost/circular_buffer.hpp>
 #include <include/async_resolve.hpp>
+#include <nlohmann/json.hpp>
+#include <stats.hpp>
+#include <tls_session_cache.hpp>
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <cstdlib>
+#include <deque>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
-#include <queue>
+#include <optional>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace crow
 {
 
-static constexpr uint8_t maxRequestQueueSize = 50;
 static constexpr unsigned int httpReadBodyLimit = 8192;
 
+// The Id of the event in data, for logging.  Only done when a send fails, as
+// it parses the whole event.
+inline uint64_t getEventId(const std::string& data)
+{
+    uint64_t eventId = 0;
+    auto eventData = nlohmann::json::parse(data, nullptr, false);
+    if (!eventData.is_discarded())
+    {
+        for (const auto& item : eventData.items())
+        {
+            if (item.key() == "Id")
+            {
+                const uint64_t* id = item.value().get_ptr<const uint64_t*>();
+                if (id != nullptr)
+                {
+                    eventId = *id;
+                }
+            }
+        }
+    }
+    return eventId;
+}
+
+// Whether a subscriber still sends events.  Only changes once the retry
+// policy gives up on one of them.
 enum class ConnState
 {
-    initialized,
-    resolveInProgress,
-    resolveFailed,
-    connectInProgress,
-    connectFailed,
-    handshakeInProgress,
-    handshakeFailed,
-    connected,
-    sendInProgress,
-    sendFailed,
-    recvInProgress,
-    recvFailed,
-    idle,
-    closeInProgress,
-    closed,
+    active,
     suspended,
-    terminated,
-    abortConnection,
-    retry
+    terminated
 };
 
+/**
+ * ConnectionPolicy
+ * Limits for the connections to one destination, which every subscriber
+ * sending to the same protocol, host and port shares.
+ */
+struct ConnectionPolicy
+{
+    // Events queued or being sent to the destination before new ones are
+    // dropped.  Each subscriber may only hold an equal share of them.
+    size_t queueDepth = bmcwebHttpClientQueueDepth;
+    // Connections opened to the destination while events are backed up
+    size_t maxConnections = bmcwebHttpClientConnections;
+    // Events written on a connection before reading their responses.  1 sends
+    // each event only once the previous one was answered.
+    size_t pipelineDepth = bmcwebHttpClientPipelineDepth;
+    // How long a connection with nothing to send is kept open
+    std::chrono::seconds idleTimeout{60};
+};
+
+class ConnectionPool;
+
 class HttpClient : public std::enable_shared_from_this<HttpClient>
 {
+  public:
+    explicit HttpClient(boost::asio::io_context& ioc, const std::string& id,
+                        const std::string& destIP, const std::string& destPort,
+                        const std::string& destUri, const std::string& uriProto,
+                        const boost::beast::http::fields& httpHeader);
+
+    HttpClient(std::shared_ptr<ConnectionPool> poolIn, const std::string& id,
+               const std::string& destUri,
+               const boost::beast::http::fields& httpHeader);
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient(HttpClient&&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+    HttpClient& operator=(HttpClient&&) = delete;
+    ~HttpClient();
+
+    // Queues an event.  data is shared with the other subscribers it is
+    // sent to, so it is never modified.  Returns false if it was dropped
+    // right away.  Otherwise done, if set, is called once the event was
+    // delivered, or given up on.
+    bool sendData(const std::shared_ptr<const std::string>& data,
+                  std::function<void(bool delivered)> done = nullptr);
+
+    void setRetryConfig(const uint32_t retryAttempts,
+                        const uint32_t retryTimeoutInterval)
+    {
+        maxRetryAttempts = retryAttempts;
+        retryIntervalSecs = retryTimeoutInterval;
+    }
+
+    void setRetryPolicy(const std::string& retryPolicy)
+    {
+        retryPolicyAction = retryPolicy;
+    }
+
+    ConnState getConnState()
+    {
+        return state;
+    }
+
+    const std::string& getSubId() const
+    {
+        return subId;
+    }
+
+    const std::string& getTarget() const
+    {
+        return target;
+    }
+
+    const boost::beast::http::fields& getHeaders() const
+    {
+        return headers;
+    }
+
+    uint32_t getMaxRetryAttempts() const
+    {
+        return maxRetryAttempts;
+    }
+
+    uint32_t getRetryIntervalSecs() const
+    {
+        return retryIntervalSecs;
+    }
+
+    // Called by the pool once data failed to be delivered more than
+    // maxRetryAttempts times.  The event is dropped either way.
+    void retriesExhausted(const std::string& data)
+    {
+        BMCWEB_LOG_ERROR << "Maximum number of retries reached for Subscriber:"
+                         << subId << " Event: " << getEventId(data);
+
+        if (retryPolicyAction == "TerminateAfterRetries")
+        {
+            state = ConnState::terminated;
+            // TODO :Remove the subscription
+            BMCWEB_LOG_ERROR << "TerminateAfterRetries is set. Subscriber: "
+                             << subId;
+            return;
+        }
+        if (retryPolicyAction == "SuspendRetries")
+        {
+            state = ConnState::suspended;
+            BMCWEB_LOG_ERROR << "SuspendRetries is set. Subscriber: " << subId
+                             << " suspended";
+            return;
+        }
+        BMCWEB_LOG_DEBUG << retryPolicyAction
+                         << " is set. Dropping the event for subId: " << subId;
+    }
+
   private:
-    crow::async_resolve::Resolver resolver;
-    boost::asio::ssl::context ctx{boost::asio::ssl::context::tlsv13_client};
-    boost::beast::tcp_stream conn;
-    std::optional<boost::beast::ssl_stream<boost::beast::tcp_stream&>> sslConn;
-    boost::asio::steady_timer timer;
-    boost::beast::flat_static_buffer<httpReadBodyLimit> buffer;
-    boost::beast::http::request<boost::beast::http::string_body> req;
-    std::optional<
-        boost::beast::http::response_parser<boost::beast::http::string_body>>
-        parser;
-    boost::circular_buffer_space_optimized<std::string> requestDataQueue{
-        maxRequestQueueSize};
+    // What the pool knows of the subscriber: it sends one event of a
+    // subscriber at a time, so they arrive in order, and holds back the
+    // events of a subscriber whose last one failed until it may retry
+    friend class ConnectionPool;
+    bool sending = false;
+    std::chrono::steady_clock::time_point retryAt;
+    // Events of the subscriber queued or being sent
+    size_t queued = 0;
 
-    ConnState state = ConnState::initialized;
+    std::shared_ptr<ConnectionPool> pool;
+    ConnState state = ConnState::active;
 
     std::string subId;
-    std::string host;
-    std::string port;
-    uint32_t retryCount = 0;
+    std::string target;
+    boost::beast::http::fields headers;
     uint32_t maxRetryAttempts = 5;
     uint32_t retryIntervalSecs = 0;
     std::string retryPolicyAction = "TerminateAfterRetries";
-    bool runningTimer = false;
+};
+
+// An event queued for a destination, or being sent to it
+struct PendingRequest
+{
+    // Shared with the other subscribers the event is sent to
+    std::shared_ptr<const std::string> data;
+    // The subscriber that sent it, whose target, headers and retry policy
+    // it's sent with.  Queued events don't keep it alive, so that a deleted
+    // subscription stops sending; its events are dropped.
+    std::weak_ptr<HttpClient> client;
+    uint32_t retryCount = 0;
+    std::function<void(bool delivered)> done = nullptr;
+};
+
+class ConnectionInfo;
+
+/**
+ * ConnectionPool
+ * Delivers the events of every subscriber sending to one destination.  Events
+ * wait in a single queue, and are sent over up to maxConnections keep-alive
+ * connections, several at a time when the policy allows pipelining.  Each
+ * subscriber has one event out at a time, so that its events arrive in order
+ * even when one has to be retried, and one that failed holds back only the
+ * events of its own subscriber.  The TLS session of the last connection is
+ * kept so that new connections resume it rather than doing a full handshake.
+ */
+class ConnectionPool : public std::enable_shared_from_this<ConnectionPool>
+{
+  public:
+    ConnectionPool(boost::asio::io_context& iocIn, const std::string& hostIn,
+                   const std::string& portIn, bool useTlsIn,
+                   const ConnectionPolicy& policyIn = ConnectionPolicy()) :
+        ioc(iocIn),
+        host(hostIn), port(portIn), useTls(useTlsIn), policy(policyIn),
+        retryTimer(iocIn)
+    {
+        sslCtx.set_options(boost::asio::ssl::context::no_tlsv1_1);
+    }
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool(ConnectionPool&&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(ConnectionPool&&) = delete;
+    ~ConnectionPool() = default;
+
+    // Returns false, dropping the event, if the destination already has
+    // queueDepth events waiting or being sent.  A subscriber may use the
+    // whole queue while the others don't need it.  Once it is full, an event
+    // of a subscriber that has fewer queued than another takes the place of
+    // the newest waiting event of the one that has the most, so that a
+    // subscriber that sends faster than the destination takes can't crowd
+    // out the others.
+    bool enqueue(PendingRequest&& request)
+    {
+        std::shared_ptr<HttpClient> client = request.client.lock();
+        if (client == nullptr)
+        {
+            return false;
+        }
+        if (queue.size() + inFlight >= policy.queueDepth &&
+            !evictForFairness(*client))
+        {
+            BMCWEB_LOG_ERROR << "Request queue for " << host << ":" << port
+                             << " is full. So ignoring data."
+                             << " Event: " << getEventId(*request.data);
+            bmcweb::stats::increment("http_client.dropped");
+            return false;
+        }
+        client->queued++;
+        queue.push_back(std::move(request));
+        schedule();
+        return true;
+    }
+
+    size_t getConnectionCount() const
+    {
+        return connections.size();
+    }
+
+    // The rest is called by the connections of the pool
+
+    // Hands queued events to connections that are free, and opens another
+    // one if events are still waiting
+    void schedule();
+
+    // Takes up to pipelineDepth events that can be sent now: the first
+    // queued event of each subscriber that has none out and isn't waiting
+    // to retry.  Events of subscribers that are gone are dropped.  May be
+    // empty.
+    std::vector<PendingRequest> takeBatch()
+    {
+        std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+        size_t count = std::max<size_t>(policy.pipelineDepth, 1);
+        std::vector<PendingRequest> batch;
+        for (auto it = queue.begin();
+             it != queue.end() && batch.size() < count;)
+        {
+            std::shared_ptr<HttpClient> client = it->client.lock();
+            if (client == nullptr)
+            {
+                bmcweb::stats::increment("http_client.abandoned");
+                finish(*it, false);
+                it = queue.erase(it);
+                continue;
+            }
+            if (!isSendable(*client, now))
+            {
+                it++;
+                continue;
+            }
+            client->sending = true;
+            batch.push_back(std::move(*it));
+            it = queue.erase(it);
+        }
+        inFlight += batch.size();
+        return batch;
+    }
+
+    void delivered(PendingRequest& request)
+    {
+        inFlight--;
+        std::shared_ptr<HttpClient> client = request.client.lock();
+        if (client != nullptr)
+        {
+            client->sending = false;
+        }
+        bmcweb::stats::increment("http_client.delivered");
+        finish(request, true);
+    }
+
+    // Puts events that weren't delivered back at the front of the queue,
+    // ahead of the later events of their subscribers.  countRetry is false
+    // when the destination never got the chance to answer them, like when
+    // it closed the connection first.  Events of subscribers that stopped
+    // sending or went away in the meantime are dropped.
+    void requeue(std::vector<PendingRequest>&& requests, bool countRetry)
+    {
+        inFlight -= requests.size();
+        std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+        std::vector<PendingRequest> exhausted;
+        for (auto it = requests.rbegin(); it != requests.rend(); it++)
+        {
+            std::shared_ptr<HttpClient> clientPtr = it->client.lock();
+            if (clientPtr == nullptr)
+            {
+                bmcweb::stats::increment("http_client.abandoned");
+                finish(*it, false);
+                continue;
+            }
+            HttpClient& client = *clientPtr;
+            client.sending = false;
+            if (client.getConnState() != ConnState::active)
+            {
+                bmcweb::stats::increment("http_client.abandoned");
+                finish(*it, false);
+                continue;
+            }
+            if (countRetry)
+            {
+                if (++it->retryCount > client.getMaxRetryAttempts())
+                {
+                    exhausted.push_back(std::move(*it));
+                    continue;
+                }
+                client.retryAt =
+                    now + std::chrono::seconds(client.getRetryIntervalSecs());
+            }
+            queue.push_front(std::move(*it));
+        }
+        for (PendingRequest& request : exhausted)
+        {
+            giveUp(request);
+        }
+        if (countRetry)
+        {
+            waitToRetry();
+        }
+    }
+
+    void connectionClosed(const ConnectionInfo* conn)
+    {
+        removeConnection(conn);
+        schedule();
+    }
+
+    // Without a connection, the first queued event of each subscriber counts
+    // the attempt, as it would have with a connection of its own
+    void connectionFailed(const ConnectionInfo* conn)
+    {
+        removeConnection(conn);
+
+        std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+        std::set<const HttpClient*> seen;
+        for (auto it = queue.begin(); it != queue.end();)
+        {
+            std::shared_ptr<HttpClient> clientPtr = it->client.lock();
+            if (clientPtr == nullptr)
+            {
+                bmcweb::stats::increment("http_client.abandoned");
+                finish(*it, false);
+                it = queue.erase(it);
+                continue;
+            }
+            HttpClient& client = *clientPtr;
+            if (!seen.insert(&client).second)
+            {
+                it++;
+                continue;
+            }
+            if (++it->retryCount <= client.getMaxRetryAttempts())
+            {
+                client.retryAt =
+                    now + std::chrono::seconds(client.getRetryIntervalSecs());
+                it++;
+                continue;
+            }
+            PendingRequest request = std::move(*it);
+            it = queue.erase(it);
+            giveUp(request);
+            // giveUp may have removed any of the queue
+            it = queue.begin();
+        }
+        waitToRetry();
+    }
+
+    // Sets up ssl for a new connection, resuming the last TLS session
+    void prepareTls(SSL* ssl)
+    {
+        if (tlsSession != nullptr)
+        {
+            SSL_set_session(ssl, tlsSession.get());
+        }
+    }
+
+    // Keeps the session of a connection for the next ones.  Done after a
+    // response was read, since TLS 1.3 sends session tickets after the
+    // handshake.
+    void saveTlsSession(SSL* ssl)
+    {
+        SSL_SESSION* session = SSL_get1_session(ssl);
+        if (session == nullptr)
+        {
+            return;
+        }
+        if (SSL_SESSION_is_resumable(session) == 0)
+        {
+            SSL_SESSION_free(session);
+            return;
+        }
+        tlsSession.reset(session, SSL_SESSION_free);
+    }
+
+    boost::asio::io_context& getIoContext()
+    {
+        return ioc;
+    }
+
+    boost::asio::ssl::context& getSslContext()
+    {
+        return sslCtx;
+    }
+
+    const std::string& getHost() const
+    {
+        return host;
+    }
+
+    const std::string& getPort() const
+    {
+        return port;
+    }
+
+    bool isTls() const
+    {
+        return useTls;
+    }
+
+    const ConnectionPolicy& getPolicy() const
+    {
+        return policy;
+    }
+
+    // Called as subscribers come and go.  The pool stays shared for as
+    // long as any subscriber sends to its destination.
+    void addClient()
+    {
+        clients++;
+    }
+
+    void removeClient();
+
+  private:
+    static bool isSendable(const HttpClient& client,
+                           std::chrono::steady_clock::time_point now)
+    {
+        return !client.sending && client.retryAt <= now;
+    }
+
+    // Whether a new connection would have anything to send
+    bool hasSendable() const
+    {
+        std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+        return std::any_of(queue.begin(), queue.end(),
+                           [now](const PendingRequest& request) {
+                               std::shared_ptr<HttpClient> client =
+                                   request.client.lock();
+                               return client != nullptr &&
+                                      isSendable(*client, now);
+                           });
+    }
+
+    void removeConnection(const ConnectionInfo* conn)
+    {
+        connections.erase(
+            std::remove_if(connections.begin(), connections.end(),
+                           [conn](const std::shared_ptr<ConnectionInfo>& c) {
+                               return c.get() == conn;
+                           }),
+            connections.end());
+    }
+
+    // Drops the newest waiting event of the subscriber with the most events
+    // queued, if it has at least two more than client.  Returns whether one
+    // was dropped.
+    bool evictForFairness(const HttpClient& client)
+    {
+        auto newest = queue.end();
+        size_t most = client.queued + 1;
+        for (auto it = queue.rbegin(); it != queue.rend(); it++)
+        {
+            std::shared_ptr<HttpClient> other = it->client.lock();
+            if (other != nullptr && other->queued > most)
+            {
+                most = other->queued;
+                newest = std::prev(it.base());
+            }
+        }
+        if (newest == queue.end())
+        {
+            return false;
+        }
+        std::shared_ptr<HttpClient> other = newest->client.lock();
+        BMCWEB_LOG_ERROR << "Request queue for " << host << ":" << port
+                         << " is full. Dropping an event of subscriber "
+                         << other->getSubId() << " to make room for "
+                         << client.getSubId()
+                         << ". Event: " << getEventId(*newest->data);
+        bmcweb::stats::increment("http_client.dropped");
+        finish(*newest, false);
+        queue.erase(newest);
+        return true;
+    }
+
+    // Tells the subscriber what became of an event.  Posted, so that it can
+    // send more without the pool being in the middle of something.  Every
+    // event that was queued ends up here once.
+    void finish(PendingRequest& request, bool delivered)
+    {
+        std::shared_ptr<HttpClient> client = request.client.lock();
+        if (client != nullptr)
+        {
+            client->queued--;
+        }
+        if (!request.done)
+        {
+            return;
+        }
+        boost::asio::post(ioc, [done = std::move(request.done), delivered] {
+            done(delivered);
+        });
+    }
+
+    // Applies the retry policy of the subscriber to an event that ran out of
+    // retries.  A subscriber that stops sending loses its other events too.
+    void giveUp(PendingRequest& request)
+    {
+        bmcweb::stats::increment("http_client.abandoned");
+        std::shared_ptr<HttpClient> client = request.client.lock();
+        if (client == nullptr)
+        {
+            finish(request, false);
+            return;
+        }
+        client->retriesExhausted(*request.data);
+        finish(request, false);
+        if (client->getConnState() == ConnState::active)
+        {
+            return;
+        }
+        auto others = std::stable_partition(
+            queue.begin(), queue.end(), [&client](const PendingRequest& r) {
+                return r.client.lock() != client;
+            });
+        for (auto it = others; it != queue.end(); it++)
+        {
+            bmcweb::stats::increment("http_client.abandoned");
+            finish(*it, false);
+        }
+        queue.erase(others, queue.end());
+    }
 
-    void doResolve()
+    // Wakes the pool when the first subscriber waiting to retry may
+    void waitToRetry()
     {
-        state = ConnState::resolveInProgress;
-        BMCWEB_LOG_DEBUG << "Trying to resolve: " << host << ":" << port;
+        std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+        std::optional<std::chrono::steady_clock::time_point> earliest;
+        for (const PendingRequest& request : queue)
+        {
+            std::shared_ptr<HttpClient> client = request.client.lock();
+            if (client == nullptr)
+            {
+                continue;
+            }
+            std::chrono::steady_clock::time_point retryAt = client->retryAt;
+            if (retryAt > now && (!earliest || retryAt < *earliest))
+            {
+                earliest = retryAt;
+            }
+        }
+        if (!earliest)
+        {
+            // Nothing waits, but some may have just stopped waiting
+            boost::asio::post(ioc,
+                              [self = shared_from_this()] { self->schedule(); });
+            return;
+        }
+        if (waitingToRetry && retryTimer.expiry() <= *earliest)
+        {
+            return;
+        }
+        waitingToRetry = true;
+        BMCWEB_LOG_DEBUG << "Attempt retry to " << host << ":" << port
+                         << " in "
+                         << std::chrono::duration_cast<std::chrono::seconds>(
+                                *earliest - now)
+                                .count()
+                         << " seconds";
+        retryTimer.expires_at(*earliest);
+        retryTimer.async_wait(
+            [self = shared_from_this()](const boost::system::error_code ec) {
+                if (ec == boost::asio::error::operation_aborted)
+                {
+                    // Set again for an earlier retry
+                    return;
+                }
+                if (ec)
+                {
+                    // Continue the retry loop regardless, so events are sent
+                    // as per the retry policy
+                    BMCWEB_LOG_ERROR << "async_wait failed: " << ec.message();
+                }
+                self->waitingToRetry = false;
+                self->schedule();
+                self->waitToRetry();
+            });
+    }
+
+    boost::asio::io_context& ioc;
+    std::string host;
+    std::string port;
+    bool useTls;
+    ConnectionPolicy policy;
+
+    boost::asio::ssl::context sslCtx{boost::asio::ssl::context::tlsv13_client};
+    std::shared_ptr<SSL_SESSION> tlsSession;
+
+    std::deque<PendingRequest> queue;
+    // Events taken from the queue by a connection and not yet answered
+    size_t inFlight = 0;
+    std::vector<std::shared_ptr<ConnectionInfo>> connections;
+
+    boost::asio::steady_timer retryTimer;
+    bool waitingToRetry = false;
+
+    // Subscribers sending through the pool
+    size_t clients = 0;
+};
+
+/**
+ * ConnectionInfo
+ * One keep-alive connection of a ConnectionPool.  Each batch of events taken
+ * from the pool is written back to back, then their responses are read in
+ * order.  Events that weren't answered go back to the pool.
+ */
+class ConnectionInfo : public std::enable_shared_from_this<ConnectionInfo>
+{
+  public:
+    explicit ConnectionInfo(std::shared_ptr<ConnectionPool> poolIn) :
+        pool(std::move(poolIn)), conn(pool->getIoContext()),
+        idleTimer(pool->getIoContext())
+    {}
+
+    bool isConnecting() const
+    {
+        return state == State::connecting;
+    }
+
+    bool isReady() const
+    {
+        return state == State::ready;
+    }
+
+    void start()
+    {
+        state = State::connecting;
+        BMCWEB_LOG_DEBUG << "Trying to resolve: " << pool->getHost() << ":"
+                         << pool->getPort();
+
+        // Addresses don't need to be resolved
+        boost::system::error_code ec;
+        boost::asio::ip::address address =
+            boost::asio::ip::make_address(pool->getHost(), ec);
+        uint16_t portNum = 0;
+        const std::string& port = pool->getPort();
+        auto it = std::from_chars(port.data(), port.data() + port.size(),
+                                  portNum);
+        if (!ec && it.ec == std::errc())
+        {
+            doConnect({boost::asio::ip::tcp::endpoint(address, portNum)});
+            return;
+        }
 
-        auto respHandler =
+        resolver.asyncResolve(
+            pool->getHost(), pool->getPort(),
             [self(shared_from_this())](
-                const boost::beast::error_code ec,
+                const boost::beast::error_code ec2,
                 const std::vector<boost::asio::ip::tcp::endpoint>&
                     endpointList) {
-                if (ec || (endpointList.size() == 0))
+                if (ec2 || (endpointList.size() == 0))
                 {
-                    BMCWEB_LOG_ERROR << "Resolve failed: " << ec.message()
-                                     << " Destination: " << self->host << ":"
-                                     << self->port;
-                    self->state = ConnState::resolveFailed;
-                    self->handleConnState();
+                    BMCWEB_LOG_ERROR << "Resolve failed: " << ec2.message()
+                                     << " Destination: "
+                                     << self->pool->getHost() << ":"
+                                     << self->pool->getPort();
+                    self->fail();
                     return;
                 }
                 BMCWEB_LOG_DEBUG << "Resolved";
                 self->doConnect(endpointList);
-            };
-        resolver.asyncResolve(host, port, std::move(respHandler));
+            });
+    }
+
+    void sendBatch(std::vector<PendingRequest>&& batchIn)
+    {
+        state = State::busy;
+        idleTimer.cancel();
+        batch = std::move(batchIn);
+        answered = 0;
+
+        requests.clear();
+        requests.reserve(batch.size());
+        clients.clear();
+        clients.reserve(batch.size());
+        for (const PendingRequest& pending : batch)
+        {
+            // takeBatch only hands out events of subscribers that are there
+            const std::shared_ptr<HttpClient>& client =
+                clients.emplace_back(pending.client.lock());
+            auto& req = requests.emplace_back(
+                boost::beast::http::verb::post, client->getTarget(), 11,
+                boost::beast::span<const char>(), client->getHeaders());
+            req.set(boost::beast::http::field::host, pool->getHost());
+            req.set(boost::beast::http::field::content_type,
+                    "application/json");
+            req.keep_alive(true);
+            req.body() = boost::beast::span<const char>(pending.data->data(),
+                                                        pending.data->size());
+            req.prepare_payload();
+        }
+        bmcweb::stats::increment("http_client.sent", batch.size());
+        sendMessage(0);
     }
 
+  private:
+    enum class State
+    {
+        connecting,
+        ready,
+        busy,
+        closed
+    };
+
     void doConnect(
         const std::vector<boost::asio::ip::tcp::endpoint>& endpointList)
     {
-        state = ConnState::connectInProgress;
-        sslConn.emplace(conn, ctx);
-
-        BMCWEB_LOG_DEBUG << "Trying to connect to: " << host << ":" << port;
-        auto respHandler = [self(shared_from_this())](
-                               const boost::beast::error_code ec,
-                               const boost::asio::ip::tcp::endpoint& endpoint) {
-            if (ec)
-            {
-                BMCWEB_LOG_ERROR
-                    << "Connect " << endpoint << " failed: " << ec.message()
-                    << " Destination: " << self->host << ":" << self->port;
-                self->state = ConnState::connectFailed;
-                self->handleConnState();
-                return;
-            }
+        if (pool->isTls())
+        {
+            sslConn.emplace(conn, pool->getSslContext());
+            pool->prepareTls(sslConn->native_handle());
+        }
 
-            BMCWEB_LOG_DEBUG << "Connected to: " << endpoint;
-            if (self->sslConn)
-            {
-                self->performHandshake();
-            }
-            else
-            {
-                self->handleConnState();
-            }
-        };
+        BMCWEB_LOG_DEBUG << "Trying to connect to: " << pool->getHost() << ":"
+                         << pool->getPort();
+        bmcweb::stats::increment("http_client.connections");
         conn.expires_after(std::chrono::seconds(30));
-        conn.async_connect(endpointList, std::move(respHandler));
+        conn.async_connect(
+            endpointList, [self(shared_from_this())](
+                              const boost::beast::error_code ec,
+                              const boost::asio::ip::tcp::endpoint& endpoint) {
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "Connect " << endpoint
+                                     << " failed: " << ec.message()
+                                     << " Destination: "
+                                     << self->pool->getHost() << ":"
+                                     << self->pool->getPort();
+                    self->fail();
+                    return;
+                }
+
+                BMCWEB_LOG_DEBUG << "Connected to: " << endpoint;
+                if (self->sslConn)
+                {
+                    self->performHandshake();
+                }
+                else
+                {
+                    self->connected();
+                }
+            });
     }
 
     void performHandshake()
     {
-        state = ConnState::handshakeInProgress;
-
         sslConn->async_handshake(
             boost::asio::ssl::stream_base::client,
             [self(shared_from_this())](const boost::beast::error_code ec) {
                 if (ec)
                 {
                     BMCWEB_LOG_ERROR << "SSL handshake failed: " << ec.message()
-                                     << " Destination: " << self->host << ":"
-                                     << self->port;
-                    self->state = ConnState::handshakeFailed;
-                    self->handleConnState();
+                                     << " Destination: "
+                                     << self->pool->getHost() << ":"
+                                     << self->pool->getPort();
+                    self->fail();
                     return;
                 }
 
+                if (SSL_session_reused(self->sslConn->native_handle()) != 0)
+                {
+                    bmcweb::stats::increment("http_client.tls.resumed");
+                }
+                else
+                {
+                    bmcweb::stats::increment("http_client.tls.full");
+                }
                 BMCWEB_LOG_DEBUG << "SSL Handshake successfull";
-                self->state = ConnState::connected;
-                self->handleConnState();
+                self->connected();
             });
     }
 
-    void sendMessage(const std::string& data)
+    void connected()
     {
-        BMCWEB_LOG_DEBUG << __FUNCTION__ << "(): " << host << ":" << port;
-        state = ConnState::sendInProgress;
+        state = State::ready;
+        pool->schedule();
+        if (state == State::ready)
+        {
+            waitIdle();
+        }
+    }
 
-        req.body() = data;
-        req.prepare_payload();
+    void sendMessage(size_t index)
+    {
+        BMCWEB_LOG_DEBUG << __FUNCTION__ << "(): " << pool->getHost() << ":"
+                         << pool->getPort();
 
-        auto respHandler = [self(shared_from_this())](
-                               const boost::beast::error_code ec,
-                               const std::size_t& bytesTransferred) {
+        auto respHandler = [self(shared_from_this()),
+                            index](const boost::beast::error_code ec,
+                                   const std::size_t& bytesTransferred) {
             if (ec)
             {
-                auto eventData =
-                    nlohmann::json::parse(self->req.body(), nullptr, false);
-                uint64_t eventId;
-                if (!eventData.is_discarded())
-                {
-                    for (const auto& item : eventData.items())
-                    {
-                        if (item.key() == "Id")
-                        {
-                            const uint64_t* id =
-                                item.value().get_ptr<const uint64_t*>();
-                            if (id != nullptr)
-                            {
-                                eventId = *id;
-                            }
-                        }
-                    }
-                }
-                BMCWEB_LOG_ERROR << "sendMessage() failed: " << ec.message()
-                                 << " Destination: " << self->host << ":"
-                                 << self->port << " to subId: " << self->subId
-                                 << " Event: " << eventId;
-                self->state = ConnState::sendFailed;
-                self->handleConnState();
+                BMCWEB_LOG_ERROR
+                    << "sendMessage() failed: " << ec.message()
+                    << " Destination: " << self->pool->getHost() << ":"
+                    << self->pool->getPort() << " to subId: "
+                    << self->clients[index]->getSubId()
+                    << " Event: " << getEventId(*self->batch[index].data);
+                self->sendFailed();
                 return;
             }
 
             BMCWEB_LOG_DEBUG << "sendMessage() bytes transferred: "
                              << bytesTransferred;
             boost::ignore_unused(bytesTransferred);
+            if (index + 1 < self->requests.size())
+            {
+                self->sendMessage(index + 1);
+                return;
+            }
             self->recvMessage();
         };
 
+        conn.expires_after(std::chrono::seconds(30));
         if (sslConn)
         {
-            boost::beast::http::async_write(*sslConn, req,
+            boost::beast::http::async_write(*sslConn, requests[index],
                                             std::move(respHandler));
         }
         else
         {
-            boost::beast::http::async_write(conn, req, std::move(respHandler));
+            boost::beast::http::async_write(conn, requests[index],
+                                            std::move(respHandler));
         }
     }
+
     void recvMessage()
     {
-        state = ConnState::recvInProgress;
-
         auto respHandler = [self(shared_from_this())](
                                const boost::beast::error_code ec,
                                const std::size_t& bytesTransferred) {
-            auto eventData =
-                nlohmann::json::parse(self->req.body(), nullptr, false);
-            uint64_t eventId;
-            if (!eventData.is_discarded())
-            {
-                for (const auto& item : eventData.items())
-                {
-                    if (item.key() == "Id")
-                    {
-                        const uint64_t* id =
-                            item.value().get_ptr<const uint64_t*>();
-                        if (id != nullptr)
-                        {
-                            eventId = *id;
-                        }
-                    }
-                }
-            }
+            const PendingRequest& pending = self->batch[self->answered];
             if (ec && ec != boost::asio::ssl::error::stream_truncated)
             {
                 BMCWEB_LOG_ERROR << "recvMessage() failed: " << ec.message()
-                                 << " from subId: " << self->subId
-                                 << " Destination: " << self->host << ":"
-                                 << self->port << " for Event: " << eventId;
-                self->state = ConnState::recvFailed;
-                self->handleConnState();
+                                 << " from subId: "
+                                 << self->clients[self->answered]->getSubId()
+                                 << " Destination: " << self->pool->getHost()
+                                 << ":" << self->pool->getPort()
+                                 << " for Event: " << getEventId(*pending.data);
+                self->sendFailed();
                 return;
             }
 
@@ -272,63 +962,20 @@ class HttpClient : public std::enable_shared_from_this<HttpClient>
                 // The parser failed to receive the response
                 BMCWEB_LOG_ERROR
                     << "recvMessage() parser failed to receive response"
-                    << " from subId: " << self->subId
-                    << " Destination: " << self->host << ":" << self->port
-                    << " for Event: " << eventId;
-                self->state = ConnState::recvFailed;
-                self->handleConnState();
-                return;
-            }
-
-            unsigned int respCode = self->parser->get().result_int();
-            BMCWEB_LOG_DEBUG << "recvMessage() Header Response Code: "
-                             << respCode;
-
-            // 2XX response is considered to be successful
-            if ((respCode < 200) || (respCode >= 300))
-            {
-                // The listener failed to receive the Sent-Event
-                BMCWEB_LOG_ERROR << "recvMessage() Listener Failed to "
-                                    "receive Sent-Event. Header Response Code: "
-                                 << respCode << " from subId: " << self->subId
-                                 << " Destination: " << self->host << ":"
-                                 << self->port << " for Event: " << eventId;
-                self->state = ConnState::recvFailed;
-                self->handleConnState();
+                    << " from subId: "
+                    << self->clients[self->answered]->getSubId()
+                    << " Destination: " << self->pool->getHost() << ":"
+                    << self->pool->getPort()
+                    << " for Event: " << getEventId(*pending.data);
+                self->sendFailed();
                 return;
             }
-
-            // Send is successful, Lets remove data from queue
-            // check for next request data in queue.
-            if (!self->requestDataQueue.empty())
-            {
-                self->requestDataQueue.pop_front();
-            }
-            self->state = ConnState::idle;
-            // Keep the connection alive if server supports it
-            // Else close the connection
-            BMCWEB_LOG_DEBUG << "recvMessage() keepalive : "
-                             << self->parser->keep_alive();
-            if (!self->parser->keep_alive())
-            {
-                // Abort the connection since server is not keep-alive
-                // enabled
-                self->state = ConnState::abortConnection;
-            }
-
-            // Returns ownership of the parsed message
-            self->parser->release();
-
-            // Set the retry count to 0 as the send-recv was successful
-            self->retryCount = 0;
-
-            self->handleConnState();
+            self->received();
         };
+
         parser.emplace(std::piecewise_construct, std::make_tuple());
         parser->body_limit(httpReadBodyLimit);
 
-        // Check only for the response header
-        parser->skip(true);
         conn.expires_after(std::chrono::seconds(30));
         if (sslConn)
         {
@@ -341,12 +988,130 @@ class HttpClient : public std::enable_shared_from_this<HttpClient>
                                            std::move(respHandler));
         }
     }
+
+    // Handles the response to batch[answered]
+    void received()
+    {
+        PendingRequest& pending = batch[answered];
+        const std::string& subId = clients[answered]->getSubId();
+        answered++;
+
+        unsigned int respCode = parser->get().result_int();
+        BMCWEB_LOG_DEBUG << "recvMessage() Header Response Code: " << respCode;
+
+        // 2XX response is considered to be successful
+        if ((respCode < 200) || (respCode >= 300))
+        {
+            // The listener failed to receive the Sent-Event
+            BMCWEB_LOG_ERROR << "recvMessage() Listener Failed to "
+                                "receive Sent-Event. Header Response Code: "
+                             << respCode
+                             << " from subId: " << subId
+                             << " Destination: " << pool->getHost() << ":"
+                             << pool->getPort()
+                             << " for Event: " << getEventId(*pending.data);
+            std::vector<PendingRequest> failed;
+            failed.push_back(std::move(pending));
+            pool->requeue(std::move(failed), true);
+        }
+        else
+        {
+            pool->delivered(pending);
+        }
+        deliveredAny = true;
+
+        if (sslConn && !tlsSessionSaved)
+        {
+            pool->saveTlsSession(sslConn->native_handle());
+            tlsSessionSaved = true;
+        }
+
+        // Keep the connection alive if server supports it
+        // Else close the connection
+        BMCWEB_LOG_DEBUG << "recvMessage() keepalive : "
+                         << parser->keep_alive();
+        if (!parser->keep_alive())
+        {
+            // The rest of the batch was never answered, and goes out on
+            // another connection
+            pool->requeue(takeUnanswered(), false);
+            doClose();
+            return;
+        }
+        if (answered < batch.size())
+        {
+            recvMessage();
+            return;
+        }
+
+        batch.clear();
+        requests.clear();
+        clients.clear();
+        state = State::ready;
+        pool->schedule();
+        if (state == State::ready)
+        {
+            waitIdle();
+        }
+    }
+
+    std::vector<PendingRequest> takeUnanswered()
+    {
+        std::vector<PendingRequest> unanswered(
+            std::make_move_iterator(batch.begin() +
+                                    static_cast<std::ptrdiff_t>(answered)),
+            std::make_move_iterator(batch.end()));
+        batch.clear();
+        requests.clear();
+        clients.clear();
+        return unanswered;
+    }
+
+    void sendFailed()
+    {
+        // A destination may close a keep-alive connection while it's idle,
+        // which is only noticed once the next batch is sent on it.  That
+        // batch is sent again right away, on a new connection.
+        bool stale = deliveredAny && answered == 0;
+        pool->requeue(takeUnanswered(), !stale);
+        closeSocket();
+        state = State::closed;
+        pool->connectionClosed(this);
+    }
+
+    void fail()
+    {
+        closeSocket();
+        state = State::closed;
+        pool->connectionFailed(this);
+    }
+
+    void waitIdle()
+    {
+        idleTimer.expires_after(pool->getPolicy().idleTimeout);
+        idleTimer.async_wait(
+            [self(shared_from_this())](const boost::system::error_code ec) {
+                if (ec || self->state != State::ready ||
+                    self->idleTimer.expiry() >
+                        std::chrono::steady_clock::now())
+                {
+                    return;
+                }
+                BMCWEB_LOG_DEBUG << "Closing idle connection to "
+                                 << self->pool->getHost() << ":"
+                                 << self->pool->getPort();
+                self->doClose();
+            });
+    }
+
     void doClose()
     {
-        state = ConnState::closeInProgress;
+        state = State::closed;
+        idleTimer.cancel();
 
         if (sslConn)
         {
+            conn.expires_after(std::chrono::seconds(30));
             sslConn->async_shutdown([self = shared_from_this()](
                                         const boost::system::error_code ec) {
                 if (ec)
@@ -362,297 +1127,199 @@ class HttpClient : public std::enable_shared_from_this<HttpClient>
                     else
                     {
                         BMCWEB_LOG_ERROR << "doClose() failed: " << ec.message()
-                                         << " Destination: " << self->host
-                                         << ":" << self->port;
+                                         << " Destination: "
+                                         << self->pool->getHost() << ":"
+                                         << self->pool->getPort();
                     }
                 }
                 else
                 {
                     BMCWEB_LOG_DEBUG << "INFO: Connection closed gracefully..."
-                                     << " Destination: " << self->host << ":"
-                                     << self->port;
-                }
-                self->conn.close();
-
-                if ((self->state != ConnState::suspended) &&
-                    (self->state != ConnState::terminated))
-                {
-                    self->state = ConnState::closed;
-                    self->handleConnState();
+                                     << " Destination: "
+                                     << self->pool->getHost() << ":"
+                                     << self->pool->getPort();
                 }
+                self->closeSocket();
+                self->pool->connectionClosed(self.get());
             });
+            return;
+        }
+
+        boost::beast::error_code ec;
+        conn.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both,
+                               ec);
+        if (ec)
+        {
+            BMCWEB_LOG_ERROR << "doClose() failed: " << ec.message();
         }
         else
         {
-            boost::beast::error_code ec;
-            conn.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both,
-                                   ec);
-            if (ec)
-            {
-                BMCWEB_LOG_ERROR << "doClose() failed: " << ec.message();
-            }
-            else
-            {
-                BMCWEB_LOG_DEBUG << "Connection closed gracefully...";
-            }
-            conn.close();
-
-            if ((state != ConnState::suspended) &&
-                (state != ConnState::terminated))
-            {
-                state = ConnState::closed;
-                handleConnState();
-            }
+            BMCWEB_LOG_DEBUG << "Connection closed gracefully...";
         }
+        closeSocket();
+        pool->connectionClosed(this);
     }
 
-    void waitAndRetry()
+    void closeSocket()
     {
-        if (retryCount >= maxRetryAttempts)
+        idleTimer.cancel();
+        if (sslConn)
         {
-            BMCWEB_LOG_ERROR
-                << "Maximum number of retries reached for Subscriber:" << subId;
-
-            if (retryPolicyAction == "TerminateAfterRetries")
-            {
-                // Clear queue.
-                while (!requestDataQueue.empty())
-                {
-                    requestDataQueue.pop_front();
-                }
-
-                state = ConnState::terminated;
-                // TODO :Remove the subscription
-                BMCWEB_LOG_ERROR << "TerminateAfterRetries is set. retryCount: "
-                                 << retryCount << " .Subscriber: " << subId;
-                return;
-            }
-            if (retryPolicyAction == "SuspendRetries")
-            {
-                // Clear queue.
-                while (!requestDataQueue.empty())
-                {
-                    requestDataQueue.pop_front();
-                }
-
-                state = ConnState::suspended;
-                BMCWEB_LOG_ERROR
-                    << "SuspendRetries is set. retryCount: " << retryCount
-                    << " .Subscriber: " << subId << "suspended";
-                return;
-            }
-
-            BMCWEB_LOG_DEBUG << retryPolicyAction
-                             << " is set. Cleanup the current event and "
-                                "reset retrycount for subId: "
-                             << subId;
-            // Reset the retrycount to zero so that client can try connecting
-            // again if needed
-            retryCount = 0;
-
-            // All retries failed, Lets remove data from queue
-            if (!requestDataQueue.empty())
-            {
-                requestDataQueue.pop_front();
-            }
+            ensuressl::keepSessionResumable(sslConn->native_handle());
+        }
+        conn.close();
+    }
 
-            // Reset the connection state to Idle, and try sending the next
-            // event in the queue
-            state = ConnState::idle;
+    std::shared_ptr<ConnectionPool> pool;
+    crow::async_resolve::Resolver resolver;
+    boost::beast::tcp_stream conn;
+    std::optional<boost::beast::ssl_stream<boost::beast::tcp_stream&>> sslConn;
+    boost::asio::steady_timer idleTimer;
+    boost::beast::flat_static_buffer<httpReadBodyLimit> buffer;
+    std::optional<
+        boost::beast::http::response_parser<boost::beast::http::string_body>>
+        parser;
 
-            handleConnState();
-            return;
-        }
+    State state = State::connecting;
+    // The events being sent, and their requests, whose bodies point into
+    // the events
+    std::vector<PendingRequest> batch;
+    std::vector<
+        boost::beast::http::request<boost::beast::http::span_body<const char>>>
+        requests;
+    // The subscribers of batch, kept while their events are out
+    std::vector<std::shared_ptr<HttpClient>> clients;
+    // How many of batch have been answered
+    size_t answered = 0;
+    bool deliveredAny = false;
+    bool tlsSessionSaved = false;
+};
 
-        if (runningTimer)
+inline void ConnectionPool::schedule()
+{
+    // Connections may be removed while batches are handed out
+    std::vector<std::shared_ptr<ConnectionInfo>> current = connections;
+    bool connecting = false;
+    for (const std::shared_ptr<ConnectionInfo>& conn : current)
+    {
+        if (queue.empty())
         {
-            BMCWEB_LOG_DEBUG << "Retry timer is already running.";
             return;
         }
-        runningTimer = true;
-
-        retryCount++;
-
-        BMCWEB_LOG_DEBUG << "Attempt retry after " << retryIntervalSecs
-                         << " seconds. RetryCount = " << retryCount;
-        timer.expires_after(std::chrono::seconds(retryIntervalSecs));
-        timer.async_wait(
-            [self = shared_from_this()](const boost::system::error_code ec) {
-                if (ec == boost::asio::error::operation_aborted)
-                {
-                    BMCWEB_LOG_DEBUG
-                        << "async_wait failed since the operation is aborted"
-                        << ec.message();
-                }
-                else if (ec)
-                {
-                    BMCWEB_LOG_ERROR << "async_wait failed: " << ec.message();
-                    // Ignore the error and continue the retry loop to attempt
-                    // sending the event as per the retry policy
-                }
-                self->runningTimer = false;
-
-                // Lets close connection and start from resolve.
-                self->doClose();
-            });
-        return;
-    }
-
-    void handleConnState()
-    {
-        switch (state)
+        if (conn->isReady())
         {
-            case ConnState::resolveInProgress:
-            case ConnState::connectInProgress:
-            case ConnState::handshakeInProgress:
-            case ConnState::sendInProgress:
-            case ConnState::recvInProgress:
-            case ConnState::closeInProgress:
-            {
-                BMCWEB_LOG_DEBUG << "Async operation is already in progress";
-                break;
-            }
-            case ConnState::initialized:
-            case ConnState::closed:
-            {
-                if (requestDataQueue.empty())
-                {
-                    BMCWEB_LOG_DEBUG << "requestDataQueue is empty";
-                    return;
-                }
-                doResolve();
-                break;
-            }
-            case ConnState::suspended:
-            {
-                doClose();
-                break;
-            }
-            case ConnState::terminated:
-            {
-                BMCWEB_LOG_ERROR << "Subscriber " << subId
-                                 << " connection terminated. Stop";
-                break;
-            }
-            case ConnState::resolveFailed:
-            case ConnState::connectFailed:
-            case ConnState::handshakeFailed:
-            case ConnState::sendFailed:
-            case ConnState::recvFailed:
-            case ConnState::retry:
-            {
-                // In case of failures during connect and handshake
-                // the retry policy will be applied
-                waitAndRetry();
-                break;
-            }
-            case ConnState::connected:
-            case ConnState::idle:
-            {
-                // State idle means, previous attempt is successful
-                // State connected means, client connection is established
-                // successfully
-                if (requestDataQueue.empty())
-                {
-                    BMCWEB_LOG_DEBUG << "requestDataQueue is empty";
-                    return;
-                }
-                std::string data = requestDataQueue.front();
-                sendMessage(data);
-                break;
-            }
-            case ConnState::abortConnection:
+            std::vector<PendingRequest> batch = takeBatch();
+            if (!batch.empty())
             {
-                // Server did not want to keep alive the session
-                doClose();
-                break;
+                conn->sendBatch(std::move(batch));
             }
-            default:
-                break;
         }
+        connecting = connecting || conn->isConnecting();
     }
-
-  public:
-    explicit HttpClient(boost::asio::io_context& ioc, const std::string& id,
-                        const std::string& destIP, const std::string& destPort,
-                        const std::string& destUri, const std::string& uriProto,
-                        const boost::beast::http::fields& httpHeader) :
-        conn(ioc),
-        timer(ioc),
-        req(boost::beast::http::verb::post, destUri, 11, "", httpHeader),
-        subId(id), host(destIP), port(destPort)
+    if (connecting || connections.size() >= policy.maxConnections ||
+        !hasSendable())
     {
-        // Set the request header
-        req.set(boost::beast::http::field::host, host);
-        req.set(boost::beast::http::field::content_type, "application/json");
-        req.keep_alive(true);
-
-        requestDataQueue.set_capacity(maxRequestQueueSize);
-        if (uriProto == "https")
-        {
-            ctx.set_options(boost::asio::ssl::context::no_tlsv1_1);
-            sslConn.emplace(conn, ctx);
-        }
+        return;
     }
-    void sendData(const std::string& data)
-    {
-        auto eventData = nlohmann::json::parse(data, nullptr, false);
-        uint64_t eventId;
-        if (!eventData.is_discarded())
-        {
-            for (const auto& item : eventData.items())
-            {
-                if (item.key() == "Id")
-                {
-                    const uint64_t* id =
-                        item.value().get_ptr<const uint64_t*>();
-                    if (id != nullptr)
-                    {
-                        eventId = *id;
-                    }
-                }
-            }
-        }
+    auto conn = std::make_shared<ConnectionInfo>(shared_from_this());
+    connections.push_back(conn);
+    conn->start();
+}
 
-        if ((state == ConnState::suspended) || (state == ConnState::terminated))
-        {
-            BMCWEB_LOG_ERROR << "sendData: " << subId
-                             << " ConnState is suspended or terminated."
-                             << " Destination: " << host << ":" << port
-                             << " Event: " << eventId;
-            return;
-        }
+// The pools of the destinations subscribers send to
+inline std::unordered_map<std::string, std::shared_ptr<ConnectionPool>>&
+    getConnectionPools()
+{
+    static std::unordered_map<std::string, std::shared_ptr<ConnectionPool>>
+        pools;
+    return pools;
+}
 
-        if (requestDataQueue.size() <= maxRequestQueueSize)
-        {
-            requestDataQueue.push_back(data);
-            handleConnState();
-        }
-        else
-        {
-            BMCWEB_LOG_ERROR << "Request queue is full. So ignoring data."
-                             << " Event: " << eventId;
-        }
+inline std::string getConnectionPoolKey(const std::string& host,
+                                        const std::string& port, bool useTls)
+{
+    return (useTls ? "https://" : "http://") + host + ":" + port;
+}
 
-        return;
+// The pool for a destination, shared by every subscriber sending to it
+inline std::shared_ptr<ConnectionPool>
+    getConnectionPool(boost::asio::io_context& ioc, const std::string& host,
+                      const std::string& port, bool useTls)
+{
+    std::shared_ptr<ConnectionPool>& pool =
+        getConnectionPools()[getConnectionPoolKey(host, port, useTls)];
+    if (pool == nullptr)
+    {
+        pool = std::make_shared<ConnectionPool>(ioc, host, port, useTls);
     }
+    return pool;
+}
 
-    void setRetryConfig(const uint32_t retryAttempts,
-                        const uint32_t retryTimeoutInterval)
+// Drops the queued events of the subscriber that went away.  Once no
+// subscriber sends to the destination, the pool is no longer shared.  Its
+// connections close once idle.
+inline void ConnectionPool::removeClient()
+{
+    auto gone = std::stable_partition(
+        queue.begin(), queue.end(),
+        [](const PendingRequest& r) { return !r.client.expired(); });
+    for (auto it = gone; it != queue.end(); it++)
     {
-        maxRetryAttempts = retryAttempts;
-        retryIntervalSecs = retryTimeoutInterval;
+        bmcweb::stats::increment("http_client.abandoned");
+        finish(*it, false);
     }
+    queue.erase(gone, queue.end());
 
-    void setRetryPolicy(const std::string& retryPolicy)
+    if (--clients > 0)
     {
-        retryPolicyAction = retryPolicy;
+        return;
+    }
+    auto& pools = getConnectionPools();
+    auto it = pools.find(getConnectionPoolKey(host, port, useTls));
+    if (it != pools.end() && it->second.get() == this)
+    {
+        pools.erase(it);
     }
+}
 
-    ConnState getConnState()
+inline HttpClient::HttpClient(std::shared_ptr<ConnectionPool> poolIn,
+                              const std::string& id,
+                              const std::string& destUri,
+                              const boost::beast::http::fields& httpHeader) :
+    pool(std::move(poolIn)),
+    subId(id), target(destUri), headers(httpHeader)
+{
+    pool->addClient();
+}
+
+inline HttpClient::~HttpClient()
+{
+    pool->removeClient();
+}
+
+inline HttpClient::HttpClient(boost::asio::io_context& ioc,
+                              const std::string& id, const std::string& destIP,
+                              const std::string& destPort,
+                              const std::string& destUri,
+                              const std::string& uriProto,
+                              const boost::beast::http::fields& httpHeader) :
+    HttpClient(getConnectionPool(ioc, destIP, destPort, uriProto == "https"),
+               id, destUri, httpHeader)
+{}
+
+inline bool HttpClient::sendData(const std::shared_ptr<const std::string>& data,
+                                 std::function<void(bool delivered)> done)
+{
+    if (state != ConnState::active)
     {
-        return state;
+        BMCWEB_LOG_ERROR << "sendData: " << subId
+                         << " ConnState is suspended or terminated."
+                         << " Destination: " << pool->getHost() << ":"
+                         << pool->getPort() << " Event: " << getEventId(*data);
+        return false;
     }
-};
+    return pool->enqueue(
+        PendingRequest{data, weak_from_this(), 0, std::move(done)});
+}
 
 } // namespace crow
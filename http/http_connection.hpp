@@ -5,8 +5,10 @@
 #include "audit_events.hpp"
 #endif
 #include "authorization.hpp"
+#include "gzip_helper.hpp"
 #include "http_response.hpp"
 #include "http_utility.hpp"
+#include "json_body.hpp"
 #include "logging.hpp"
 #include "utility.hpp"
 
@@ -17,12 +19,15 @@
 #include <boost/asio/ssl/stream.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/beast/core/flat_static_buffer.hpp>
+#include <boost/beast/http/span_body.hpp>
 #include <boost/beast/ssl/ssl_stream.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/url/url_view.hpp>
 #include <json_html_serializer.hpp>
+#include <json_stream_serializer.hpp>
 #include <security_headers.hpp>
 #include <ssl_key_handler.hpp>
+#include <stats.hpp>
 
 #include <atomic>
 #include <chrono>
@@ -48,6 +53,170 @@ constexpr uint64_t loggedOutPostBodyLimit = 4096;
 
 constexpr uint32_t httpHeaderLimit = 8192;
 
+// Renders res.jsonValue into the body in one piece
+inline void encodeJsonBody(crow::Response& res,
+                           http_helpers::ResponseEncoding encoding)
+{
+    // The representation depends on the Accept header
+    res.addHeader(boost::beast::http::field::vary, "Accept");
+    switch (encoding)
+    {
+        case http_helpers::ResponseEncoding::Html:
+            prettyPrintJson(res);
+            break;
+        case http_helpers::ResponseEncoding::Cbor:
+            res.addHeader(boost::beast::http::field::content_type,
+                          "application/cbor");
+            nlohmann::json::to_cbor(res.jsonValue, res.body());
+            break;
+        case http_helpers::ResponseEncoding::MsgPack:
+            res.addHeader(boost::beast::http::field::content_type,
+                          "application/msgpack");
+            nlohmann::json::to_msgpack(res.jsonValue, res.body());
+            break;
+        case http_helpers::ResponseEncoding::JsonCompact:
+            res.addHeader(boost::beast::http::field::content_type,
+                          "application/json");
+            res.body() = res.jsonValue.dump(
+                -1, ' ', true, nlohmann::json::error_handler_t::replace);
+            break;
+        case http_helpers::ResponseEncoding::Json:
+            res.addHeader(boost::beast::http::field::content_type,
+                          "application/json");
+            res.body() = res.jsonValue.dump(
+                2, ' ', true, nlohmann::json::error_handler_t::replace);
+            break;
+    }
+}
+
+// Picks the content coding for a response, or Identity when the response
+// should be sent as is.  Streamed bodies are always large enough to
+// compress.
+inline http_helpers::ContentEncoding
+    getResponseContentEncoding(const crow::Request& req, crow::Response& res,
+                               bool streamed)
+{
+    if (bmcwebHttpCompressionLevel == 0)
+    {
+        return http_helpers::ContentEncoding::Identity;
+    }
+    if (res.result() == boost::beast::http::status::no_content ||
+        res.result() == boost::beast::http::status::not_modified)
+    {
+        return http_helpers::ContentEncoding::Identity;
+    }
+    // Already encoded, for example precompressed static files
+    if (res.stringResponse->count(
+            boost::beast::http::field::content_encoding) != 0)
+    {
+        return http_helpers::ContentEncoding::Identity;
+    }
+    // Static bodies are precompressed by whoever keeps them, if at all
+    if (!res.staticBody.empty())
+    {
+        return http_helpers::ContentEncoding::Identity;
+    }
+    // Responses with session tokens or key material are not compressed, to
+    // keep them out of reach of compression side channels
+    if (http_helpers::urlMayCarrySecrets(req.url) ||
+        res.stringResponse->count(boost::beast::http::field::set_cookie) != 0 ||
+        res.stringResponse->count("X-Auth-Token") != 0)
+    {
+        return http_helpers::ContentEncoding::Identity;
+    }
+    if (!streamed && res.body().size() < compressionThreshold)
+    {
+        return http_helpers::ContentEncoding::Identity;
+    }
+    return http_helpers::getPreferredContentEncoding(
+        req.getHeaderValue(boost::beast::http::field::accept_encoding));
+}
+
+// Compresses res.body() in place and sets the matching headers
+inline bool compressResponseBody(crow::Response& res,
+                                 http_helpers::ContentEncoding encoding)
+{
+    bool gzip = encoding == http_helpers::ContentEncoding::Gzip;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    std::string compressed;
+    DeflateEncoder encoder(gzip, bmcwebHttpCompressionLevel);
+    if (!encoder.write(res.body(), compressed, true))
+    {
+        BMCWEB_LOG_ERROR << "Failed to compress response";
+        return false;
+    }
+    bmcweb::stats::increment("compression.responses");
+    bmcweb::stats::increment("compression.bytes_in", res.body().size());
+    bmcweb::stats::increment("compression.bytes_out", compressed.size());
+    bmcweb::stats::increment(
+        "compression.microseconds",
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count()));
+    res.body() = std::move(compressed);
+    res.addHeader(boost::beast::http::field::content_encoding,
+                  gzip ? "gzip" : "deflate");
+    res.stringResponse->insert(boost::beast::http::field::vary,
+                               "Accept-Encoding");
+    return true;
+}
+
+/**
+ * Tags a successful GET or HEAD response with an ETag, unless the handler
+ * already set one from a version it keeps, and turns the response into a
+ * 304 Not Modified when the client lists the tag in If-None-Match.  Tags of
+ * compressed responses get the coding appended, so that each coding has its
+ * own strong tag.  Returns true if the response is now a 304.
+ */
+inline bool setResponseETag(const crow::Request& req, crow::Response& res,
+                            http_helpers::ResponseEncoding encoding,
+                            http_helpers::ContentEncoding coding)
+{
+    if ((req.method() != boost::beast::http::verb::get &&
+         req.method() != boost::beast::http::verb::head) ||
+        res.result() != boost::beast::http::status::ok)
+    {
+        return false;
+    }
+    std::string etag(
+        res.stringResponse->operator[](boost::beast::http::field::etag));
+    if (etag.empty())
+    {
+        if (res.jsonValue.empty() && res.payload().empty())
+        {
+            return false;
+        }
+        etag = http_helpers::getETag(res, encoding);
+    }
+    if (coding != http_helpers::ContentEncoding::Identity &&
+        etag.size() >= 2 && etag.starts_with('"') && etag.ends_with('"'))
+    {
+        etag.insert(etag.size() - 1,
+                    coding == http_helpers::ContentEncoding::Gzip ? "-gzip"
+                                                                  : "-deflate");
+    }
+    res.stringResponse->set(boost::beast::http::field::etag, etag);
+
+    if (!http_helpers::etagMatches(
+            req.getHeaderValue(boost::beast::http::field::if_none_match), etag,
+            true))
+    {
+        return false;
+    }
+    res.result(boost::beast::http::status::not_modified);
+    res.body().clear();
+    res.staticBody = {};
+    bmcweb::stats::increment("http.not_modified");
+    return true;
+}
+
+#ifdef BMCWEB_ENABLE_HTTP2
+template <typename Adaptor, typename Handler>
+class HTTP2Connection;
+#endif
+
 template <typename Adaptor, typename Handler>
 class Connection :
     public std::enable_shared_from_this<Connection<Adaptor, Handler>>
@@ -163,111 +332,160 @@ class Connection :
             BMCWEB_LOG_DEBUG << this
                              << " Certificate verification of final depth";
 
-            // Verify KeyUsage
-            bool isKeyUsageDigitalSignature = false;
-            bool isKeyUsageKeyAgreement = false;
+            // No request has been read yet to take the address from
+            boost::asio::ip::address ip;
+            getClientIp(ip);
+            authenticateTlsUser(peerCert, ip);
+            return true;
+        });
+    }
+
+    // Creates a transport session for the user named in a client
+    // certificate that has already passed verification
+    void authenticateTlsUser(X509* peerCert,
+                             const boost::asio::ip::address& clientIp)
+    {
+        // Verify KeyUsage
+        bool isKeyUsageDigitalSignature = false;
+        bool isKeyUsageKeyAgreement = false;
 
-            ASN1_BIT_STRING* usage = static_cast<ASN1_BIT_STRING*>(
-                X509_get_ext_d2i(peerCert, NID_key_usage, nullptr, nullptr));
+        ASN1_BIT_STRING* usage = static_cast<ASN1_BIT_STRING*>(
+            X509_get_ext_d2i(peerCert, NID_key_usage, nullptr, nullptr));
 
-            if (usage == nullptr)
-            {
-                BMCWEB_LOG_DEBUG << this << " TLS usage is null";
-                return true;
-            }
+        if (usage == nullptr)
+        {
+            BMCWEB_LOG_DEBUG << this << " TLS usage is null";
+            return;
+        }
 
-            for (int i = 0; i < usage->length; i++)
+        for (int i = 0; i < usage->length; i++)
+        {
+            if (KU_DIGITAL_SIGNATURE & usage->data[i])
             {
-                if (KU_DIGITAL_SIGNATURE & usage->data[i])
-                {
-                    isKeyUsageDigitalSignature = true;
-                }
-                if (KU_KEY_AGREEMENT & usage->data[i])
-                {
-                    isKeyUsageKeyAgreement = true;
-                }
+                isKeyUsageDigitalSignature = true;
             }
-            ASN1_BIT_STRING_free(usage);
-
-            if (!isKeyUsageDigitalSignature || !isKeyUsageKeyAgreement)
+            if (KU_KEY_AGREEMENT & usage->data[i])
             {
-                BMCWEB_LOG_DEBUG << this
-                                 << " Certificate ExtendedKeyUsage does "
-                                    "not allow provided certificate to "
-                                    "be used for user authentication";
-                return true;
+                isKeyUsageKeyAgreement = true;
             }
+        }
+        ASN1_BIT_STRING_free(usage);
 
-            // Determine that ExtendedKeyUsage includes Client Auth
+        if (!isKeyUsageDigitalSignature || !isKeyUsageKeyAgreement)
+        {
+            BMCWEB_LOG_DEBUG << this
+                             << " Certificate ExtendedKeyUsage does "
+                                "not allow provided certificate to "
+                                "be used for user authentication";
+            return;
+        }
 
-            stack_st_ASN1_OBJECT* extUsage =
-                static_cast<stack_st_ASN1_OBJECT*>(X509_get_ext_d2i(
-                    peerCert, NID_ext_key_usage, nullptr, nullptr));
+        // Determine that ExtendedKeyUsage includes Client Auth
 
-            if (extUsage == nullptr)
-            {
-                BMCWEB_LOG_DEBUG << this << " TLS extUsage is null";
-                return true;
-            }
+        stack_st_ASN1_OBJECT* extUsage =
+            static_cast<stack_st_ASN1_OBJECT*>(X509_get_ext_d2i(
+                peerCert, NID_ext_key_usage, nullptr, nullptr));
 
-            bool isExKeyUsageClientAuth = false;
-            for (int i = 0; i < sk_ASN1_OBJECT_num(extUsage); i++)
-            {
-                if (NID_client_auth ==
-                    OBJ_obj2nid(sk_ASN1_OBJECT_value(extUsage, i)))
-                {
-                    isExKeyUsageClientAuth = true;
-                    break;
-                }
-            }
-            sk_ASN1_OBJECT_free(extUsage);
+        if (extUsage == nullptr)
+        {
+            BMCWEB_LOG_DEBUG << this << " TLS extUsage is null";
+            return;
+        }
 
-            // Certificate has to have proper key usages set
-            if (!isExKeyUsageClientAuth)
+        bool isExKeyUsageClientAuth = false;
+        for (int i = 0; i < sk_ASN1_OBJECT_num(extUsage); i++)
+        {
+            if (NID_client_auth ==
+                OBJ_obj2nid(sk_ASN1_OBJECT_value(extUsage, i)))
             {
-                BMCWEB_LOG_DEBUG << this
-                                 << " Certificate ExtendedKeyUsage does "
-                                    "not allow provided certificate to "
-                                    "be used for user authentication";
-                return true;
+                isExKeyUsageClientAuth = true;
+                break;
             }
-            std::string sslUser;
-            // Extract username contained in CommonName
-            sslUser.resize(256, '\0');
+        }
+        sk_ASN1_OBJECT_free(extUsage);
 
-            int status = X509_NAME_get_text_by_NID(
-                X509_get_subject_name(peerCert), NID_commonName, sslUser.data(),
-                static_cast<int>(sslUser.size()));
+        // Certificate has to have proper key usages set
+        if (!isExKeyUsageClientAuth)
+        {
+            BMCWEB_LOG_DEBUG << this
+                             << " Certificate ExtendedKeyUsage does "
+                                "not allow provided certificate to "
+                                "be used for user authentication";
+            return;
+        }
+        std::string sslUser;
+        // Extract username contained in CommonName
+        sslUser.resize(256, '\0');
 
-            if (status == -1)
-            {
-                BMCWEB_LOG_DEBUG
-                    << this << " TLS cannot get username to create session";
-                return true;
-            }
+        int status = X509_NAME_get_text_by_NID(
+            X509_get_subject_name(peerCert), NID_commonName, sslUser.data(),
+            static_cast<int>(sslUser.size()));
 
-            size_t lastChar = sslUser.find('\0');
-            if (lastChar == std::string::npos || lastChar == 0)
-            {
-                BMCWEB_LOG_DEBUG << this << " Invalid TLS user name";
-                return true;
-            }
-            sslUser.resize(lastChar);
-            sessionIsFromTransport = true;
-            userSession =
-                persistent_data::SessionStore::getInstance()
-                    .generateUserSession(
-                        sslUser, req->ipAddress.to_string(), std::nullopt,
-                        persistent_data::PersistenceType::TIMEOUT);
-            if (userSession != nullptr)
-            {
-                BMCWEB_LOG_DEBUG
-                    << this
-                    << " Generating TLS session: " << userSession->uniqueId;
-            }
-            return true;
-        });
+        if (status == -1)
+        {
+            BMCWEB_LOG_DEBUG
+                << this << " TLS cannot get username to create session";
+            return;
+        }
+
+        size_t lastChar = sslUser.find('\0');
+        if (lastChar == std::string::npos || lastChar == 0)
+        {
+            BMCWEB_LOG_DEBUG << this << " Invalid TLS user name";
+            return;
+        }
+        sslUser.resize(lastChar);
+        sessionIsFromTransport = true;
+        userSession =
+            persistent_data::SessionStore::getInstance()
+                .generateUserSession(
+                    sslUser, clientIp.to_string(), std::nullopt,
+                    persistent_data::PersistenceType::TIMEOUT);
+        if (userSession != nullptr)
+        {
+            BMCWEB_LOG_DEBUG
+                << this
+                << " Generating TLS session: " << userSession->uniqueId;
+        }
+    }
+
+#ifdef BMCWEB_ENABLE_MUTUAL_TLS_AUTHENTICATION
+    // A resumed TLS session skips certificate verification, so the verify
+    // callback never runs.  Recreate the transport session from the
+    // certificate the original handshake verified.
+    void resumeTlsUser()
+    {
+        SSL* ssl = adaptor.native_handle();
+        if (SSL_session_reused(ssl) == 0 || userSession != nullptr)
+        {
+            return;
+        }
+        if (!persistent_data::SessionStore::getInstance()
+                 .getAuthMethodsConfig()
+                 .tls)
+        {
+            return;
+        }
+        if (SSL_get_verify_result(ssl) != X509_V_OK)
+        {
+            return;
+        }
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000L)
+        X509* peerCert = SSL_get1_peer_certificate(ssl);
+#else
+        X509* peerCert = SSL_get_peer_certificate(ssl);
+#endif
+        if (peerCert == nullptr)
+        {
+            return;
+        }
+        BMCWEB_LOG_DEBUG << this << " Resumed TLS session with certificate";
+        boost::asio::ip::address ip;
+        getClientIp(ip);
+        authenticateTlsUser(peerCert, ip);
+        X509_free(peerCert);
     }
+#endif // BMCWEB_ENABLE_MUTUAL_TLS_AUTHENTICATION
 
     Adaptor& socket()
     {
@@ -297,6 +515,13 @@ class Connection :
                                         {
                                             return;
                                         }
+                                        recordHandshake();
+#ifdef BMCWEB_ENABLE_HTTP2
+                                        if (upgradeToHttp2())
+                                        {
+                                            return;
+                                        }
+#endif
                                         doReadHeaders();
                                     });
         }
@@ -306,6 +531,54 @@ class Connection :
         }
     }
 
+    void recordHandshake()
+    {
+        if (SSL_session_reused(adaptor.native_handle()) != 0)
+        {
+            bmcweb::stats::increment("tls.sessions.resumed");
+        }
+        else
+        {
+            bmcweb::stats::increment("tls.sessions.full");
+        }
+#ifdef BMCWEB_ENABLE_MUTUAL_TLS_AUTHENTICATION
+        resumeTlsUser();
+#endif
+    }
+
+#ifdef BMCWEB_ENABLE_HTTP2
+    // Hands the socket to an HTTP2Connection if the client negotiated "h2"
+    // during the TLS handshake.  Returns true if it did.
+    bool upgradeToHttp2()
+    {
+        const unsigned char* alpn = nullptr;
+        unsigned int alpnLen = 0;
+        SSL_get0_alpn_selected(adaptor.native_handle(), &alpn, &alpnLen);
+        std::string_view selected(reinterpret_cast<const char*>(alpn),
+                                  alpnLen);
+        if (selected != "h2")
+        {
+            return false;
+        }
+        BMCWEB_LOG_DEBUG << this << " Client negotiated HTTP/2";
+        cancelDeadlineTimer();
+
+        boost::system::error_code ec;
+        boost::asio::ip::address ip =
+            boost::beast::get_lowest_layer(adaptor)
+                .remote_endpoint(ec)
+                .address();
+        if (ec)
+        {
+            BMCWEB_LOG_ERROR << ec;
+        }
+        auto http2 = std::make_shared<HTTP2Connection<Adaptor, Handler>>(
+            std::move(adaptor), handler, getCachedDateStr, ip, userSession);
+        http2->start();
+        return true;
+    }
+#endif
+
     void handle()
     {
         std::error_code reqEc;
@@ -413,6 +686,7 @@ class Connection :
                                      boost::beast::ssl_stream<
                                          boost::asio::ip::tcp::socket>>)
         {
+            ensuressl::keepSessionResumable(adaptor.native_handle());
             adaptor.next_layer().close();
 #ifdef BMCWEB_ENABLE_MUTUAL_TLS_AUTHENTICATION
             if (userSession != nullptr)
@@ -486,16 +760,9 @@ class Connection :
 
         if (res.body().empty() && !res.jsonValue.empty())
         {
-            if (http_helpers::requestPrefersHtml(req->getHeaderValue("Accept")))
-            {
-                prettyPrintJson(res);
-            }
-            else
-            {
-                res.jsonMode();
-                res.body() = res.jsonValue.dump(
-                    2, ' ', true, nlohmann::json::error_handler_t::replace);
-            }
+            responseEncoding = http_helpers::getPreferredEncoding(*req);
+            encodeStart = std::chrono::steady_clock::now();
+            encodeJson(*responseEncoding);
         }
 
         if (res.resultInt() >= 400 && res.body().empty())
@@ -511,8 +778,23 @@ class Connection :
             BMCWEB_LOG_CRITICAL
                 << this << " Response content provided but code was no-content";
             res.body().clear();
+            res.staticBody = {};
+            jsonStream.reset();
+            streamEncoder.reset();
         }
 
+        http_helpers::ContentEncoding coding =
+            getResponseContentEncoding(*req, res, jsonStream != nullptr);
+        if (setResponseETag(*req, res,
+                            http_helpers::getPreferredEncoding(*req), coding))
+        {
+            // The client already has the body
+            jsonStream.reset();
+            responseEncoding.reset();
+            coding = http_helpers::ContentEncoding::Identity;
+        }
+        compressBody(coding);
+
         res.addHeader(boost::beast::http::field::date, getCachedDateStr());
 
         res.keepAlive(req->keepAlive());
@@ -650,9 +932,67 @@ class Connection :
             });
     }
 
+    void encodeJson(http_helpers::ResponseEncoding encoding)
+    {
+        // HTTP/1.0 has no chunked transfer encoding, so it always gets the
+        // whole document in one piece
+        if (req->version() < 11 ||
+            (encoding != http_helpers::ResponseEncoding::Json &&
+             encoding != http_helpers::ResponseEncoding::JsonCompact))
+        {
+            encodeJsonBody(res, encoding);
+            return;
+        }
+        res.addHeader(boost::beast::http::field::vary, "Accept");
+        res.jsonMode();
+        jsonStream = std::make_unique<json_stream_util::JsonStreamSerializer>(
+            res.jsonValue,
+            encoding == http_helpers::ResponseEncoding::Json ? 2 : -1);
+        // Documents that fit in the first chunk are sent as a plain body
+        // with a Content-Length; anything larger is streamed from the DOM
+        // as it is written, rather than rendered to one string up front.
+        if (jsonStream->fill(res.body(), jsonStreamChunkSize))
+        {
+            jsonStream.reset();
+        }
+    }
+
+    // Applies the content coding picked by getResponseContentEncoding, if any
+    void compressBody(http_helpers::ContentEncoding encoding)
+    {
+        if (encoding == http_helpers::ContentEncoding::Identity)
+        {
+            return;
+        }
+        if (jsonStream == nullptr)
+        {
+            compressResponseBody(res, encoding);
+            return;
+        }
+        // Compressed as it is streamed out
+        bool gzip = encoding == http_helpers::ContentEncoding::Gzip;
+        streamEncoder =
+            std::make_unique<DeflateEncoder>(gzip, bmcwebHttpCompressionLevel);
+        bmcweb::stats::increment("compression.responses");
+        res.addHeader(boost::beast::http::field::content_encoding,
+                      gzip ? "gzip" : "deflate");
+        res.stringResponse->insert(boost::beast::http::field::vary,
+                                   "Accept-Encoding");
+    }
+
     void doWrite()
     {
         BMCWEB_LOG_DEBUG << this << " doWrite";
+        if (jsonStream != nullptr)
+        {
+            doWriteStream();
+            return;
+        }
+        if (!res.staticBody.empty())
+        {
+            doWriteStatic();
+            return;
+        }
         res.preparePayload();
         serializer.emplace(*res.stringResponse);
         startDeadline();
@@ -661,42 +1001,113 @@ class Connection :
             [this,
              self(shared_from_this())](const boost::system::error_code& ec,
                                        std::size_t bytesTransferred) {
-                BMCWEB_LOG_DEBUG << this << " async_write " << bytesTransferred
-                                 << " bytes";
+                afterDoWrite(ec, bytesTransferred);
+            });
+    }
 
-                cancelDeadlineTimer();
+    void doWriteStream()
+    {
+        BMCWEB_LOG_DEBUG << this << " doWriteStream";
+        streamResponse.emplace(res.stringResponse->base());
+        streamResponse->body().prefix = std::move(res.body());
+        streamResponse->body().serializer = std::move(jsonStream);
+        streamResponse->body().encoder = std::move(streamEncoder);
+        streamResponse->erase(boost::beast::http::field::content_length);
+        streamResponse->chunked(true);
+        streamSerializer.emplace(*streamResponse);
+        startDeadline();
+        boost::beast::http::async_write(
+            adaptor, *streamSerializer,
+            [this,
+             self(shared_from_this())](const boost::system::error_code& ec,
+                                       std::size_t bytesTransferred) {
+                afterDoWrite(ec, bytesTransferred);
+            });
+    }
 
-                if (ec)
-                {
-                    BMCWEB_LOG_DEBUG << this << " from write(2)";
-                    return;
-                }
-                if (!res.keepAlive())
-                {
-                    close();
-                    BMCWEB_LOG_DEBUG << this << " from write(1)";
-                    return;
-                }
+    // Writes res.staticBody straight from where it is kept
+    void doWriteStatic()
+    {
+        BMCWEB_LOG_DEBUG << this << " doWriteStatic";
+        staticResponse.emplace(res.stringResponse->base());
+        staticResponse->body() = {res.staticBody.data(),
+                                  res.staticBody.size()};
+        staticResponse->prepare_payload();
+        staticSerializer.emplace(*staticResponse);
+        startDeadline();
+        boost::beast::http::async_write(
+            adaptor, *staticSerializer,
+            [this,
+             self(shared_from_this())](const boost::system::error_code& ec,
+                                       std::size_t bytesTransferred) {
+                afterDoWrite(ec, bytesTransferred);
+            });
+    }
 
-                serializer.reset();
-                BMCWEB_LOG_DEBUG << this << " Clearing response";
-                res.clear();
-                parser.emplace(std::piecewise_construct, std::make_tuple());
-                parser->body_limit(httpReqBodyLimit); // reset body limit for
-                                                      // newly created parser
-                buffer.consume(buffer.size());
-
-                // If the session was built from the transport, we don't need to
-                // clear it.  All other sessions are generated per request.
-                if (!sessionIsFromTransport)
-                {
-                    userSession = nullptr;
-                }
+    void afterDoWrite(const boost::system::error_code& ec,
+                      std::size_t bytesTransferred)
+    {
+        BMCWEB_LOG_DEBUG << this << " async_write " << bytesTransferred
+                         << " bytes";
 
-                // Destroy the Request via the std::optional
-                req.reset();
-                doReadHeaders();
-            });
+        cancelDeadlineTimer();
+
+        if (responseEncoding)
+        {
+            recordEncodingStats(*responseEncoding, bytesTransferred);
+            responseEncoding.reset();
+        }
+
+        if (ec)
+        {
+            BMCWEB_LOG_DEBUG << this << " from write(2)";
+            return;
+        }
+        if (!res.keepAlive())
+        {
+            close();
+            BMCWEB_LOG_DEBUG << this << " from write(1)";
+            return;
+        }
+
+        serializer.reset();
+        streamSerializer.reset();
+        streamResponse.reset();
+        staticSerializer.reset();
+        staticResponse.reset();
+        BMCWEB_LOG_DEBUG << this << " Clearing response";
+        res.clear();
+        parser.emplace(std::piecewise_construct, std::make_tuple());
+        parser->body_limit(httpReqBodyLimit); // reset body limit for
+                                              // newly created parser
+        buffer.consume(buffer.size());
+
+        // If the session was built from the transport, we don't need to
+        // clear it.  All other sessions are generated per request.
+        if (!sessionIsFromTransport)
+        {
+            userSession = nullptr;
+        }
+
+        // Destroy the Request via the std::optional
+        req.reset();
+        doReadHeaders();
+    }
+
+    // Counts bytes written and time from encoding to write completion for
+    // each response encoding, so the encodings can be compared
+    void recordEncodingStats(http_helpers::ResponseEncoding encoding,
+                             std::size_t bytesTransferred)
+    {
+        std::string prefix = "encoding.";
+        prefix += http_helpers::toString(encoding);
+        std::chrono::microseconds elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - encodeStart);
+        bmcweb::stats::increment(prefix + ".responses");
+        bmcweb::stats::increment(prefix + ".bytes", bytesTransferred);
+        bmcweb::stats::increment(prefix + ".microseconds",
+                                 static_cast<uint64_t>(elapsed.count()));
     }
 
     void cancelDeadlineTimer()
@@ -766,6 +1177,26 @@ class Connection :
         boost::beast::http::string_body>>
         serializer;
 
+    // Set when a JSON body is too large to send in one piece, and is instead
+    // streamed from res.jsonValue while writing
+    std::unique_ptr<json_stream_util::JsonStreamSerializer> jsonStream;
+    std::unique_ptr<DeflateEncoder> streamEncoder;
+    std::optional<boost::beast::http::response<JsonStreamBody>> streamResponse;
+    std::optional<boost::beast::http::response_serializer<JsonStreamBody>>
+        streamSerializer;
+
+    // Set when the body is res.staticBody
+    std::optional<boost::beast::http::response<
+        boost::beast::http::span_body<const char>>>
+        staticResponse;
+    std::optional<boost::beast::http::response_serializer<
+        boost::beast::http::span_body<const char>>>
+        staticSerializer;
+
+    // Encoding chosen for the JSON body of the current response, if any
+    std::optional<http_helpers::ResponseEncoding> responseEncoding;
+    std::chrono::steady_clock::time_point encodeStart;
+
     std::optional<crow::Request> req;
     crow::Response res;
 
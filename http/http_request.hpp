@@ -13,6 +13,7 @@
 #include <string>
 #include <string_view>
 #include <system_error>
+#include <vector>
 
 namespace crow
 {
@@ -34,6 +35,11 @@ struct Request
     std::shared_ptr<persistent_data::UserSession> session;
 
     std::string userRole{};
+
+    // Property paths from $select, parsed once by the router so that
+    // handlers can skip what isn't selected.  Empty selects everything.
+    std::vector<std::string> selectProperties{};
+
     Request(boost::beast::http::request<boost::beast::http::string_body> reqIn,
             std::error_code& ec) :
         req(std::move(reqIn)),
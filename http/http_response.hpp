@@ -8,6 +8,8 @@
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/string_body.hpp>
 
+#include <array>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -29,6 +31,14 @@ struct Response
 
     nlohmann::json jsonValue;
 
+    // Sent in place of body() without being copied, for data that outlives
+    // the response, such as static files mapped at startup
+    std::string_view staticBody;
+
+    // Hash of the complete jsonValue, kept by http_helpers::getETag so that
+    // the tags of every encoding of it share one pass over the document
+    std::optional<std::array<uint64_t, 2>> jsonDigest;
+
     void addHeader(const std::string_view key, const std::string_view value)
     {
         stringResponse->set(key, value);
@@ -50,6 +60,10 @@ struct Response
         stringResponse = std::move(r.stringResponse);
         r.stringResponse.emplace(response_type{});
         jsonValue = std::move(r.jsonValue);
+        staticBody = r.staticBody;
+        r.staticBody = {};
+        jsonDigest = r.jsonDigest;
+        r.jsonDigest.reset();
         completed = r.completed;
         return *this;
     }
@@ -84,6 +98,16 @@ struct Response
         return stringResponse->body();
     }
 
+    // The body as it is sent, from staticBody if set
+    std::string_view payload()
+    {
+        if (!staticBody.empty())
+        {
+            return staticBody;
+        }
+        return stringResponse->body();
+    }
+
     void keepAlive(bool k)
     {
         stringResponse->keep_alive(k);
@@ -97,6 +121,12 @@ struct Response
     void preparePayload()
     {
         stringResponse->prepare_payload();
+        // A 304 has no body, but stands in for one that does, so a length of
+        // zero would be wrong
+        if (result() == boost::beast::http::status::not_modified)
+        {
+            stringResponse->erase(boost::beast::http::field::content_length);
+        }
     }
 
     void clear()
@@ -104,6 +134,8 @@ struct Response
         BMCWEB_LOG_DEBUG << this << " Clearing response containers";
         stringResponse.emplace(response_type{});
         jsonValue.clear();
+        staticBody = {};
+        jsonDigest.reset();
         completed = false;
     }
 
@@ -2,6 +2,9 @@
 
 #include "http_connection.hpp"
 #include "logging.hpp"
+#ifdef BMCWEB_ENABLE_HTTP2
+#include "http2_connection.hpp"
+#endif
 
 #include <boost/asio/ip/address.hpp>
 #include <boost/asio/ip/tcp.hpp>
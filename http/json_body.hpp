@@ -0,0 +1,106 @@
+#pragma once
+
+#include "gzip_helper.hpp"
+#include "json_stream_serializer.hpp"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace crow
+{
+
+// Size of each chunk handed to the socket when streaming a JSON body.  Peak
+// memory for the serialized text of a response is roughly one chunk.
+constexpr size_t jsonStreamChunkSize = 16384;
+
+/**
+ * JsonStreamBody
+ * A Beast body that serializes a nlohmann::json DOM while it is being
+ * written, one chunk at a time, optionally compressing each chunk.  The
+ * message is expected to use chunked transfer encoding, as the final length
+ * is not known up front.
+ */
+struct JsonStreamBody
+{
+    struct value_type
+    {
+        // Text that was already serialized before the body was handed to
+        // the connection, sent ahead of anything the serializer produces.
+        std::string prefix;
+        std::unique_ptr<json_stream_util::JsonStreamSerializer> serializer;
+        // When set, output is compressed and the message is expected to
+        // carry the matching Content-Encoding
+        std::unique_ptr<DeflateEncoder> encoder;
+    };
+
+    class writer
+    {
+      public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(const boost::beast::http::header<isRequest, Fields>&,
+               const value_type& bodyIn) :
+            body(bodyIn)
+        {}
+
+        void init(boost::beast::error_code& ec)
+        {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>>
+            get(boost::beast::error_code& ec)
+        {
+            ec = {};
+            if (finished)
+            {
+                return boost::none;
+            }
+            chunk.clear();
+            if (!prefixSent)
+            {
+                prefixSent = true;
+                chunk = body.prefix;
+            }
+            if (body.serializer != nullptr &&
+                chunk.size() < jsonStreamChunkSize)
+            {
+                body.serializer->fill(chunk, jsonStreamChunkSize);
+            }
+            finished = body.serializer == nullptr || body.serializer->done();
+
+            if (body.encoder != nullptr)
+            {
+                encoded.clear();
+                if (!body.encoder->write(chunk, encoded, finished))
+                {
+                    ec = boost::system::errc::make_error_code(
+                        boost::system::errc::io_error);
+                    return boost::none;
+                }
+                chunk.swap(encoded);
+            }
+            if (chunk.empty())
+            {
+                return boost::none;
+            }
+            return {{boost::asio::buffer(chunk), !finished}};
+        }
+
+      private:
+        const value_type& body;
+        std::string chunk;
+        std::string encoded;
+        bool prefixSent = false;
+        bool finished = false;
+    };
+};
+
+} // namespace crow
@@ -0,0 +1,161 @@
+#pragma once
+
+extern "C"
+{
+#include <nghttp2/nghttp2.h>
+}
+
+#include "logging.hpp"
+
+#include <span>
+#include <string_view>
+
+namespace crow
+{
+
+/* RAII adapters for the nghttp2 C structures.  They stay as close to a direct
+ * call into the library as possible, while keeping ownership and lifetimes
+ * managed. */
+
+class Nghttp2SessionCallbacks
+{
+  public:
+    friend class Nghttp2Session;
+
+    Nghttp2SessionCallbacks()
+    {
+        nghttp2_session_callbacks_new(&ptr);
+    }
+
+    ~Nghttp2SessionCallbacks()
+    {
+        nghttp2_session_callbacks_del(ptr);
+    }
+
+    Nghttp2SessionCallbacks(const Nghttp2SessionCallbacks&) = delete;
+    Nghttp2SessionCallbacks& operator=(const Nghttp2SessionCallbacks&) = delete;
+    Nghttp2SessionCallbacks(Nghttp2SessionCallbacks&&) = delete;
+    Nghttp2SessionCallbacks& operator=(Nghttp2SessionCallbacks&&) = delete;
+
+    void setSendCallback(nghttp2_send_callback sendCallback)
+    {
+        nghttp2_session_callbacks_set_send_callback(ptr, sendCallback);
+    }
+
+    void setOnFrameRecvCallback(nghttp2_on_frame_recv_callback onFrameRecv)
+    {
+        nghttp2_session_callbacks_set_on_frame_recv_callback(ptr, onFrameRecv);
+    }
+
+    void setOnStreamCloseCallback(nghttp2_on_stream_close_callback onClose)
+    {
+        nghttp2_session_callbacks_set_on_stream_close_callback(ptr, onClose);
+    }
+
+    void setOnHeaderCallback(nghttp2_on_header_callback onHeader)
+    {
+        nghttp2_session_callbacks_set_on_header_callback(ptr, onHeader);
+    }
+
+    void setOnBeginHeadersCallback(
+        nghttp2_on_begin_headers_callback onBeginHeaders)
+    {
+        nghttp2_session_callbacks_set_on_begin_headers_callback(
+            ptr, onBeginHeaders);
+    }
+
+    void setOnDataChunkRecvCallback(
+        nghttp2_on_data_chunk_recv_callback onDataChunkRecv)
+    {
+        nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
+            ptr, onDataChunkRecv);
+    }
+
+  private:
+    nghttp2_session_callbacks* get()
+    {
+        return ptr;
+    }
+
+    nghttp2_session_callbacks* ptr = nullptr;
+};
+
+class Nghttp2Session
+{
+  public:
+    Nghttp2Session(Nghttp2SessionCallbacks& callbacks, void* userData)
+    {
+        if (nghttp2_session_server_new(&ptr, callbacks.get(), userData) != 0)
+        {
+            BMCWEB_LOG_ERROR << "nghttp2_session_server_new failed";
+            ptr = nullptr;
+        }
+    }
+
+    ~Nghttp2Session()
+    {
+        nghttp2_session_del(ptr);
+    }
+
+    Nghttp2Session(const Nghttp2Session&) = delete;
+    Nghttp2Session& operator=(const Nghttp2Session&) = delete;
+    Nghttp2Session(Nghttp2Session&&) = delete;
+    Nghttp2Session& operator=(Nghttp2Session&&) = delete;
+
+    bool valid() const
+    {
+        return ptr != nullptr;
+    }
+
+    int submitSettings(std::span<const nghttp2_settings_entry> iv)
+    {
+        return nghttp2_submit_settings(ptr, NGHTTP2_FLAG_NONE, iv.data(),
+                                       iv.size());
+    }
+
+    ssize_t memRecv(std::span<const uint8_t> in)
+    {
+        return nghttp2_session_mem_recv(ptr, in.data(), in.size());
+    }
+
+    // The returned view is valid until the next call into the session
+    std::string_view memSend()
+    {
+        const uint8_t* bytes = nullptr;
+        ssize_t size = nghttp2_session_mem_send(ptr, &bytes);
+        if (size <= 0)
+        {
+            return "";
+        }
+        return {reinterpret_cast<const char*>(bytes),
+                static_cast<size_t>(size)};
+    }
+
+    int submitResponse(int32_t streamId, std::span<const nghttp2_nv> headers,
+                       const nghttp2_data_provider* dataPrd)
+    {
+        return nghttp2_submit_response(ptr, streamId, headers.data(),
+                                       headers.size(), dataPrd);
+    }
+
+    int submitRstStream(int32_t streamId, uint32_t errorCode)
+    {
+        return nghttp2_submit_rst_stream(ptr, NGHTTP2_FLAG_NONE, streamId,
+                                         errorCode);
+    }
+
+    bool wantRead()
+    {
+        return nghttp2_session_want_read(ptr) != 0;
+    }
+
+    bool wantWrite()
+    {
+        return nghttp2_session_want_write(ptr) != 0;
+    }
+
+  private:
+    nghttp2_session* ptr = nullptr;
+};
+
+} // namespace crow
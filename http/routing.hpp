@@ -7,20 +7,25 @@
 #include "http_stream.hpp"
 #include "logging.hpp"
 #include "privileges.hpp"
+#include "routing_trie.hpp"
 #include "sessions.hpp"
+#include "user_info_cache.hpp"
 #include "utility.hpp"
+#include "utils/query_param.hpp"
 #include "websocket.hpp"
 
 #include <async_resp.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/container/flat_map.hpp>
 #include <boost/container/small_vector.hpp>
 #include <boost/lexical_cast.hpp>
+#include <http_utility.hpp>
 
-#include <cerrno>
 #include <cstdint>
-#include <cstdlib>
+#include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -94,6 +99,9 @@ class BaseRule
 
     std::vector<redfish::Privileges> privilegesSet;
 
+    // Whether If-Match is checked on a PATCH, see RuleParameterTraits::ifMatch
+    bool checksIfMatch = false;
+
     std::string rule;
     std::string nameStr;
 
@@ -554,6 +562,18 @@ struct RuleParameterTraits
         }
         return *self;
     }
+
+    // Checks If-Match on a PATCH against the ETag of a GET of the same URL.
+    // Only for resources whose GET stays the same until they are changed, or
+    // whose GET handler sets its ETag from a version it keeps; If-Match is
+    // ignored on other rules, as a time or reading in the GET would never
+    // match.
+    self_t& ifMatch()
+    {
+        self_t* self = static_cast<self_t*>(this);
+        self->checksIfMatch = true;
+        return *self;
+    }
 };
 
 class DynamicRule : public BaseRule, public RuleParameterTraits<DynamicRule>
@@ -754,405 +774,6 @@ class TaggedRule :
 
 const int ruleSpecialRedirectSlash = 1;
 
-class Trie
-{
-  public:
-    struct Node
-    {
-        unsigned ruleIndex{};
-        std::array<size_t, static_cast<size_t>(ParamType::MAX)>
-            paramChildrens{};
-        boost::container::flat_map<std::string, unsigned> children;
-
-        bool isSimpleNode() const
-        {
-            return !ruleIndex && std::all_of(std::begin(paramChildrens),
-                                             std::end(paramChildrens),
-                                             [](size_t x) { return !x; });
-        }
-    };
-
-    Trie() : nodes(1)
-    {}
-
-  private:
-    void optimizeNode(Node* node)
-    {
-        for (size_t x : node->paramChildrens)
-        {
-            if (!x)
-            {
-                continue;
-            }
-            Node* child = &nodes[x];
-            optimizeNode(child);
-        }
-        if (node->children.empty())
-        {
-            return;
-        }
-        bool mergeWithChild = true;
-        for (const std::pair<std::string, unsigned>& kv : node->children)
-        {
-            Node* child = &nodes[kv.second];
-            if (!child->isSimpleNode())
-            {
-                mergeWithChild = false;
-                break;
-            }
-        }
-        if (mergeWithChild)
-        {
-            decltype(node->children) merged;
-            for (const std::pair<std::string, unsigned>& kv : node->children)
-            {
-                Node* child = &nodes[kv.second];
-                for (const std::pair<std::string, unsigned>& childKv :
-                     child->children)
-                {
-                    merged[kv.first + childKv.first] = childKv.second;
-                }
-            }
-            node->children = std::move(merged);
-            optimizeNode(node);
-        }
-        else
-        {
-            for (const std::pair<std::string, unsigned>& kv : node->children)
-            {
-                Node* child = &nodes[kv.second];
-                optimizeNode(child);
-            }
-        }
-    }
-
-    void optimize()
-    {
-        optimizeNode(head());
-    }
-
-  public:
-    void validate()
-    {
-        optimize();
-    }
-
-    void findRouteIndexes(const std::string& reqUrl,
-                          std::vector<unsigned>& routeIndexes,
-                          const Node* node = nullptr, unsigned pos = 0) const
-    {
-        if (node == nullptr)
-        {
-            node = head();
-        }
-        for (const std::pair<std::string, unsigned>& kv : node->children)
-        {
-            const std::string& fragment = kv.first;
-            const Node* child = &nodes[kv.second];
-            if (pos >= reqUrl.size())
-            {
-                if (child->ruleIndex != 0 && fragment != "/")
-                {
-                    routeIndexes.push_back(child->ruleIndex);
-                }
-                findRouteIndexes(reqUrl, routeIndexes, child,
-                                 static_cast<unsigned>(pos + fragment.size()));
-            }
-            else
-            {
-                if (reqUrl.compare(pos, fragment.size(), fragment) == 0)
-                {
-                    findRouteIndexes(
-                        reqUrl, routeIndexes, child,
-                        static_cast<unsigned>(pos + fragment.size()));
-                }
-            }
-        }
-    }
-
-    std::pair<unsigned, RoutingParams>
-        find(const std::string_view reqUrl, const Node* node = nullptr,
-             size_t pos = 0, RoutingParams* params = nullptr) const
-    {
-        RoutingParams empty;
-        if (params == nullptr)
-        {
-            params = &empty;
-        }
-
-        unsigned found{};
-        RoutingParams matchParams;
-
-        if (node == nullptr)
-        {
-            node = head();
-        }
-        if (pos == reqUrl.size())
-        {
-            return {node->ruleIndex, *params};
-        }
-
-        auto updateFound =
-            [&found, &matchParams](std::pair<unsigned, RoutingParams>& ret) {
-                if (ret.first && (!found || found > ret.first))
-                {
-                    found = ret.first;
-                    matchParams = std::move(ret.second);
-                }
-            };
-
-        if (node->paramChildrens[static_cast<size_t>(ParamType::INT)])
-        {
-            char c = reqUrl[pos];
-            if ((c >= '0' && c <= '9') || c == '+' || c == '-')
-            {
-                char* eptr;
-                errno = 0;
-                long long int value =
-                    std::strtoll(reqUrl.data() + pos, &eptr, 10);
-                if (errno != ERANGE && eptr != reqUrl.data() + pos)
-                {
-                    params->intParams.push_back(value);
-                    std::pair<unsigned, RoutingParams> ret =
-                        find(reqUrl,
-                             &nodes[node->paramChildrens[static_cast<size_t>(
-                                 ParamType::INT)]],
-                             static_cast<size_t>(eptr - reqUrl.data()), params);
-                    updateFound(ret);
-                    params->intParams.pop_back();
-                }
-            }
-        }
-
-        if (node->paramChildrens[static_cast<size_t>(ParamType::UINT)])
-        {
-            char c = reqUrl[pos];
-            if ((c >= '0' && c <= '9') || c == '+')
-            {
-                char* eptr;
-                errno = 0;
-                unsigned long long int value =
-                    std::strtoull(reqUrl.data() + pos, &eptr, 10);
-                if (errno != ERANGE && eptr != reqUrl.data() + pos)
-                {
-                    params->uintParams.push_back(value);
-                    std::pair<unsigned, RoutingParams> ret =
-                        find(reqUrl,
-                             &nodes[node->paramChildrens[static_cast<size_t>(
-                                 ParamType::UINT)]],
-                             static_cast<size_t>(eptr - reqUrl.data()), params);
-                    updateFound(ret);
-                    params->uintParams.pop_back();
-                }
-            }
-        }
-
-        if (node->paramChildrens[static_cast<size_t>(ParamType::DOUBLE)])
-        {
-            char c = reqUrl[pos];
-            if ((c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.')
-            {
-                char* eptr;
-                errno = 0;
-                double value = std::strtod(reqUrl.data() + pos, &eptr);
-                if (errno != ERANGE && eptr != reqUrl.data() + pos)
-                {
-                    params->doubleParams.push_back(value);
-                    std::pair<unsigned, RoutingParams> ret =
-                        find(reqUrl,
-                             &nodes[node->paramChildrens[static_cast<size_t>(
-                                 ParamType::DOUBLE)]],
-                             static_cast<size_t>(eptr - reqUrl.data()), params);
-                    updateFound(ret);
-                    params->doubleParams.pop_back();
-                }
-            }
-        }
-
-        if (node->paramChildrens[static_cast<size_t>(ParamType::STRING)])
-        {
-            size_t epos = pos;
-            for (; epos < reqUrl.size(); epos++)
-            {
-                if (reqUrl[epos] == '/')
-                {
-                    break;
-                }
-            }
-
-            if (epos != pos)
-            {
-                params->stringParams.emplace_back(
-                    reqUrl.substr(pos, epos - pos));
-                std::pair<unsigned, RoutingParams> ret =
-                    find(reqUrl,
-                         &nodes[node->paramChildrens[static_cast<size_t>(
-                             ParamType::STRING)]],
-                         epos, params);
-                updateFound(ret);
-                params->stringParams.pop_back();
-            }
-        }
-
-        if (node->paramChildrens[static_cast<size_t>(ParamType::PATH)])
-        {
-            size_t epos = reqUrl.size();
-
-            if (epos != pos)
-            {
-                params->stringParams.emplace_back(
-                    reqUrl.substr(pos, epos - pos));
-                std::pair<unsigned, RoutingParams> ret =
-                    find(reqUrl,
-                         &nodes[node->paramChildrens[static_cast<size_t>(
-                             ParamType::PATH)]],
-                         epos, params);
-                updateFound(ret);
-                params->stringParams.pop_back();
-            }
-        }
-
-        for (const std::pair<std::string, unsigned>& kv : node->children)
-        {
-            const std::string& fragment = kv.first;
-            const Node* child = &nodes[kv.second];
-
-            if (reqUrl.compare(pos, fragment.size(), fragment) == 0)
-            {
-                std::pair<unsigned, RoutingParams> ret =
-                    find(reqUrl, child, pos + fragment.size(), params);
-                updateFound(ret);
-            }
-        }
-
-        return {found, matchParams};
-    }
-
-    void add(const std::string& url, unsigned ruleIndex)
-    {
-        size_t idx = 0;
-
-        for (unsigned i = 0; i < url.size(); i++)
-        {
-            char c = url[i];
-            if (c == '<')
-            {
-                const static std::array<std::pair<ParamType, std::string>, 7>
-                    paramTraits = {{
-                        {ParamType::INT, "<int>"},
-                        {ParamType::UINT, "<uint>"},
-                        {ParamType::DOUBLE, "<float>"},
-                        {ParamType::DOUBLE, "<double>"},
-                        {ParamType::STRING, "<str>"},
-                        {ParamType::STRING, "<string>"},
-                        {ParamType::PATH, "<path>"},
-                    }};
-
-                for (const std::pair<ParamType, std::string>& x : paramTraits)
-                {
-                    if (url.compare(i, x.second.size(), x.second) == 0)
-                    {
-                        size_t index = static_cast<size_t>(x.first);
-                        if (!nodes[idx].paramChildrens[index])
-                        {
-                            unsigned newNodeIdx = newNode();
-                            nodes[idx].paramChildrens[index] = newNodeIdx;
-                        }
-                        idx = nodes[idx].paramChildrens[index];
-                        i += static_cast<unsigned>(x.second.size());
-                        break;
-                    }
-                }
-
-                i--;
-            }
-            else
-            {
-                std::string piece(&c, 1);
-                if (!nodes[idx].children.count(piece))
-                {
-                    unsigned newNodeIdx = newNode();
-                    nodes[idx].children.emplace(piece, newNodeIdx);
-                }
-                idx = nodes[idx].children[piece];
-            }
-        }
-        if (nodes[idx].ruleIndex)
-        {
-            throw std::runtime_error("handler already exists for " + url);
-        }
-        nodes[idx].ruleIndex = ruleIndex;
-    }
-
-  private:
-    void debugNodePrint(Node* n, size_t level)
-    {
-        for (size_t i = 0; i < static_cast<size_t>(ParamType::MAX); i++)
-        {
-            if (n->paramChildrens[i])
-            {
-                BMCWEB_LOG_DEBUG << std::string(
-                    2U * level, ' ') /*<< "("<<n->paramChildrens[i]<<") "*/;
-                switch (static_cast<ParamType>(i))
-                {
-                    case ParamType::INT:
-                        BMCWEB_LOG_DEBUG << "<int>";
-                        break;
-                    case ParamType::UINT:
-                        BMCWEB_LOG_DEBUG << "<uint>";
-                        break;
-                    case ParamType::DOUBLE:
-                        BMCWEB_LOG_DEBUG << "<float>";
-                        break;
-                    case ParamType::STRING:
-                        BMCWEB_LOG_DEBUG << "<str>";
-                        break;
-                    case ParamType::PATH:
-                        BMCWEB_LOG_DEBUG << "<path>";
-                        break;
-                    case ParamType::MAX:
-                        BMCWEB_LOG_DEBUG << "<ERROR>";
-                        break;
-                }
-
-                debugNodePrint(&nodes[n->paramChildrens[i]], level + 1);
-            }
-        }
-        for (const std::pair<std::string, unsigned>& kv : n->children)
-        {
-            BMCWEB_LOG_DEBUG
-                << std::string(2U * level, ' ') /*<< "(" << kv.second << ") "*/
-                << kv.first;
-            debugNodePrint(&nodes[kv.second], level + 1);
-        }
-    }
-
-  public:
-    void debugPrint()
-    {
-        debugNodePrint(head(), 0U);
-    }
-
-  private:
-    const Node* head() const
-    {
-        return &nodes.front();
-    }
-
-    Node* head()
-    {
-        return &nodes.front();
-    }
-
-    unsigned newNode()
-    {
-        nodes.resize(nodes.size() + 1);
-        return static_cast<unsigned>(nodes.size() - 1);
-    }
-
-    std::vector<Node> nodes;
-};
-
 class Router
 {
   public:
@@ -1224,10 +845,6 @@ class Router
                 internalAddRuleObject(rule->rule, rule.get());
             }
         }
-        for (PerMethod& perMethod : perMethods)
-        {
-            perMethod.trie.validate();
-        }
     }
 
     template <typename Adaptor>
@@ -1244,8 +861,8 @@ class Router
         Trie& trie = perMethod.trie;
         std::vector<BaseRule*>& rules = perMethod.rules;
 
-        const std::pair<unsigned, RoutingParams>& found = trie.find(req.url);
-        unsigned ruleIndex = found.first;
+        RouteMatch match;
+        unsigned ruleIndex = trie.find(req.url, match);
         if (!ruleIndex)
         {
             BMCWEB_LOG_DEBUG << "Cannot match rules " << req.url;
@@ -1324,6 +941,113 @@ class Router
 
     void handle(Request& req,
                 const std::shared_ptr<bmcweb::AsyncResp>& asyncResp)
+    {
+        if (req.method() != boost::beast::http::verb::get ||
+            !req.url.starts_with("/redfish/"))
+        {
+            routeRequest(req, asyncResp);
+            return;
+        }
+        std::optional<redfish::query_param::Query> query =
+            redfish::query_param::parseParameters(req.urlParams,
+                                                  asyncResp->res);
+        if (!query)
+        {
+            return;
+        }
+        req.selectProperties = query->selectProperties;
+        // Each expanded reference is read with the rights of the request, and
+        // an anonymous request only has those for the service root
+        if (req.session == nullptr &&
+            query->expandType != redfish::query_param::ExpandType::None)
+        {
+            BMCWEB_LOG_DEBUG << "Not expanding " << req.url
+                             << " for an unauthenticated request";
+            query->expandType = redfish::query_param::ExpandType::None;
+        }
+        if (!redfish::query_param::needsProcessing(*query))
+        {
+            routeRequest(req, asyncResp);
+            return;
+        }
+
+        // The handler completes an intermediate response, which the query is
+        // then applied to
+        std::shared_ptr<Response> intermediate = std::make_shared<Response>();
+        intermediate->setCompleteRequestHandler([this, &req, asyncResp,
+                                                 parsed{*query},
+                                                 intermediate] {
+            boost::asio::post(*req.ioService, [this, &req, asyncResp, parsed,
+                                               intermediate] {
+                redfish::query_param::processAllParams(
+                    parsed, asyncResp, *intermediate,
+                    [this, &req](
+                        const std::string& uri,
+                        std::function<void(Response&)>&& callback) {
+                        subRequest(req, uri, std::move(callback));
+                    });
+                // delete lambda with intermediate shared_ptr
+                intermediate->setCompleteRequestHandler(nullptr);
+            });
+        });
+        routeRequest(req, std::make_shared<bmcweb::AsyncResp>(*intermediate));
+    }
+
+    // Runs a GET of target through the routes, as the user that made req,
+    // and calls callback with the completed response.  The callback is
+    // posted, so never runs before this returns.  Without a session there is
+    // no user to check the rights of, so the GET is refused with 401.
+    void subRequest(const Request& req, std::string_view target,
+                    std::function<void(Response&)>&& callback)
+    {
+        boost::beast::http::request<boost::beast::http::string_body>
+            getBeastReq(req.req);
+        getBeastReq.method(boost::beast::http::verb::get);
+        getBeastReq.target(target);
+        getBeastReq.body().clear();
+        getBeastReq.erase(boost::beast::http::field::content_length);
+        getBeastReq.erase(boost::beast::http::field::if_match);
+        getBeastReq.erase(boost::beast::http::field::if_none_match);
+        std::error_code ec;
+        std::shared_ptr<Request> getReq =
+            std::make_shared<Request>(std::move(getBeastReq), ec);
+        getReq->session = req.session;
+        getReq->ipAddress = req.ipAddress;
+        getReq->ioService = req.ioService;
+        getReq->isSecure = req.isSecure;
+
+        std::shared_ptr<Response> getRes = std::make_shared<Response>();
+        getRes->setCompleteRequestHandler(
+            [getReq, getRes, callback{std::move(callback)}]() mutable {
+                boost::asio::post(*getReq->ioService,
+                                  [getReq, getRes,
+                                   callback{std::move(callback)}] {
+                                      callback(*getRes);
+                                      // delete lambda with getRes shared_ptr
+                                      getRes->setCompleteRequestHandler(
+                                          nullptr);
+                                  });
+            });
+        if (ec)
+        {
+            BMCWEB_LOG_ERROR << "Invalid subrequest target " << target;
+            getRes->result(boost::beast::http::status::internal_server_error);
+            getRes->end();
+            return;
+        }
+        if (getReq->session == nullptr)
+        {
+            BMCWEB_LOG_WARNING << "Refusing unauthenticated subrequest of "
+                               << target;
+            getRes->result(boost::beast::http::status::unauthorized);
+            getRes->end();
+            return;
+        }
+        routeRequest(*getReq, std::make_shared<bmcweb::AsyncResp>(*getRes));
+    }
+
+    void routeRequest(Request& req,
+                      const std::shared_ptr<bmcweb::AsyncResp>& asyncResp)
     {
         if (static_cast<size_t>(req.method()) >= perMethods.size())
         {
@@ -1334,18 +1058,16 @@ class Router
         Trie& trie = perMethod.trie;
         std::vector<BaseRule*>& rules = perMethod.rules;
 
-        const std::pair<unsigned, RoutingParams>& found = trie.find(req.url);
-
-        unsigned ruleIndex = found.first;
+        RouteMatch match;
+        unsigned ruleIndex = trie.find(req.url, match);
 
         if (!ruleIndex)
         {
             // Check to see if this url exists at any verb
             for (const PerMethod& p : perMethods)
             {
-                const std::pair<unsigned, RoutingParams>& found2 =
-                    p.trie.find(req.url);
-                if (found2.first > 0)
+                RouteMatch otherMatch;
+                if (p.trie.find(req.url, otherMatch) > 0)
                 {
                     asyncResp->res.result(
                         boost::beast::http::status::method_not_allowed);
@@ -1401,18 +1123,18 @@ class Router
                          << static_cast<uint32_t>(req.method()) << " / "
                          << rules[ruleIndex]->getMethods();
 
+        RoutingParams params = match.toRoutingParams();
         if (req.session == nullptr)
         {
-            rules[ruleIndex]->handle(req, asyncResp, found.second);
+            handleRule(req, asyncResp, *rules[ruleIndex], params);
             return;
         }
 
-        crow::connections::systemBus->async_method_call(
-            [&req, asyncResp, &rules, ruleIndex, found](
-                const boost::system::error_code ec,
-                std::map<std::string, std::variant<bool, std::string,
-                                                   std::vector<std::string>>>
-                    userInfo) {
+        crow::user_info::getUserInfo(
+            req.session->username,
+            [this, &req, asyncResp, &rules, ruleIndex,
+             params](const boost::system::error_code ec,
+                     const crow::user_info::UserInfoMap& userInfo) {
                 if (ec)
                 {
                     BMCWEB_LOG_ERROR << "GetUserInfo failed for user: "
@@ -1439,7 +1161,7 @@ class Router
                                      << " userRole = " << *userRolePtr;
                 }
 
-                bool* remoteUserPtr = nullptr;
+                const bool* remoteUserPtr = nullptr;
                 auto remoteUserIter = userInfo.find("RemoteUser");
                 if (remoteUserIter != userInfo.end())
                 {
@@ -1458,7 +1180,7 @@ class Router
                 bool passwordExpired = false; // default for remote user
                 if (!remoteUser)
                 {
-                    bool* passwordExpiredPtr = nullptr;
+                    const bool* passwordExpiredPtr = nullptr;
                     auto passwordExpiredIter =
                         userInfo.find("UserPasswordExpired");
                     if (passwordExpiredIter != userInfo.end())
@@ -1514,11 +1236,66 @@ class Router
                 }
 
                 req.userRole = userRole;
-                rules[ruleIndex]->handle(req, asyncResp, found.second);
-            },
-            "xyz.openbmc_project.User.Manager", "/xyz/openbmc_project/user",
-            "xyz.openbmc_project.User.Manager", "GetUserInfo",
-            req.session->username);
+                handleRule(req, asyncResp, *rules[ruleIndex], params);
+            });
+    }
+
+    // Calls the rule, after checking If-Match on a PATCH of a rule that asks
+    // for it.  Only the GET handler knows what the resource holds, so the
+    // current entity tags come from a GET of the same URL.  That GET is only
+    // made for a session, as it would read the resource for whoever sent the
+    // PATCH; If-Match on an anonymous PATCH always fails.
+    void handleRule(Request& req,
+                    const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                    BaseRule& rule, const RoutingParams& params)
+    {
+        if (req.method() != boost::beast::http::verb::patch ||
+            req.getHeaderValue(boost::beast::http::field::if_match).empty())
+        {
+            rule.handle(req, asyncResp, params);
+            return;
+        }
+        if (!rule.checksIfMatch)
+        {
+            BMCWEB_LOG_DEBUG << "Ignoring If-Match on PATCH of " << req.url;
+            rule.handle(req, asyncResp, params);
+            return;
+        }
+        if (req.session == nullptr)
+        {
+            BMCWEB_LOG_DEBUG << "If-Match on unauthenticated PATCH of "
+                             << req.url;
+            redfish::messages::preconditionFailed(asyncResp->res);
+            return;
+        }
+
+        subRequest(req, req.target(),
+                   [&req, asyncResp, &rule, params](Response& getRes) {
+                       afterIfMatchGet(req, asyncResp, rule, params, getRes);
+                   });
+    }
+
+    static void
+        afterIfMatchGet(Request& req,
+                        const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                        BaseRule& rule, const RoutingParams& params,
+                        Response& getRes)
+    {
+        if (getRes.result() != boost::beast::http::status::ok)
+        {
+            BMCWEB_LOG_DEBUG << "If-Match GET of " << req.url
+                             << " failed: " << getRes.resultInt();
+            redfish::messages::preconditionFailed(asyncResp->res);
+            return;
+        }
+        if (!http_helpers::ifMatchMatches(
+                req.getHeaderValue(boost::beast::http::field::if_match),
+                getRes))
+        {
+            redfish::messages::preconditionFailed(asyncResp->res);
+            return;
+        }
+        rule.handle(req, asyncResp, params);
     }
 
     void debugPrint()
@@ -1537,11 +1314,14 @@ class Router
 
         for (const PerMethod& pm : perMethods)
         {
-            std::vector<unsigned> x;
-            pm.trie.findRouteIndexes(parent, x);
-            for (unsigned index : x)
+            // Index 0 and 1 are reserved, see PerMethod
+            for (size_t index = 2; index < pm.rules.size(); index++)
             {
-                ret.push_back(&pm.rules[index]->rule);
+                const std::string& rule = pm.rules[index]->rule;
+                if (rule.size() > parent.size() && rule.starts_with(parent))
+                {
+                    ret.push_back(&rule);
+                }
             }
         }
         return ret;
@@ -0,0 +1,490 @@
+#pragma once
+
+#include "common.hpp"
+#include "logging.hpp"
+
+#include <boost/container/small_vector.hpp>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace crow
+{
+
+// The most parameters a single route may declare
+constexpr size_t maxRouteParams = 8;
+
+struct RouteParam
+{
+    ParamType type;
+    std::string_view value;
+};
+
+/**
+ * RouteMatch
+ * The parameters captured while matching a url, as views into the url.
+ * Matching never allocates; convert to RoutingParams once a rule is chosen.
+ */
+struct RouteMatch
+{
+    std::array<RouteParam, maxRouteParams> params{};
+    size_t count = 0;
+
+    RoutingParams toRoutingParams() const;
+};
+
+namespace routing_detail
+{
+
+inline bool parseInt(std::string_view value, int64_t& out)
+{
+    if (value.starts_with('+'))
+    {
+        value.remove_prefix(1);
+        if (value.starts_with('-'))
+        {
+            return false;
+        }
+    }
+    const char* end = value.data() + value.size();
+    std::from_chars_result ret = std::from_chars(value.data(), end, out);
+    return ret.ec == std::errc() && ret.ptr == end;
+}
+
+inline bool parseUint(std::string_view value, uint64_t& out)
+{
+    if (value.starts_with('+'))
+    {
+        value.remove_prefix(1);
+    }
+    const char* end = value.data() + value.size();
+    std::from_chars_result ret = std::from_chars(value.data(), end, out);
+    return ret.ec == std::errc() && ret.ptr == end;
+}
+
+inline bool parseDouble(std::string_view value, double& out)
+{
+    if (value.empty())
+    {
+        return false;
+    }
+    char c = value.front();
+    if ((c < '0' || c > '9') && c != '+' && c != '-' && c != '.')
+    {
+        return false;
+    }
+    if (c == '+')
+    {
+        value.remove_prefix(1);
+        if (value.starts_with('-'))
+        {
+            return false;
+        }
+    }
+    const char* end = value.data() + value.size();
+    std::from_chars_result ret = std::from_chars(value.data(), end, out);
+    return ret.ec == std::errc() && ret.ptr == end;
+}
+
+// Checks that a url segment can fill a parameter of the given type
+inline bool segmentMatches(ParamType type, std::string_view segment)
+{
+    switch (type)
+    {
+        case ParamType::INT:
+        {
+            int64_t value = 0;
+            return parseInt(segment, value);
+        }
+        case ParamType::UINT:
+        {
+            uint64_t value = 0;
+            return parseUint(segment, value);
+        }
+        case ParamType::DOUBLE:
+        {
+            double value = 0.0;
+            return parseDouble(segment, value);
+        }
+        case ParamType::STRING:
+        case ParamType::PATH:
+            return !segment.empty();
+        case ParamType::MAX:
+            break;
+    }
+    return false;
+}
+
+} // namespace routing_detail
+
+inline RoutingParams RouteMatch::toRoutingParams() const
+{
+    RoutingParams ret;
+    for (size_t i = 0; i < count; i++)
+    {
+        const RouteParam& param = params[i];
+        switch (param.type)
+        {
+            case ParamType::INT:
+            {
+                int64_t value = 0;
+                routing_detail::parseInt(param.value, value);
+                ret.intParams.push_back(value);
+                break;
+            }
+            case ParamType::UINT:
+            {
+                uint64_t value = 0;
+                routing_detail::parseUint(param.value, value);
+                ret.uintParams.push_back(value);
+                break;
+            }
+            case ParamType::DOUBLE:
+            {
+                double value = 0.0;
+                routing_detail::parseDouble(param.value, value);
+                ret.doubleParams.push_back(value);
+                break;
+            }
+            case ParamType::STRING:
+            case ParamType::PATH:
+                ret.stringParams.emplace_back(param.value);
+                break;
+            case ParamType::MAX:
+                break;
+        }
+    }
+    return ret;
+}
+
+/**
+ * Trie
+ * Maps urls to rule indexes one '/' separated segment at a time.  Static
+ * segments are looked up by a hash of the segment, which is computed once
+ * per request segment and shared by every node at that depth.  Parameters
+ * must span a whole segment, except <path>, which takes the rest of the url.
+ *
+ * When more than one rule matches a url, the one with the lowest index, the
+ * first one added, wins.  Each node records the lowest index below it, so
+ * branches that can't beat the current match are skipped.
+ */
+class Trie
+{
+  public:
+    struct StaticChild
+    {
+        size_t hash;
+        std::string segment;
+        unsigned node;
+    };
+
+    struct Node
+    {
+        unsigned ruleIndex{};
+        // Lowest rule index of this node and everything below it
+        unsigned minRuleIndex = std::numeric_limits<unsigned>::max();
+        std::array<unsigned, static_cast<size_t>(ParamType::MAX)>
+            paramChildren{};
+        // Sorted by hash, then segment
+        std::vector<StaticChild> children;
+    };
+
+    Trie() : nodes(1)
+    {}
+
+    // Returns the index of the rule matching url, or 0 if none does.  Any
+    // parameters are captured into match as views into url.
+    unsigned find(std::string_view url, RouteMatch& match) const
+    {
+        if (!url.starts_with('/'))
+        {
+            return 0;
+        }
+        url.remove_prefix(1);
+
+        boost::container::small_vector<Segment, 16> segments;
+        while (true)
+        {
+            size_t slash = url.find('/');
+            std::string_view text = url.substr(0, slash);
+            segments.push_back({text, std::hash<std::string_view>{}(text)});
+            if (slash == std::string_view::npos)
+            {
+                break;
+            }
+            url.remove_prefix(slash + 1);
+        }
+
+        Search search{{segments.data(), segments.size()}, match};
+        findFrom(nodes.front(), 0, search);
+        return search.found;
+    }
+
+    void add(std::string_view url, unsigned ruleIndex)
+    {
+        if (!url.starts_with('/'))
+        {
+            throw std::runtime_error("route must start with '/': " +
+                                     std::string(url));
+        }
+        std::string_view rest = url.substr(1);
+        size_t paramCount = 0;
+        unsigned idx = 0;
+        updateMin(idx, ruleIndex);
+        while (true)
+        {
+            size_t slash = rest.find('/');
+            std::string_view segment = rest.substr(0, slash);
+
+            ParamType type = ParamType::MAX;
+            if (segment.find('<') != std::string_view::npos)
+            {
+                type = paramTypeFromSegment(segment);
+                if (type == ParamType::MAX)
+                {
+                    throw std::runtime_error(
+                        "parameters must fill a whole url segment: " +
+                        std::string(url));
+                }
+                if (++paramCount > maxRouteParams)
+                {
+                    throw std::runtime_error("too many parameters in route: " +
+                                             std::string(url));
+                }
+                size_t index = static_cast<size_t>(type);
+                if (nodes[idx].paramChildren[index] == 0)
+                {
+                    unsigned newNodeIdx = newNode();
+                    nodes[idx].paramChildren[index] = newNodeIdx;
+                }
+                idx = nodes[idx].paramChildren[index];
+            }
+            else
+            {
+                idx = staticChild(idx, segment);
+            }
+            updateMin(idx, ruleIndex);
+
+            if (slash == std::string_view::npos)
+            {
+                break;
+            }
+            rest.remove_prefix(slash + 1);
+        }
+        if (nodes[idx].ruleIndex != 0)
+        {
+            throw std::runtime_error("handler already exists for " +
+                                     std::string(url));
+        }
+        nodes[idx].ruleIndex = ruleIndex;
+    }
+
+    void debugPrint() const
+    {
+        debugNodePrint(nodes.front(), 0U);
+    }
+
+  private:
+    struct Segment
+    {
+        std::string_view text;
+        size_t hash;
+    };
+
+    struct Search
+    {
+        std::span<const Segment> segments;
+        RouteMatch& best;
+        RouteMatch current{};
+        unsigned found = 0;
+    };
+
+    static ParamType paramTypeFromSegment(std::string_view segment)
+    {
+        constexpr std::array<std::pair<ParamType, std::string_view>, 7>
+            paramTraits = {{
+                {ParamType::INT, "<int>"},
+                {ParamType::UINT, "<uint>"},
+                {ParamType::DOUBLE, "<float>"},
+                {ParamType::DOUBLE, "<double>"},
+                {ParamType::STRING, "<str>"},
+                {ParamType::STRING, "<string>"},
+                {ParamType::PATH, "<path>"},
+            }};
+        for (const std::pair<ParamType, std::string_view>& x : paramTraits)
+        {
+            if (segment == x.second)
+            {
+                return x.first;
+            }
+        }
+        return ParamType::MAX;
+    }
+
+    void findFrom(const Node& node, size_t segmentIndex, Search& search) const
+    {
+        if (search.found != 0 && node.minRuleIndex >= search.found)
+        {
+            // Nothing below here can beat the current match
+            return;
+        }
+        if (segmentIndex == search.segments.size())
+        {
+            if (node.ruleIndex != 0)
+            {
+                search.found = node.ruleIndex;
+                search.best = search.current;
+            }
+            return;
+        }
+
+        const Segment& segment = search.segments[segmentIndex];
+        const Node* child = findStatic(node, segment);
+        if (child != nullptr)
+        {
+            findFrom(*child, segmentIndex + 1, search);
+        }
+
+        for (size_t i = 0; i < node.paramChildren.size(); i++)
+        {
+            if (node.paramChildren[i] == 0)
+            {
+                continue;
+            }
+            ParamType type = static_cast<ParamType>(i);
+            std::string_view value = segment.text;
+            size_t next = segmentIndex + 1;
+            if (type == ParamType::PATH)
+            {
+                // Everything from this segment to the end of the url
+                const Segment& last = search.segments.back();
+                value = std::string_view(
+                    segment.text.data(), static_cast<size_t>(
+                                             last.text.data() +
+                                             last.text.size() -
+                                             segment.text.data()));
+                next = search.segments.size();
+            }
+            if (!routing_detail::segmentMatches(type, value))
+            {
+                continue;
+            }
+            RouteMatch& current = search.current;
+            current.params[current.count] = {type, value};
+            current.count++;
+            findFrom(nodes[node.paramChildren[i]], next, search);
+            current.count--;
+        }
+    }
+
+    const Node* findStatic(const Node& node, const Segment& segment) const
+    {
+        auto it = std::lower_bound(
+            node.children.begin(), node.children.end(), segment.hash,
+            [](const StaticChild& child, size_t hash) {
+                return child.hash < hash;
+            });
+        for (; it != node.children.end() && it->hash == segment.hash; ++it)
+        {
+            if (it->segment == segment.text)
+            {
+                return &nodes[it->node];
+            }
+        }
+        return nullptr;
+    }
+
+    unsigned staticChild(unsigned idx, std::string_view segment)
+    {
+        size_t hash = std::hash<std::string_view>{}(segment);
+        std::vector<StaticChild>& children = nodes[idx].children;
+        auto it = std::lower_bound(
+            children.begin(), children.end(), std::make_pair(hash, segment),
+            [](const StaticChild& child,
+               const std::pair<size_t, std::string_view>& key) {
+                return std::make_pair(child.hash,
+                                      std::string_view(child.segment)) < key;
+            });
+        if (it != children.end() && it->hash == hash && it->segment == segment)
+        {
+            return it->node;
+        }
+        size_t pos = static_cast<size_t>(it - children.begin());
+        unsigned newNodeIdx = newNode();
+        // newNode may reallocate nodes, so look the children up again
+        std::vector<StaticChild>& updated = nodes[idx].children;
+        updated.insert(updated.begin() + static_cast<std::ptrdiff_t>(pos),
+                       {hash, std::string(segment), newNodeIdx});
+        return newNodeIdx;
+    }
+
+    void updateMin(unsigned idx, unsigned ruleIndex)
+    {
+        nodes[idx].minRuleIndex = std::min(nodes[idx].minRuleIndex, ruleIndex);
+    }
+
+    void debugNodePrint(const Node& n, size_t level) const
+    {
+        for (size_t i = 0; i < static_cast<size_t>(ParamType::MAX); i++)
+        {
+            if (n.paramChildren[i] == 0)
+            {
+                continue;
+            }
+            switch (static_cast<ParamType>(i))
+            {
+                case ParamType::INT:
+                    BMCWEB_LOG_DEBUG << std::string(2U * level, ' ')
+                                     << "<int>";
+                    break;
+                case ParamType::UINT:
+                    BMCWEB_LOG_DEBUG << std::string(2U * level, ' ')
+                                     << "<uint>";
+                    break;
+                case ParamType::DOUBLE:
+                    BMCWEB_LOG_DEBUG << std::string(2U * level, ' ')
+                                     << "<float>";
+                    break;
+                case ParamType::STRING:
+                    BMCWEB_LOG_DEBUG << std::string(2U * level, ' ')
+                                     << "<str>";
+                    break;
+                case ParamType::PATH:
+                    BMCWEB_LOG_DEBUG << std::string(2U * level, ' ')
+                                     << "<path>";
+                    break;
+                case ParamType::MAX:
+                    BMCWEB_LOG_DEBUG << std::string(2U * level, ' ')
+                                     << "<ERROR>";
+                    break;
+            }
+            debugNodePrint(nodes[n.paramChildren[i]], level + 1);
+        }
+        for (const StaticChild& child : n.children)
+        {
+            BMCWEB_LOG_DEBUG << std::string(2U * level, ' ') << '/'
+                             << child.segment;
+            debugNodePrint(nodes[child.node], level + 1);
+        }
+    }
+
+    unsigned newNode()
+    {
+        nodes.resize(nodes.size() + 1);
+        return static_cast<unsigned>(nodes.size() - 1);
+    }
+
+    std::vector<Node> nodes;
+};
+
+} // namespace crow
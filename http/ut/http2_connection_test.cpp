@@ -0,0 +1,155 @@
+#include "http2_connection.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+struct FakeHandler
+{
+    bool handled = false;
+
+    void handle(crow::Request& /*req*/,
+                const std::shared_ptr<bmcweb::AsyncResp>& /*asyncResp*/)
+    {
+        handled = true;
+    }
+};
+
+// A bare nghttp2 client, driven by hand from the test
+struct Client
+{
+    std::string body;
+    size_t bodySent = 0;
+    int32_t streamId = 0;
+    bool closed = false;
+    uint32_t closeError = 0;
+};
+
+ssize_t readClientBody(nghttp2_session* /*session*/, int32_t /*streamId*/,
+                       uint8_t* buf, size_t length, uint32_t* dataFlags,
+                       nghttp2_data_source* /*source*/, void* userData)
+{
+    Client& client = *static_cast<Client*>(userData);
+    size_t toSend = std::min(client.body.size() - client.bodySent, length);
+    std::copy_n(client.body.begin() +
+                    static_cast<std::ptrdiff_t>(client.bodySent),
+                toSend, buf);
+    client.bodySent += toSend;
+    if (client.bodySent == client.body.size())
+    {
+        *dataFlags |= NGHTTP2_DATA_FLAG_EOF;
+    }
+    return static_cast<ssize_t>(toSend);
+}
+
+int onClientStreamClose(nghttp2_session* /*session*/, int32_t streamId,
+                        uint32_t errorCode, void* userData)
+{
+    Client& client = *static_cast<Client*>(userData);
+    if (streamId == client.streamId)
+    {
+        client.closed = true;
+        client.closeError = errorCode;
+    }
+    return 0;
+}
+
+nghttp2_nv header(const char* name, const char* value)
+{
+    return {reinterpret_cast<uint8_t*>(const_cast<char*>(name)),
+            reinterpret_cast<uint8_t*>(const_cast<char*>(value)),
+            std::strlen(name), std::strlen(value), NGHTTP2_NV_FLAG_NONE};
+}
+
+} // namespace
+
+TEST(Http2Connection, RefusedStreamIsNotDispatched)
+{
+    boost::asio::io_context ioc;
+    boost::asio::ip::tcp::acceptor acceptor(
+        ioc, {boost::asio::ip::make_address("127.0.0.1"), 0});
+    boost::asio::ip::tcp::socket clientSocket(ioc);
+    clientSocket.connect(acceptor.local_endpoint());
+    boost::asio::ip::tcp::socket serverSocket = acceptor.accept();
+
+    FakeHandler handler;
+    std::function<std::string()> getDate = [] { return std::string(); };
+    auto conn = std::make_shared<
+        crow::HTTP2Connection<boost::asio::ip::tcp::socket, FakeHandler>>(
+        std::move(serverSocket), &handler, getDate,
+        boost::asio::ip::make_address("127.0.0.1"), nullptr);
+    conn->start();
+
+    Client client;
+    // Over the limit for a stream that isn't logged in, sent with
+    // END_STREAM in the same frame
+    client.body = std::string(crow::loggedOutPostBodyLimit + 1, 'a');
+
+    nghttp2_session_callbacks* callbacks = nullptr;
+    nghttp2_session_callbacks_new(&callbacks);
+    nghttp2_session_callbacks_set_on_stream_close_callback(
+        callbacks, onClientStreamClose);
+    nghttp2_session* session = nullptr;
+    ASSERT_EQ(nghttp2_session_client_new(&session, callbacks, &client), 0);
+    nghttp2_session_callbacks_del(callbacks);
+
+    ASSERT_EQ(nghttp2_submit_settings(session, NGHTTP2_FLAG_NONE, nullptr, 0),
+              0);
+    std::array<nghttp2_nv, 4> headers = {
+        header(":method", "POST"), header(":scheme", "https"),
+        header(":path", "/login"), header(":authority", "localhost")};
+    nghttp2_data_provider dataPrd{};
+    dataPrd.read_callback = readClientBody;
+    client.streamId = nghttp2_submit_request(
+        session, nullptr, headers.data(), headers.size(), &dataPrd, nullptr);
+    ASSERT_GT(client.streamId, 0);
+
+    std::string out;
+    const uint8_t* bytes = nullptr;
+    ssize_t size = 0;
+    while ((size = nghttp2_session_mem_send(session, &bytes)) > 0)
+    {
+        out.append(reinterpret_cast<const char*>(bytes),
+                   static_cast<size_t>(size));
+    }
+    boost::asio::write(clientSocket, boost::asio::buffer(out));
+
+    std::array<uint8_t, 8192> inBuffer{};
+    std::function<void(const boost::system::error_code&, size_t)> onRead =
+        [&](const boost::system::error_code& ec, size_t bytesRead) {
+            if (ec)
+            {
+                return;
+            }
+            nghttp2_session_mem_recv(session, inBuffer.data(), bytesRead);
+            if (client.closed)
+            {
+                ioc.stop();
+                return;
+            }
+            clientSocket.async_read_some(boost::asio::buffer(inBuffer),
+                                         onRead);
+        };
+    clientSocket.async_read_some(boost::asio::buffer(inBuffer), onRead);
+    ioc.run_for(std::chrono::seconds(5));
+
+    EXPECT_TRUE(client.closed);
+    EXPECT_EQ(client.closeError,
+              static_cast<uint32_t>(NGHTTP2_REFUSED_STREAM));
+    EXPECT_FALSE(handler.handled);
+
+    nghttp2_session_del(session);
+}
@@ -0,0 +1,460 @@
+#include <dbus_singleton.hpp>
+#include <http_client.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using crow::ConnectionPolicy;
+using crow::ConnectionPool;
+using crow::ConnState;
+using crow::HttpClient;
+using crow::PendingRequest;
+using Strings = std::vector<std::string>;
+
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+// An event destination on the loopback interface, which records the body of
+// every request it reads
+class Collector
+{
+  public:
+    explicit Collector(boost::asio::io_context& ioc) :
+        acceptor(ioc, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0))
+    {
+        accept();
+    }
+
+    std::string port() const
+    {
+        return std::to_string(acceptor.local_endpoint().port());
+    }
+
+    // Responses are only written once this many requests are read from a
+    // connection, which only happens if the client pipelines them
+    size_t batchSize = 1;
+    // The response status for the request with the given index in bodies
+    std::function<unsigned(size_t)> status = [](size_t) { return 200U; };
+
+    Strings bodies;
+    size_t accepted = 0;
+
+  private:
+    struct Session
+    {
+        explicit Session(tcp::socket&& socketIn) : socket(std::move(socketIn))
+        {}
+
+        tcp::socket socket;
+        boost::beast::flat_buffer buffer;
+        http::request<http::string_body> req;
+        std::vector<unsigned> statuses;
+    };
+
+    void accept()
+    {
+        acceptor.async_accept(
+            [this](const boost::system::error_code ec, tcp::socket socket) {
+                if (ec)
+                {
+                    return;
+                }
+                accepted++;
+                read(std::make_shared<Session>(std::move(socket)));
+                accept();
+            });
+    }
+
+    void read(const std::shared_ptr<Session>& session)
+    {
+        session->req = {};
+        http::async_read(
+            session->socket, session->buffer, session->req,
+            [this, session](const boost::system::error_code ec, size_t) {
+                if (ec)
+                {
+                    return;
+                }
+                bodies.push_back(session->req.body());
+                session->statuses.push_back(status(bodies.size() - 1));
+                if (session->statuses.size() < batchSize)
+                {
+                    read(session);
+                    return;
+                }
+                respond(session);
+            });
+    }
+
+    void respond(const std::shared_ptr<Session>& session)
+    {
+        if (session->statuses.empty())
+        {
+            read(session);
+            return;
+        }
+        auto res = std::make_shared<http::response<http::string_body>>(
+            static_cast<http::status>(session->statuses.front()), 11);
+        res->keep_alive(true);
+        res->prepare_payload();
+        http::async_write(
+            session->socket, *res,
+            [this, session, res](const boost::system::error_code ec, size_t) {
+                if (ec)
+                {
+                    return;
+                }
+                session->statuses.erase(session->statuses.begin());
+                respond(session);
+            });
+    }
+
+    tcp::acceptor acceptor;
+};
+
+// Runs ioc until done returns true, or a few seconds passed
+bool runUntil(boost::asio::io_context& ioc, const std::function<bool()>& done)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done() && std::chrono::steady_clock::now() < deadline)
+    {
+        ioc.run_one_for(std::chrono::milliseconds(10));
+    }
+    return done();
+}
+
+std::shared_ptr<const std::string> event(const std::string& body)
+{
+    return std::make_shared<const std::string>(body);
+}
+
+std::shared_ptr<HttpClient>
+    makeClient(const std::shared_ptr<ConnectionPool>& pool,
+               const std::string& id)
+{
+    return std::make_shared<HttpClient>(pool, id, "/events",
+                                        boost::beast::http::fields());
+}
+
+} // namespace
+
+TEST(HttpClient, SubscribersShareKeepAliveConnection)
+{
+    boost::asio::io_context ioc;
+    Collector collector(ioc);
+    ConnectionPolicy policy;
+    policy.maxConnections = 1;
+    policy.pipelineDepth = 1;
+    auto pool = std::make_shared<ConnectionPool>(ioc, "127.0.0.1",
+                                                 collector.port(), false,
+                                                 policy);
+    auto first = makeClient(pool, "1");
+    auto second = makeClient(pool, "2");
+
+    first->sendData(event("a"));
+    second->sendData(event("b"));
+    first->sendData(event("c"));
+    ASSERT_TRUE(runUntil(ioc, [&] { return collector.bodies.size() == 3; }));
+    second->sendData(event("d"));
+    ASSERT_TRUE(runUntil(ioc, [&] { return collector.bodies.size() == 4; }));
+
+    EXPECT_EQ(collector.bodies, Strings({"a", "b", "c", "d"}));
+    EXPECT_EQ(collector.accepted, 1U);
+    EXPECT_EQ(pool->getConnectionCount(), 1U);
+}
+
+TEST(HttpClient, PipelinesQueuedEvents)
+{
+    boost::asio::io_context ioc;
+    Collector collector(ioc);
+    collector.batchSize = 3;
+    ConnectionPolicy policy;
+    policy.maxConnections = 1;
+    policy.pipelineDepth = 3;
+    auto pool = std::make_shared<ConnectionPool>(ioc, "127.0.0.1",
+                                                 collector.port(), false,
+                                                 policy);
+    auto first = makeClient(pool, "1");
+    auto second = makeClient(pool, "2");
+    auto third = makeClient(pool, "3");
+
+    // Queued before the connection is up, so they go out as one batch that
+    // the collector only answers once it has read all of it.  Only the
+    // first event of each subscriber is in it.
+    first->sendData(event("a"));
+    first->sendData(event("b"));
+    second->sendData(event("c"));
+    third->sendData(event("d"));
+    ASSERT_TRUE(runUntil(ioc, [&] { return collector.bodies.size() == 3; }));
+    EXPECT_EQ(collector.bodies, Strings({"a", "c", "d"}));
+    EXPECT_EQ(collector.accepted, 1U);
+}
+
+TEST(HttpClient, RetriedEventKeepsItsOrder)
+{
+    boost::asio::io_context ioc;
+    Collector collector(ioc);
+    collector.status = [](size_t index) { return index == 0 ? 500U : 200U; };
+    ConnectionPolicy policy;
+    policy.maxConnections = 1;
+    policy.pipelineDepth = 3;
+    auto pool = std::make_shared<ConnectionPool>(ioc, "127.0.0.1",
+                                                 collector.port(), false,
+                                                 policy);
+    auto client = makeClient(pool, "1");
+    client->setRetryConfig(3, 0);
+
+    client->sendData(event("a"));
+    client->sendData(event("b"));
+    client->sendData(event("c"));
+    ASSERT_TRUE(runUntil(ioc, [&] { return collector.bodies.size() == 4; }));
+    EXPECT_EQ(collector.bodies, Strings({"a", "a", "b", "c"}));
+}
+
+TEST(HttpClient, RetryHoldsBackOnlyItsSubscriber)
+{
+    boost::asio::io_context ioc;
+    Collector collector(ioc);
+    collector.status = [](size_t index) { return index == 0 ? 500U : 200U; };
+    ConnectionPolicy policy;
+    policy.maxConnections = 1;
+    auto pool = std::make_shared<ConnectionPool>(ioc, "127.0.0.1",
+                                                 collector.port(), false,
+                                                 policy);
+    auto failing = makeClient(pool, "1");
+    auto other = makeClient(pool, "2");
+    failing->setRetryConfig(3, 60);
+
+    failing->sendData(event("a"));
+    failing->sendData(event("b"));
+    other->sendData(event("c"));
+    ASSERT_TRUE(runUntil(ioc, [&] { return collector.bodies.size() == 2; }));
+    other->sendData(event("d"));
+    ASSERT_TRUE(runUntil(ioc, [&] { return collector.bodies.size() == 3; }));
+    EXPECT_EQ(collector.bodies, Strings({"a", "c", "d"}));
+}
+
+TEST(HttpClient, QueueDepthBoundsWaitingEvents)
+{
+    boost::asio::io_context ioc;
+    Collector collector(ioc);
+    // Never answers
+    collector.batchSize = 100;
+    ConnectionPolicy policy;
+    policy.queueDepth = 4;
+    auto pool = std::make_shared<ConnectionPool>(ioc, "127.0.0.1",
+                                                 collector.port(), false,
+                                                 policy);
+    auto client = makeClient(pool, "1");
+    auto other = makeClient(pool, "2");
+
+    EXPECT_TRUE(pool->enqueue(PendingRequest{event("a"), client}));
+    EXPECT_TRUE(pool->enqueue(PendingRequest{event("b"), other}));
+    ASSERT_TRUE(runUntil(ioc, [&] { return collector.bodies.size() == 2; }));
+    // Events being sent still count against the depth
+    EXPECT_TRUE(pool->enqueue(PendingRequest{event("c"), client}));
+    EXPECT_TRUE(pool->enqueue(PendingRequest{event("d"), other}));
+    EXPECT_FALSE(pool->enqueue(PendingRequest{event("e"), other}));
+}
+
+TEST(HttpClient, SubscribersCantStarveEachOther)
+{
+    boost::asio::io_context ioc;
+    Collector collector(ioc);
+    // Never answers
+    collector.batchSize = 100;
+    ConnectionPolicy policy;
+    policy.queueDepth = 4;
+    policy.maxConnections = 1;
+    policy.pipelineDepth = 2;
+    auto pool = std::make_shared<ConnectionPool>(ioc, "127.0.0.1",
+                                                 collector.port(), false,
+                                                 policy);
+    auto noisy = makeClient(pool, "1");
+    auto quiet = makeClient(pool, "2");
+
+    // The noisy subscriber fills the queue while nothing else needs it
+    std::vector<bool> delivered;
+    for (const char* body : {"a", "b", "c", "d"})
+    {
+        EXPECT_TRUE(noisy->sendData(event(body), [&delivered](bool ok) {
+            delivered.push_back(ok);
+        }));
+    }
+    EXPECT_FALSE(noisy->sendData(event("x")));
+
+    // The other one takes back its half, from the noisy one's newest events
+    EXPECT_TRUE(quiet->sendData(event("e")));
+    EXPECT_TRUE(quiet->sendData(event("f")));
+    EXPECT_FALSE(quiet->sendData(event("g")));
+
+    ASSERT_TRUE(runUntil(ioc, [&] { return collector.bodies.size() == 2; }));
+    EXPECT_EQ(collector.bodies, Strings({"a", "e"}));
+    // The noisy subscriber is told of the events it lost
+    EXPECT_EQ(delivered, std::vector<bool>({false, false}));
+}
+
+TEST(HttpClient, LoneSubscriberUsesWholeQueue)
+{
+    boost::asio::io_context ioc;
+    Collector collector(ioc);
+    // Never answers
+    collector.batchSize = 100;
+    ConnectionPolicy policy;
+    policy.queueDepth = 8;
+    auto pool = std::make_shared<ConnectionPool>(ioc, "127.0.0.1",
+                                                 collector.port(), false,
+                                                 policy);
+    auto busy = makeClient(pool, "1");
+    // Idle subscribers of the same destination don't hold back any of it
+    auto idle = makeClient(pool, "2");
+    auto idle2 = makeClient(pool, "3");
+    auto idle3 = makeClient(pool, "4");
+
+    for (size_t i = 0; i < policy.queueDepth; i++)
+    {
+        EXPECT_TRUE(busy->sendData(event(std::to_string(i))));
+    }
+    EXPECT_FALSE(busy->sendData(event("full")));
+}
+
+TEST(HttpClient, DeletedSubscriberStopsSending)
+{
+    boost::asio::io_context ioc;
+    Collector collector(ioc);
+    ConnectionPolicy policy;
+    policy.maxConnections = 1;
+    auto pool = std::make_shared<ConnectionPool>(ioc, "127.0.0.1",
+                                                 collector.port(), false,
+                                                 policy);
+    auto deleted = makeClient(pool, "1");
+    auto other = makeClient(pool, "2");
+
+    std::optional<bool> delivered;
+    deleted->sendData(event("a"), [&](bool result) { delivered = result; });
+    deleted->sendData(event("b"));
+    // Queued events don't keep the subscriber around
+    std::weak_ptr<HttpClient> weak = deleted;
+    deleted.reset();
+    EXPECT_TRUE(weak.expired());
+
+    other->sendData(event("c"));
+    ASSERT_TRUE(runUntil(ioc, [&] {
+        return collector.bodies.size() == 1 && delivered.has_value();
+    }));
+    EXPECT_FALSE(*delivered);
+    EXPECT_EQ(collector.bodies, Strings({"c"}));
+}
+
+TEST(HttpClient, FailedEventIsRetried)
+{
+    boost::asio::io_context ioc;
+    Collector collector(ioc);
+    collector.status = [](size_t index) { return index == 0 ? 500U : 200U; };
+    auto pool = std::make_shared<ConnectionPool>(ioc, "127.0.0.1",
+                                                 collector.port(), false);
+    auto client = makeClient(pool, "1");
+    client->setRetryConfig(3, 0);
+
+    std::optional<bool> delivered;
+    EXPECT_TRUE(client->sendData(event("a"), [&](bool result) {
+        delivered = result;
+    }));
+    ASSERT_TRUE(runUntil(ioc, [&] { return delivered.has_value(); }));
+    EXPECT_TRUE(*delivered);
+    EXPECT_EQ(collector.bodies, Strings({"a", "a"}));
+    EXPECT_EQ(client->getConnState(), ConnState::active);
+}
+
+TEST(HttpClient, TerminateAfterRetriesStopsSubscriber)
+{
+    boost::asio::io_context ioc;
+    Collector collector(ioc);
+    collector.status = [](size_t) { return 503U; };
+    auto pool = std::make_shared<ConnectionPool>(ioc, "127.0.0.1",
+                                                 collector.port(), false);
+    auto client = makeClient(pool, "1");
+    auto other = makeClient(pool, "2");
+    client->setRetryConfig(2, 0);
+    client->setRetryPolicy("TerminateAfterRetries");
+    other->setRetryConfig(100, 0);
+    other->setRetryPolicy("RetryForever");
+
+    std::optional<bool> delivered;
+    client->sendData(event("a"), [&](bool result) { delivered = result; });
+    ASSERT_TRUE(runUntil(ioc, [&] { return delivered.has_value(); }));
+    EXPECT_FALSE(*delivered);
+    EXPECT_EQ(client->getConnState(), ConnState::terminated);
+    // The first attempt, then two retries
+    EXPECT_EQ(collector.bodies, Strings({"a", "a", "a"}));
+
+    EXPECT_FALSE(client->sendData(event("b")));
+    collector.status = [](size_t) { return 200U; };
+    other->sendData(event("c"));
+    ASSERT_TRUE(runUntil(ioc, [&] { return collector.bodies.size() == 4; }));
+    EXPECT_EQ(collector.bodies.back(), "c");
+    EXPECT_EQ(other->getConnState(), ConnState::active);
+}
+
+TEST(HttpClient, UnreachableDestinationSuspendsSubscriber)
+{
+    boost::asio::io_context ioc;
+    std::string port;
+    {
+        // A port nothing listens on
+        Collector closed(ioc);
+        port = closed.port();
+    }
+    auto pool =
+        std::make_shared<ConnectionPool>(ioc, "127.0.0.1", port, false);
+    auto client = makeClient(pool, "1");
+    client->setRetryConfig(1, 0);
+    client->setRetryPolicy("SuspendRetries");
+
+    client->sendData(event("a"));
+    client->sendData(event("b"));
+    ASSERT_TRUE(runUntil(ioc, [&] {
+        return client->getConnState() == ConnState::suspended;
+    }));
+    EXPECT_TRUE(runUntil(ioc, [&] { return pool->getConnectionCount() == 0; }));
+}
+
+TEST(HttpClient, PoolIsSharedWhileSubscribersUseIt)
+{
+    boost::asio::io_context ioc;
+    auto first = std::make_shared<HttpClient>(
+        ioc, "1", "127.0.0.1", "4000", "/events", "http",
+        boost::beast::http::fields());
+    auto second = std::make_shared<HttpClient>(
+        ioc, "2", "127.0.0.1", "4000", "/events", "http",
+        boost::beast::http::fields());
+    std::shared_ptr<ConnectionPool> pool =
+        crow::getConnectionPool(ioc, "127.0.0.1", "4000", false);
+    EXPECT_EQ(crow::getConnectionPools().size(), 1U);
+
+    first.reset();
+    EXPECT_EQ(crow::getConnectionPools().size(), 1U);
+    second.reset();
+    EXPECT_TRUE(crow::getConnectionPools().empty());
+    // A new subscriber gets a new pool
+    auto third = std::make_shared<HttpClient>(
+        ioc, "3", "127.0.0.1", "4000", "/events", "http",
+        boost::beast::http::fields());
+    EXPECT_NE(crow::getConnectionPool(ioc, "127.0.0.1", "4000", false), pool);
+}
@@ -0,0 +1,294 @@
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/ssl/ssl_stream.hpp>
+#include <cors_preflight.hpp>
+#include <routing.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+// A service root linking to a collection that must not be read anonymously
+void addRoutes(crow::Router& router, bool& systemsRead)
+{
+    router.newRuleTagged<0>("/redfish/v1/")
+        .methods(boost::beast::http::verb::get)(
+            [](const crow::Request&,
+               const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                asyncResp->res.jsonValue["@odata.id"] = "/redfish/v1";
+                asyncResp->res.jsonValue["Systems"]["@odata.id"] =
+                    "/redfish/v1/Systems";
+            });
+    router.newRuleTagged<0>("/redfish/v1/Systems/")
+        .methods(boost::beast::http::verb::get)(
+            [&systemsRead](
+                const crow::Request&,
+                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                systemsRead = true;
+                asyncResp->res.jsonValue["Members@odata.count"] = 1;
+            });
+    router.newRuleTagged<0>("/redfish/v1/Systems/")
+        .ifMatch()
+        .methods(boost::beast::http::verb::patch)(
+            [](const crow::Request&,
+               const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                asyncResp->res.jsonValue["Patched"] = true;
+            });
+    router.validate();
+}
+
+// Routes a request of an administrator's session
+void route(boost::asio::io_context& ioc, crow::Router& router,
+           boost::beast::http::verb method, const char* target,
+           crow::Response& res, const std::string& ifMatch = "")
+{
+    crow::user_info::UserInfoCache& users =
+        crow::user_info::UserInfoCache::getInstance();
+    users.insert("admin",
+                 {{"UserPrivilege", std::string("priv-admin")},
+                  {"RemoteUser", false},
+                  {"UserPasswordExpired", false}},
+                 std::chrono::steady_clock::now(), users.getGeneration());
+
+    boost::beast::http::request<boost::beast::http::string_body> beastReq(
+        method, target, 11);
+    if (!ifMatch.empty())
+    {
+        beastReq.set(boost::beast::http::field::if_match, ifMatch);
+    }
+    std::error_code ec;
+    crow::Request req(beastReq, ec);
+    EXPECT_FALSE(ec);
+    req.ioService = &ioc;
+    req.session = std::make_shared<persistent_data::UserSession>();
+    req.session->username = "admin";
+
+    res.setCompleteRequestHandler([] {});
+    router.handle(req, std::make_shared<bmcweb::AsyncResp>(res));
+    ioc.run();
+    ioc.restart();
+}
+
+// A resource whose GET has a time in it, which changes on every read
+void addVolatileRoutes(crow::Router& router, int& now, bool optIn)
+{
+    router.newRuleTagged<0>("/redfish/v1/Managers/bmc/")
+        .methods(boost::beast::http::verb::get)(
+            [&now, optIn](const crow::Request&,
+                          const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                asyncResp->res.jsonValue["DateTime"] = now++;
+                if (optIn)
+                {
+                    // From what a PATCH changes, leaving out the time
+                    asyncResp->res.addHeader(boost::beast::http::field::etag,
+                                             "\"version-1\"");
+                }
+            });
+    auto& patch = router.newRuleTagged<0>("/redfish/v1/Managers/bmc/");
+    if (optIn)
+    {
+        patch.ifMatch();
+    }
+    patch.methods(boost::beast::http::verb::patch)(
+        [](const crow::Request&,
+           const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+            asyncResp->res.jsonValue["Patched"] = true;
+        });
+    router.validate();
+}
+
+} // namespace
+
+TEST(Router, AnonymousExpandReturnsReferences)
+{
+    boost::asio::io_context ioc;
+    crow::Router router;
+    bool systemsRead = false;
+    addRoutes(router, systemsRead);
+
+    boost::beast::http::request<boost::beast::http::string_body> beastReq(
+        boost::beast::http::verb::get, "/redfish/v1/?$expand=*($levels=6)",
+        11);
+    std::error_code ec;
+    crow::Request req(beastReq, ec);
+    ASSERT_FALSE(ec);
+    req.ioService = &ioc;
+
+    crow::Response res;
+    bool completed = false;
+    res.setCompleteRequestHandler([&completed] { completed = true; });
+    router.handle(req, std::make_shared<bmcweb::AsyncResp>(res));
+    ioc.run();
+
+    EXPECT_TRUE(completed);
+    EXPECT_FALSE(systemsRead);
+    EXPECT_EQ(res.jsonValue["Systems"],
+              nlohmann::json({{"@odata.id", "/redfish/v1/Systems"}}));
+}
+
+TEST(Router, AnonymousSubRequestIsRefused)
+{
+    boost::asio::io_context ioc;
+    crow::Router router;
+    bool systemsRead = false;
+    addRoutes(router, systemsRead);
+
+    boost::beast::http::request<boost::beast::http::string_body> beastReq(
+        boost::beast::http::verb::get, "/redfish/v1/", 11);
+    std::error_code ec;
+    crow::Request req(beastReq, ec);
+    ASSERT_FALSE(ec);
+    req.ioService = &ioc;
+
+    unsigned result = 0;
+    router.subRequest(req, "/redfish/v1/Systems/",
+                      [&result](crow::Response& res) {
+                          result = res.resultInt();
+                      });
+    ioc.run();
+
+    EXPECT_EQ(result, 401U);
+    EXPECT_FALSE(systemsRead);
+}
+
+TEST(Router, AnonymousIfMatchFails)
+{
+    boost::asio::io_context ioc;
+    crow::Router router;
+    bool systemsRead = false;
+    addRoutes(router, systemsRead);
+
+    boost::beast::http::request<boost::beast::http::string_body> beastReq(
+        boost::beast::http::verb::patch, "/redfish/v1/Systems/", 11);
+    beastReq.set(boost::beast::http::field::if_match, "*");
+    std::error_code ec;
+    crow::Request req(beastReq, ec);
+    ASSERT_FALSE(ec);
+    req.ioService = &ioc;
+
+    crow::Response res;
+    res.setCompleteRequestHandler([] {});
+    router.handle(req, std::make_shared<bmcweb::AsyncResp>(res));
+    ioc.run();
+
+    // Without reading the resource to compare with
+    EXPECT_EQ(res.resultInt(), 412U);
+    EXPECT_FALSE(systemsRead);
+    EXPECT_FALSE(res.jsonValue.contains("Patched"));
+}
+
+TEST(Router, SelectIsParsedForHandlers)
+{
+    boost::asio::io_context ioc;
+    crow::Router router;
+    std::vector<std::string> seen;
+    bool statusSelected = true;
+    router.newRuleTagged<0>("/redfish/v1/Chassis/")
+        .methods(boost::beast::http::verb::get)(
+            [&seen, &statusSelected](
+                const crow::Request& req,
+                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                seen = req.selectProperties;
+                statusSelected =
+                    redfish::query_param::isSelected(req, "Status");
+                asyncResp->res.jsonValue["Name"] = "Chassis";
+                asyncResp->res.jsonValue["Status"]["Health"] = "OK";
+            });
+    router.validate();
+
+    boost::beast::http::request<boost::beast::http::string_body> beastReq(
+        boost::beast::http::verb::get,
+        "/redfish/v1/Chassis/?$select=Name,Links/Chassis", 11);
+    std::error_code ec;
+    crow::Request req(beastReq, ec);
+    ASSERT_FALSE(ec);
+    req.ioService = &ioc;
+
+    crow::Response res;
+    res.setCompleteRequestHandler([] {});
+    router.handle(req, std::make_shared<bmcweb::AsyncResp>(res));
+    ioc.run();
+
+    EXPECT_THAT(seen, testing::ElementsAre("Name", "Links/Chassis"));
+    EXPECT_FALSE(statusSelected);
+    EXPECT_EQ(res.jsonValue, nlohmann::json({{"Name", "Chassis"}}));
+}
+
+TEST(Router, CorsPreflightRouteValidates)
+{
+    boost::asio::io_context ioc;
+    App app;
+    bool systemsRead = false;
+    app.route<0>("/redfish/v1/Systems/")
+        .methods(boost::beast::http::verb::get)(
+            [&systemsRead](const crow::Request&,
+                           const std::shared_ptr<bmcweb::AsyncResp>&) {
+                systemsRead = true;
+            });
+    cors_preflight::requestRoutes(app);
+    EXPECT_NO_THROW(app.validate());
+
+    boost::beast::http::request<boost::beast::http::string_body> beastReq(
+        boost::beast::http::verb::options, "/redfish/v1/Systems", 11);
+    std::error_code ec;
+    crow::Request req(beastReq, ec);
+    ASSERT_FALSE(ec);
+    req.ioService = &ioc;
+
+    crow::Response res;
+    res.setCompleteRequestHandler([] {});
+    app.handle(req, std::make_shared<bmcweb::AsyncResp>(res));
+    ioc.run();
+
+    EXPECT_EQ(res.resultInt(), 200U);
+    EXPECT_FALSE(systemsRead);
+}
+
+TEST(Router, IfMatchIgnoredUnlessRuleAsks)
+{
+    boost::asio::io_context ioc;
+    crow::Router router;
+    int now = 0;
+    addVolatileRoutes(router, now, false);
+
+    crow::Response got;
+    route(ioc, router, boost::beast::http::verb::get,
+          "/redfish/v1/Managers/bmc/", got);
+    std::string etag =
+        http_helpers::getETag(got, http_helpers::ResponseEncoding::Json);
+    // The time has moved on since, so the tag no longer matches a GET
+    crow::Response res;
+    route(ioc, router, boost::beast::http::verb::patch,
+          "/redfish/v1/Managers/bmc/", res, etag);
+    EXPECT_EQ(res.resultInt(), 200U);
+    EXPECT_EQ(res.jsonValue["Patched"], true);
+}
+
+TEST(Router, IfMatchUsesTagOfHandler)
+{
+    boost::asio::io_context ioc;
+    crow::Router router;
+    int now = 0;
+    addVolatileRoutes(router, now, true);
+
+    crow::Response res;
+    route(ioc, router, boost::beast::http::verb::patch,
+          "/redfish/v1/Managers/bmc/", res, "\"version-1\"");
+    EXPECT_EQ(res.resultInt(), 200U);
+    EXPECT_EQ(res.jsonValue["Patched"], true);
+    EXPECT_EQ(now, 1);
+
+    crow::Response stale;
+    route(ioc, router, boost::beast::http::verb::patch,
+          "/redfish/v1/Managers/bmc/", stale, "\"version-0\"");
+    EXPECT_EQ(stale.resultInt(), 412U);
+    EXPECT_FALSE(stale.jsonValue.contains("Patched"));
+}
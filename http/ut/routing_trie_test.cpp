@@ -0,0 +1,122 @@
+#include "routing_trie.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+crow::RoutingParams findParams(const crow::Trie& trie, std::string_view url,
+                               unsigned expectedRule)
+{
+    crow::RouteMatch match;
+    EXPECT_EQ(trie.find(url, match), expectedRule) << url;
+    return match.toRoutingParams();
+}
+
+} // namespace
+
+TEST(RoutingTrie, StaticSegments)
+{
+    crow::Trie trie;
+    trie.add("/", 2);
+    trie.add("/redfish/v1/", 3);
+    trie.add("/redfish/v1", 4);
+    trie.add("/redfish/v1/Systems/", 5);
+
+    crow::RouteMatch match;
+    EXPECT_EQ(trie.find("/", match), 2U);
+    EXPECT_EQ(trie.find("/redfish/v1/", match), 3U);
+    EXPECT_EQ(trie.find("/redfish/v1", match), 4U);
+    EXPECT_EQ(trie.find("/redfish/v1/Systems/", match), 5U);
+    EXPECT_EQ(match.count, 0U);
+
+    EXPECT_EQ(trie.find("/redfish/v1/Systems", match), 0U);
+    EXPECT_EQ(trie.find("/redfish/v1x", match), 0U);
+    EXPECT_EQ(trie.find("/redfish//v1", match), 0U);
+    EXPECT_EQ(trie.find("redfish/v1", match), 0U);
+    EXPECT_EQ(trie.find("", match), 0U);
+}
+
+TEST(RoutingTrie, StringParams)
+{
+    crow::Trie trie;
+    trie.add("/redfish/v1/Systems/<str>/", 2);
+    trie.add("/redfish/v1/Systems/<str>/LogServices/<str>/", 3);
+
+    crow::RoutingParams params =
+        findParams(trie, "/redfish/v1/Systems/system/", 2);
+    EXPECT_THAT(params.stringParams, testing::ElementsAre("system"));
+
+    params = findParams(trie, "/redfish/v1/Systems/system/LogServices/Dump/",
+                        3);
+    EXPECT_THAT(params.stringParams, testing::ElementsAre("system", "Dump"));
+
+    // Parameters never match an empty segment
+    findParams(trie, "/redfish/v1/Systems//", 0);
+}
+
+TEST(RoutingTrie, PathParams)
+{
+    crow::Trie trie;
+    trie.add("/bus/system/<str>/<path>", 2);
+
+    crow::RoutingParams params =
+        findParams(trie, "/bus/system/xyz.openbmc_project/a/b/c", 2);
+    EXPECT_THAT(params.stringParams,
+                testing::ElementsAre("xyz.openbmc_project", "a/b/c"));
+
+    findParams(trie, "/bus/system/xyz.openbmc_project/", 0);
+}
+
+TEST(RoutingTrie, NumericParams)
+{
+    crow::Trie trie;
+    trie.add("/int/<int>", 2);
+    trie.add("/uint/<uint>", 3);
+    trie.add("/double/<double>", 4);
+
+    crow::RoutingParams params = findParams(trie, "/int/-42", 2);
+    EXPECT_THAT(params.intParams, testing::ElementsAre(-42));
+    params = findParams(trie, "/int/+42", 2);
+    EXPECT_THAT(params.intParams, testing::ElementsAre(42));
+    findParams(trie, "/int/42abc", 0);
+    findParams(trie, "/int/+-42", 0);
+    findParams(trie, "/int/99999999999999999999", 0);
+
+    params = findParams(trie, "/uint/18446744073709551615", 3);
+    EXPECT_THAT(params.uintParams,
+                testing::ElementsAre(18446744073709551615ULL));
+    findParams(trie, "/uint/-1", 0);
+
+    params = findParams(trie, "/double/-1.5", 4);
+    EXPECT_THAT(params.doubleParams, testing::ElementsAre(-1.5));
+    params = findParams(trie, "/double/.5", 4);
+    EXPECT_THAT(params.doubleParams, testing::ElementsAre(0.5));
+    findParams(trie, "/double/abc", 0);
+}
+
+TEST(RoutingTrie, LowestRuleIndexWins)
+{
+    crow::Trie trie;
+    trie.add("/a/<str>/c", 2);
+    trie.add("/a/b/c", 3);
+    trie.add("/a/b/<str>", 4);
+
+    crow::RoutingParams params = findParams(trie, "/a/b/c", 2);
+    EXPECT_THAT(params.stringParams, testing::ElementsAre("b"));
+    params = findParams(trie, "/a/b/d", 4);
+    EXPECT_THAT(params.stringParams, testing::ElementsAre("d"));
+}
+
+TEST(RoutingTrie, InvalidRoutes)
+{
+    crow::Trie trie;
+    trie.add("/a/<str>", 2);
+    EXPECT_THROW(trie.add("/a/<str>", 3), std::runtime_error);
+    EXPECT_THROW(trie.add("/b/<str>.json", 4), std::runtime_error);
+    EXPECT_THROW(trie.add("c", 5), std::runtime_error);
+}
@@ -6,12 +6,15 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/container/flat_set.hpp>
 #include <common.hpp>
+#include <credential_cache.hpp>
 #include <forward_unauthorized.hpp>
 #include <http_request.hpp>
 #include <http_response.hpp>
 #include <http_utility.hpp>
 #include <pam_authenticate.hpp>
+#include <stats.hpp>
 
+#include <chrono>
 #include <random>
 #include <utility>
 
@@ -72,19 +75,33 @@ static std::shared_ptr<persistent_data::UserSession>
     BMCWEB_LOG_DEBUG << "[AuthMiddleware] User IPAddress: "
                      << clientIp.to_string();
 
-    int pamrc = pamAuthenticateUser(user, pass);
-    bool isConfigureSelfOnly = pamrc == PAM_NEW_AUTHTOK_REQD;
-    if ((pamrc != PAM_SUCCESS) && !isConfigureSelfOnly)
+    // PAM runs on the io thread and can be slow, so clients that send the
+    // same credentials on every request are only checked against it once in
+    // a while
+    CredentialCache& credentials = CredentialCache::getInstance();
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+    bool isConfigureSelfOnly = false;
+    if (credentials.verify(user, pass, now, isConfigureSelfOnly))
     {
-        return nullptr;
+        bmcweb::stats::increment("basic_auth.cache.hits");
+    }
+    else
+    {
+        bmcweb::stats::increment("basic_auth.cache.misses");
+        int pamrc = pamAuthenticateUser(user, pass);
+        isConfigureSelfOnly = pamrc == PAM_NEW_AUTHTOK_REQD;
+        if ((pamrc != PAM_SUCCESS) && !isConfigureSelfOnly)
+        {
+            return nullptr;
+        }
+        credentials.insert(user, pass, now, isConfigureSelfOnly);
     }
 
     // TODO(ed) generateUserSession is a little expensive for basic
     // auth, as it generates some random identifiers that will never be
     // used.  This should have a "fast" path for when user tokens aren't
     // needed.
-    // This whole flow needs to be revisited anyway, as we can't be
-    // calling directly into pam for every request
     return persistent_data::SessionStore::getInstance().generateUserSession(
         user, clientIp.to_string(), std::nullopt,
         persistent_data::PersistenceType::SINGLE_REQUEST, isConfigureSelfOnly);
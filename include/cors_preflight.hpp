@@ -8,7 +8,8 @@ namespace cors_preflight
 {
 inline void requestRoutes(App& app)
 {
-    BMCWEB_ROUTE(app, "<str>")
+    // Routes must start with '/', so match every url below the root
+    BMCWEB_ROUTE(app, "/<path>")
         .methods(boost::beast::http::verb::options)(
             [](const crow::Request&, const std::shared_ptr<bmcweb::AsyncResp>&,
                const std::string&) {
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "logging.hpp"
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#include <boost/container/flat_map.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace crow
+{
+namespace authorization
+{
+
+// How long a successful verification is reused for before PAM is asked again
+constexpr std::chrono::seconds credentialCacheTtl{30};
+
+constexpr size_t credentialCacheMaxEntries = 32;
+
+// PBKDF2 rounds for stored passwords.  Enough to make a dumped entry costly
+// to brute force, while staying well below the cost of a PAM conversation.
+constexpr int credentialHashIterations = 1000;
+
+/**
+ * CredentialCache
+ * Remembers recent successful Basic auth logins, so that clients sending
+ * the same credentials on every request don't each go through PAM.  Only a
+ * salted PBKDF2 hash of the password is kept, and a password that doesn't
+ * match is always passed on to PAM, so failed logins are still counted by
+ * PAM modules like pam_faillock.
+ */
+class CredentialCache
+{
+  public:
+    static CredentialCache& getInstance()
+    {
+        static CredentialCache cache;
+        return cache;
+    }
+
+    // Returns true if password matches a verification of username made
+    // within the TTL.  isConfigureSelfOnly is set to what PAM returned then.
+    bool verify(std::string_view username, std::string_view password,
+                std::chrono::steady_clock::time_point now,
+                bool& isConfigureSelfOnly) const
+    {
+        auto it = entries.find(username);
+        if (it == entries.end() || now - it->second.verified >= ttl)
+        {
+            return false;
+        }
+        const Entry& entry = it->second;
+        Hash hash{};
+        if (!hashPassword(password, entry.salt, hash))
+        {
+            return false;
+        }
+        if (CRYPTO_memcmp(hash.data(), entry.hash.data(), hash.size()) != 0)
+        {
+            return false;
+        }
+        isConfigureSelfOnly = entry.isConfigureSelfOnly;
+        return true;
+    }
+
+    // Records a login PAM accepted
+    void insert(const std::string& username, std::string_view password,
+                std::chrono::steady_clock::time_point now,
+                bool isConfigureSelfOnly)
+    {
+        Entry entry;
+        entry.verified = now;
+        entry.isConfigureSelfOnly = isConfigureSelfOnly;
+        if (RAND_bytes(entry.salt.data(),
+                       static_cast<int>(entry.salt.size())) != 1 ||
+            !hashPassword(password, entry.salt, entry.hash))
+        {
+            BMCWEB_LOG_ERROR << "Failed to hash credentials for caching";
+            return;
+        }
+        if (entries.size() >= maxEntries &&
+            entries.find(username) == entries.end())
+        {
+            evict(now);
+        }
+        entries.insert_or_assign(username, entry);
+    }
+
+    void erase(std::string_view username)
+    {
+        auto it = entries.find(username);
+        if (it != entries.end())
+        {
+            entries.erase(it);
+        }
+    }
+
+    void clear()
+    {
+        entries.clear();
+    }
+
+    CredentialCache(std::chrono::seconds ttlIn, size_t maxEntriesIn) :
+        ttl(ttlIn), maxEntries(maxEntriesIn)
+    {}
+
+    CredentialCache(const CredentialCache&) = delete;
+    CredentialCache(CredentialCache&&) = delete;
+    CredentialCache& operator=(const CredentialCache&) = delete;
+    CredentialCache& operator=(CredentialCache&&) = delete;
+    ~CredentialCache() = default;
+
+  private:
+    CredentialCache() :
+        CredentialCache(credentialCacheTtl, credentialCacheMaxEntries)
+    {}
+
+    using Salt = std::array<unsigned char, 16>;
+    using Hash = std::array<unsigned char, 32>;
+
+    struct Entry
+    {
+        Salt salt{};
+        Hash hash{};
+        std::chrono::steady_clock::time_point verified;
+        bool isConfigureSelfOnly = false;
+    };
+
+    static bool hashPassword(std::string_view password, const Salt& salt,
+                             Hash& hash)
+    {
+        return PKCS5_PBKDF2_HMAC(password.data(),
+                                 static_cast<int>(password.size()),
+                                 salt.data(), static_cast<int>(salt.size()),
+                                 credentialHashIterations, EVP_sha256(),
+                                 static_cast<int>(hash.size()),
+                                 hash.data()) == 1;
+    }
+
+    void evict(std::chrono::steady_clock::time_point now)
+    {
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (now - it->second.verified >= ttl)
+            {
+                it = entries.erase(it);
+                continue;
+            }
+            it++;
+        }
+        if (entries.size() < maxEntries)
+        {
+            return;
+        }
+        auto oldest = std::min_element(
+            entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+                return a.second.verified < b.second.verified;
+            });
+        entries.erase(oldest);
+    }
+
+    std::chrono::seconds ttl;
+    size_t maxEntries;
+    boost::container::flat_map<std::string, Entry, std::less<>> entries;
+};
+
+} // namespace authorization
+} // namespace crow
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <boost/system/error_code.hpp>
+#include <dbus_singleton.hpp>
+#include <stats.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace crow
+{
+namespace single_flight
+{
+
+namespace details
+{
+
+// Strings are length prefixed and ranges bracketed, so that no two
+// different argument lists make the same key
+inline void appendKey(std::string& key, std::string_view value)
+{
+    key += std::to_string(value.size());
+    key += ':';
+    key += value;
+}
+
+template <typename T>
+requires std::is_arithmetic_v<T>
+inline void appendKey(std::string& key, T value)
+{
+    appendKey(key, std::to_string(value));
+}
+
+template <typename Range>
+requires(std::ranges::range<Range> &&
+         !std::is_convertible_v<const Range&, std::string_view>)
+inline void appendKey(std::string& key, const Range& values)
+{
+    key += '[';
+    for (const auto& value : values)
+    {
+        appendKey(key, value);
+    }
+    key += ']';
+}
+
+template <typename Reply>
+class Waiter
+{
+  public:
+    Waiter() = default;
+    virtual ~Waiter() = default;
+    Waiter(const Waiter&) = delete;
+    Waiter(Waiter&&) = delete;
+    Waiter& operator=(const Waiter&) = delete;
+    Waiter& operator=(Waiter&&) = delete;
+
+    virtual void operator()(const boost::system::error_code& ec,
+                            const Reply& reply) = 0;
+};
+
+// Holds a callback that may only be moved, which std::function can't
+template <typename Reply, typename Callback>
+class CallbackWaiter : public Waiter<Reply>
+{
+  public:
+    explicit CallbackWaiter(Callback&& callbackIn) :
+        callback(std::move(callbackIn))
+    {}
+
+    void operator()(const boost::system::error_code& ec,
+                    const Reply& reply) override
+    {
+        callback(ec, reply);
+    }
+
+  private:
+    Callback callback;
+};
+
+} // namespace details
+
+template <typename Reply>
+using Waiters = std::vector<std::unique_ptr<details::Waiter<Reply>>>;
+
+// The calls waiting on a reply, by key.  A map per reply type, as callers
+// that decode the same call differently can't share a reply.
+template <typename Reply>
+inline std::map<std::string, Waiters<Reply>, std::less<>>& inFlight()
+{
+    static std::map<std::string, Waiters<Reply>, std::less<>> calls;
+    return calls;
+}
+
+template <typename... Args>
+inline std::string makeKey(const std::string& service, const std::string& path,
+                           const std::string& interface,
+                           const std::string& method, const Args&... args)
+{
+    std::string key;
+    details::appendKey(key, service);
+    details::appendKey(key, path);
+    details::appendKey(key, interface);
+    details::appendKey(key, method);
+    (details::appendKey(key, args), ...);
+    return key;
+}
+
+// Adds a caller to those waiting on the call with key.  Returns whether it
+// is the first, in which case the caller makes the call.
+template <typename Reply, typename Callback>
+inline bool wait(const std::string& key, Callback&& callback)
+{
+    auto [it, first] = inFlight<Reply>().try_emplace(key);
+    it->second.emplace_back(
+        std::make_unique<
+            details::CallbackWaiter<Reply, std::decay_t<Callback>>>(
+            std::decay_t<Callback>(std::forward<Callback>(callback))));
+    return first;
+}
+
+// Hands a reply to every caller waiting on it.  The callers are taken out
+// first, so that any of them can make the same call again.
+template <typename Reply>
+inline void finish(const std::string& key, const boost::system::error_code& ec,
+                   const Reply& reply)
+{
+    auto it = inFlight<Reply>().find(key);
+    if (it == inFlight<Reply>().end())
+    {
+        return;
+    }
+    Waiters<Reply> waiters = std::move(it->second);
+    inFlight<Reply>().erase(it);
+    for (const std::unique_ptr<details::Waiter<Reply>>& waiter : waiters)
+    {
+        (*waiter)(ec, reply);
+    }
+}
+
+/**
+ * async_method_call, for calls that only read.  While a call with the same
+ * service, path, interface, method and arguments is waiting on its reply,
+ * another one isn't made: callback is called with the same decoded reply
+ * instead.  Reply is the type the reply is decoded to, and callback gets it
+ * as a const reference, as it may be shared.
+ */
+template <typename Reply, typename Callback, typename... Args>
+inline void asyncMethodCall(Callback&& callback, const std::string& service,
+                            const std::string& path,
+                            const std::string& interface,
+                            const std::string& method, const Args&... args)
+{
+    std::string key = makeKey(service, path, interface, method, args...);
+    if (!wait<Reply>(key, std::forward<Callback>(callback)))
+    {
+        bmcweb::stats::increment("single_flight.deduplicated");
+        return;
+    }
+    bmcweb::stats::increment("single_flight.calls");
+    crow::connections::systemBus->async_method_call(
+        [key](const boost::system::error_code ec, const Reply& reply) {
+            finish(key, ec, reply);
+        },
+        service, path, interface, method, args...);
+}
+
+} // namespace single_flight
+} // namespace crow
@@ -2,8 +2,10 @@
 
 #include <zlib.h>
 
+#include <array>
 #include <cstring>
 #include <string>
+#include <string_view>
 
 inline bool gzipInflate(const std::string& compressedBytes,
                         std::string& uncompressedBytes)
@@ -61,5 +63,84 @@ inline bool gzipInflate(const std::string& compressedBytes,
         }
     }
 
+    // The buffer is grown in steps, trim it to what was actually written
+    uncompressedBytes.resize(strm.total_out);
+
     return inflateEnd(&strm) == Z_OK;
-}
\ No newline at end of file
+}
+
+// Bodies smaller than this are sent uncompressed; below roughly one TCP
+// segment, compression costs CPU without saving a round trip
+constexpr size_t compressionThreshold = 1024;
+
+/**
+ * DeflateEncoder
+ * Incremental zlib compressor, used to apply a gzip or deflate content coding
+ * to a response body that may be produced a piece at a time.
+ */
+class DeflateEncoder
+{
+  public:
+    // gzip selects the gzip wrapper; otherwise the zlib wrapper is used, which
+    // is what HTTP calls the "deflate" content coding
+    DeflateEncoder(bool gzip, int level)
+    {
+        initialized = deflateInit2(&strm, level, Z_DEFLATED,
+                                   gzip ? 16 + MAX_WBITS : MAX_WBITS, 8,
+                                   Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    DeflateEncoder(const DeflateEncoder&) = delete;
+    DeflateEncoder(DeflateEncoder&&) = delete;
+    DeflateEncoder& operator=(const DeflateEncoder&) = delete;
+    DeflateEncoder& operator=(DeflateEncoder&&) = delete;
+
+    ~DeflateEncoder()
+    {
+        if (initialized)
+        {
+            deflateEnd(&strm);
+        }
+    }
+
+    // Compresses input and appends the result to output.  Each call is
+    // flushed, so a client can decode everything written so far; the last
+    // call should set finish to write the stream trailer.
+    bool write(std::string_view input, std::string& output, bool finish)
+    {
+        if (!initialized)
+        {
+            return false;
+        }
+        // zlib doesn't take const input buffers, but doesn't modify them
+        strm.next_in = reinterpret_cast<Bytef*>( // NOLINT
+            const_cast<char*>(input.data()));    // NOLINT
+        strm.avail_in = static_cast<uInt>(input.size());
+        int flush = finish ? Z_FINISH : Z_SYNC_FLUSH;
+        std::array<char, 4096> outBuffer{};
+        do
+        {
+            strm.next_out = reinterpret_cast<Bytef*>(outBuffer.data());
+            strm.avail_out = static_cast<uInt>(outBuffer.size());
+            if (deflate(&strm, flush) == Z_STREAM_ERROR)
+            {
+                return false;
+            }
+            output.append(outBuffer.data(),
+                          outBuffer.size() - strm.avail_out);
+        } while (strm.avail_out == 0);
+        return true;
+    }
+
+  private:
+    z_stream strm{};
+    bool initialized = false;
+};
+
+inline bool gzipDeflate(std::string_view uncompressedBytes,
+                        std::string& compressedBytes, int level)
+{
+    DeflateEncoder encoder(true, level);
+    compressedBytes.clear();
+    return encoder.write(uncompressedBytes, compressedBytes, true);
+}
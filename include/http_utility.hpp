@@ -1,7 +1,18 @@
 #pragma once
 #include "http_request.hpp"
+#include "http_response.hpp"
 
 #include <boost/algorithm/string.hpp>
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace http_helpers
 {
@@ -32,6 +43,200 @@ inline bool requestPrefersHtml(std::string_view header)
     return false;
 }
 
+// Encodings a JSON resource can be sent in
+enum class ResponseEncoding
+{
+    Html,
+    Json,
+    JsonCompact,
+    Cbor,
+    MsgPack,
+};
+
+inline std::string_view toString(ResponseEncoding encoding)
+{
+    switch (encoding)
+    {
+        case ResponseEncoding::Html:
+            return "html";
+        case ResponseEncoding::Json:
+            return "json";
+        case ResponseEncoding::JsonCompact:
+            return "compact";
+        case ResponseEncoding::Cbor:
+            return "cbor";
+        case ResponseEncoding::MsgPack:
+            return "msgpack";
+    }
+    return "json";
+}
+
+/**
+ * @brief Chooses how a JSON response is encoded
+ *
+ * @param[in] header        Value of the Accept header
+ * @param[in] formatParam   Value of the $format query parameter, if any.  This
+ *                          takes precedence over the Accept header, and is the
+ *                          only way to ask for compact JSON.
+ *
+ * @return The encoding to use.  Pretty printed JSON when nothing better is
+ *         requested, so existing clients see no change.
+ */
+inline ResponseEncoding getPreferredEncoding(std::string_view header,
+                                             std::string_view formatParam)
+{
+    if (formatParam == "compact")
+    {
+        return ResponseEncoding::JsonCompact;
+    }
+    if (formatParam == "cbor")
+    {
+        return ResponseEncoding::Cbor;
+    }
+    if (formatParam == "msgpack")
+    {
+        return ResponseEncoding::MsgPack;
+    }
+    if (formatParam == "json")
+    {
+        return ResponseEncoding::Json;
+    }
+    for (std::string& encoding : parseAccept(header))
+    {
+        // ignore any q-factor weighting (;q=)
+        std::size_t separator = encoding.find(";q=");
+        if (separator != std::string::npos)
+        {
+            encoding = encoding.substr(0, separator);
+        }
+        if (encoding == "text/html")
+        {
+            return ResponseEncoding::Html;
+        }
+        if (encoding == "application/json" || encoding == "*/*")
+        {
+            return ResponseEncoding::Json;
+        }
+        if (encoding == "application/cbor")
+        {
+            return ResponseEncoding::Cbor;
+        }
+        if (encoding == "application/msgpack" ||
+            encoding == "application/x-msgpack" ||
+            encoding == "application/vnd.msgpack")
+        {
+            return ResponseEncoding::MsgPack;
+        }
+    }
+    return ResponseEncoding::Json;
+}
+
+// Encoding for a JSON response to req, from its $format parameter and Accept
+// header
+inline ResponseEncoding getPreferredEncoding(const crow::Request& req)
+{
+    std::string formatParam;
+    boost::urls::query_params_view::iterator format =
+        req.urlParams.find("$format");
+    if (format != req.urlParams.end())
+    {
+        formatParam = format->value();
+    }
+    return getPreferredEncoding(req.getHeaderValue("Accept"), formatParam);
+}
+
+// Content codings a response body can be compressed with
+enum class ContentEncoding
+{
+    Identity,
+    Gzip,
+    Deflate,
+};
+
+/**
+ * @brief Chooses a content coding from an Accept-Encoding header
+ *
+ * @param[in] header    Value of the Accept-Encoding header
+ *
+ * @return The acceptable coding with the highest q-value, preferring the one
+ *         listed first on a tie, or Identity if neither gzip nor deflate is
+ *         acceptable
+ */
+inline ContentEncoding getPreferredContentEncoding(std::string_view header)
+{
+    ContentEncoding preferred = ContentEncoding::Identity;
+    double preferredQuality = 0.0;
+    std::vector<std::string> codings;
+    boost::split(codings, header, boost::is_any_of(","));
+    for (std::string& coding : codings)
+    {
+        double quality = 1.0;
+        std::size_t separator = coding.find(';');
+        if (separator != std::string::npos)
+        {
+            std::string params = coding.substr(separator + 1);
+            coding.resize(separator);
+            boost::trim(params);
+            if (boost::starts_with(params, "q="))
+            {
+                quality = std::strtod(params.c_str() + 2, nullptr);
+            }
+        }
+        boost::trim(coding);
+
+        ContentEncoding encoding = ContentEncoding::Identity;
+        if (boost::iequals(coding, "gzip") ||
+            boost::iequals(coding, "x-gzip") || coding == "*")
+        {
+            encoding = ContentEncoding::Gzip;
+        }
+        else if (boost::iequals(coding, "deflate"))
+        {
+            encoding = ContentEncoding::Deflate;
+        }
+        else
+        {
+            continue;
+        }
+        if (quality > preferredQuality)
+        {
+            preferred = encoding;
+            preferredQuality = quality;
+        }
+    }
+    return preferred;
+}
+
+/**
+ * @brief Checks whether responses for a URL may carry secrets
+ *
+ * Compressing a secret next to data the client influences leaks the secret
+ * through the compressed length (BREACH), so responses that hand out session
+ * tokens or certificate and key material are never compressed.
+ *
+ * @param[in] url   Path of the request
+ *
+ * @return True for login, session and certificate URLs
+ */
+inline bool urlMayCarrySecrets(std::string_view url)
+{
+    if (url == "/login" || url.starts_with("/login/") ||
+        url.starts_with("/redfish/v1/SessionService"))
+    {
+        return true;
+    }
+    std::vector<std::string> segments;
+    boost::split(segments, url, boost::is_any_of("/"));
+    for (const std::string& segment : segments)
+    {
+        if (segment == "Certificates" || segment == "CertificateService")
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 inline bool isOctetAccepted(std::string_view header)
 {
     for (std::string& encoding : parseAccept(header))
@@ -50,6 +255,307 @@ inline bool isOctetAccepted(std::string_view header)
     return false;
 }
 
+/**
+ * ETagHasher
+ * A 128 bit hash of content fed to it in pieces, for entity tags.  Tags only
+ * have to tell versions of a resource apart, so two FNV-1a style lanes with
+ * different multipliers are enough, and cheap enough to run on every GET.
+ */
+class ETagHasher
+{
+  public:
+    ETagHasher() = default;
+
+    // Continues from a digest() of earlier content
+    explicit ETagHasher(const std::array<uint64_t, 2>& stateIn) :
+        state(stateIn)
+    {}
+
+    void update(std::string_view data)
+    {
+        for (char c : data)
+        {
+            uint64_t byte = static_cast<unsigned char>(c);
+            state[0] = (state[0] ^ byte) * 0x100000001b3ULL;
+            state[1] = (state[1] ^ byte) * 0x9e3779b97f4a7c15ULL;
+            state[1] ^= state[1] >> 29;
+        }
+    }
+
+    void update(uint64_t value)
+    {
+        std::array<char, sizeof(value)> bytes{};
+        for (char& byte : bytes)
+        {
+            byte = static_cast<char>(value & 0xff);
+            value >>= 8;
+        }
+        update(std::string_view(bytes.data(), bytes.size()));
+    }
+
+    const std::array<uint64_t, 2>& digest() const
+    {
+        return state;
+    }
+
+    // The quoted tag
+    std::string finish() const
+    {
+        // Mix each lane into the other, so that every bit of the tag depends
+        // on every byte
+        std::array<uint64_t, 2> mixed = {mix(state[0] ^ rotate(state[1])),
+                                         mix(state[1] ^ rotate(state[0]))};
+        constexpr std::string_view hexDigits = "0123456789abcdef";
+        std::string etag = "\"";
+        for (uint64_t lane : mixed)
+        {
+            for (int shift = 60; shift >= 0; shift -= 4)
+            {
+                etag += hexDigits[(lane >> shift) & 0xf];
+            }
+        }
+        etag += '"';
+        return etag;
+    }
+
+  private:
+    static uint64_t rotate(uint64_t value)
+    {
+        return (value << 32) | (value >> 32);
+    }
+
+    // The 64 bit finalizer of MurmurHash3
+    static uint64_t mix(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return value;
+    }
+
+    std::array<uint64_t, 2> state = {0xcbf29ce484222325ULL,
+                                     0x6c62272e07bb0142ULL};
+};
+
+// Feeds a JSON document to hasher as it is held, without serializing it.
+// Every value is prefixed with its type, and containers and strings with
+// their size, so that different documents can't feed the same bytes.
+inline void hashJson(const nlohmann::json& value, ETagHasher& hasher)
+{
+    switch (value.type())
+    {
+        case nlohmann::json::value_t::null:
+            hasher.update("n");
+            break;
+        case nlohmann::json::value_t::boolean:
+            hasher.update(value.get<bool>() ? "t" : "f");
+            break;
+        case nlohmann::json::value_t::number_integer:
+            hasher.update("i");
+            hasher.update(static_cast<uint64_t>(value.get<int64_t>()));
+            break;
+        case nlohmann::json::value_t::number_unsigned:
+            hasher.update("u");
+            hasher.update(value.get<uint64_t>());
+            break;
+        case nlohmann::json::value_t::number_float:
+            hasher.update("d");
+            hasher.update(std::bit_cast<uint64_t>(value.get<double>()));
+            break;
+        case nlohmann::json::value_t::string:
+        {
+            const std::string& str = value.get_ref<const std::string&>();
+            hasher.update("s");
+            hasher.update(static_cast<uint64_t>(str.size()));
+            hasher.update(str);
+            break;
+        }
+        case nlohmann::json::value_t::binary:
+        {
+            const nlohmann::json::binary_t& binary = value.get_binary();
+            hasher.update("b");
+            hasher.update(static_cast<uint64_t>(binary.size()));
+            hasher.update(
+                std::string_view(reinterpret_cast<const char*>(binary.data()),
+                                 binary.size()));
+            break;
+        }
+        case nlohmann::json::value_t::array:
+            hasher.update("[");
+            hasher.update(static_cast<uint64_t>(value.size()));
+            for (const nlohmann::json& element : value)
+            {
+                hashJson(element, hasher);
+            }
+            break;
+        case nlohmann::json::value_t::object:
+            // Objects are kept sorted by key, so the order they were built
+            // in doesn't count
+            hasher.update("{");
+            hasher.update(static_cast<uint64_t>(value.size()));
+            for (const auto& [key, element] :
+                 value.get_ref<const nlohmann::json::object_t&>())
+            {
+                hasher.update(static_cast<uint64_t>(key.size()));
+                hasher.update(key);
+                hashJson(element, hasher);
+            }
+            break;
+        case nlohmann::json::value_t::discarded:
+            break;
+    }
+}
+
+// Entity tag for a body, from a hash of its bytes
+inline std::string getETag(std::string_view body)
+{
+    ETagHasher hasher;
+    hasher.update(body);
+    return hasher.finish();
+}
+
+// The hash of the document of res, from jsonDigest if it is already known.
+// Until the response is complete the document may still change, so only a
+// complete response keeps it.
+inline ETagHasher hashDocument(crow::Response& res)
+{
+    if (res.jsonDigest)
+    {
+        return ETagHasher(*res.jsonDigest);
+    }
+    ETagHasher hasher;
+    hashJson(res.jsonValue, hasher);
+    if (res.isCompleted())
+    {
+        res.jsonDigest = hasher.digest();
+    }
+    return hasher;
+}
+
+// The tag of a document in one encoding, from the hash of the document
+inline std::string getETag(ETagHasher document, ResponseEncoding encoding)
+{
+    const char encodingByte = static_cast<char>(encoding);
+    document.update(std::string_view(&encodingByte, 1));
+    return document.finish();
+}
+
+/**
+ * @brief Computes a strong entity tag for a response, before content coding
+ *
+ * JSON responses are tagged by a hash of the document as it is held, so
+ * nothing is serialized for it, and documents that are streamed out can be
+ * tagged before they are written.  The encoding is mixed in last, as each
+ * one is a separate representation.  Anything else is tagged by a hash of
+ * the body.
+ *
+ * @return The quoted entity tag
+ */
+inline std::string getETag(crow::Response& res, ResponseEncoding encoding)
+{
+    if (res.jsonValue.empty())
+    {
+        return getETag(res.payload());
+    }
+    return getETag(hashDocument(res), encoding);
+}
+
+/**
+ * @brief Checks an If-Match or If-None-Match header against an entity tag
+ *
+ * @param[in] header    Value of the header, "*" or a list of entity tags
+ * @param[in] etag      Quoted entity tag of the current representation
+ * @param[in] weak      Whether weak comparison is used, as for
+ *                      If-None-Match.  Weak (W/) tags never match otherwise.
+ *
+ * A -gzip or -deflate suffix, as added to the tags of compressed responses,
+ * is ignored on both sides, since every coding has the same content.
+ *
+ * @return True if any tag in the list matches
+ */
+inline bool etagMatches(std::string_view header, std::string_view etag,
+                        bool weak)
+{
+    auto stripCoding = [](std::string_view tag) {
+        for (std::string_view suffix : {"-gzip\"", "-deflate\""})
+        {
+            if (tag.size() > suffix.size() && tag.ends_with(suffix))
+            {
+                return std::string(tag.substr(0, tag.size() - suffix.size())) +
+                       '"';
+            }
+        }
+        return std::string(tag);
+    };
+    std::string current = stripCoding(etag);
+
+    std::vector<std::string> tags;
+    boost::split(tags, header, boost::is_any_of(","));
+    for (std::string& tag : tags)
+    {
+        boost::trim(tag);
+        if (tag == "*")
+        {
+            return true;
+        }
+        std::string_view candidate = tag;
+        if (candidate.starts_with("W/"))
+        {
+            if (!weak)
+            {
+                continue;
+            }
+            candidate.remove_prefix(2);
+        }
+        if (stripCoding(candidate) == current)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Checks an If-Match header against the current state of a resource
+ *
+ * A client may send back a tag it got with any Accept header or content
+ * coding, while the tag of a JSON document depends on the encoding, so every
+ * encoding is tried.  A tag the handler set itself stands for all of them.
+ *
+ * @param[in] header    Value of the If-Match header
+ * @param[in] res       A completed GET response for the resource
+ *
+ * @return True if any tag in the list matches a representation
+ */
+inline bool ifMatchMatches(std::string_view header, crow::Response& res)
+{
+    std::string etag(
+        res.stringResponse->operator[](boost::beast::http::field::etag));
+    if (!etag.empty())
+    {
+        return etagMatches(header, etag, false);
+    }
+    if (res.jsonValue.empty())
+    {
+        return etagMatches(header, getETag(res.payload()), false);
+    }
+    // The document is hashed once for all of them
+    ETagHasher document = hashDocument(res);
+    for (ResponseEncoding encoding :
+         {ResponseEncoding::Json, ResponseEncoding::JsonCompact,
+          ResponseEncoding::Cbor, ResponseEncoding::MsgPack,
+          ResponseEncoding::Html})
+    {
+        if (etagMatches(header, getETag(document, encoding), false))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 inline std::string urlEncode(const std::string_view value)
 {
     std::ostringstream escaped;
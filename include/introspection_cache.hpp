@@ -0,0 +1,308 @@
+#pragma once
+
+#include "logging.hpp"
+
+#include <dbus_singleton.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+#include <stats.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace crow
+{
+namespace introspection
+{
+
+// Introspection data is small, but the REST API can walk every object on
+// the bus.  The cache starts over when it grows past this.
+constexpr size_t maxIntrospectionEntries = 2048;
+
+// Objects outside any ObjectManager send no InterfacesAdded or
+// InterfacesRemoved, so nothing says when they change.  They are only
+// cached for this long.
+constexpr std::chrono::seconds unsignalledIntrospectionMaxAge{10};
+
+constexpr const char* objectManagerInterface =
+    "org.freedesktop.DBus.ObjectManager";
+
+// The attributes of an <arg>, each of which may be left out
+struct Argument
+{
+    std::optional<std::string> name;
+    std::optional<std::string> direction;
+    std::optional<std::string> type;
+};
+
+struct Member
+{
+    std::string name;
+    std::vector<Argument> args;
+};
+
+struct Property
+{
+    std::string name;
+    // Empty if the introspection data left it out
+    std::string type;
+};
+
+struct Interface
+{
+    std::string name;
+    std::vector<Member> methods;
+    std::vector<Member> signals;
+    std::vector<Property> properties;
+};
+
+/**
+ * Node
+ * What Introspect returns for an object, as tables of signatures.  Elements
+ * without a name are left out.
+ */
+struct Node
+{
+    std::vector<Interface> interfaces;
+    std::vector<std::string> children;
+
+    const Interface* findInterface(const std::string& name) const
+    {
+        for (const Interface& interface : interfaces)
+        {
+            if (interface.name == name)
+            {
+                return &interface;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * IntrospectionCache
+ * Introspection data by service and object path.  An entry is dropped when
+ * its service changes owner, or when interfaces are added to or removed
+ * from its object or any object below it, as the children change too.
+ * Objects of a service that aren't below one of its ObjectManagers, as far
+ * as the cache has seen, expire after unsignalledIntrospectionMaxAge.
+ */
+class IntrospectionCache
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static IntrospectionCache& getInstance()
+    {
+        static IntrospectionCache cache;
+        return cache;
+    }
+
+    std::shared_ptr<const Node> find(const std::string& service,
+                                     const std::string& path,
+                                     Clock::time_point now) const
+    {
+        auto it = entries.find({path, service});
+        if (it == entries.end())
+        {
+            return nullptr;
+        }
+        if (it->second.expires && now >= *it->second.expires)
+        {
+            return nullptr;
+        }
+        return it->second.node;
+    }
+
+    // Incremented whenever entries are dropped.  Read before introspecting
+    // and pass to store().
+    uint64_t getEpoch() const
+    {
+        return epoch;
+    }
+
+    // Stores a node, unless entries were dropped after it was requested, as
+    // it may then predate the change
+    bool store(const std::string& service, const std::string& path,
+               std::shared_ptr<const Node> node, uint64_t fetchEpoch,
+               Clock::time_point now)
+    {
+        if (fetchEpoch != epoch)
+        {
+            return false;
+        }
+        if (entries.size() >= maxIntrospectionEntries)
+        {
+            entries.clear();
+            servicePaths.clear();
+        }
+        if (node->findInterface(objectManagerInterface) != nullptr)
+        {
+            objectManagers.emplace(service, path);
+        }
+        servicePaths.emplace(service, path);
+        Entry& entry = entries[{path, service}];
+        entry.expires.reset();
+        if (!isManaged(service, path))
+        {
+            entry.expires = now + unsignalledIntrospectionMaxAge;
+        }
+        entry.node = std::move(node);
+        return true;
+    }
+
+    void removeService(const std::string& service)
+    {
+        auto it = servicePaths.lower_bound({service, std::string()});
+        while (it != servicePaths.end() && it->first == service)
+        {
+            entries.erase({it->second, service});
+            it = servicePaths.erase(it);
+        }
+        auto managerIt = objectManagers.lower_bound({service, std::string()});
+        while (managerIt != objectManagers.end() &&
+               managerIt->first == service)
+        {
+            managerIt = objectManagers.erase(managerIt);
+        }
+        epoch++;
+    }
+
+    // Drops the object and every object above it, from every service
+    void removeObject(const std::string& path)
+    {
+        std::string_view object = path;
+        while (true)
+        {
+            removeEntries(object);
+            size_t slash = object.rfind('/');
+            if (object == "/" || slash == std::string_view::npos)
+            {
+                break;
+            }
+            object = slash == 0 ? "/" : object.substr(0, slash);
+        }
+        epoch++;
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    IntrospectionCache() = default;
+    ~IntrospectionCache() = default;
+    IntrospectionCache(const IntrospectionCache&) = delete;
+    IntrospectionCache& operator=(const IntrospectionCache&) = delete;
+    IntrospectionCache(IntrospectionCache&&) = delete;
+    IntrospectionCache& operator=(IntrospectionCache&&) = delete;
+
+  private:
+    struct Entry
+    {
+        std::shared_ptr<const Node> node;
+        // Unset for objects whose changes are signalled
+        std::optional<Clock::time_point> expires;
+    };
+
+    // Drops the entries of every service for one object
+    void removeEntries(std::string_view path)
+    {
+        auto it = entries.lower_bound({std::string(path), std::string()});
+        while (it != entries.end() && it->first.first == path)
+        {
+            servicePaths.erase({it->first.second, it->first.first});
+            it = entries.erase(it);
+        }
+    }
+
+    // Whether the service has an ObjectManager at path or above it
+    bool isManaged(const std::string& service, const std::string& path) const
+    {
+        auto it = objectManagers.upper_bound({service, path});
+        while (it != objectManagers.begin())
+        {
+            it--;
+            if (it->first != service)
+            {
+                return false;
+            }
+            const std::string& managerPath = it->second;
+            if (managerPath == path || managerPath == "/" ||
+                (path.starts_with(managerPath) &&
+                 path[managerPath.size()] == '/'))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // By path, then service, so that an object's entries are one range
+    std::map<std::pair<std::string, std::string>, Entry> entries;
+    // The paths cached for each service
+    std::set<std::pair<std::string, std::string>> servicePaths;
+    // The ObjectManagers seen, by service and path
+    std::set<std::pair<std::string, std::string>> objectManagers;
+    uint64_t epoch = 0;
+};
+
+static std::unique_ptr<sdbusplus::bus::match::match> interfacesAddedMonitor;
+static std::unique_ptr<sdbusplus::bus::match::match> interfacesRemovedMonitor;
+static std::unique_ptr<sdbusplus::bus::match::match> nameOwnerMonitor;
+
+inline void onInterfacesChanged(sdbusplus::message::message& message)
+{
+    sdbusplus::message::object_path path;
+    message.read(path);
+    IntrospectionCache::getInstance().removeObject(path.str);
+}
+
+inline void onNameOwnerChanged(sdbusplus::message::message& message)
+{
+    std::string name;
+    std::string oldOwner;
+    std::string newOwner;
+    message.read(name, oldOwner, newOwner);
+    if (name.starts_with(':') && oldOwner.empty())
+    {
+        // A new connection, which nothing was introspected from yet
+        return;
+    }
+    // A service that lost or gained its name may be a different process,
+    // with different objects, whether or not it has an ObjectManager
+    IntrospectionCache::getInstance().removeService(name);
+}
+
+inline void registerIntrospectionSignals()
+{
+    BMCWEB_LOG_INFO << "Register introspection cache signals";
+    sdbusplus::bus::bus& bus =
+        static_cast<sdbusplus::bus::bus&>(*crow::connections::systemBus);
+    interfacesAddedMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+        "member='InterfacesAdded'",
+        onInterfacesChanged);
+    interfacesRemovedMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+        "member='InterfacesRemoved'",
+        onInterfacesChanged);
+    nameOwnerMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',sender='org.freedesktop.DBus',"
+        "interface='org.freedesktop.DBus',member='NameOwnerChanged'",
+        onNameOwnerChanged);
+}
+
+} // namespace introspection
+} // namespace crow
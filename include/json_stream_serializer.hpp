@@ -0,0 +1,134 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+#include <vector>
+
+namespace json_stream_util
+{
+
+/**
+ * JsonStreamSerializer
+ * Walks a nlohmann::json DOM incrementally, producing the same text as
+ * nlohmann::json::dump(indent, ' ', true, error_handler_t::replace), but a
+ * bounded piece at a time, so that large documents never need to exist as a
+ * single string in memory.
+ *
+ * The serializer holds a reference to the DOM; the caller must keep the DOM
+ * alive and unmodified until the serializer reports completion.
+ */
+class JsonStreamSerializer
+{
+  public:
+    JsonStreamSerializer(const nlohmann::json& rootIn, int indentIn) :
+        root(rootIn), indent(indentIn)
+    {}
+
+    JsonStreamSerializer(const JsonStreamSerializer&) = delete;
+    JsonStreamSerializer(JsonStreamSerializer&&) = delete;
+    JsonStreamSerializer& operator=(const JsonStreamSerializer&) = delete;
+    JsonStreamSerializer& operator=(JsonStreamSerializer&&) = delete;
+    ~JsonStreamSerializer() = default;
+
+    // Appends serialized text to out until out is at least chunkSize bytes
+    // long or the document is complete.  A single scalar is never split, so
+    // out may exceed chunkSize by the length of one value.  Returns true once
+    // the whole document has been written.
+    bool fill(std::string& out, size_t chunkSize)
+    {
+        if (!started)
+        {
+            started = true;
+            writeValue(out, root);
+        }
+        while (!stack.empty() && out.size() < chunkSize)
+        {
+            Frame& frame = stack.back();
+            if (frame.it == frame.node->cend())
+            {
+                if (!frame.first)
+                {
+                    newline(out, stack.size() - 1);
+                }
+                out += frame.node->is_object() ? '}' : ']';
+                stack.pop_back();
+                continue;
+            }
+            if (!frame.first)
+            {
+                out += ',';
+            }
+            frame.first = false;
+            newline(out, stack.size());
+            if (frame.node->is_object())
+            {
+                writeScalar(out, nlohmann::json(frame.it.key()));
+                out += ':';
+                if (indent >= 0)
+                {
+                    out += ' ';
+                }
+            }
+            const nlohmann::json& child = frame.it.value();
+            // Advance before writeValue, as pushing a new frame invalidates
+            // the frame reference
+            ++frame.it;
+            writeValue(out, child);
+        }
+        return done();
+    }
+
+    bool done() const
+    {
+        return started && stack.empty();
+    }
+
+  private:
+    struct Frame
+    {
+        const nlohmann::json* node;
+        nlohmann::json::const_iterator it;
+        bool first;
+    };
+
+    void newline(std::string& out, size_t depth) const
+    {
+        if (indent < 0)
+        {
+            return;
+        }
+        out += '\n';
+        out.append(depth * static_cast<size_t>(indent), ' ');
+    }
+
+    static void writeScalar(std::string& out, const nlohmann::json& value)
+    {
+        out += value.dump(-1, ' ', true,
+                          nlohmann::json::error_handler_t::replace);
+    }
+
+    void writeValue(std::string& out, const nlohmann::json& value)
+    {
+        if (value.is_object())
+        {
+            out += '{';
+            stack.push_back({&value, value.cbegin(), true});
+            return;
+        }
+        if (value.is_array())
+        {
+            out += '[';
+            stack.push_back({&value, value.cbegin(), true});
+            return;
+        }
+        writeScalar(out, value);
+    }
+
+    const nlohmann::json& root;
+    int indent;
+    bool started = false;
+    std::vector<Frame> stack;
+};
+
+} // namespace json_stream_util
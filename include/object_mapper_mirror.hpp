@@ -0,0 +1,1122 @@
+#pragma once
+
+#include "logging.hpp"
+
+#include <bmcweb_config.h>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+#include <boost/system/error_code.hpp>
+#include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/exception.hpp>
+#include <sdbusplus/message.hpp>
+#include <stats.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace crow
+{
+namespace object_mapper
+{
+
+using dbus::utility::MapperGetObject;
+using dbus::utility::MapperGetSubTreeResponse;
+
+// Services that come or go are introspected by the mapper some time later.
+// The mirror is reseeded after this long, which also lets a burst of
+// services, such as at startup, cost a single reseed.
+constexpr std::chrono::seconds mapperMirrorReseedDelay{5};
+
+// Signals that can't be applied directly, such as from a connection without
+// a well-known name, are refreshed from the mapper after this long, so that
+// a burst of them costs a single GetSubTree
+constexpr std::chrono::milliseconds mapperMirrorRefreshDelay{500};
+
+/**
+ * MapperMirror
+ * A copy of what the ObjectMapper knows about the bus, so that GetSubTree,
+ * GetSubTreePaths and GetObject can be answered without a D-Bus round trip.
+ * Objects are kept ordered by path, so that a subtree is one contiguous
+ * range, and are indexed by interface, so that a search for a few
+ * interfaces only visits the objects that implement them.  Results match
+ * what the mapper itself returns for the same contents.
+ */
+class MapperMirror
+{
+  public:
+    static MapperMirror& getInstance()
+    {
+        static MapperMirror mirror;
+        return mirror;
+    }
+
+    // Whether queries can be answered from the mirror.  It can't be until it
+    // is first seeded, or while it may have fallen behind the mapper.
+    bool isReady() const
+    {
+        return ready;
+    }
+
+    // Incremented on every change
+    uint64_t getGeneration() const
+    {
+        return generation;
+    }
+
+    // Called before requesting a seed.  Changes from then on are kept until
+    // the seed arrives, to be applied on top of it.  Pass the result to
+    // seed(), or to abandonSeed() if the request failed.
+    uint64_t beginSeed()
+    {
+        seedsInFlight++;
+        return generation;
+    }
+
+    // Replaces the contents with the mapper's GetSubTree of "/", then
+    // applies the changes made since the seed was requested, as the seed
+    // may be older than they are.  A seed requested before the last
+    // invalidate() is refused.  Returns whether the seed was taken.
+    bool seed(const MapperGetSubTreeResponse& subtree, uint64_t seedGeneration)
+    {
+        endSeed();
+        if (seedGeneration < invalidatedGeneration)
+        {
+            dropChanges();
+            return false;
+        }
+        objects.clear();
+        interfaceIndex.clear();
+        for (const auto& [path, services] : subtree)
+        {
+            storeObject(path, services);
+        }
+        for (const Change& pending : changes)
+        {
+            if (pending.generation > seedGeneration)
+            {
+                apply(pending);
+            }
+        }
+        dropChanges();
+        ready = true;
+        return true;
+    }
+
+    void abandonSeed()
+    {
+        endSeed();
+        dropChanges();
+    }
+
+    // Stops answering queries until a seed requested after this arrives
+    void invalidate()
+    {
+        generation++;
+        invalidatedGeneration = generation;
+        ready = false;
+    }
+
+    // What an InterfacesAdded signal from service announced
+    void addInterfaces(const std::string& path, const std::string& service,
+                       const std::vector<std::string>& interfaces)
+    {
+        change({0, Change::Kind::addInterfaces, path, service, interfaces, {}});
+    }
+
+    // What an InterfacesRemoved signal from service announced
+    void removeInterfaces(const std::string& path, const std::string& service,
+                          const std::vector<std::string>& interfaces)
+    {
+        change(
+            {0, Change::Kind::removeInterfaces, path, service, interfaces, {}});
+    }
+
+    // Replaces everything below subtree with the mapper's GetSubTree of it
+    void setSubTree(const std::string& subtree,
+                    const MapperGetSubTreeResponse& below)
+    {
+        change({0, Change::Kind::setSubTree, subtree, {}, {}, below});
+    }
+
+    // Removes everything a service that left the bus provided
+    void removeService(std::string_view service)
+    {
+        change({0, Change::Kind::removeService, {}, std::string(service), {},
+                {}});
+    }
+
+    // The objects below subtree, at most depth levels down (any depth for 0
+    // or less), with the services implementing any of interfaces, or all
+    // services if interfaces is empty.  Returns false if subtree is unknown.
+    bool getSubTree(std::string_view subtree, int32_t depth,
+                    const std::vector<std::string>& interfaces,
+                    MapperGetSubTreeResponse& result) const
+    {
+        return forEachInSubTree(
+            subtree, depth, interfaces,
+            [&interfaces, &result](const std::string& path,
+                                   const ServiceMap& services) {
+                MapperGetObject matched = matchServices(services, interfaces);
+                if (!matched.empty())
+                {
+                    result.emplace_back(path, std::move(matched));
+                }
+            });
+    }
+
+    // As getSubTree(), with only the paths
+    bool getSubTreePaths(std::string_view subtree, int32_t depth,
+                         const std::vector<std::string>& interfaces,
+                         std::vector<std::string>& result) const
+    {
+        return forEachInSubTree(
+            subtree, depth, interfaces,
+            [&interfaces, &result](const std::string& path,
+                                   const ServiceMap& services) {
+                if (!matchServices(services, interfaces).empty())
+                {
+                    result.push_back(path);
+                }
+            });
+    }
+
+    // How many objects service has below subtree, which is what a
+    // GetManagedObjects on an ObjectManager there returns
+    size_t countObjects(std::string_view subtree,
+                        const std::string& service) const
+    {
+        size_t count = 0;
+        forEachInSubTree(subtree, 0, {},
+                         [&service, &count](const std::string& /*path*/,
+                                            const ServiceMap& services) {
+                             if (services.find(service) != services.end())
+                             {
+                                 count++;
+                             }
+                         });
+        return count;
+    }
+
+    // The services implementing any of interfaces on path, or all of them
+    // if interfaces is empty.  Returns false if there are none.
+    bool getObject(std::string_view path,
+                   const std::vector<std::string>& interfaces,
+                   MapperGetObject& result) const
+    {
+        if (path.size() > 1 && path.ends_with('/'))
+        {
+            path.remove_suffix(1);
+        }
+        auto it = objects.find(path);
+        if (it == objects.end())
+        {
+            return false;
+        }
+        result = matchServices(it->second, interfaces);
+        return !result.empty();
+    }
+
+    size_t size() const
+    {
+        return objects.size();
+    }
+
+    MapperMirror() = default;
+    MapperMirror(const MapperMirror&) = delete;
+    MapperMirror(MapperMirror&&) = delete;
+    MapperMirror& operator=(const MapperMirror&) = delete;
+    MapperMirror& operator=(MapperMirror&&) = delete;
+    ~MapperMirror() = default;
+
+  private:
+    using InterfaceSet = boost::container::flat_set<std::string, std::less<>>;
+    using ServiceMap =
+        boost::container::flat_map<std::string, InterfaceSet, std::less<>>;
+
+    // A change to the contents, kept while a seed is in flight
+    struct Change
+    {
+        enum class Kind
+        {
+            addInterfaces,
+            removeInterfaces,
+            setSubTree,
+            removeService,
+        };
+
+        uint64_t generation;
+        Kind kind;
+        std::string path;
+        std::string service;
+        std::vector<std::string> interfaces;
+        MapperGetSubTreeResponse subtree;
+    };
+
+    void change(Change&& next)
+    {
+        generation++;
+        next.generation = generation;
+        apply(next);
+        if (seedsInFlight > 0)
+        {
+            changes.push_back(std::move(next));
+        }
+    }
+
+    void apply(const Change& next)
+    {
+        switch (next.kind)
+        {
+            case Change::Kind::addInterfaces:
+                storeInterfaces(next.path, next.service, next.interfaces);
+                break;
+            case Change::Kind::removeInterfaces:
+                dropInterfaces(next.path, next.service, next.interfaces);
+                break;
+            case Change::Kind::setSubTree:
+                storeSubTree(next.path, next.subtree);
+                break;
+            case Change::Kind::removeService:
+                dropService(next.service);
+                break;
+        }
+    }
+
+    void endSeed()
+    {
+        if (seedsInFlight > 0)
+        {
+            seedsInFlight--;
+        }
+    }
+
+    // Once no seed is in flight, there is nothing to apply changes to
+    void dropChanges()
+    {
+        if (seedsInFlight == 0)
+        {
+            changes.clear();
+        }
+    }
+
+    void storeObject(const std::string& path, const MapperGetObject& services)
+    {
+        eraseObject(path);
+        if (services.empty())
+        {
+            return;
+        }
+        ServiceMap& entry = objects[path];
+        for (const auto& [service, interfaces] : services)
+        {
+            InterfaceSet& known = entry[service];
+            known.insert(interfaces.begin(), interfaces.end());
+            for (const std::string& interface : interfaces)
+            {
+                interfaceIndex[interface].insert(path);
+            }
+        }
+    }
+
+    void storeInterfaces(const std::string& path, const std::string& service,
+                         const std::vector<std::string>& interfaces)
+    {
+        if (interfaces.empty())
+        {
+            return;
+        }
+        InterfaceSet& known = objects[path][service];
+        known.insert(interfaces.begin(), interfaces.end());
+        for (const std::string& interface : interfaces)
+        {
+            interfaceIndex[interface].insert(path);
+        }
+    }
+
+    void dropInterfaces(const std::string& path, const std::string& service,
+                        const std::vector<std::string>& interfaces)
+    {
+        auto it = objects.find(path);
+        if (it == objects.end())
+        {
+            return;
+        }
+        auto found = it->second.find(service);
+        if (found == it->second.end())
+        {
+            return;
+        }
+        for (const std::string& interface : interfaces)
+        {
+            found->second.erase(interface);
+        }
+        if (found->second.empty())
+        {
+            it->second.erase(found);
+        }
+        for (const std::string& interface : interfaces)
+        {
+            if (!implements(it->second, interface))
+            {
+                unindex(interface, path);
+            }
+        }
+        if (it->second.empty())
+        {
+            objects.erase(it);
+        }
+    }
+
+    void storeSubTree(const std::string& subtree,
+                      const MapperGetSubTreeResponse& below)
+    {
+        std::string prefix = subtree;
+        if (!prefix.ends_with('/'))
+        {
+            prefix += '/';
+        }
+        auto it = objects.lower_bound(prefix);
+        while (it != objects.end() && it->first.starts_with(prefix))
+        {
+            std::string path = it->first;
+            it++;
+            eraseObject(path);
+        }
+        for (const auto& [path, services] : below)
+        {
+            if (path.starts_with(prefix))
+            {
+                storeObject(path, services);
+            }
+        }
+    }
+
+    void dropService(std::string_view service)
+    {
+        for (auto it = objects.begin(); it != objects.end();)
+        {
+            auto found = it->second.find(service);
+            if (found == it->second.end())
+            {
+                it++;
+                continue;
+            }
+            InterfaceSet interfaces = std::move(found->second);
+            it->second.erase(found);
+            for (const std::string& interface : interfaces)
+            {
+                if (!implements(it->second, interface))
+                {
+                    unindex(interface, it->first);
+                }
+            }
+            if (it->second.empty())
+            {
+                it = objects.erase(it);
+                continue;
+            }
+            it++;
+        }
+    }
+
+    static bool implements(const ServiceMap& services,
+                           std::string_view interface)
+    {
+        return std::any_of(services.begin(), services.end(),
+                           [interface](const auto& service) {
+                               return service.second.find(interface) !=
+                                      service.second.end();
+                           });
+    }
+
+    void unindex(const std::string& interface, const std::string& path)
+    {
+        auto indexed = interfaceIndex.find(interface);
+        if (indexed == interfaceIndex.end())
+        {
+            return;
+        }
+        indexed->second.erase(path);
+        if (indexed->second.empty())
+        {
+            interfaceIndex.erase(indexed);
+        }
+    }
+
+    void eraseObject(const std::string& path)
+    {
+        auto it = objects.find(path);
+        if (it == objects.end())
+        {
+            return;
+        }
+        for (const auto& [service, interfaces] : it->second)
+        {
+            for (const std::string& interface : interfaces)
+            {
+                unindex(interface, path);
+            }
+        }
+        objects.erase(it);
+    }
+
+    static MapperGetObject
+        matchServices(const ServiceMap& services,
+                      const std::vector<std::string>& interfaces)
+    {
+        MapperGetObject matched;
+        for (const auto& [service, implemented] : services)
+        {
+            bool match = interfaces.empty() ||
+                         std::any_of(interfaces.begin(), interfaces.end(),
+                                     [&implemented](const std::string& i) {
+                                         return implemented.find(i) !=
+                                                implemented.end();
+                                     });
+            if (match)
+            {
+                matched.emplace_back(
+                    service, std::vector<std::string>(implemented.begin(),
+                                                      implemented.end()));
+            }
+        }
+        return matched;
+    }
+
+    // Calls callback with each object below subtree, in path order, the
+    // way the mapper selects them: paths that start with subtree, other
+    // than subtree itself, with no more than depth slashes past it
+    template <typename Callback>
+    bool forEachInSubTree(std::string_view subtree, int32_t depth,
+                          const std::vector<std::string>& interfaces,
+                          Callback&& callback) const
+    {
+        if (subtree.ends_with('/'))
+        {
+            subtree.remove_suffix(1);
+        }
+        if (!subtree.empty() && !objects.contains(subtree))
+        {
+            // The mapper also knows the paths leading to objects, which
+            // aren't all mirrored; any object below will do
+            std::string below(subtree);
+            below += '/';
+            auto first = objects.lower_bound(below);
+            if (first == objects.end() || !first->first.starts_with(below))
+            {
+                return false;
+            }
+        }
+
+        auto inSubTree = [subtree, depth](const std::string& path) {
+            if (!path.starts_with(subtree) || path == subtree)
+            {
+                return false;
+            }
+            if (depth <= 0)
+            {
+                return true;
+            }
+            return std::count(path.begin() + static_cast<std::ptrdiff_t>(
+                                                 subtree.size()),
+                              path.end(), '/') <= depth;
+        };
+
+        if (interfaces.empty())
+        {
+            for (auto it = objects.lower_bound(subtree);
+                 it != objects.end() && it->first.starts_with(subtree); it++)
+            {
+                if (inSubTree(it->first))
+                {
+                    callback(it->first, it->second);
+                }
+            }
+            return true;
+        }
+
+        // Only the objects that implement one of interfaces
+        std::vector<const std::string*> paths;
+        for (const std::string& interface : interfaces)
+        {
+            auto indexed = interfaceIndex.find(interface);
+            if (indexed == interfaceIndex.end())
+            {
+                continue;
+            }
+            for (auto it = indexed->second.lower_bound(subtree);
+                 it != indexed->second.end() && it->starts_with(subtree);
+                 it++)
+            {
+                if (inSubTree(*it))
+                {
+                    paths.push_back(&*it);
+                }
+            }
+        }
+        std::sort(paths.begin(), paths.end(),
+                  [](const std::string* a, const std::string* b) {
+                      return *a < *b;
+                  });
+        paths.erase(std::unique(paths.begin(), paths.end(),
+                                [](const std::string* a, const std::string* b) {
+                                    return *a == *b;
+                                }),
+                    paths.end());
+        for (const std::string* path : paths)
+        {
+            auto it = objects.find(*path);
+            if (it != objects.end())
+            {
+                callback(it->first, it->second);
+            }
+        }
+        return true;
+    }
+
+    bool ready = false;
+    uint64_t generation = 0;
+    // Seeds requested before this are refused
+    uint64_t invalidatedGeneration = 0;
+    size_t seedsInFlight = 0;
+    // Changes since the oldest seed in flight was requested
+    std::vector<Change> changes;
+    // Object path to the services on it and the interfaces each implements
+    std::map<std::string, ServiceMap, std::less<>> objects;
+    // Interface to the paths of the objects implementing it
+    std::map<std::string, std::set<std::string, std::less<>>, std::less<>>
+        interfaceIndex;
+};
+
+/**
+ * ServiceOwners
+ * The well-known names of the connections on the bus.  Signals come from a
+ * connection's unique name, while the mapper reports its well-known name.
+ */
+class ServiceOwners
+{
+  public:
+    void add(const std::string& owner, const std::string& name)
+    {
+        std::vector<std::string>& owned = names[owner];
+        if (std::find(owned.begin(), owned.end(), name) == owned.end())
+        {
+            owned.push_back(name);
+        }
+    }
+
+    void remove(const std::string& owner, const std::string& name)
+    {
+        auto it = names.find(owner);
+        if (it == names.end())
+        {
+            return;
+        }
+        std::erase(it->second, name);
+        if (it->second.empty())
+        {
+            names.erase(it);
+        }
+    }
+
+    // The well-known name of owner, or empty if it has none or several, in
+    // which case it isn't known which one the mapper reports
+    std::string_view find(std::string_view owner) const
+    {
+        auto it = names.find(owner);
+        if (it == names.end() || it->second.size() != 1)
+        {
+            return {};
+        }
+        return it->second.front();
+    }
+
+    bool isKnown(const std::string& name) const
+    {
+        return std::any_of(names.begin(), names.end(), [&name](const auto& o) {
+            return std::find(o.second.begin(), o.second.end(), name) !=
+                   o.second.end();
+        });
+    }
+
+  private:
+    std::map<std::string, std::vector<std::string>, std::less<>> names;
+};
+
+inline ServiceOwners& serviceOwners()
+{
+    static ServiceOwners owners;
+    return owners;
+}
+
+// The deepest path that all of paths are strictly below, which is what to
+// ask the mapper for to refresh all of them at once
+inline std::string refreshRoot(const std::vector<std::string>& paths)
+{
+    auto parent = [](const std::string& path) {
+        size_t slash = path.rfind('/');
+        if (slash == 0 || slash == std::string::npos)
+        {
+            return std::string("/");
+        }
+        return path.substr(0, slash);
+    };
+    auto isBelow = [](const std::string& path, const std::string& root) {
+        return root == "/" ||
+               (path.starts_with(root) && path.size() > root.size() &&
+                path[root.size()] == '/');
+    };
+    if (paths.empty())
+    {
+        return "/";
+    }
+    std::string root = parent(paths.front());
+    for (const std::string& path : paths)
+    {
+        while (!isBelow(path, root))
+        {
+            root = parent(root);
+        }
+    }
+    return root;
+}
+
+template <typename Interfaces>
+inline std::vector<std::string> toInterfaceList(const Interfaces& interfaces)
+{
+    return std::vector<std::string>(std::begin(interfaces),
+                                    std::end(interfaces));
+}
+
+// What the mapper returns for an unknown path
+inline boost::system::error_code notFoundError()
+{
+    return boost::system::errc::make_error_code(
+        boost::system::errc::io_error);
+}
+
+/**
+ * The ObjectMapper's GetSubTree, answered from the mirror once it is ready
+ * and from the mapper otherwise.  callback is called as it would be by
+ * async_method_call, and never before this returns.
+ */
+template <typename Interfaces, typename Callback>
+inline void getSubTree(const std::string& path, int32_t depth,
+                       const Interfaces& interfaces, Callback&& callback)
+{
+    std::vector<std::string> interfaceList = toInterfaceList(interfaces);
+    MapperMirror& mirror = MapperMirror::getInstance();
+    if (!mirror.isReady())
+    {
+        bmcweb::stats::increment("mapper_mirror.dbus_calls");
+        crow::connections::systemBus->async_method_call(
+            std::forward<Callback>(callback),
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetSubTree", path, depth,
+            interfaceList);
+        return;
+    }
+    bmcweb::stats::increment("mapper_mirror.hits");
+    MapperGetSubTreeResponse result;
+    bool found = mirror.getSubTree(path, depth, interfaceList, result);
+    boost::asio::post(
+        crow::connections::systemBus->get_io_context(),
+        [callback{std::forward<Callback>(callback)}, found,
+         result{std::move(result)}]() mutable {
+            callback(found ? boost::system::error_code() : notFoundError(),
+                     result);
+        });
+}
+
+// As getSubTree(), for GetSubTreePaths
+template <typename Interfaces, typename Callback>
+inline void getSubTreePaths(const std::string& path, int32_t depth,
+                            const Interfaces& interfaces, Callback&& callback)
+{
+    std::vector<std::string> interfaceList = toInterfaceList(interfaces);
+    MapperMirror& mirror = MapperMirror::getInstance();
+    if (!mirror.isReady())
+    {
+        bmcweb::stats::increment("mapper_mirror.dbus_calls");
+        crow::connections::systemBus->async_method_call(
+            std::forward<Callback>(callback),
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths", path, depth,
+            interfaceList);
+        return;
+    }
+    bmcweb::stats::increment("mapper_mirror.hits");
+    std::vector<std::string> result;
+    bool found = mirror.getSubTreePaths(path, depth, interfaceList, result);
+    boost::asio::post(
+        crow::connections::systemBus->get_io_context(),
+        [callback{std::forward<Callback>(callback)}, found,
+         result{std::move(result)}]() mutable {
+            callback(found ? boost::system::error_code() : notFoundError(),
+                     result);
+        });
+}
+
+// As getSubTree(), for GetObject
+template <typename Interfaces, typename Callback>
+inline void getObject(const std::string& path, const Interfaces& interfaces,
+                      Callback&& callback)
+{
+    std::vector<std::string> interfaceList = toInterfaceList(interfaces);
+    MapperMirror& mirror = MapperMirror::getInstance();
+    if (!mirror.isReady())
+    {
+        bmcweb::stats::increment("mapper_mirror.dbus_calls");
+        crow::connections::systemBus->async_method_call(
+            std::forward<Callback>(callback),
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetObject", path,
+            interfaceList);
+        return;
+    }
+    bmcweb::stats::increment("mapper_mirror.hits");
+    MapperGetObject result;
+    bool found = mirror.getObject(path, interfaceList, result);
+    boost::asio::post(
+        crow::connections::systemBus->get_io_context(),
+        [callback{std::forward<Callback>(callback)}, found,
+         result{std::move(result)}]() mutable {
+            callback(found ? boost::system::error_code() : notFoundError(),
+                     result);
+        });
+}
+
+static std::unique_ptr<sdbusplus::bus::match::match> interfacesAddedMonitor;
+static std::unique_ptr<sdbusplus::bus::match::match> interfacesRemovedMonitor;
+static std::unique_ptr<sdbusplus::bus::match::match> nameOwnerMonitor;
+static std::unique_ptr<boost::asio::steady_timer> reseedTimer;
+static std::unique_ptr<boost::asio::steady_timer> selfCheckTimer;
+static std::unique_ptr<boost::asio::steady_timer> refreshTimer;
+// The objects whose signals are waiting for refreshTimer
+static std::vector<std::string> pendingRefreshes;
+
+// Counts the objects on which the mirror and the mapper differ, logging each
+inline size_t countDifferences(const MapperGetSubTreeResponse& mirrored,
+                               const MapperGetSubTreeResponse& mapped)
+{
+    std::map<std::string_view, const MapperGetObject*> expected;
+    for (const auto& [path, services] : mapped)
+    {
+        expected.emplace(path, &services);
+    }
+    size_t differences = 0;
+    for (const auto& [path, services] : mirrored)
+    {
+        auto it = expected.find(path);
+        if (it == expected.end())
+        {
+            BMCWEB_LOG_ERROR << "Mapper mirror has stale object " << path;
+            differences++;
+            continue;
+        }
+        MapperGetObject sorted = *it->second;
+        std::sort(sorted.begin(), sorted.end());
+        for (auto& [service, interfaces] : sorted)
+        {
+            std::sort(interfaces.begin(), interfaces.end());
+        }
+        if (sorted != services)
+        {
+            BMCWEB_LOG_ERROR << "Mapper mirror differs on object " << path;
+            differences++;
+        }
+        expected.erase(it);
+    }
+    for (const auto& [path, services] : expected)
+    {
+        BMCWEB_LOG_ERROR << "Mapper mirror is missing object " << path;
+        differences++;
+    }
+    return differences;
+}
+
+inline void scheduleReseed();
+
+// Services that were on the bus before bmcweb started watching it only
+// announced their names then, so ask who owns them
+inline void learnOwners(const MapperGetSubTreeResponse& subtree)
+{
+    std::set<std::string> services;
+    for (const auto& [path, objectServices] : subtree)
+    {
+        for (const auto& [service, interfaces] : objectServices)
+        {
+            services.insert(service);
+        }
+    }
+    for (const std::string& service : services)
+    {
+        if (serviceOwners().isKnown(service))
+        {
+            continue;
+        }
+        crow::connections::systemBus->async_method_call(
+            [service](const boost::system::error_code ec,
+                      const std::string& owner) {
+                if (ec)
+                {
+                    return;
+                }
+                serviceOwners().add(owner, service);
+            },
+            "org.freedesktop.DBus", "/org/freedesktop/DBus",
+            "org.freedesktop.DBus", "GetNameOwner", service);
+    }
+}
+
+// Fetches the whole tree from the mapper.  With selfCheck, the mirror is
+// first compared against it.
+inline void seedMapperMirror(bool selfCheck = false)
+{
+    uint64_t generation = MapperMirror::getInstance().beginSeed();
+    crow::connections::systemBus->async_method_call(
+        [generation, selfCheck](const boost::system::error_code ec,
+                                const MapperGetSubTreeResponse& subtree) {
+            MapperMirror& mirror = MapperMirror::getInstance();
+            if (ec)
+            {
+                BMCWEB_LOG_ERROR << "Mapper mirror seed failed: " << ec;
+                mirror.abandonSeed();
+                if (!mirror.isReady())
+                {
+                    scheduleReseed();
+                }
+                return;
+            }
+            if (selfCheck && mirror.isReady() &&
+                generation == mirror.getGeneration())
+            {
+                MapperGetSubTreeResponse mirrored;
+                mirror.getSubTree("/", 0, {}, mirrored);
+                size_t differences = countDifferences(mirrored, subtree);
+                bmcweb::stats::increment("mapper_mirror.mismatches",
+                                         differences);
+            }
+            if (!mirror.seed(subtree, generation))
+            {
+                // A service came while the seed was in flight, and already
+                // scheduled the seed that will include it
+                bmcweb::stats::increment("mapper_mirror.refused_seeds");
+                return;
+            }
+            bmcweb::stats::increment("mapper_mirror.seeds");
+            BMCWEB_LOG_DEBUG << "Mapper mirror seeded with " << mirror.size()
+                             << " objects";
+            learnOwners(subtree);
+        },
+        "xyz.openbmc_project.ObjectMapper",
+        "/xyz/openbmc_project/object_mapper",
+        "xyz.openbmc_project.ObjectMapper", "GetSubTree", "/", int32_t(0),
+        std::vector<std::string>());
+}
+
+inline void scheduleReseed()
+{
+    MapperMirror::getInstance().invalidate();
+    if (!reseedTimer)
+    {
+        return;
+    }
+    reseedTimer->expires_after(mapperMirrorReseedDelay);
+    reseedTimer->async_wait([](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            // Cancelled by a later reschedule
+            return;
+        }
+        seedMapperMirror();
+    });
+}
+
+inline void scheduleSelfCheck()
+{
+    if (!selfCheckTimer || bmcwebMapperMirrorSelfCheckSeconds == 0)
+    {
+        return;
+    }
+    selfCheckTimer->expires_after(
+        std::chrono::seconds(bmcwebMapperMirrorSelfCheckSeconds));
+    selfCheckTimer->async_wait([](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            return;
+        }
+        seedMapperMirror(true);
+        scheduleSelfCheck();
+    });
+}
+
+// The mapper has already handled the signals by the time a call from here
+// reaches it, so its view of the objects is current
+inline void refreshPending()
+{
+    std::string root = refreshRoot(pendingRefreshes);
+    pendingRefreshes.clear();
+    bmcweb::stats::increment("mapper_mirror.refreshes");
+    crow::connections::systemBus->async_method_call(
+        [root](const boost::system::error_code ec,
+               const MapperGetSubTreeResponse& subtree) {
+            // The mapper fails for a path with nothing below it
+            MapperMirror::getInstance().setSubTree(
+                root, ec ? MapperGetSubTreeResponse() : subtree);
+        },
+        "xyz.openbmc_project.ObjectMapper",
+        "/xyz/openbmc_project/object_mapper",
+        "xyz.openbmc_project.ObjectMapper", "GetSubTree", root, int32_t(0),
+        std::vector<std::string>());
+}
+
+inline void scheduleRefresh(const std::string& path)
+{
+    pendingRefreshes.push_back(path);
+    if (!refreshTimer || pendingRefreshes.size() > 1)
+    {
+        // Already waiting
+        return;
+    }
+    refreshTimer->expires_after(mapperMirrorRefreshDelay);
+    refreshTimer->async_wait([](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            return;
+        }
+        refreshPending();
+    });
+}
+
+inline void onInterfacesAdded(sdbusplus::message::message& message)
+{
+    sdbusplus::message::object_path path;
+    std::string_view service = serviceOwners().find(message.get_sender());
+    if (service.empty())
+    {
+        message.read(path);
+        scheduleRefresh(path.str);
+        return;
+    }
+    dbus::utility::DBusInteracesMap interfaces;
+    try
+    {
+        message.read(path, interfaces);
+    }
+    catch (const sdbusplus::exception::exception& e)
+    {
+        // A property of a type bmcweb doesn't know
+        BMCWEB_LOG_DEBUG << "Mapper mirror refreshing " << path.str << ": "
+                         << e.what();
+        scheduleRefresh(path.str);
+        return;
+    }
+    std::vector<std::string> added;
+    added.reserve(interfaces.size());
+    for (const auto& [interface, properties] : interfaces)
+    {
+        added.push_back(interface);
+    }
+    MapperMirror::getInstance().addInterfaces(path.str, std::string(service),
+                                              added);
+}
+
+inline void onInterfacesRemoved(sdbusplus::message::message& message)
+{
+    sdbusplus::message::object_path path;
+    std::vector<std::string> removed;
+    message.read(path, removed);
+    std::string_view service = serviceOwners().find(message.get_sender());
+    if (service.empty())
+    {
+        scheduleRefresh(path.str);
+        return;
+    }
+    MapperMirror::getInstance().removeInterfaces(
+        path.str, std::string(service), removed);
+}
+
+inline void onNameOwnerChanged(sdbusplus::message::message& message)
+{
+    std::string name;
+    std::string oldOwner;
+    std::string newOwner;
+    message.read(name, oldOwner, newOwner);
+    if (name.starts_with(':'))
+    {
+        // The mapper only reports well-known names
+        return;
+    }
+    if (!oldOwner.empty())
+    {
+        serviceOwners().remove(oldOwner, name);
+    }
+    if (!newOwner.empty())
+    {
+        serviceOwners().add(newOwner, name);
+    }
+    if (newOwner.empty())
+    {
+        BMCWEB_LOG_DEBUG << "Mapper mirror dropping service " << name;
+        MapperMirror::getInstance().removeService(name);
+        return;
+    }
+    // A new service isn't known until the mapper introspects it
+    BMCWEB_LOG_DEBUG << "Mapper mirror reseeding for service " << name;
+    scheduleReseed();
+}
+
+// Seeds the mirror and keeps it current from then on.  Until it is seeded,
+// queries go to the mapper.
+inline void registerMapperMirror()
+{
+    BMCWEB_LOG_INFO << "Register ObjectMapper mirror";
+    sdbusplus::bus::bus& bus =
+        static_cast<sdbusplus::bus::bus&>(*crow::connections::systemBus);
+    interfacesAddedMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+        "member='InterfacesAdded'",
+        onInterfacesAdded);
+    interfacesRemovedMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+        "member='InterfacesRemoved'",
+        onInterfacesRemoved);
+    nameOwnerMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',sender='org.freedesktop.DBus',"
+        "interface='org.freedesktop.DBus',member='NameOwnerChanged'",
+        onNameOwnerChanged);
+
+    boost::asio::io_context& io =
+        crow::connections::systemBus->get_io_context();
+    reseedTimer = std::make_unique<boost::asio::steady_timer>(io);
+    selfCheckTimer = std::make_unique<boost::asio::steady_timer>(io);
+    refreshTimer = std::make_unique<boost::asio::steady_timer>(io);
+
+    seedMapperMirror();
+    scheduleSelfCheck();
+}
+
+} // namespace object_mapper
+} // namespace crow
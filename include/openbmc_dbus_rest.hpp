@@ -18,13 +18,19 @@
 #include <app.hpp>
 #include <async_resp.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/container/flat_set.hpp>
+#include <dbus_single_flight.hpp>
 #include <dbus_singleton.hpp>
 #include <dbus_utility.hpp>
+#include <introspection_cache.hpp>
 #include <sdbusplus/message/types.hpp>
+#include <stats.hpp>
 
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <optional>
 #include <regex>
 #include <utility>
 
@@ -67,6 +73,166 @@ inline void setErrorResponse(crow::Response& res,
                      {"status", "error"}};
 }
 
+inline std::optional<std::string>
+    getAttribute(const tinyxml2::XMLElement* element, const char* name)
+{
+    const char* value = element->Attribute(name);
+    if (value == nullptr)
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+inline std::vector<introspection::Member>
+    parseMembers(const tinyxml2::XMLElement* interface, const char* kind)
+{
+    std::vector<introspection::Member> members;
+    for (const tinyxml2::XMLElement* element =
+             interface->FirstChildElement(kind);
+         element != nullptr; element = element->NextSiblingElement(kind))
+    {
+        const char* name = element->Attribute("name");
+        if (name == nullptr)
+        {
+            continue;
+        }
+        introspection::Member& member = members.emplace_back();
+        member.name = name;
+        for (const tinyxml2::XMLElement* arg =
+                 element->FirstChildElement("arg");
+             arg != nullptr; arg = arg->NextSiblingElement("arg"))
+        {
+            member.args.push_back({getAttribute(arg, "name"),
+                                   getAttribute(arg, "direction"),
+                                   getAttribute(arg, "type")});
+        }
+    }
+    return members;
+}
+
+// Reduces introspection XML to the signatures the handlers use.  Returns
+// nullptr if it doesn't parse.
+inline std::shared_ptr<const introspection::Node>
+    parseIntrospection(const std::string& introspectXml, std::string& error)
+{
+    tinyxml2::XMLDocument doc;
+    doc.Parse(introspectXml.data(), introspectXml.size());
+    if (doc.Error())
+    {
+        error = doc.ErrorStr();
+        return nullptr;
+    }
+    const tinyxml2::XMLElement* pRoot = doc.FirstChildElement("node");
+    if (pRoot == nullptr)
+    {
+        error = "no <node> element";
+        return nullptr;
+    }
+
+    auto node = std::make_shared<introspection::Node>();
+    for (const tinyxml2::XMLElement* child = pRoot->FirstChildElement("node");
+         child != nullptr; child = child->NextSiblingElement("node"))
+    {
+        const char* childPath = child->Attribute("name");
+        if (childPath != nullptr)
+        {
+            node->children.emplace_back(childPath);
+        }
+    }
+    for (const tinyxml2::XMLElement* element =
+             pRoot->FirstChildElement("interface");
+         element != nullptr; element = element->NextSiblingElement("interface"))
+    {
+        const char* name = element->Attribute("name");
+        if (name == nullptr)
+        {
+            continue;
+        }
+        introspection::Interface& interface = node->interfaces.emplace_back();
+        interface.name = name;
+        interface.methods = parseMembers(element, "method");
+        interface.signals = parseMembers(element, "signal");
+        for (const tinyxml2::XMLElement* property =
+                 element->FirstChildElement("property");
+             property != nullptr;
+             property = property->NextSiblingElement("property"))
+        {
+            const char* propertyName = property->Attribute("name");
+            if (propertyName == nullptr)
+            {
+                continue;
+            }
+            const char* type = property->Attribute("type");
+            interface.properties.push_back(
+                {propertyName, type == nullptr ? "" : type});
+        }
+    }
+    return node;
+}
+
+/**
+ * Introspects an object, from the introspection cache if it holds the object.
+ * callback is called with the error, if any, and the object's node, which
+ * is nullptr if the introspection data doesn't parse.  It is never called
+ * before this returns.
+ */
+template <typename Callback>
+inline void introspect(const std::string& service, const std::string& path,
+                       Callback&& callback)
+{
+    introspection::IntrospectionCache& cache =
+        introspection::IntrospectionCache::getInstance();
+    std::shared_ptr<const introspection::Node> node = cache.find(
+        service, path, introspection::IntrospectionCache::Clock::now());
+    if (node != nullptr)
+    {
+        bmcweb::stats::increment("introspection_cache.hits");
+        boost::asio::post(crow::connections::systemBus->get_io_context(),
+                          [callback{std::forward<Callback>(callback)},
+                           node{std::move(node)}]() mutable {
+                              callback(boost::system::error_code(), node);
+                          });
+        return;
+    }
+    bmcweb::stats::increment("introspection_cache.misses");
+    crow::single_flight::asyncMethodCall<std::string>(
+        [callback{std::forward<Callback>(callback)}, service, path,
+         fetchEpoch{cache.getEpoch()}](
+            const boost::system::error_code ec,
+            const std::string& introspectXml) mutable {
+            if (ec)
+            {
+                callback(ec, nullptr);
+                return;
+            }
+            // Callers that shared the call share the parse too
+            introspection::IntrospectionCache& cache =
+                introspection::IntrospectionCache::getInstance();
+            introspection::IntrospectionCache::Clock::time_point now =
+                introspection::IntrospectionCache::Clock::now();
+            std::shared_ptr<const introspection::Node> node =
+                cache.find(service, path, now);
+            if (node == nullptr)
+            {
+                std::string error;
+                node = parseIntrospection(introspectXml, error);
+                if (node == nullptr)
+                {
+                    BMCWEB_LOG_ERROR << "XML document failed to parse "
+                                     << service << " " << path << ": "
+                                     << error;
+                }
+                else
+                {
+                    cache.store(service, path, node, fetchEpoch, now);
+                }
+            }
+            callback(ec, node);
+        },
+        service, path, "org.freedesktop.DBus.Introspectable", "Introspect");
+}
+
 inline void
     introspectObjects(const std::string& processName,
                       const std::string& objectPath,
@@ -79,11 +245,12 @@ inline void
                                       {"objects", nlohmann::json::array()}};
     }
 
-    crow::connections::systemBus->async_method_call(
+    introspect(
+        processName, objectPath,
         [transaction, processName{std::string(processName)},
          objectPath{std::string(objectPath)}](
             const boost::system::error_code ec,
-            const std::string& introspectXml) {
+            const std::shared_ptr<const introspection::Node>& node) {
             if (ec)
             {
                 BMCWEB_LOG_ERROR
@@ -95,39 +262,22 @@ inline void
             transaction->res.jsonValue["objects"].push_back(
                 {{"path", objectPath}});
 
-            tinyxml2::XMLDocument doc;
-
-            doc.Parse(introspectXml.c_str());
-            tinyxml2::XMLNode* pRoot = doc.FirstChildElement("node");
-            if (pRoot == nullptr)
+            if (node == nullptr)
             {
-                BMCWEB_LOG_ERROR << "XML document failed to parse "
-                                 << processName << " " << objectPath << "\n";
+                return;
             }
-            else
+            for (const std::string& childPath : node->children)
             {
-                tinyxml2::XMLElement* node = pRoot->FirstChildElement("node");
-                while (node != nullptr)
+                std::string newpath;
+                if (objectPath != "/")
                 {
-                    const char* childPath = node->Attribute("name");
-                    if (childPath != nullptr)
-                    {
-                        std::string newpath;
-                        if (objectPath != "/")
-                        {
-                            newpath += objectPath;
-                        }
-                        newpath += std::string("/") + childPath;
-                        // introspect the subobjects as well
-                        introspectObjects(processName, newpath, transaction);
-                    }
-
-                    node = node->NextSiblingElement("node");
+                    newpath += objectPath;
                 }
+                newpath += "/" + childPath;
+                // introspect the subobjects as well
+                introspectObjects(processName, newpath, transaction);
             }
-        },
-        processName, objectPath, "org.freedesktop.DBus.Introspectable",
-        "Introspect");
+        });
 }
 
 inline void getPropertiesForEnumerate(
@@ -1314,11 +1464,11 @@ inline void findActionOnInterface(
 {
     BMCWEB_LOG_DEBUG << "findActionOnInterface for connection "
                      << connectionName;
-    crow::connections::systemBus->async_method_call(
+    introspect(
+        connectionName, transaction->path,
         [transaction, connectionName{std::string(connectionName)}](
             const boost::system::error_code ec,
-            const std::string& introspectXml) {
-            BMCWEB_LOG_DEBUG << "got xml:\n " << introspectXml;
+            const std::shared_ptr<const introspection::Node>& node) {
             if (ec)
             {
                 BMCWEB_LOG_ERROR
@@ -1326,153 +1476,105 @@ inline void findActionOnInterface(
                     << " on process: " << connectionName << "\n";
                 return;
             }
-            tinyxml2::XMLDocument doc;
-
-            doc.Parse(introspectXml.data(), introspectXml.size());
-            tinyxml2::XMLNode* pRoot = doc.FirstChildElement("node");
-            if (pRoot == nullptr)
+            if (node == nullptr)
             {
-                BMCWEB_LOG_ERROR << "XML document failed to parse "
-                                 << connectionName << "\n";
                 return;
             }
-            tinyxml2::XMLElement* interfaceNode =
-                pRoot->FirstChildElement("interface");
-            while (interfaceNode != nullptr)
+            for (const introspection::Interface& interface : node->interfaces)
             {
-                const char* thisInterfaceName =
-                    interfaceNode->Attribute("name");
-                if (thisInterfaceName != nullptr)
+                if (!transaction->interfaceName.empty() &&
+                    (transaction->interfaceName != interface.name))
                 {
-                    if (!transaction->interfaceName.empty() &&
-                        (transaction->interfaceName != thisInterfaceName))
+                    continue;
+                }
+
+                for (const introspection::Member& method : interface.methods)
+                {
+                    BMCWEB_LOG_DEBUG << "Found method: " << method.name;
+                    if (method.name != transaction->methodName)
                     {
-                        interfaceNode =
-                            interfaceNode->NextSiblingElement("interface");
                         continue;
                     }
+                    BMCWEB_LOG_DEBUG << "Found method named " << method.name
+                                     << " on interface " << interface.name;
+                    sdbusplus::message::message m =
+                        crow::connections::systemBus->new_method_call(
+                            connectionName.c_str(), transaction->path.c_str(),
+                            interface.name.c_str(),
+                            transaction->methodName.c_str());
+
+                    std::string returnType;
 
-                    tinyxml2::XMLElement* methodNode =
-                        interfaceNode->FirstChildElement("method");
-                    while (methodNode != nullptr)
+                    // Find the output type
+                    for (const introspection::Argument& argument : method.args)
                     {
-                        const char* thisMethodName =
-                            methodNode->Attribute("name");
-                        BMCWEB_LOG_DEBUG << "Found method: " << thisMethodName;
-                        if (thisMethodName != nullptr &&
-                            thisMethodName == transaction->methodName)
+                        if (argument.direction == "out" && argument.type)
                         {
-                            BMCWEB_LOG_DEBUG
-                                << "Found method named " << thisMethodName
-                                << " on interface " << thisInterfaceName;
-                            sdbusplus::message::message m =
-                                crow::connections::systemBus->new_method_call(
-                                    connectionName.c_str(),
-                                    transaction->path.c_str(),
-                                    thisInterfaceName,
-                                    transaction->methodName.c_str());
-
-                            tinyxml2::XMLElement* argumentNode =
-                                methodNode->FirstChildElement("arg");
-
-                            std::string returnType;
-
-                            // Find the output type
-                            while (argumentNode != nullptr)
-                            {
-                                const char* argDirection =
-                                    argumentNode->Attribute("direction");
-                                const char* argType =
-                                    argumentNode->Attribute("type");
-                                if (argDirection != nullptr &&
-                                    argType != nullptr &&
-                                    std::string(argDirection) == "out")
-                                {
-                                    returnType = argType;
-                                    break;
-                                }
-                                argumentNode =
-                                    argumentNode->NextSiblingElement("arg");
-                            }
+                            returnType = *argument.type;
+                            break;
+                        }
+                    }
+
+                    auto argIt = transaction->arguments.begin();
 
-                            auto argIt = transaction->arguments.begin();
+                    for (const introspection::Argument& argument : method.args)
+                    {
+                        if (argument.direction != "in" || !argument.type)
+                        {
+                            continue;
+                        }
+                        if (argIt == transaction->arguments.end())
+                        {
+                            transaction->setErrorStatus("Invalid method args");
+                            return;
+                        }
+                        if (convertJsonToDbus(m.get(), *argument.type,
+                                              *argIt) < 0)
+                        {
+                            transaction->setErrorStatus(
+                                "Invalid method arg type");
+                            return;
+                        }
 
-                            argumentNode = methodNode->FirstChildElement("arg");
+                        argIt++;
+                    }
 
-                            while (argumentNode != nullptr)
+                    crow::connections::systemBus->async_send(
+                        m, [transaction,
+                            returnType](boost::system::error_code ec2,
+                                        sdbusplus::message::message& m2) {
+                            if (ec2)
                             {
-                                const char* argDirection =
-                                    argumentNode->Attribute("direction");
-                                const char* argType =
-                                    argumentNode->Attribute("type");
-                                if (argDirection != nullptr &&
-                                    argType != nullptr &&
-                                    std::string(argDirection) == "in")
-                                {
-                                    if (argIt == transaction->arguments.end())
-                                    {
-                                        transaction->setErrorStatus(
-                                            "Invalid method args");
-                                        return;
-                                    }
-                                    if (convertJsonToDbus(m.get(),
-                                                          std::string(argType),
-                                                          *argIt) < 0)
-                                    {
-                                        transaction->setErrorStatus(
-                                            "Invalid method arg type");
-                                        return;
-                                    }
+                                transaction->methodFailed = true;
+                                const sd_bus_error* e = m2.get_error();
 
-                                    argIt++;
+                                if (e)
+                                {
+                                    setErrorResponse(
+                                        transaction->res,
+                                        boost::beast::http::status::
+                                            bad_request,
+                                        e->name, e->message);
                                 }
-                                argumentNode =
-                                    argumentNode->NextSiblingElement("arg");
+                                else
+                                {
+                                    setErrorResponse(
+                                        transaction->res,
+                                        boost::beast::http::status::
+                                            bad_request,
+                                        "Method call failed",
+                                        methodFailedMsg);
+                                }
+                                return;
                             }
+                            transaction->methodPassed = true;
 
-                            crow::connections::systemBus->async_send(
-                                m, [transaction, returnType](
-                                       boost::system::error_code ec2,
-                                       sdbusplus::message::message& m2) {
-                                    if (ec2)
-                                    {
-                                        transaction->methodFailed = true;
-                                        const sd_bus_error* e = m2.get_error();
-
-                                        if (e)
-                                        {
-                                            setErrorResponse(
-                                                transaction->res,
-                                                boost::beast::http::status::
-                                                    bad_request,
-                                                e->name, e->message);
-                                        }
-                                        else
-                                        {
-                                            setErrorResponse(
-                                                transaction->res,
-                                                boost::beast::http::status::
-                                                    bad_request,
-                                                "Method call failed",
-                                                methodFailedMsg);
-                                        }
-                                        return;
-                                    }
-                                    transaction->methodPassed = true;
-
-                                    handleMethodResponse(transaction, m2,
-                                                         returnType);
-                                });
-                            break;
-                        }
-                        methodNode = methodNode->NextSiblingElement("method");
-                    }
+                            handleMethodResponse(transaction, m2, returnType);
+                        });
+                    break;
                 }
-                interfaceNode = interfaceNode->NextSiblingElement("interface");
             }
-        },
-        connectionName, transaction->path,
-        "org.freedesktop.DBus.Introspectable", "Introspect");
+        });
 }
 
 inline void handleAction(const crow::Request& req,
@@ -1839,10 +1941,13 @@ inline void handlePut(const crow::Request& req,
             {
                 const std::string& connectionName = connection.first;
 
-                crow::connections::systemBus->async_method_call(
+                introspect(
+                    connectionName, transaction->objectPath,
                     [connectionName{std::string(connectionName)},
-                     transaction](const boost::system::error_code ec3,
-                                  const std::string& introspectXml) {
+                     transaction](
+                        const boost::system::error_code ec3,
+                        const std::shared_ptr<const introspection::Node>&
+                            node) {
                         if (ec3)
                         {
                             BMCWEB_LOG_ERROR
@@ -1852,134 +1957,103 @@ inline void handlePut(const crow::Request& req,
                             transaction->setErrorStatus("Unexpected Error");
                             return;
                         }
-                        tinyxml2::XMLDocument doc;
-
-                        doc.Parse(introspectXml.c_str());
-                        tinyxml2::XMLNode* pRoot =
-                            doc.FirstChildElement("node");
-                        if (pRoot == nullptr)
+                        if (node == nullptr)
                         {
-                            BMCWEB_LOG_ERROR << "XML document failed to parse: "
-                                             << introspectXml;
                             transaction->setErrorStatus("Unexpected Error");
                             return;
                         }
-                        tinyxml2::XMLElement* ifaceNode =
-                            pRoot->FirstChildElement("interface");
-                        while (ifaceNode != nullptr)
+                        for (const introspection::Interface& interface :
+                             node->interfaces)
                         {
-                            const char* interfaceName =
-                                ifaceNode->Attribute("name");
                             BMCWEB_LOG_DEBUG << "found interface "
-                                             << interfaceName;
-                            tinyxml2::XMLElement* propNode =
-                                ifaceNode->FirstChildElement("property");
-                            while (propNode != nullptr)
+                                             << interface.name;
+                            for (const introspection::Property& property :
+                                 interface.properties)
                             {
-                                const char* propertyName =
-                                    propNode->Attribute("name");
                                 BMCWEB_LOG_DEBUG << "Found property "
-                                                 << propertyName;
-                                if (propertyName == transaction->propertyName)
+                                                 << property.name;
+                                if (property.name !=
+                                        transaction->propertyName ||
+                                    property.type.empty())
+                                {
+                                    continue;
+                                }
+                                const char* argType = property.type.c_str();
+                                sdbusplus::message::message m =
+                                    crow::connections::systemBus
+                                        ->new_method_call(
+                                            connectionName.c_str(),
+                                            transaction->objectPath.c_str(),
+                                            "org.freedesktop.DBus."
+                                            "Properties",
+                                            "Set");
+                                m.append(interface.name,
+                                         transaction->propertyName);
+                                int r = sd_bus_message_open_container(
+                                    m.get(), SD_BUS_TYPE_VARIANT, argType);
+                                if (r < 0)
+                                {
+                                    transaction->setErrorStatus(
+                                        "Unexpected Error");
+                                    return;
+                                }
+                                r = convertJsonToDbus(
+                                    m.get(), argType,
+                                    transaction->propertyValue);
+                                if (r < 0)
                                 {
-                                    const char* argType =
-                                        propNode->Attribute("type");
-                                    if (argType != nullptr)
+                                    if (r == -ERANGE)
                                     {
-                                        sdbusplus::message::message m =
-                                            crow::connections::systemBus
-                                                ->new_method_call(
-                                                    connectionName.c_str(),
-                                                    transaction->objectPath
-                                                        .c_str(),
-                                                    "org.freedesktop.DBus."
-                                                    "Properties",
-                                                    "Set");
-                                        m.append(interfaceName,
-                                                 transaction->propertyName);
-                                        int r = sd_bus_message_open_container(
-                                            m.get(), SD_BUS_TYPE_VARIANT,
-                                            argType);
-                                        if (r < 0)
-                                        {
-                                            transaction->setErrorStatus(
-                                                "Unexpected Error");
-                                            return;
-                                        }
-                                        r = convertJsonToDbus(
-                                            m.get(), argType,
-                                            transaction->propertyValue);
-                                        if (r < 0)
+                                        transaction->setErrorStatus(
+                                            "Provided property value "
+                                            "is out of range for the "
+                                            "property type");
+                                    }
+                                    else
+                                    {
+                                        transaction->setErrorStatus(
+                                            "Invalid arg type");
+                                    }
+                                    return;
+                                }
+                                r = sd_bus_message_close_container(m.get());
+                                if (r < 0)
+                                {
+                                    transaction->setErrorStatus(
+                                        "Unexpected Error");
+                                    return;
+                                }
+                                crow::connections::systemBus->async_send(
+                                    m,
+                                    [transaction](
+                                        boost::system::error_code ec,
+                                        sdbusplus::message::message& m2) {
+                                        BMCWEB_LOG_DEBUG << "sent";
+                                        if (ec)
                                         {
-                                            if (r == -ERANGE)
-                                            {
-                                                transaction->setErrorStatus(
-                                                    "Provided property value "
-                                                    "is out of range for the "
-                                                    "property type");
-                                            }
-                                            else
-                                            {
-                                                transaction->setErrorStatus(
-                                                    "Invalid arg type");
-                                            }
-                                            return;
+                                            const sd_bus_error* e =
+                                                m2.get_error();
+                                            setErrorResponse(
+                                                transaction->asyncResp->res,
+                                                boost::beast::http::status::
+                                                    forbidden,
+                                                (e) ? e->name
+                                                    : ec.category().name(),
+                                                (e) ? e->message
+                                                    : ec.message());
                                         }
-                                        r = sd_bus_message_close_container(
-                                            m.get());
-                                        if (r < 0)
+                                        else
                                         {
-                                            transaction->setErrorStatus(
-                                                "Unexpected Error");
-                                            return;
+                                            transaction->asyncResp->res
+                                                .jsonValue = {
+                                                {"status", "ok"},
+                                                {"message", "200 OK"},
+                                                {"data", nullptr}};
                                         }
-                                        crow::connections::systemBus
-                                            ->async_send(
-                                                m,
-                                                [transaction](
-                                                    boost::system::error_code
-                                                        ec,
-                                                    sdbusplus::message::message&
-                                                        m2) {
-                                                    BMCWEB_LOG_DEBUG << "sent";
-                                                    if (ec)
-                                                    {
-                                                        const sd_bus_error* e =
-                                                            m2.get_error();
-                                                        setErrorResponse(
-                                                            transaction
-                                                                ->asyncResp
-                                                                ->res,
-                                                            boost::beast::http::
-                                                                status::
-                                                                    forbidden,
-                                                            (e) ? e->name
-                                                                : ec.category()
-                                                                      .name(),
-                                                            (e) ? e->message
-                                                                : ec.message());
-                                                    }
-                                                    else
-                                                    {
-                                                        transaction->asyncResp
-                                                            ->res.jsonValue = {
-                                                            {"status", "ok"},
-                                                            {"message",
-                                                             "200 OK"},
-                                                            {"data", nullptr}};
-                                                    }
-                                                });
-                                    }
-                                }
-                                propNode =
-                                    propNode->NextSiblingElement("property");
+                                    });
                             }
-                            ifaceNode =
-                                ifaceNode->NextSiblingElement("interface");
                         }
-                    },
-                    connectionName, transaction->objectPath,
-                    "org.freedesktop.DBus.Introspectable", "Introspect");
+                    });
             }
         },
         "xyz.openbmc_project.ObjectMapper",
@@ -2294,10 +2368,12 @@ inline void requestRoutes(App& app)
                 }
                 if (interfaceName.empty())
                 {
-                    crow::connections::systemBus->async_method_call(
-                        [asyncResp, processName,
-                         objectPath](const boost::system::error_code ec,
-                                     const std::string& introspectXml) {
+                    introspect(
+                        processName, objectPath,
+                        [asyncResp, processName, objectPath](
+                            const boost::system::error_code ec,
+                            const std::shared_ptr<const introspection::Node>&
+                                node) {
                             if (ec)
                             {
                                 BMCWEB_LOG_ERROR
@@ -2307,16 +2383,8 @@ inline void requestRoutes(App& app)
                                     << " path: " << objectPath << "\n";
                                 return;
                             }
-                            tinyxml2::XMLDocument doc;
-
-                            doc.Parse(introspectXml.c_str());
-                            tinyxml2::XMLNode* pRoot =
-                                doc.FirstChildElement("node");
-                            if (pRoot == nullptr)
+                            if (node == nullptr)
                             {
-                                BMCWEB_LOG_ERROR
-                                    << "XML document failed to parse "
-                                    << processName << " " << objectPath << "\n";
                                 asyncResp->res.jsonValue = {
                                     {"status", "XML parse error"}};
                                 asyncResp->res.result(
@@ -2325,7 +2393,6 @@ inline void requestRoutes(App& app)
                                 return;
                             }
 
-                            BMCWEB_LOG_DEBUG << introspectXml;
                             asyncResp->res.jsonValue = {
                                 {"status", "ok"},
                                 {"bus_name", processName},
@@ -2333,32 +2400,22 @@ inline void requestRoutes(App& app)
                             nlohmann::json& interfacesArray =
                                 asyncResp->res.jsonValue["interfaces"];
                             interfacesArray = nlohmann::json::array();
-                            tinyxml2::XMLElement* interface =
-                                pRoot->FirstChildElement("interface");
-
-                            while (interface != nullptr)
+                            for (const introspection::Interface& interface :
+                                 node->interfaces)
                             {
-                                const char* ifaceName =
-                                    interface->Attribute("name");
-                                if (ifaceName != nullptr)
-                                {
-                                    interfacesArray.push_back(
-                                        {{"name", ifaceName}});
-                                }
-
-                                interface =
-                                    interface->NextSiblingElement("interface");
+                                interfacesArray.push_back(
+                                    {{"name", interface.name}});
                             }
-                        },
-                        processName, objectPath,
-                        "org.freedesktop.DBus.Introspectable", "Introspect");
+                        });
                 }
                 else if (methodName.empty())
                 {
-                    crow::connections::systemBus->async_method_call(
-                        [asyncResp, processName, objectPath,
-                         interfaceName](const boost::system::error_code ec,
-                                        const std::string& introspectXml) {
+                    introspect(
+                        processName, objectPath,
+                        [asyncResp, processName, objectPath, interfaceName](
+                            const boost::system::error_code ec,
+                            const std::shared_ptr<const introspection::Node>&
+                                node) {
                             if (ec)
                             {
                                 BMCWEB_LOG_ERROR
@@ -2368,17 +2425,8 @@ inline void requestRoutes(App& app)
                                     << " path: " << objectPath << "\n";
                                 return;
                             }
-                            tinyxml2::XMLDocument doc;
-
-                            doc.Parse(introspectXml.data(),
-                                      introspectXml.size());
-                            tinyxml2::XMLNode* pRoot =
-                                doc.FirstChildElement("node");
-                            if (pRoot == nullptr)
+                            if (node == nullptr)
                             {
-                                BMCWEB_LOG_ERROR
-                                    << "XML document failed to parse "
-                                    << processName << " " << objectPath << "\n";
                                 asyncResp->res.result(
                                     boost::beast::http::status::
                                         internal_server_error);
@@ -2402,24 +2450,8 @@ inline void requestRoutes(App& app)
                                 asyncResp->res.jsonValue["properties"];
                             propertiesObj = nlohmann::json::object();
 
-                            // if we know we're the only call, build the
-                            // json directly
-                            tinyxml2::XMLElement* interface =
-                                pRoot->FirstChildElement("interface");
-                            while (interface != nullptr)
-                            {
-                                const char* ifaceName =
-                                    interface->Attribute("name");
-
-                                if (ifaceName != nullptr &&
-                                    ifaceName == interfaceName)
-                                {
-                                    break;
-                                }
-
-                                interface =
-                                    interface->NextSiblingElement("interface");
-                            }
+                            const introspection::Interface* interface =
+                                node->findInterface(interfaceName);
                             if (interface == nullptr)
                             {
                                 // if we got to the end of the list and
@@ -2429,126 +2461,101 @@ inline void requestRoutes(App& app)
                                 return;
                             }
 
-                            tinyxml2::XMLElement* methods =
-                                interface->FirstChildElement("method");
-                            while (methods != nullptr)
+                            for (const introspection::Member& method :
+                                 interface->methods)
                             {
                                 nlohmann::json argsArray =
                                     nlohmann::json::array();
-                                tinyxml2::XMLElement* arg =
-                                    methods->FirstChildElement("arg");
-                                while (arg != nullptr)
+                                for (const introspection::Argument& arg :
+                                     method.args)
                                 {
                                     nlohmann::json thisArg;
-                                    for (const char* fieldName :
-                                         std::array<const char*, 3>{
-                                             "name", "direction", "type"})
+                                    if (arg.name)
                                     {
-                                        const char* fieldValue =
-                                            arg->Attribute(fieldName);
-                                        if (fieldValue != nullptr)
-                                        {
-                                            thisArg[fieldName] = fieldValue;
-                                        }
+                                        thisArg["name"] = *arg.name;
+                                    }
+                                    if (arg.direction)
+                                    {
+                                        thisArg["direction"] = *arg.direction;
+                                    }
+                                    if (arg.type)
+                                    {
+                                        thisArg["type"] = *arg.type;
                                     }
                                     argsArray.push_back(std::move(thisArg));
-                                    arg = arg->NextSiblingElement("arg");
                                 }
 
-                                const char* name = methods->Attribute("name");
-                                if (name != nullptr)
-                                {
-                                    std::string uri;
-                                    uri.reserve(14 + processName.size() +
-                                                objectPath.size() +
-                                                interfaceName.size() +
-                                                strlen(name));
-                                    uri += "/bus/system/";
-                                    uri += processName;
-                                    uri += objectPath;
-                                    uri += "/";
-                                    uri += interfaceName;
-                                    uri += "/";
-                                    uri += name;
-                                    methodsArray.push_back(
-                                        {{"name", name},
-                                         {"uri", std::move(uri)},
-                                         {"args", argsArray}});
-                                }
-                                methods = methods->NextSiblingElement("method");
+                                std::string uri;
+                                uri.reserve(14 + processName.size() +
+                                            objectPath.size() +
+                                            interfaceName.size() +
+                                            method.name.size());
+                                uri += "/bus/system/";
+                                uri += processName;
+                                uri += objectPath;
+                                uri += "/";
+                                uri += interfaceName;
+                                uri += "/";
+                                uri += method.name;
+                                methodsArray.push_back(
+                                    {{"name", method.name},
+                                     {"uri", std::move(uri)},
+                                     {"args", argsArray}});
                             }
-                            tinyxml2::XMLElement* signals =
-                                interface->FirstChildElement("signal");
-                            while (signals != nullptr)
+                            for (const introspection::Member& signalMember :
+                                 interface->signals)
                             {
                                 nlohmann::json argsArray =
                                     nlohmann::json::array();
-
-                                tinyxml2::XMLElement* arg =
-                                    signals->FirstChildElement("arg");
-                                while (arg != nullptr)
+                                for (const introspection::Argument& arg :
+                                     signalMember.args)
                                 {
-                                    const char* name = arg->Attribute("name");
-                                    const char* type = arg->Attribute("type");
-                                    if (name != nullptr && type != nullptr)
+                                    if (arg.name && arg.type)
                                     {
                                         argsArray.push_back({
-                                            {"name", name},
-                                            {"type", type},
+                                            {"name", *arg.name},
+                                            {"type", *arg.type},
                                         });
                                     }
-                                    arg = arg->NextSiblingElement("arg");
-                                }
-                                const char* name = signals->Attribute("name");
-                                if (name != nullptr)
-                                {
-                                    signalsArray.push_back(
-                                        {{"name", name}, {"args", argsArray}});
                                 }
-
-                                signals = signals->NextSiblingElement("signal");
+                                signalsArray.push_back(
+                                    {{"name", signalMember.name},
+                                     {"args", argsArray}});
                             }
 
-                            tinyxml2::XMLElement* property =
-                                interface->FirstChildElement("property");
-                            while (property != nullptr)
+                            for (const introspection::Property& property :
+                                 interface->properties)
                             {
-                                const char* name = property->Attribute("name");
-                                const char* type = property->Attribute("type");
-                                if (type != nullptr && name != nullptr)
+                                if (property.type.empty())
                                 {
-                                    sdbusplus::message::message m =
-                                        crow::connections::systemBus
-                                            ->new_method_call(
-                                                processName.c_str(),
-                                                objectPath.c_str(),
-                                                "org.freedesktop."
-                                                "DBus."
-                                                "Properties",
-                                                "Get");
-                                    m.append(interfaceName, name);
-                                    nlohmann::json& propertyItem =
-                                        propertiesObj[name];
-                                    crow::connections::systemBus->async_send(
-                                        m,
-                                        [&propertyItem, asyncResp](
-                                            boost::system::error_code& e,
-                                            sdbusplus::message::message& msg) {
-                                            if (e)
-                                            {
-                                                return;
-                                            }
-
-                                            convertDBusToJSON("v", msg,
-                                                              propertyItem);
-                                        });
+                                    continue;
                                 }
-                                property =
-                                    property->NextSiblingElement("property");
+                                sdbusplus::message::message m =
+                                    crow::connections::systemBus
+                                        ->new_method_call(
+                                            processName.c_str(),
+                                            objectPath.c_str(),
+                                            "org.freedesktop."
+                                            "DBus."
+                                            "Properties",
+                                            "Get");
+                                m.append(interfaceName, property.name);
+                                nlohmann::json& propertyItem =
+                                    propertiesObj[property.name];
+                                crow::connections::systemBus->async_send(
+                                    m, [&propertyItem, asyncResp](
+                                           boost::system::error_code& e,
+                                           sdbusplus::message::message& msg) {
+                                        if (e)
+                                        {
+                                            return;
+                                        }
+
+                                        convertDBusToJSON("v", msg,
+                                                          propertyItem);
+                                    });
                             }
-                        },
-                        processName, objectPath,
-                        "org.freedesktop.DBus.Introspectable", "Introspect");
+                        });
                 }
                 else
                 {
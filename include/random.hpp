@@ -2,6 +2,9 @@
 
 #include <openssl/rand.h>
 
+#include <iostream>
+#include <limits>
+
 namespace bmcweb
 {
 
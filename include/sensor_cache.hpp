@@ -0,0 +1,425 @@
+#pragma once
+
+#include "logging.hpp"
+
+#include <boost/asio/post.hpp>
+#include <boost/container/flat_map.hpp>
+#include <boost/system/error_code.hpp>
+#include <dbus_single_flight.hpp>
+#include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+#include <stats.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace crow
+{
+namespace sensor_cache
+{
+
+using SensorVariant =
+    std::variant<int64_t, double, uint32_t, bool, std::string>;
+
+using SensorProperties = boost::container::flat_map<std::string, SensorVariant>;
+
+using SensorInterfaces =
+    boost::container::flat_map<std::string, SensorProperties>;
+
+using ManagedObjects =
+    std::vector<std::pair<sdbusplus::message::object_path, SensorInterfaces>>;
+
+constexpr std::string_view sensorsPath = "/xyz/openbmc_project/sensors/";
+
+// The interfaces the sensor handlers read.  Only these are cached.
+constexpr std::array<std::string_view, 5> cachedInterfaces = {
+    "xyz.openbmc_project.Sensor.Value",
+    "xyz.openbmc_project.Sensor.Threshold.Warning",
+    "xyz.openbmc_project.Sensor.Threshold.Critical",
+    "xyz.openbmc_project.State.Decorator.OperationalStatus",
+    "xyz.openbmc_project.State.Decorator.Availability"};
+
+// Sensor daemons emit PropertiesChanged for every update, so an entry is
+// current for as long as signals keep arriving.  It is fetched again after
+// this long anyway, in case a daemon updated a value without a signal.
+constexpr std::chrono::seconds sensorCacheMaxAge{60};
+
+inline bool isCachedInterface(std::string_view interface)
+{
+    return std::find(cachedInterfaces.begin(), cachedInterfaces.end(),
+                     interface) != cachedInterfaces.end();
+}
+
+/**
+ * SensorCache
+ * The sensor properties of each service, as its ObjectManager's
+ * GetManagedObjects would return them, kept current from PropertiesChanged
+ * signals.  An entry is keyed by service and ObjectManager path, and holds
+ * only the objects under /xyz/openbmc_project/sensors and only the
+ * interfaces in cachedInterfaces.  Objects are indexed by path, so that a
+ * signal finds what it updates without visiting every entry.
+ */
+class SensorCache
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        ManagedObjects objects;
+        // When the entry was fetched from the service
+        Clock::time_point populated;
+        // When a signal last changed the entry
+        Clock::time_point updated;
+    };
+
+    static SensorCache& getInstance()
+    {
+        static SensorCache cache;
+        return cache;
+    }
+
+    // Incremented whenever entries are dropped.  Read before fetching an
+    // entry and pass to store().
+    uint64_t getEpoch() const
+    {
+        return epoch;
+    }
+
+    // Stores what GetManagedObjects returned, unless entries were dropped
+    // after the fetch started, as the result may then predate the change.
+    // Signals from the service itself need no such check: they reach us in
+    // the order the service sent them, relative to its reply.
+    bool store(const std::string& connection, const std::string& objectManager,
+               const ManagedObjects& objects, uint64_t fetchEpoch,
+               Clock::time_point now)
+    {
+        if (fetchEpoch != epoch)
+        {
+            return false;
+        }
+        auto entryIt = entries.try_emplace({connection, objectManager}).first;
+        unindexEntry(entryIt);
+        Entry& entry = entryIt->second;
+        entry.objects.clear();
+        for (const auto& [path, interfaces] : objects)
+        {
+            if (!path.str.starts_with(sensorsPath))
+            {
+                continue;
+            }
+            SensorInterfaces kept;
+            for (const auto& [interface, properties] : interfaces)
+            {
+                if (isCachedInterface(interface))
+                {
+                    kept.emplace(interface, properties);
+                }
+            }
+            pathIndex[path.str].emplace_back(entryIt, entry.objects.size());
+            entry.objects.emplace_back(path, std::move(kept));
+        }
+        entry.populated = now;
+        entry.updated = now;
+        return true;
+    }
+
+    // The entry for a service, or nullptr if it isn't cached or is older
+    // than sensorCacheMaxAge
+    const Entry* find(const std::string& connection,
+                      const std::string& objectManager,
+                      Clock::time_point now) const
+    {
+        auto it = entries.find({connection, objectManager});
+        if (it == entries.end() ||
+            now - it->second.populated >= sensorCacheMaxAge)
+        {
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    // Applies a PropertiesChanged signal.  An interface is provided by a
+    // single service, so this updates whichever entry has the object.
+    // Properties that were invalidated rather than sent, or whose type
+    // couldn't be stored, drop the entry, so the next request fetches it.
+    void updateProperties(const std::string& path, const std::string& interface,
+                          const SensorProperties& changed, bool complete,
+                          Clock::time_point now)
+    {
+        auto indexed = pathIndex.find(path);
+        if (indexed == pathIndex.end())
+        {
+            return;
+        }
+        // Dropping an entry changes the index
+        std::vector<ObjectRef> objectRefs = indexed->second;
+        for (const auto& [entryIt, objectIndex] : objectRefs)
+        {
+            SensorInterfaces& interfaces =
+                entryIt->second.objects[objectIndex].second;
+            auto properties = interfaces.find(interface);
+            if (properties == interfaces.end())
+            {
+                continue;
+            }
+            if (!complete)
+            {
+                BMCWEB_LOG_DEBUG << "Sensor cache dropping "
+                                 << entryIt->first.first << " for " << path;
+                eraseEntry(entryIt);
+                epoch++;
+                continue;
+            }
+            for (const auto& [name, value] : changed)
+            {
+                properties->second[name] = value;
+            }
+            entryIt->second.updated = now;
+        }
+    }
+
+    // Drops every entry, for when sensors are added or removed
+    void invalidate()
+    {
+        entries.clear();
+        pathIndex.clear();
+        epoch++;
+    }
+
+    void removeService(const std::string& connection)
+    {
+        auto it = entries.lower_bound({connection, std::string()});
+        while (it != entries.end() && it->first.first == connection)
+        {
+            it = eraseEntry(it);
+        }
+        epoch++;
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    // Nothing is stored or served until the signals that keep the cache
+    // current are matched
+    bool isEnabled() const
+    {
+        return enabled;
+    }
+
+    void enable()
+    {
+        enabled = true;
+    }
+
+    SensorCache() = default;
+    ~SensorCache() = default;
+    SensorCache(const SensorCache&) = delete;
+    SensorCache& operator=(const SensorCache&) = delete;
+    SensorCache(SensorCache&&) = delete;
+    SensorCache& operator=(SensorCache&&) = delete;
+
+  private:
+    using EntryMap = std::map<std::pair<std::string, std::string>, Entry>;
+    // An entry, and the position of an object in its objects
+    using ObjectRef = std::pair<EntryMap::iterator, size_t>;
+
+    void unindexEntry(EntryMap::iterator entryIt)
+    {
+        for (const auto& [path, interfaces] : entryIt->second.objects)
+        {
+            auto indexed = pathIndex.find(path.str);
+            if (indexed == pathIndex.end())
+            {
+                continue;
+            }
+            std::erase_if(indexed->second, [entryIt](const ObjectRef& ref) {
+                return ref.first == entryIt;
+            });
+            if (indexed->second.empty())
+            {
+                pathIndex.erase(indexed);
+            }
+        }
+    }
+
+    EntryMap::iterator eraseEntry(EntryMap::iterator entryIt)
+    {
+        unindexEntry(entryIt);
+        return entries.erase(entryIt);
+    }
+
+    EntryMap entries;
+    // Object path to the entries holding it
+    std::map<std::string, std::vector<ObjectRef>, std::less<>> pathIndex;
+    uint64_t epoch = 0;
+    bool enabled = false;
+};
+
+/**
+ * GetManagedObjects on a sensor service's ObjectManager, answered from the
+ * cache when it holds the service and from the service otherwise.  Only
+ * sensor objects and the cached interfaces are returned from the cache, so
+ * callers must not look for anything else.  callback is called as it would
+ * be by async_method_call, and never before this returns.
+ */
+template <typename Callback>
+inline void getManagedObjects(const std::string& connection,
+                              const std::string& objectManager,
+                              Callback&& callback)
+{
+    SensorCache& cache = SensorCache::getInstance();
+    const SensorCache::Entry* entry =
+        cache.isEnabled()
+            ? cache.find(connection, objectManager, SensorCache::Clock::now())
+            : nullptr;
+    if (entry != nullptr)
+    {
+        bmcweb::stats::increment("sensor_cache.hits");
+        boost::asio::post(crow::connections::systemBus->get_io_context(),
+                          [callback{std::forward<Callback>(callback)},
+                           objects{entry->objects}]() mutable {
+                              callback(boost::system::error_code(), objects);
+                          });
+        return;
+    }
+    bmcweb::stats::increment("sensor_cache.misses");
+    // Requests that miss together share one fetch, and the first of them to
+    // get the reply stores it
+    crow::single_flight::asyncMethodCall<ManagedObjects>(
+        [callback{std::forward<Callback>(callback)}, connection, objectManager,
+         fetchEpoch{cache.getEpoch()}](const boost::system::error_code ec,
+                                       const ManagedObjects& objects) mutable {
+            SensorCache& cache = SensorCache::getInstance();
+            SensorCache::Clock::time_point now = SensorCache::Clock::now();
+            if (!ec && cache.isEnabled() &&
+                cache.find(connection, objectManager, now) == nullptr)
+            {
+                cache.store(connection, objectManager, objects, fetchEpoch,
+                            now);
+            }
+            callback(ec, objects);
+        },
+        connection, objectManager, "org.freedesktop.DBus.ObjectManager",
+        "GetManagedObjects");
+}
+
+static std::unique_ptr<sdbusplus::bus::match::match> sensorPropertiesMonitor;
+static std::unique_ptr<sdbusplus::bus::match::match> decoratorPropertiesMonitor;
+static std::unique_ptr<sdbusplus::bus::match::match> interfacesAddedMonitor;
+static std::unique_ptr<sdbusplus::bus::match::match> interfacesRemovedMonitor;
+static std::unique_ptr<sdbusplus::bus::match::match> nameOwnerMonitor;
+
+inline void onPropertiesChanged(sdbusplus::message::message& message)
+{
+    std::string interface;
+    dbus::utility::DBusPropertiesMap changed;
+    std::vector<std::string> invalidated;
+    message.read(interface, changed, invalidated);
+    if (!isCachedInterface(interface))
+    {
+        return;
+    }
+
+    bool complete = invalidated.empty();
+    SensorProperties properties;
+    for (const auto& [name, value] : changed)
+    {
+        std::visit(
+            [&properties, &complete, &name](const auto& v) {
+                using T = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<T, int64_t> ||
+                              std::is_same_v<T, double> ||
+                              std::is_same_v<T, uint32_t> ||
+                              std::is_same_v<T, bool> ||
+                              std::is_same_v<T, std::string>)
+                {
+                    properties.emplace(name, v);
+                }
+                else
+                {
+                    complete = false;
+                }
+            },
+            value);
+    }
+    SensorCache::getInstance().updateProperties(
+        message.get_path(), interface, properties, complete,
+        SensorCache::Clock::now());
+}
+
+inline void onInterfacesChanged(sdbusplus::message::message& /*message*/)
+{
+    BMCWEB_LOG_DEBUG << "Sensor cache dropped, sensors changed";
+    SensorCache::getInstance().invalidate();
+}
+
+inline void onNameOwnerChanged(sdbusplus::message::message& message)
+{
+    std::string name;
+    std::string oldOwner;
+    std::string newOwner;
+    message.read(name, oldOwner, newOwner);
+    if (!name.starts_with(':') && !oldOwner.empty())
+    {
+        SensorCache::getInstance().removeService(name);
+    }
+}
+
+// Starts caching sensor properties.  The signals are matched first, so that
+// nothing fetched after this can miss an update.
+inline void registerSensorCache()
+{
+    BMCWEB_LOG_INFO << "Register sensor property cache";
+    sdbusplus::bus::bus& bus =
+        static_cast<sdbusplus::bus::bus&>(*crow::connections::systemBus);
+    sensorPropertiesMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',interface='org.freedesktop.DBus.Properties',"
+        "member='PropertiesChanged',"
+        "path_namespace='/xyz/openbmc_project/sensors',"
+        "arg0namespace='xyz.openbmc_project.Sensor'",
+        onPropertiesChanged);
+    decoratorPropertiesMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',interface='org.freedesktop.DBus.Properties',"
+        "member='PropertiesChanged',"
+        "path_namespace='/xyz/openbmc_project/sensors',"
+        "arg0namespace='xyz.openbmc_project.State.Decorator'",
+        onPropertiesChanged);
+    interfacesAddedMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+        "member='InterfacesAdded',"
+        "arg0path='/xyz/openbmc_project/sensors/'",
+        onInterfacesChanged);
+    interfacesRemovedMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+        "member='InterfacesRemoved',"
+        "arg0path='/xyz/openbmc_project/sensors/'",
+        onInterfacesChanged);
+    nameOwnerMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',sender='org.freedesktop.DBus',"
+        "interface='org.freedesktop.DBus',member='NameOwnerChanged'",
+        onNameOwnerChanged);
+    SensorCache::getInstance().enable();
+}
+
+} // namespace sensor_cache
+} // namespace crow
@@ -12,8 +12,11 @@
 
 #include <boost/asio/ssl/context.hpp>
 #include <random.hpp>
+#include <tls_session_cache.hpp>
 
 #include <random>
+#include <string>
+#include <string_view>
 
 namespace ensuressl
 {
@@ -419,6 +422,34 @@ inline void ensureOpensslKeyPresentAndValid(const std::string& filepath)
     }
 }
 
+#ifdef BMCWEB_ENABLE_HTTP2
+inline int alpnSelectProtoCallback(SSL* /*unused*/, const unsigned char** out,
+                                   unsigned char* outlen,
+                                   const unsigned char* in, unsigned int inlen,
+                                   void* /*unused*/)
+{
+    // Prefer HTTP/2, falling back to HTTP/1.1 for clients that don't offer it
+    for (std::string_view proto : {"h2", "http/1.1"})
+    {
+        std::string wire(1, static_cast<char>(proto.size()));
+        wire += proto;
+        unsigned char* selected = nullptr;
+        // The match is returned as a pointer into the first list, so pass
+        // the client's list there, as it outlives this callback
+        int rv = SSL_select_next_proto(
+            &selected, outlen, in, inlen,
+            reinterpret_cast<const unsigned char*>(wire.data()),
+            static_cast<unsigned int>(wire.size()));
+        if (rv == OPENSSL_NPN_NEGOTIATED)
+        {
+            *out = selected;
+            return SSL_TLSEXT_ERR_OK;
+        }
+    }
+    return SSL_TLSEXT_ERR_NOACK;
+}
+#endif
+
 inline std::shared_ptr<boost::asio::ssl::context>
     getSslContext(const std::string& sslPemFile)
 {
@@ -471,6 +502,12 @@ inline std::shared_ptr<boost::asio::ssl::context>
     {
         BMCWEB_LOG_ERROR << "Error setting cipher list\n";
     }
+
+    configureSessionResumption(mSslContext->native_handle());
+#ifdef BMCWEB_ENABLE_HTTP2
+    SSL_CTX_set_alpn_select_cb(mSslContext->native_handle(),
+                               alpnSelectProtoCallback, nullptr);
+#endif
     return mSslContext;
 }
 } // namespace ensuressl
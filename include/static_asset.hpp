@@ -0,0 +1,173 @@
+#pragma once
+
+#include "bmcweb_config.h"
+
+#include "logging.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gzip_helper.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace crow
+{
+namespace webassets
+{
+
+/**
+ * MappedFile
+ * A file mapped read only for as long as the object lives.  The web UI files
+ * are on a read only filesystem, so they can be mapped once at startup and
+ * served straight from the page cache.
+ */
+class MappedFile
+{
+  public:
+    // Returns nullptr if the file can't be opened or mapped
+    static std::unique_ptr<MappedFile> map(const std::filesystem::path& path)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            BMCWEB_LOG_ERROR << "Failed to open " << path;
+            return nullptr;
+        }
+        struct stat st = {};
+        if (fstat(fd, &st) != 0)
+        {
+            BMCWEB_LOG_ERROR << "Failed to stat " << path;
+            close(fd);
+            return nullptr;
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        void* addr = nullptr;
+        if (size > 0)
+        {
+            addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        // The mapping stays valid without the descriptor
+        close(fd);
+        if (addr == MAP_FAILED)
+        {
+            BMCWEB_LOG_ERROR << "Failed to map " << path;
+            return nullptr;
+        }
+        return std::unique_ptr<MappedFile>(new MappedFile(addr, size));
+    }
+
+    std::string_view data() const
+    {
+        if (addr == nullptr)
+        {
+            return {};
+        }
+        return {static_cast<const char*>(addr), size};
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    ~MappedFile()
+    {
+        if (addr != nullptr)
+        {
+            munmap(addr, size);
+        }
+    }
+
+  private:
+    MappedFile(void* addrIn, size_t sizeIn) : addr(addrIn), size(sizeIn)
+    {}
+
+    void* addr;
+    size_t size;
+};
+
+// Bundlers put a hash of the content in the names of files that can be
+// cached forever, as in app.0a1b2c3d.js.  Looks for a part between two dots
+// that is at least 8 hex digits.
+inline bool hasContentHash(std::string_view filename)
+{
+    size_t start = filename.find('.');
+    while (start != std::string_view::npos)
+    {
+        size_t end = filename.find('.', start + 1);
+        if (end == std::string_view::npos)
+        {
+            // The extension
+            break;
+        }
+        std::string_view part = filename.substr(start + 1, end - start - 1);
+        if (part.size() >= 8 &&
+            std::all_of(part.begin(), part.end(), [](char c) {
+                return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+            }))
+        {
+            return true;
+        }
+        start = end;
+    }
+    return false;
+}
+
+/**
+ * StaticAsset
+ * One file served by the web UI routes, in its identity and gzip forms.
+ * Either may be missing: a file.gz without file is only served compressed,
+ * and a file without file.gz is compressed on first use if it is text.
+ */
+class StaticAsset
+{
+  public:
+    std::unique_ptr<MappedFile> identity;
+    std::unique_ptr<MappedFile> gzipFile;
+    const char* contentType = nullptr;
+    // Quoted entity tag for the identity form, or the gzip form if that is
+    // all there is
+    std::string etag;
+    bool compressible = false;
+    bool immutable = false;
+
+    // Returns the gzip form, or an empty view if there is none
+    std::string_view gzip()
+    {
+        if (gzipFile != nullptr)
+        {
+            return gzipFile->data();
+        }
+        if (!gzipGenerated)
+        {
+            gzipGenerated.emplace();
+            if (compressible && identity != nullptr &&
+                identity->data().size() >= compressionThreshold &&
+                bmcwebHttpCompressionLevel != 0)
+            {
+                DeflateEncoder encoder(true, bmcwebHttpCompressionLevel);
+                if (!encoder.write(identity->data(), *gzipGenerated, true))
+                {
+                    BMCWEB_LOG_ERROR << "Failed to compress static asset";
+                    gzipGenerated->clear();
+                }
+            }
+        }
+        return *gzipGenerated;
+    }
+
+  private:
+    std::optional<std::string> gzipGenerated;
+};
+
+} // namespace webassets
+} // namespace crow
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace bmcweb
+{
+
+namespace stats
+{
+
+/**
+ * Registry
+ * Named, monotonically increasing counters used to measure the effect of the
+ * various caches and encodings in the webserver.  Counters are only touched
+ * from the io_context thread, so no locking is done.  References returned by
+ * counter() stay valid for the life of the process.
+ */
+class Registry
+{
+  public:
+    static Registry& getInstance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    uint64_t& counter(std::string_view name)
+    {
+        auto it = counters.find(name);
+        if (it == counters.end())
+        {
+            it = counters.emplace(std::string(name), 0U).first;
+        }
+        return it->second;
+    }
+
+    const std::map<std::string, uint64_t, std::less<>>& getCounters() const
+    {
+        return counters;
+    }
+
+    Registry(const Registry&) = delete;
+    Registry(Registry&&) = delete;
+    Registry& operator=(const Registry&) = delete;
+    Registry& operator=(Registry&&) = delete;
+
+  private:
+    Registry() = default;
+    ~Registry() = default;
+
+    std::map<std::string, uint64_t, std::less<>> counters;
+};
+
+inline void increment(std::string_view name, uint64_t value = 1)
+{
+    Registry::getInstance().counter(name) += value;
+}
+
+} // namespace stats
+} // namespace bmcweb
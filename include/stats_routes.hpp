@@ -0,0 +1,30 @@
+#pragma once
+
+#include <app.hpp>
+#include <stats.hpp>
+
+namespace crow
+{
+
+namespace stats_routes
+{
+
+inline void requestRoutes(App& app)
+{
+    BMCWEB_ROUTE(app, "/bmcweb/stats")
+        .privileges({{"ConfigureManager"}})
+        .methods(boost::beast::http::verb::get)(
+            [](const crow::Request&,
+               const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                nlohmann::json& counters = asyncResp->res.jsonValue;
+                counters = nlohmann::json::object();
+                for (const auto& [name, value] :
+                     bmcweb::stats::Registry::getInstance().getCounters())
+                {
+                    counters[name] = value;
+                }
+            });
+}
+
+} // namespace stats_routes
+} // namespace crow
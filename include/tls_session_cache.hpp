@@ -0,0 +1,270 @@
+#pragma once
+
+#include "bmcweb_config.h"
+
+#include "logging.hpp"
+
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/ssl.h>
+#include <stats.hpp>
+
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000L)
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#else
+#include <openssl/hmac.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace ensuressl
+{
+
+// Sessions are only resumed by SSL objects sharing the same id context
+constexpr std::string_view tlsSessionIdContext = "bmcweb";
+
+// Length of the key name that prefixes every ticket, fixed by OpenSSL
+constexpr size_t ticketKeyNameSize = 16;
+
+struct TicketKey
+{
+    std::array<unsigned char, ticketKeyNameSize> name{};
+    std::array<unsigned char, 32> hmacKey{};
+    std::array<unsigned char, 32> aesKey{};
+    std::chrono::steady_clock::time_point created;
+};
+
+/**
+ * TicketKeyRing
+ * Keys used to encrypt TLS session tickets.  New tickets are issued under the
+ * current key, which is replaced once it is older than the configured
+ * lifetime.  Tickets under the previous key are still accepted until it is
+ * two lifetimes old, and the client is handed a new ticket under the current
+ * key.  Keys are random and only kept in memory, so a restart invalidates
+ * every outstanding ticket.
+ */
+class TicketKeyRing
+{
+  public:
+    explicit TicketKeyRing(std::chrono::seconds lifetimeIn) :
+        lifetime(lifetimeIn)
+    {}
+
+    static TicketKeyRing& getInstance()
+    {
+        static TicketKeyRing ring{
+            std::chrono::minutes(bmcwebTlsTicketKeyLifetimeMinutes)};
+        return ring;
+    }
+
+    // Returns the key to issue new tickets under, rotating first if the
+    // current key has expired.  Returns nullptr if no key could be generated.
+    const TicketKey* currentKey(std::chrono::steady_clock::time_point now)
+    {
+        if (!current || now - current->created >= lifetime)
+        {
+            rotate(now);
+        }
+        if (!current)
+        {
+            return nullptr;
+        }
+        return &*current;
+    }
+
+    // Returns the key a ticket was issued under, or nullptr if that key is
+    // unknown or too old to accept
+    const TicketKey*
+        findKey(std::span<const unsigned char, ticketKeyNameSize> name,
+                std::chrono::steady_clock::time_point now) const
+    {
+        for (const std::optional<TicketKey>* key : {&current, &previous})
+        {
+            if (!*key || now - (*key)->created >= 2 * lifetime)
+            {
+                continue;
+            }
+            if (std::equal(name.begin(), name.end(), (*key)->name.begin()))
+            {
+                return &**key;
+            }
+        }
+        return nullptr;
+    }
+
+    bool isCurrent(const TicketKey& key) const
+    {
+        return current && &*current == &key;
+    }
+
+    void rotate(std::chrono::steady_clock::time_point now)
+    {
+        TicketKey key;
+        key.created = now;
+        if (RAND_bytes(key.name.data(), static_cast<int>(key.name.size())) !=
+                1 ||
+            RAND_bytes(key.hmacKey.data(),
+                       static_cast<int>(key.hmacKey.size())) != 1 ||
+            RAND_bytes(key.aesKey.data(),
+                       static_cast<int>(key.aesKey.size())) != 1)
+        {
+            BMCWEB_LOG_ERROR << "Failed to generate TLS ticket key";
+            return;
+        }
+        previous = std::move(current);
+        current = key;
+        bmcweb::stats::increment("tls.ticket_keys.rotations");
+    }
+
+  private:
+    std::chrono::seconds lifetime;
+    std::optional<TicketKey> current;
+    std::optional<TicketKey> previous;
+};
+
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000L)
+using TicketMacCtx = EVP_MAC_CTX;
+
+inline bool initTicketMac(EVP_MAC_CTX* macCtx, const TicketKey& key)
+{
+    std::array<char, 7> digest = {"SHA256"};
+    std::array<OSSL_PARAM, 3> params = {
+        OSSL_PARAM_construct_octet_string(
+            OSSL_MAC_PARAM_KEY, const_cast<unsigned char*>(key.hmacKey.data()),
+            key.hmacKey.size()),
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest.data(),
+                                         0),
+        OSSL_PARAM_construct_end()};
+    return EVP_MAC_CTX_set_params(macCtx, params.data()) == 1;
+}
+#else
+using TicketMacCtx = HMAC_CTX;
+
+inline bool initTicketMac(HMAC_CTX* macCtx, const TicketKey& key)
+{
+    return HMAC_Init_ex(macCtx, key.hmacKey.data(),
+                        static_cast<int>(key.hmacKey.size()), EVP_sha256(),
+                        nullptr) == 1;
+}
+#endif
+
+// Called by OpenSSL to set up the cipher and MAC used to seal (enc == 1) or
+// open (enc == 0) a session ticket.  The return values follow
+// SSL_CTX_set_tlsext_ticket_key_cb.
+inline int ticketKeyCallback(SSL* /*ssl*/, unsigned char* keyName,
+                             unsigned char* iv, EVP_CIPHER_CTX* cipherCtx,
+                             TicketMacCtx* macCtx, int enc)
+{
+    TicketKeyRing& ring = TicketKeyRing::getInstance();
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+    const EVP_CIPHER* cipher = EVP_aes_256_cbc();
+
+    if (enc == 1)
+    {
+        const TicketKey* key = ring.currentKey(now);
+        if (key == nullptr)
+        {
+            // Don't issue a ticket
+            return 0;
+        }
+        if (RAND_bytes(iv, EVP_CIPHER_iv_length(cipher)) != 1)
+        {
+            return -1;
+        }
+        std::copy(key->name.begin(), key->name.end(), keyName);
+        if (EVP_EncryptInit_ex(cipherCtx, cipher, nullptr, key->aesKey.data(),
+                               iv) != 1 ||
+            !initTicketMac(macCtx, *key))
+        {
+            return -1;
+        }
+        bmcweb::stats::increment("tls.tickets.issued");
+        return 1;
+    }
+
+    const TicketKey* key = ring.findKey(
+        std::span<const unsigned char, ticketKeyNameSize>(keyName,
+                                                          ticketKeyNameSize),
+        now);
+    if (key == nullptr)
+    {
+        // Falls back to a full handshake
+        bmcweb::stats::increment("tls.tickets.unknown_key");
+        return 0;
+    }
+    if (EVP_DecryptInit_ex(cipherCtx, cipher, nullptr, key->aesKey.data(),
+                           iv) != 1 ||
+        !initTicketMac(macCtx, *key))
+    {
+        return -1;
+    }
+    if (!ring.isCurrent(*key))
+    {
+        // Accept the ticket, but have OpenSSL issue a new one under the
+        // current key
+        bmcweb::stats::increment("tls.tickets.renewed");
+        return 2;
+    }
+    return 1;
+}
+
+// OpenSSL drops the session of a connection that is freed without a TLS
+// shutdown from the session cache, and connections are closed without
+// sending close_notify.  Call before closing the socket of a connection that
+// completed its handshake, so the session can still be resumed.
+inline void keepSessionResumable(SSL* ssl)
+{
+    if (SSL_is_init_finished(ssl) == 1)
+    {
+        SSL_set_shutdown(ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    }
+}
+
+/**
+ * Enables TLS session resumption on a server context, so that clients that
+ * reconnect can skip the full key exchange.  Resumption works through a
+ * bounded in-memory session cache, and through session tickets sealed with
+ * the keys in TicketKeyRing.  Either one can be turned off by setting its
+ * build option to 0.
+ */
+inline void configureSessionResumption(SSL_CTX* ctx)
+{
+    if (SSL_CTX_set_session_id_context(
+            ctx,
+            reinterpret_cast<const unsigned char*>(tlsSessionIdContext.data()),
+            static_cast<unsigned int>(tlsSessionIdContext.size())) != 1)
+    {
+        BMCWEB_LOG_ERROR << "Error setting TLS session id context";
+    }
+
+    if (bmcwebTlsSessionCacheSize == 0)
+    {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+    }
+    else
+    {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_sess_set_cache_size(
+            ctx, static_cast<long>(bmcwebTlsSessionCacheSize));
+    }
+
+    if (bmcwebTlsTicketKeyLifetimeMinutes == 0)
+    {
+        SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+        return;
+    }
+#if (OPENSSL_VERSION_NUMBER >= 0x30000000L)
+    SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, ticketKeyCallback);
+#else
+    SSL_CTX_set_tlsext_ticket_key_cb(ctx, ticketKeyCallback);
+#endif
+}
+
+} // namespace ensuressl
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "logging.hpp"
+
+#include <boost/container/flat_map.hpp>
+#include <credential_cache.hpp>
+#include <dbus_singleton.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+#include <sdbusplus/message/types.hpp>
+#include <stats.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace crow
+{
+namespace user_info
+{
+
+using UserInfoMap =
+    std::map<std::string,
+             std::variant<bool, std::string, std::vector<std::string>>>;
+
+// Entries are refetched after this long even if no signal invalidated them,
+// in case a change was made without one
+constexpr std::chrono::seconds userInfoCacheTtl{60};
+
+// Remote (LDAP) users are not bounded by the local user limit
+constexpr size_t userInfoCacheMaxEntries = 64;
+
+constexpr std::string_view userObjectPath = "/xyz/openbmc_project/user";
+
+// Returns the user a /xyz/openbmc_project/user/<name> path refers to, or an
+// empty string for any other path
+inline std::string_view userNameFromObjectPath(std::string_view objectPath)
+{
+    if (!objectPath.starts_with(userObjectPath))
+    {
+        return {};
+    }
+    std::string_view name = objectPath.substr(userObjectPath.size());
+    if (!name.starts_with('/'))
+    {
+        return {};
+    }
+    name.remove_prefix(1);
+    if (name == "ldap" || name.find('/') != std::string_view::npos)
+    {
+        return {};
+    }
+    return name;
+}
+
+/**
+ * UserInfoCache
+ * GetUserInfo results keyed by username, so that authenticated requests
+ * don't each need a round trip to the user manager before dispatch.
+ * Entries are dropped as soon as the user manager signals a change under
+ * /xyz/openbmc_project/user, with a TTL as a fallback.
+ */
+class UserInfoCache
+{
+  public:
+    static UserInfoCache& getInstance()
+    {
+        static UserInfoCache cache;
+        return cache;
+    }
+
+    // Returns the cached info for username, or nullptr on a miss
+    const UserInfoMap* find(std::string_view username,
+                            std::chrono::steady_clock::time_point now)
+    {
+        auto it = entries.find(username);
+        if (it == entries.end() || now - it->second.fetched >= ttl)
+        {
+            bmcweb::stats::increment("user_info_cache.misses");
+            return nullptr;
+        }
+        bmcweb::stats::increment("user_info_cache.hits");
+        return &it->second.info;
+    }
+
+    // Stores a fetched result, unless the cache was invalidated while the
+    // fetch was in flight, as the result may then be stale
+    void insert(const std::string& username, const UserInfoMap& info,
+                std::chrono::steady_clock::time_point now,
+                uint64_t fetchGeneration)
+    {
+        if (fetchGeneration != generation)
+        {
+            return;
+        }
+        if (entries.size() >= maxEntries &&
+            entries.find(username) == entries.end())
+        {
+            evict(now);
+        }
+        entries.insert_or_assign(username, Entry{info, now});
+    }
+
+    // Incremented on every invalidation.  Read before starting a fetch and
+    // pass to insert().
+    uint64_t getGeneration() const
+    {
+        return generation;
+    }
+
+    // Drops whatever a change to the given object may have affected.  User
+    // objects only affect their own user, while anything else, such as LDAP
+    // role mappings or the manager itself, may affect every user.
+    void invalidate(std::string_view objectPath)
+    {
+        generation++;
+        bmcweb::stats::increment("user_info_cache.invalidations");
+
+        std::string_view name = userNameFromObjectPath(objectPath);
+        if (name.empty())
+        {
+            entries.clear();
+            return;
+        }
+        auto it = entries.find(name);
+        if (it != entries.end())
+        {
+            entries.erase(it);
+        }
+    }
+
+    void clear()
+    {
+        generation++;
+        entries.clear();
+    }
+
+    UserInfoCache(std::chrono::seconds ttlIn, size_t maxEntriesIn) :
+        ttl(ttlIn), maxEntries(maxEntriesIn)
+    {}
+
+    UserInfoCache(const UserInfoCache&) = delete;
+    UserInfoCache(UserInfoCache&&) = delete;
+    UserInfoCache& operator=(const UserInfoCache&) = delete;
+    UserInfoCache& operator=(UserInfoCache&&) = delete;
+    ~UserInfoCache() = default;
+
+  private:
+    UserInfoCache() : UserInfoCache(userInfoCacheTtl, userInfoCacheMaxEntries)
+    {}
+
+    struct Entry
+    {
+        UserInfoMap info;
+        std::chrono::steady_clock::time_point fetched;
+    };
+
+    void evict(std::chrono::steady_clock::time_point now)
+    {
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (now - it->second.fetched >= ttl)
+            {
+                it = entries.erase(it);
+                continue;
+            }
+            it++;
+        }
+        if (entries.size() < maxEntries)
+        {
+            return;
+        }
+        // Everything left is fresh; drop the oldest
+        auto oldest = std::min_element(
+            entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+                return a.second.fetched < b.second.fetched;
+            });
+        entries.erase(oldest);
+    }
+
+    std::chrono::seconds ttl;
+    size_t maxEntries;
+    uint64_t generation = 0;
+    boost::container::flat_map<std::string, Entry, std::less<>> entries;
+};
+
+/**
+ * Calls callback with the GetUserInfo result for username, from the cache
+ * when possible.  On a hit the callback runs before this returns.
+ */
+template <typename Callback>
+inline void getUserInfo(const std::string& username, Callback&& callback)
+{
+    UserInfoCache& cache = UserInfoCache::getInstance();
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+    const UserInfoMap* cached = cache.find(username, now);
+    if (cached != nullptr)
+    {
+        callback(boost::system::error_code{}, *cached);
+        return;
+    }
+
+    uint64_t generation = cache.getGeneration();
+    crow::connections::systemBus->async_method_call(
+        [username, generation, callback{std::forward<Callback>(callback)}](
+            const boost::system::error_code ec, const UserInfoMap& userInfo) {
+            if (!ec)
+            {
+                UserInfoCache::getInstance().insert(
+                    username, userInfo, std::chrono::steady_clock::now(),
+                    generation);
+            }
+            callback(ec, userInfo);
+        },
+        "xyz.openbmc_project.User.Manager", "/xyz/openbmc_project/user",
+        "xyz.openbmc_project.User.Manager", "GetUserInfo", username);
+}
+
+static std::unique_ptr<sdbusplus::bus::match::match> userInfoSignalMonitor;
+
+// Drops cached info and credentials for whatever the object affects
+inline void invalidateUserObject(std::string_view objectPath)
+{
+    UserInfoCache::getInstance().invalidate(objectPath);
+
+    authorization::CredentialCache& credentials =
+        authorization::CredentialCache::getInstance();
+    std::string_view name = userNameFromObjectPath(objectPath);
+    if (name.empty())
+    {
+        credentials.clear();
+        return;
+    }
+    credentials.erase(name);
+}
+
+inline void onUserSignal(sdbusplus::message::message& message)
+{
+    const char* member = message.get_member();
+    if (member != nullptr && (strcmp(member, "InterfacesAdded") == 0 ||
+                              strcmp(member, "InterfacesRemoved") == 0))
+    {
+        // Sent by the object manager; the changed object is the first
+        // argument
+        sdbusplus::message::object_path path;
+        message.read(path);
+        BMCWEB_LOG_DEBUG << "User object " << member << ": "
+                         << std::string(path);
+        invalidateUserObject(std::string(path));
+        return;
+    }
+    const char* path = message.get_path();
+    BMCWEB_LOG_DEBUG << "User object signal " << (member ? member : "")
+                     << ": " << (path ? path : "");
+    invalidateUserObject(path ? path : "");
+}
+
+// Any signal under the user tree invalidates what it touches: property
+// changes on a user, users being added, removed or renamed, and changes to
+// LDAP configuration and role mappings
+inline void registerUserInfoSignals()
+{
+    BMCWEB_LOG_INFO << "Register user manager signals";
+    std::string matchString = "type='signal',"
+                              "path_namespace='" +
+                              std::string(userObjectPath) + "'";
+    userInfoSignalMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        static_cast<sdbusplus::bus::bus&>(*crow::connections::systemBus),
+        matchString, onUserSignal);
+}
+
+} // namespace user_info
+} // namespace crow
@@ -0,0 +1,100 @@
+#include <credential_cache.hpp>
+
+#include <chrono>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using crow::authorization::CredentialCache;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+} // namespace
+
+TEST(CredentialCache, VerifiesCachedPassword)
+{
+    CredentialCache cache(seconds(30), 8);
+    steady_clock::time_point now = steady_clock::now();
+    bool isConfigureSelfOnly = true;
+
+    EXPECT_FALSE(cache.verify("alice", "secret", now, isConfigureSelfOnly));
+    cache.insert("alice", "secret", now, false);
+
+    EXPECT_TRUE(cache.verify("alice", "secret", now + seconds(29),
+                             isConfigureSelfOnly));
+    EXPECT_FALSE(isConfigureSelfOnly);
+
+    EXPECT_FALSE(cache.verify("alice", "Secret", now, isConfigureSelfOnly));
+    EXPECT_FALSE(cache.verify("alice", "secret2", now, isConfigureSelfOnly));
+    EXPECT_FALSE(cache.verify("alice", "", now, isConfigureSelfOnly));
+    EXPECT_FALSE(cache.verify("bob", "secret", now, isConfigureSelfOnly));
+}
+
+TEST(CredentialCache, KeepsConfigureSelfOnly)
+{
+    CredentialCache cache(seconds(30), 8);
+    steady_clock::time_point now = steady_clock::now();
+    cache.insert("alice", "expired", now, true);
+
+    bool isConfigureSelfOnly = false;
+    EXPECT_TRUE(cache.verify("alice", "expired", now, isConfigureSelfOnly));
+    EXPECT_TRUE(isConfigureSelfOnly);
+}
+
+TEST(CredentialCache, ExpiresAfterTtl)
+{
+    CredentialCache cache(seconds(30), 8);
+    steady_clock::time_point now = steady_clock::now();
+    cache.insert("alice", "secret", now, false);
+
+    bool isConfigureSelfOnly = false;
+    EXPECT_FALSE(cache.verify("alice", "secret", now + seconds(30),
+                              isConfigureSelfOnly));
+}
+
+TEST(CredentialCache, NewPasswordReplacesOld)
+{
+    CredentialCache cache(seconds(30), 8);
+    steady_clock::time_point now = steady_clock::now();
+    cache.insert("alice", "old", now, false);
+    cache.insert("alice", "new", now, false);
+
+    bool isConfigureSelfOnly = false;
+    EXPECT_FALSE(cache.verify("alice", "old", now, isConfigureSelfOnly));
+    EXPECT_TRUE(cache.verify("alice", "new", now, isConfigureSelfOnly));
+}
+
+TEST(CredentialCache, EraseAndClear)
+{
+    CredentialCache cache(seconds(30), 8);
+    steady_clock::time_point now = steady_clock::now();
+    cache.insert("alice", "secret", now, false);
+    cache.insert("bob", "hunter2", now, false);
+
+    bool isConfigureSelfOnly = false;
+    cache.erase("alice");
+    EXPECT_FALSE(cache.verify("alice", "secret", now, isConfigureSelfOnly));
+    EXPECT_TRUE(cache.verify("bob", "hunter2", now, isConfigureSelfOnly));
+
+    cache.clear();
+    EXPECT_FALSE(cache.verify("bob", "hunter2", now, isConfigureSelfOnly));
+}
+
+TEST(CredentialCache, EvictsOldestWhenFull)
+{
+    CredentialCache cache(seconds(30), 2);
+    steady_clock::time_point now = steady_clock::now();
+    cache.insert("alice", "a", now, false);
+    cache.insert("bob", "b", now + seconds(1), false);
+    cache.insert("carol", "c", now + seconds(2), false);
+
+    bool isConfigureSelfOnly = false;
+    EXPECT_FALSE(cache.verify("alice", "a", now + seconds(2),
+                              isConfigureSelfOnly));
+    EXPECT_TRUE(cache.verify("bob", "b", now + seconds(2),
+                             isConfigureSelfOnly));
+    EXPECT_TRUE(cache.verify("carol", "c", now + seconds(2),
+                             isConfigureSelfOnly));
+}
@@ -0,0 +1,87 @@
+#include <dbus_single_flight.hpp>
+
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using crow::single_flight::finish;
+using crow::single_flight::inFlight;
+using crow::single_flight::makeKey;
+using crow::single_flight::wait;
+
+using Paths = std::vector<std::string>;
+
+std::string subTreePathsKey(const std::string& path)
+{
+    return makeKey("xyz.openbmc_project.ObjectMapper",
+                   "/xyz/openbmc_project/object_mapper",
+                   "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths", path,
+                   int32_t{0},
+                   std::array<const char*, 1>{"xyz.openbmc_project.Item"});
+}
+
+} // namespace
+
+TEST(SingleFlight, KeysDifferWithArguments)
+{
+    EXPECT_EQ(subTreePathsKey("/"), subTreePathsKey("/"));
+    EXPECT_NE(subTreePathsKey("/"), subTreePathsKey("/xyz"));
+    // Lengths keep neighbouring strings apart
+    EXPECT_NE(makeKey("a", "bc", "d", "e"), makeKey("ab", "c", "d", "e"));
+    EXPECT_NE(makeKey("a", "b", "c", "d", std::vector<std::string>{"x", "y"}),
+              makeKey("a", "b", "c", "d", std::vector<std::string>{"xy"}));
+    EXPECT_NE(makeKey("a", "b", "c", "d", 1, 2),
+              makeKey("a", "b", "c", "d", 12));
+}
+
+TEST(SingleFlight, ConcurrentCallsShareOneReply)
+{
+    std::vector<std::string> results;
+    auto callback = [&results](const boost::system::error_code& ec,
+                               const Paths& paths) {
+        ASSERT_FALSE(ec);
+        results.insert(results.end(), paths.begin(), paths.end());
+    };
+
+    std::string key = subTreePathsKey("/");
+    EXPECT_TRUE(wait<Paths>(key, callback));
+    EXPECT_FALSE(wait<Paths>(key, callback));
+    EXPECT_FALSE(wait<Paths>(key, callback));
+    ASSERT_EQ(inFlight<Paths>().size(), 1U);
+
+    finish(key, boost::system::error_code(), Paths{"/item"});
+    EXPECT_EQ(results, Paths({"/item", "/item", "/item"}));
+    EXPECT_TRUE(inFlight<Paths>().empty());
+
+    // A reply that arrives after its callers are gone is dropped
+    finish(key, boost::system::error_code(), Paths{"/item"});
+    EXPECT_EQ(results.size(), 3U);
+}
+
+TEST(SingleFlight, CallersCanRepeatTheCall)
+{
+    std::string key = makeKey("s", "/p", "i", "m");
+    int calls = 0;
+    std::function<void()> call;
+    call = [&call, &calls, &key]() {
+        wait<Paths>(key, [&call, &calls](const boost::system::error_code&,
+                                         const Paths&) {
+            if (++calls == 1)
+            {
+                call();
+            }
+        });
+    };
+    call();
+    finish(key, boost::system::error_code(), Paths());
+    ASSERT_EQ(inFlight<Paths>().size(), 1U);
+    finish(key, boost::system::error_code(), Paths());
+    EXPECT_EQ(calls, 2);
+    EXPECT_TRUE(inFlight<Paths>().empty());
+}
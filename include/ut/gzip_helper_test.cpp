@@ -0,0 +1,67 @@
+#include <gzip_helper.hpp>
+#include <nlohmann/json.hpp>
+
+#include <string>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+std::string sensorCollection()
+{
+    nlohmann::json j;
+    j["@odata.type"] = "#SensorCollection.SensorCollection";
+    j["@odata.id"] = "/redfish/v1/Chassis/chassis/Sensors";
+    nlohmann::json& members = j["Members"];
+    for (int i = 0; i < 200; i++)
+    {
+        members.push_back(
+            {{"@odata.id",
+              "/redfish/v1/Chassis/chassis/Sensors/temp_" + std::to_string(i)},
+             {"Reading", 20 + i % 7},
+             {"Status", {{"Health", "OK"}, {"State", "Enabled"}}}});
+    }
+    return j.dump(2);
+}
+
+} // namespace
+
+TEST(GzipHelper, RoundTrip)
+{
+    std::string body = sensorCollection();
+    std::string compressed;
+    ASSERT_TRUE(gzipDeflate(body, compressed, 6));
+    // Redfish JSON is highly repetitive
+    EXPECT_LT(compressed.size(), body.size() / 5);
+
+    std::string inflated;
+    ASSERT_TRUE(gzipInflate(compressed, inflated));
+    EXPECT_EQ(inflated, body);
+}
+
+TEST(GzipHelper, StreamedRoundTrip)
+{
+    std::string body = sensorCollection();
+    DeflateEncoder encoder(true, 1);
+    std::string compressed;
+    for (size_t pos = 0; pos < body.size(); pos += 1000)
+    {
+        std::string_view piece = std::string_view(body).substr(pos, 1000);
+        ASSERT_TRUE(encoder.write(piece, compressed, false));
+    }
+    ASSERT_TRUE(encoder.write("", compressed, true));
+
+    std::string inflated;
+    ASSERT_TRUE(gzipInflate(compressed, inflated));
+    EXPECT_EQ(inflated, body);
+}
+
+TEST(GzipHelper, Empty)
+{
+    std::string compressed;
+    ASSERT_TRUE(gzipDeflate("", compressed, 6));
+    std::string inflated;
+    ASSERT_TRUE(gzipInflate(compressed, inflated));
+    EXPECT_EQ(inflated, "");
+}
@@ -19,3 +19,182 @@ TEST(HttpUtility, requestPrefersHtml)
     EXPECT_FALSE(http_helpers::requestPrefersHtml("application/json"));
     EXPECT_FALSE(http_helpers::isOctetAccepted("application/json"));
 }
+
+TEST(HttpUtility, getPreferredEncoding)
+{
+    using http_helpers::getPreferredEncoding;
+    using http_helpers::ResponseEncoding;
+
+    EXPECT_EQ(getPreferredEncoding("", ""), ResponseEncoding::Json);
+    EXPECT_EQ(getPreferredEncoding("*/*", ""), ResponseEncoding::Json);
+    EXPECT_EQ(getPreferredEncoding("text/html, application/json", ""),
+              ResponseEncoding::Html);
+    EXPECT_EQ(getPreferredEncoding("application/cbor;q=0.9, */*;q=0.8", ""),
+              ResponseEncoding::Cbor);
+    EXPECT_EQ(getPreferredEncoding("image/png, application/msgpack", ""),
+              ResponseEncoding::MsgPack);
+    EXPECT_EQ(getPreferredEncoding("application/json, application/cbor", ""),
+              ResponseEncoding::Json);
+
+    // The query parameter wins over the Accept header
+    EXPECT_EQ(getPreferredEncoding("text/html", "compact"),
+              ResponseEncoding::JsonCompact);
+    EXPECT_EQ(getPreferredEncoding("application/json", "cbor"),
+              ResponseEncoding::Cbor);
+    EXPECT_EQ(getPreferredEncoding("application/cbor", "json"),
+              ResponseEncoding::Json);
+    EXPECT_EQ(getPreferredEncoding("application/cbor", "bogus"),
+              ResponseEncoding::Cbor);
+}
+
+TEST(HttpUtility, getPreferredContentEncoding)
+{
+    using http_helpers::ContentEncoding;
+    using http_helpers::getPreferredContentEncoding;
+
+    EXPECT_EQ(getPreferredContentEncoding(""), ContentEncoding::Identity);
+    EXPECT_EQ(getPreferredContentEncoding("identity"),
+              ContentEncoding::Identity);
+    EXPECT_EQ(getPreferredContentEncoding("gzip, deflate, br"),
+              ContentEncoding::Gzip);
+    EXPECT_EQ(getPreferredContentEncoding("deflate"), ContentEncoding::Deflate);
+    EXPECT_EQ(getPreferredContentEncoding("gzip;q=0.5, deflate"),
+              ContentEncoding::Deflate);
+    EXPECT_EQ(getPreferredContentEncoding("GZIP ; q=0.8"),
+              ContentEncoding::Gzip);
+    EXPECT_EQ(getPreferredContentEncoding("gzip;q=0, deflate;q=0"),
+              ContentEncoding::Identity);
+    EXPECT_EQ(getPreferredContentEncoding("*"), ContentEncoding::Gzip);
+}
+
+TEST(HttpUtility, urlMayCarrySecrets)
+{
+    using http_helpers::urlMayCarrySecrets;
+
+    EXPECT_TRUE(urlMayCarrySecrets("/login"));
+    EXPECT_TRUE(urlMayCarrySecrets("/redfish/v1/SessionService/Sessions"));
+    EXPECT_TRUE(urlMayCarrySecrets("/redfish/v1/SessionService/Sessions/ab"));
+    EXPECT_TRUE(urlMayCarrySecrets(
+        "/redfish/v1/Managers/bmc/NetworkProtocol/HTTPS/Certificates/1"));
+    EXPECT_TRUE(urlMayCarrySecrets(
+        "/redfish/v1/CertificateService/Actions/"
+        "CertificateService.GenerateCSR"));
+    EXPECT_FALSE(urlMayCarrySecrets("/redfish/v1/Chassis"));
+    EXPECT_FALSE(urlMayCarrySecrets("/redfish/v1/Systems/system/LogServices"));
+    EXPECT_FALSE(urlMayCarrySecrets("/loginpage"));
+}
+
+TEST(HttpUtility, getETag)
+{
+    using http_helpers::getETag;
+    using http_helpers::ResponseEncoding;
+
+    crow::Response res;
+    res.jsonValue["Name"] = "Chassis";
+    std::string etag = getETag(res, ResponseEncoding::Json);
+    EXPECT_TRUE(etag.starts_with('"'));
+    EXPECT_TRUE(etag.ends_with('"'));
+    EXPECT_EQ(getETag(res, ResponseEncoding::Json), etag);
+    EXPECT_NE(getETag(res, ResponseEncoding::Cbor), etag);
+
+    res.jsonValue["Name"] = "System";
+    EXPECT_NE(getETag(res, ResponseEncoding::Json), etag);
+
+    crow::Response raw;
+    raw.body() = "<html></html>";
+    EXPECT_EQ(getETag(raw, ResponseEncoding::Json),
+              getETag(raw, ResponseEncoding::Cbor));
+
+    // 128 bits of hash
+    EXPECT_EQ(etag.size(), 34U);
+    EXPECT_EQ(getETag("").size(), 34U);
+    EXPECT_NE(getETag(""), getETag("a"));
+
+    // Only the content counts, not the order it was built in
+    crow::Response reordered;
+    reordered.jsonValue["Id"] = "1";
+    reordered.jsonValue["Name"] = "System";
+    res.jsonValue["Id"] = "1";
+    EXPECT_EQ(getETag(reordered, ResponseEncoding::Json),
+              getETag(res, ResponseEncoding::Json));
+}
+
+TEST(HttpUtility, getETagKeepsDigestOfCompleteResponse)
+{
+    using http_helpers::getETag;
+    using http_helpers::ResponseEncoding;
+
+    crow::Response res;
+    res.jsonValue["Name"] = "Chassis";
+    // The document may still change
+    std::string json = getETag(res, ResponseEncoding::Json);
+    EXPECT_FALSE(res.jsonDigest);
+
+    res.end();
+    EXPECT_EQ(getETag(res, ResponseEncoding::Json), json);
+    ASSERT_TRUE(res.jsonDigest);
+    std::array<uint64_t, 2> digest = *res.jsonDigest;
+    EXPECT_NE(getETag(res, ResponseEncoding::Cbor), json);
+    EXPECT_EQ(*res.jsonDigest, digest);
+
+    // Different values of the same type and size don't collide
+    crow::Response other;
+    other.jsonValue["Name"] = "Chassit";
+    EXPECT_NE(getETag(other, ResponseEncoding::Json), json);
+    crow::Response number;
+    number.jsonValue["Name"] = 1;
+    crow::Response text;
+    text.jsonValue["Name"] = "1";
+    EXPECT_NE(getETag(number, ResponseEncoding::Json),
+              getETag(text, ResponseEncoding::Json));
+
+    res.clear();
+    EXPECT_FALSE(res.jsonDigest);
+}
+
+TEST(HttpUtility, etagMatches)
+{
+    using http_helpers::etagMatches;
+
+    EXPECT_TRUE(etagMatches("\"abc\"", "\"abc\"", true));
+    EXPECT_TRUE(etagMatches("\"xyz\", \"abc\"", "\"abc\"", false));
+    EXPECT_TRUE(etagMatches("*", "\"abc\"", false));
+    EXPECT_FALSE(etagMatches("\"abd\"", "\"abc\"", true));
+    EXPECT_FALSE(etagMatches("", "\"abc\"", true));
+
+    // Weak tags only match with weak comparison
+    EXPECT_TRUE(etagMatches("W/\"abc\"", "\"abc\"", true));
+    EXPECT_FALSE(etagMatches("W/\"abc\"", "\"abc\"", false));
+
+    // Content codings don't change what the tag stands for
+    EXPECT_TRUE(etagMatches("\"abc-gzip\"", "\"abc\"", false));
+    EXPECT_TRUE(etagMatches("\"abc\"", "\"abc-deflate\"", true));
+    EXPECT_TRUE(etagMatches("\"abc-gzip\"", "\"abc-deflate\"", true));
+    EXPECT_FALSE(etagMatches("\"abc-gzip\"", "\"abd\"", true));
+}
+
+TEST(HttpUtility, ifMatchMatches)
+{
+    using http_helpers::getETag;
+    using http_helpers::ifMatchMatches;
+    using http_helpers::ResponseEncoding;
+
+    crow::Response res;
+    res.jsonValue["Name"] = "Chassis";
+    std::string cbor = getETag(res, ResponseEncoding::Cbor);
+    std::string json = getETag(res, ResponseEncoding::Json);
+
+    // A tag from a GET with another Accept header or coding still matches
+    EXPECT_TRUE(ifMatchMatches(cbor, res));
+    EXPECT_TRUE(ifMatchMatches(json, res));
+    EXPECT_TRUE(ifMatchMatches(json.substr(0, json.size() - 1) + "-gzip\"",
+                               res));
+    EXPECT_FALSE(ifMatchMatches("\"abc\"", res));
+
+    res.jsonValue["Name"] = "System";
+    EXPECT_FALSE(ifMatchMatches(json, res));
+
+    res.stringResponse->set(boost::beast::http::field::etag, "\"v2\"");
+    EXPECT_TRUE(ifMatchMatches("\"v2\"", res));
+    EXPECT_FALSE(ifMatchMatches(json, res));
+}
@@ -0,0 +1,97 @@
+#include <introspection_cache.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using crow::introspection::IntrospectionCache;
+using crow::introspection::Node;
+
+const IntrospectionCache::Clock::time_point now;
+
+std::shared_ptr<const Node> node(const std::string& interface)
+{
+    auto result = std::make_shared<Node>();
+    result->interfaces.push_back({interface, {}, {}, {}});
+    return result;
+}
+
+} // namespace
+
+TEST(IntrospectionCache, StoresByServiceAndPath)
+{
+    IntrospectionCache cache;
+    EXPECT_EQ(cache.find("a.b", "/x", now), nullptr);
+    EXPECT_TRUE(
+        cache.store("a.b", "/x", node("a.b.X"), cache.getEpoch(), now));
+    ASSERT_NE(cache.find("a.b", "/x", now), nullptr);
+    EXPECT_NE(cache.find("a.b", "/x", now)->findInterface("a.b.X"), nullptr);
+    EXPECT_EQ(cache.find("a.b", "/x", now)->findInterface("a.b.Y"), nullptr);
+    EXPECT_EQ(cache.find("a.c", "/x", now), nullptr);
+    EXPECT_EQ(cache.find("a.b", "/y", now), nullptr);
+}
+
+TEST(IntrospectionCache, ObjectChangesDropItAndItsParents)
+{
+    IntrospectionCache cache;
+    for (const char* path : {"/", "/x", "/x/y", "/x/y/z", "/xy", "/w"})
+    {
+        cache.store("a.b", path, node("a.b.X"), cache.getEpoch(), now);
+    }
+    cache.store("a.c", "/x", node("a.b.X"), cache.getEpoch(), now);
+    cache.store("a.c", "/w", node("a.b.X"), cache.getEpoch(), now);
+    cache.removeObject("/x/y");
+    EXPECT_EQ(cache.find("a.b", "/", now), nullptr);
+    EXPECT_EQ(cache.find("a.b", "/x", now), nullptr);
+    EXPECT_EQ(cache.find("a.b", "/x/y", now), nullptr);
+    EXPECT_NE(cache.find("a.b", "/x/y/z", now), nullptr);
+    EXPECT_NE(cache.find("a.b", "/xy", now), nullptr);
+    EXPECT_NE(cache.find("a.b", "/w", now), nullptr);
+    // From every service
+    EXPECT_EQ(cache.find("a.c", "/x", now), nullptr);
+    EXPECT_NE(cache.find("a.c", "/w", now), nullptr);
+
+    cache.removeService("a.c");
+    EXPECT_EQ(cache.find("a.c", "/w", now), nullptr);
+    EXPECT_EQ(cache.size(), 3U);
+}
+
+TEST(IntrospectionCache, ServicesLeavingDropTheirEntries)
+{
+    IntrospectionCache cache;
+    uint64_t epoch = cache.getEpoch();
+    cache.store("a.b", "/x", node("a.b.X"), epoch, now);
+    cache.store(":1.5", "/x", node("a.b.X"), epoch, now);
+    cache.removeService("a.b");
+    EXPECT_EQ(cache.find("a.b", "/x", now), nullptr);
+    EXPECT_NE(cache.find(":1.5", "/x", now), nullptr);
+
+    // Anything requested before the change is stale
+    EXPECT_FALSE(cache.store("a.b", "/x", node("a.b.X"), epoch, now));
+    EXPECT_EQ(cache.size(), 1U);
+}
+
+TEST(IntrospectionCache, ObjectsWithoutObjectManagerExpire)
+{
+    IntrospectionCache cache;
+    std::chrono::seconds maxAge =
+        crow::introspection::unsignalledIntrospectionMaxAge;
+    cache.store("a.b", "/x", node("a.b.X"), cache.getEpoch(), now);
+    cache.store("a.b", "/y", node(crow::introspection::objectManagerInterface),
+                cache.getEpoch(), now);
+    cache.store("a.b", "/y/z", node("a.b.X"), cache.getEpoch(), now);
+    cache.store("a.c", "/y/z", node("a.b.X"), cache.getEpoch(), now);
+
+    EXPECT_NE(cache.find("a.b", "/x", now), nullptr);
+    EXPECT_EQ(cache.find("a.b", "/x", now + maxAge), nullptr);
+    // Changes below an ObjectManager are signalled
+    EXPECT_NE(cache.find("a.b", "/y", now + maxAge), nullptr);
+    EXPECT_NE(cache.find("a.b", "/y/z", now + maxAge), nullptr);
+    // But only for the service that has it
+    EXPECT_EQ(cache.find("a.c", "/y/z", now + maxAge), nullptr);
+}
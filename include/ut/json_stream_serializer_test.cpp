@@ -0,0 +1,96 @@
+#include <json_stream_serializer.hpp>
+
+#include <string>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+std::string streamAll(const nlohmann::json& j, int indent, size_t chunkSize)
+{
+    json_stream_util::JsonStreamSerializer serializer(j, indent);
+    std::string out;
+    std::string chunk;
+    bool done = false;
+    while (!done)
+    {
+        chunk.clear();
+        done = serializer.fill(chunk, chunkSize);
+        out += chunk;
+    }
+    return out;
+}
+
+nlohmann::json makeDocument()
+{
+    nlohmann::json j;
+    j["@odata.id"] = "/redfish/v1/Systems/system/LogServices/EventLog/Entries";
+    j["Name"] = "System Event Log Entries";
+    j["Members@odata.count"] = 3;
+    j["Empty"] = nlohmann::json::object();
+    j["EmptyArray"] = nlohmann::json::array();
+    j["Null"] = nullptr;
+    j["Escaped"] = "quote \" backslash \\ tab \t unicode \xc3\xa9";
+    j["Invalid"] = "\xff\xfe";
+    nlohmann::json& members = j["Members"];
+    for (int i = 0; i < 3; i++)
+    {
+        members.push_back({{"Id", std::to_string(i)},
+                           {"Created", "2020-01-01T00:00:00+00:00"},
+                           {"Severity", "OK"},
+                           {"Reading", 1.5 * i},
+                           {"Enabled", i % 2 == 0},
+                           {"Links", {{"Nested", {1, 2, {{"a", {}}}}}}}});
+    }
+    return j;
+}
+
+} // namespace
+
+TEST(JsonStreamSerializer, MatchesDumpPretty)
+{
+    nlohmann::json j = makeDocument();
+    std::string expected =
+        j.dump(2, ' ', true, nlohmann::json::error_handler_t::replace);
+    for (size_t chunkSize : {1U, 7U, 64U, 4096U})
+    {
+        EXPECT_EQ(streamAll(j, 2, chunkSize), expected);
+    }
+}
+
+TEST(JsonStreamSerializer, MatchesDumpCompact)
+{
+    nlohmann::json j = makeDocument();
+    std::string expected =
+        j.dump(-1, ' ', true, nlohmann::json::error_handler_t::replace);
+    EXPECT_EQ(streamAll(j, -1, 16), expected);
+}
+
+TEST(JsonStreamSerializer, Scalars)
+{
+    EXPECT_EQ(streamAll(nlohmann::json(42), 2, 1), "42");
+    EXPECT_EQ(streamAll(nlohmann::json("str"), 2, 1), "\"str\"");
+    EXPECT_EQ(streamAll(nlohmann::json::object(), 2, 1), "{}");
+    EXPECT_EQ(streamAll(nlohmann::json::array(), 2, 1), "[]");
+}
+
+TEST(JsonStreamSerializer, BoundedChunks)
+{
+    nlohmann::json j = nlohmann::json::array();
+    for (int i = 0; i < 1000; i++)
+    {
+        j.push_back(i);
+    }
+    json_stream_util::JsonStreamSerializer serializer(j, 2);
+    std::string chunk;
+    bool done = false;
+    while (!done)
+    {
+        chunk.clear();
+        done = serializer.fill(chunk, 256);
+        // A chunk only overshoots by at most one element
+        EXPECT_LT(chunk.size(), 256U + 16U);
+    }
+    EXPECT_TRUE(serializer.done());
+}
@@ -0,0 +1,291 @@
+#include <object_mapper_mirror.hpp>
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using crow::object_mapper::MapperGetObject;
+using crow::object_mapper::MapperGetSubTreeResponse;
+using crow::object_mapper::MapperMirror;
+
+constexpr const char* inventory = "xyz.openbmc_project.Inventory.Manager";
+constexpr const char* sensors = "xyz.openbmc_project.HwmonTempSensor";
+constexpr const char* dimm = "xyz.openbmc_project.Inventory.Item.Dimm";
+constexpr const char* cpu = "xyz.openbmc_project.Inventory.Item.Cpu";
+constexpr const char* value = "xyz.openbmc_project.Sensor.Value";
+constexpr const char* assoc = "xyz.openbmc_project.Association.Definitions";
+
+MapperGetSubTreeResponse bus()
+{
+    return {
+        {"/xyz/openbmc_project/inventory/system/dimm0",
+         {{inventory, {assoc, dimm}}}},
+        {"/xyz/openbmc_project/inventory/system/dimm1",
+         {{inventory, {dimm}}}},
+        {"/xyz/openbmc_project/inventory/system/cpu0", {{inventory, {cpu}}}},
+        {"/xyz/openbmc_project/inventory/system/cpu0/core0",
+         {{inventory, {cpu}}}},
+        {"/xyz/openbmc_project/sensors/temperature/cpu0",
+         {{sensors, {value}}, {inventory, {assoc}}}},
+    };
+}
+
+std::vector<std::string> paths(const MapperMirror& mirror,
+                               std::string_view subtree, int32_t depth,
+                               const std::vector<std::string>& interfaces)
+{
+    std::vector<std::string> result;
+    EXPECT_TRUE(mirror.getSubTreePaths(subtree, depth, interfaces, result));
+    return result;
+}
+
+} // namespace
+
+TEST(MapperMirror, NotReadyUntilSeeded)
+{
+    MapperMirror mirror;
+    EXPECT_FALSE(mirror.isReady());
+    EXPECT_TRUE(mirror.seed(bus(), mirror.getGeneration()));
+    EXPECT_TRUE(mirror.isReady());
+    EXPECT_EQ(mirror.size(), 5U);
+
+    mirror.invalidate();
+    EXPECT_FALSE(mirror.isReady());
+}
+
+TEST(MapperMirror, ChangesDuringSeedAreApplied)
+{
+    MapperMirror mirror;
+    uint64_t generation = mirror.beginSeed();
+    // Signals handled while the seed was in flight, which it may predate
+    mirror.addInterfaces("/xyz/openbmc_project/inventory/system/dimm2",
+                         inventory, {dimm});
+    mirror.removeInterfaces("/xyz/openbmc_project/inventory/system/dimm0",
+                            inventory, {assoc, dimm});
+    mirror.removeService(sensors);
+    EXPECT_TRUE(mirror.seed(bus(), generation));
+    EXPECT_TRUE(mirror.isReady());
+    EXPECT_THAT(paths(mirror, "/", 0, {dimm}),
+                testing::ElementsAre(
+                    "/xyz/openbmc_project/inventory/system/dimm1",
+                    "/xyz/openbmc_project/inventory/system/dimm2"));
+    EXPECT_TRUE(paths(mirror, "/", 0, {value}).empty());
+
+    // Once applied, they aren't applied to a later seed
+    generation = mirror.beginSeed();
+    EXPECT_TRUE(mirror.seed(bus(), generation));
+    EXPECT_EQ(mirror.size(), 5U);
+}
+
+TEST(MapperMirror, SeedBeforeInvalidateIsRefused)
+{
+    MapperMirror mirror;
+    uint64_t generation = mirror.beginSeed();
+    mirror.invalidate();
+    EXPECT_FALSE(mirror.seed(bus(), generation));
+    EXPECT_FALSE(mirror.isReady());
+
+    generation = mirror.beginSeed();
+    EXPECT_TRUE(mirror.seed(bus(), generation));
+    EXPECT_TRUE(mirror.isReady());
+}
+
+TEST(MapperMirror, SubTreePaths)
+{
+    MapperMirror mirror;
+    mirror.seed(bus(), mirror.getGeneration());
+
+    EXPECT_THAT(paths(mirror, "/xyz/openbmc_project/inventory", 0, {dimm}),
+                testing::ElementsAre(
+                    "/xyz/openbmc_project/inventory/system/dimm0",
+                    "/xyz/openbmc_project/inventory/system/dimm1"));
+    EXPECT_THAT(
+        paths(mirror, "/", 0, {cpu, value}),
+        testing::ElementsAre(
+            "/xyz/openbmc_project/inventory/system/cpu0",
+            "/xyz/openbmc_project/inventory/system/cpu0/core0",
+            "/xyz/openbmc_project/sensors/temperature/cpu0"));
+    // Depth counts the levels below the subtree
+    EXPECT_THAT(
+        paths(mirror, "/xyz/openbmc_project/inventory/system", 1, {cpu}),
+        testing::ElementsAre("/xyz/openbmc_project/inventory/system/cpu0"));
+    // The subtree itself isn't part of it
+    EXPECT_THAT(
+        paths(mirror, "/xyz/openbmc_project/inventory/system/cpu0/", 0, {}),
+        testing::ElementsAre(
+            "/xyz/openbmc_project/inventory/system/cpu0/core0"));
+    EXPECT_TRUE(paths(mirror, "/xyz/openbmc_project", 0, {"x.y.Z"}).empty());
+
+    std::vector<std::string> result;
+    EXPECT_FALSE(
+        mirror.getSubTreePaths("/xyz/openbmc_project/none", 0, {}, result));
+}
+
+TEST(MapperMirror, SubTreeHasMatchingServices)
+{
+    MapperMirror mirror;
+    mirror.seed(bus(), mirror.getGeneration());
+
+    MapperGetSubTreeResponse result;
+    ASSERT_TRUE(mirror.getSubTree("/xyz/openbmc_project/sensors", 0, {value},
+                                  result));
+    ASSERT_EQ(result.size(), 1U);
+    EXPECT_EQ(result[0].second,
+              MapperGetObject({{sensors, {value}}}));
+
+    result.clear();
+    ASSERT_TRUE(mirror.getSubTree("/xyz/openbmc_project/sensors", 0, {},
+                                  result));
+    ASSERT_EQ(result.size(), 1U);
+    EXPECT_EQ(result[0].second,
+              MapperGetObject({{sensors, {value}}, {inventory, {assoc}}}));
+}
+
+TEST(MapperMirror, CountObjects)
+{
+    MapperMirror mirror;
+    mirror.seed(bus(), mirror.getGeneration());
+    EXPECT_EQ(mirror.countObjects("/", inventory), 5U);
+    EXPECT_EQ(mirror.countObjects("/xyz/openbmc_project/inventory", inventory),
+              4U);
+    EXPECT_EQ(mirror.countObjects("/", sensors), 1U);
+    EXPECT_EQ(mirror.countObjects("/xyz/openbmc_project/none", sensors), 0U);
+}
+
+TEST(MapperMirror, GetObject)
+{
+    MapperMirror mirror;
+    mirror.seed(bus(), mirror.getGeneration());
+
+    MapperGetObject result;
+    ASSERT_TRUE(mirror.getObject(
+        "/xyz/openbmc_project/inventory/system/dimm0", {dimm}, result));
+    EXPECT_EQ(result, MapperGetObject({{inventory, {assoc, dimm}}}));
+    EXPECT_FALSE(mirror.getObject(
+        "/xyz/openbmc_project/inventory/system/dimm0", {cpu}, result));
+    EXPECT_FALSE(mirror.getObject(
+        "/xyz/openbmc_project/inventory/system/dimm9", {}, result));
+}
+
+TEST(MapperMirror, SignalsUpdateObjectsAndIndex)
+{
+    MapperMirror mirror;
+    mirror.seed(bus(), mirror.getGeneration());
+
+    mirror.addInterfaces("/xyz/openbmc_project/inventory/system/dimm2",
+                         inventory, {dimm});
+    mirror.removeInterfaces("/xyz/openbmc_project/inventory/system/dimm0",
+                            inventory, {assoc, dimm});
+    EXPECT_THAT(paths(mirror, "/", 0, {dimm}),
+                testing::ElementsAre(
+                    "/xyz/openbmc_project/inventory/system/dimm1",
+                    "/xyz/openbmc_project/inventory/system/dimm2"));
+    EXPECT_TRUE(paths(mirror, "/xyz/openbmc_project/inventory", 0, {assoc})
+                    .empty());
+
+    // The sensor object stays, with what the inventory still provides
+    mirror.removeService(sensors);
+    EXPECT_TRUE(paths(mirror, "/", 0, {value}).empty());
+    EXPECT_THAT(
+        paths(mirror, "/", 0, {assoc}),
+        testing::ElementsAre("/xyz/openbmc_project/sensors/temperature/cpu0"));
+
+    mirror.removeService(inventory);
+    EXPECT_EQ(mirror.size(), 0U);
+}
+
+TEST(MapperMirror, InterfacesChangeOneService)
+{
+    MapperMirror mirror;
+    mirror.seed(bus(), mirror.getGeneration());
+
+    mirror.addInterfaces("/xyz/openbmc_project/sensors/temperature/cpu0",
+                         sensors, {assoc});
+    MapperGetObject result;
+    ASSERT_TRUE(mirror.getObject(
+        "/xyz/openbmc_project/sensors/temperature/cpu0", {}, result));
+    EXPECT_EQ(result, MapperGetObject({{sensors, {assoc, value}},
+                                       {inventory, {assoc}}}));
+
+    // The interface stays indexed while another service implements it
+    mirror.removeInterfaces("/xyz/openbmc_project/sensors/temperature/cpu0",
+                            inventory, {assoc});
+    EXPECT_THAT(
+        paths(mirror, "/xyz/openbmc_project/sensors", 0, {assoc}),
+        testing::ElementsAre("/xyz/openbmc_project/sensors/temperature/cpu0"));
+    mirror.removeInterfaces("/xyz/openbmc_project/sensors/temperature/cpu0",
+                            sensors, {assoc, value});
+    EXPECT_FALSE(mirror.getObject(
+        "/xyz/openbmc_project/sensors/temperature/cpu0", {}, result));
+    EXPECT_EQ(mirror.size(), 4U);
+}
+
+TEST(MapperMirror, SetSubTreeReplacesOnlyBelow)
+{
+    MapperMirror mirror;
+    mirror.seed(bus(), mirror.getGeneration());
+
+    mirror.setSubTree("/xyz/openbmc_project/inventory/system/cpu0",
+                      {{"/xyz/openbmc_project/inventory/system/cpu0/core1",
+                        {{inventory, {cpu}}}}});
+    EXPECT_THAT(
+        paths(mirror, "/xyz/openbmc_project/inventory/system", 0, {cpu}),
+        testing::ElementsAre(
+            "/xyz/openbmc_project/inventory/system/cpu0",
+            "/xyz/openbmc_project/inventory/system/cpu0/core1"));
+
+    mirror.setSubTree("/xyz/openbmc_project/inventory", {});
+    EXPECT_EQ(mirror.size(), 1U);
+}
+
+TEST(MapperMirror, RefreshRoot)
+{
+    using crow::object_mapper::refreshRoot;
+    EXPECT_EQ(refreshRoot({"/xyz/openbmc_project/sensors/temperature/a",
+                           "/xyz/openbmc_project/sensors/temperature/b"}),
+              "/xyz/openbmc_project/sensors/temperature");
+    // A path is never its own root, as GetSubTree leaves the path itself out
+    EXPECT_EQ(refreshRoot({"/xyz/openbmc_project/sensors/temperature",
+                           "/xyz/openbmc_project/sensors/temperature/b"}),
+              "/xyz/openbmc_project/sensors");
+    EXPECT_EQ(refreshRoot({"/xyz/openbmc_project/sensors/temperature/a",
+                           "/xyz/openbmc_project/sensors/temp"}),
+              "/xyz/openbmc_project/sensors");
+    EXPECT_EQ(refreshRoot({"/xyz", "/org"}), "/");
+}
+
+TEST(MapperMirror, ServiceOwners)
+{
+    crow::object_mapper::ServiceOwners owners;
+    owners.add(":1.42", inventory);
+    EXPECT_EQ(owners.find(":1.42"), inventory);
+    EXPECT_TRUE(owners.isKnown(inventory));
+    EXPECT_TRUE(owners.find(":1.43").empty());
+
+    // It isn't known which of several names the mapper reports
+    owners.add(":1.42", sensors);
+    EXPECT_TRUE(owners.find(":1.42").empty());
+    owners.remove(":1.42", inventory);
+    EXPECT_EQ(owners.find(":1.42"), sensors);
+    owners.remove(":1.42", sensors);
+    EXPECT_FALSE(owners.isKnown(sensors));
+}
+
+TEST(MapperMirror, CountDifferences)
+{
+    MapperMirror mirror;
+    mirror.seed(bus(), mirror.getGeneration());
+    MapperGetSubTreeResponse mirrored;
+    mirror.getSubTree("/", 0, {}, mirrored);
+    EXPECT_EQ(crow::object_mapper::countDifferences(mirrored, bus()), 0U);
+
+    MapperGetSubTreeResponse mapped = bus();
+    mapped.pop_back();
+    mapped[0].second[0].second.emplace_back(cpu);
+    mapped.push_back({"/xyz/openbmc_project/new", {{inventory, {cpu}}}});
+    EXPECT_EQ(crow::object_mapper::countDifferences(mirrored, mapped), 3U);
+}
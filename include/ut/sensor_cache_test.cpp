@@ -0,0 +1,146 @@
+#include <sensor_cache.hpp>
+
+#include <chrono>
+#include <string>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using crow::sensor_cache::ManagedObjects;
+using crow::sensor_cache::SensorCache;
+using crow::sensor_cache::SensorProperties;
+
+constexpr const char* service = "xyz.openbmc_project.HwmonTempSensor";
+constexpr const char* value = "xyz.openbmc_project.Sensor.Value";
+constexpr const char* warning = "xyz.openbmc_project.Sensor.Threshold.Warning";
+constexpr const char* critical =
+    "xyz.openbmc_project.Sensor.Threshold.Critical";
+constexpr const char* cpuTemp = "/xyz/openbmc_project/sensors/temperature/cpu";
+
+ManagedObjects objects()
+{
+    ManagedObjects result;
+    result.push_back(
+        {{cpuTemp},
+         {{value, {{"Value", 41.0}, {"Scale", int64_t{0}}}},
+          {critical, {{"CriticalHigh", 95.0}}},
+          {"xyz.openbmc_project.Association.Definitions", {}}}});
+    result.push_back({{"/xyz/openbmc_project/inventory/cpu"},
+                      {{value, {{"Value", 1.0}}}}});
+    return result;
+}
+
+const crow::sensor_cache::SensorVariant*
+    property(const SensorCache::Entry& entry, const std::string& interface,
+             const std::string& name)
+{
+    auto it = entry.objects[0].second.find(interface);
+    if (it == entry.objects[0].second.end())
+    {
+        return nullptr;
+    }
+    auto propertyIt = it->second.find(name);
+    return propertyIt == it->second.end() ? nullptr : &propertyIt->second;
+}
+
+} // namespace
+
+TEST(SensorCache, StoresSensorInterfacesOnly)
+{
+    SensorCache cache;
+    SensorCache::Clock::time_point now;
+    EXPECT_EQ(cache.find(service, "/", now), nullptr);
+    EXPECT_TRUE(cache.store(service, "/", objects(), cache.getEpoch(), now));
+
+    const SensorCache::Entry* entry = cache.find(service, "/", now);
+    ASSERT_NE(entry, nullptr);
+    ASSERT_EQ(entry->objects.size(), 1U);
+    EXPECT_EQ(entry->objects[0].first.str, cpuTemp);
+    EXPECT_EQ(entry->objects[0].second.size(), 2U);
+    EXPECT_EQ(entry->populated, now);
+    EXPECT_EQ(cache.find(service, "/xyz", now), nullptr);
+}
+
+TEST(SensorCache, EntriesExpire)
+{
+    SensorCache cache;
+    SensorCache::Clock::time_point now;
+    cache.store(service, "/", objects(), cache.getEpoch(), now);
+    EXPECT_NE(cache.find(service, "/", now + std::chrono::seconds(59)),
+              nullptr);
+    EXPECT_EQ(cache.find(service, "/", now + std::chrono::seconds(60)),
+              nullptr);
+}
+
+TEST(SensorCache, PropertiesChangedUpdatesEntry)
+{
+    SensorCache cache;
+    SensorCache::Clock::time_point now;
+    cache.store(service, "/", objects(), cache.getEpoch(), now);
+
+    SensorCache::Clock::time_point later = now + std::chrono::seconds(1);
+    cache.updateProperties(cpuTemp, value, {{"Value", 43.5}}, true, later);
+    const SensorCache::Entry* entry = cache.find(service, "/", later);
+    ASSERT_NE(entry, nullptr);
+    const crow::sensor_cache::SensorVariant* reading =
+        property(*entry, value, "Value");
+    ASSERT_NE(reading, nullptr);
+    EXPECT_EQ(std::get<double>(*reading), 43.5);
+    EXPECT_EQ(entry->updated, later);
+    EXPECT_EQ(entry->populated, now);
+
+    // Interfaces that weren't fetched aren't made up from signals
+    cache.updateProperties(cpuTemp, warning, {{"WarningHigh", 80.0}}, true,
+                           later);
+    EXPECT_EQ(property(*entry, warning, "WarningHigh"), nullptr);
+
+    // An invalidated property can't be kept current
+    cache.updateProperties(cpuTemp, critical, {}, false, later);
+    EXPECT_EQ(cache.find(service, "/", later), nullptr);
+}
+
+TEST(SensorCache, DroppedEntriesRefuseOlderFetches)
+{
+    SensorCache cache;
+    SensorCache::Clock::time_point now;
+    uint64_t epoch = cache.getEpoch();
+    cache.invalidate();
+    EXPECT_FALSE(cache.store(service, "/", objects(), epoch, now));
+    EXPECT_EQ(cache.size(), 0U);
+
+    cache.store(service, "/", objects(), cache.getEpoch(), now);
+    cache.store("xyz.openbmc_project.FanSensor", "/", objects(),
+                cache.getEpoch(), now);
+    cache.removeService(service);
+    EXPECT_EQ(cache.find(service, "/", now), nullptr);
+    EXPECT_NE(cache.find("xyz.openbmc_project.FanSensor", "/", now), nullptr);
+}
+
+TEST(SensorCache, SignalsFindObjectsAfterEntriesChange)
+{
+    SensorCache cache;
+    SensorCache::Clock::time_point now;
+    const char* fans = "xyz.openbmc_project.FanSensor";
+    cache.store(service, "/", objects(), cache.getEpoch(), now);
+    cache.store(fans, "/", objects(), cache.getEpoch(), now);
+    // Stored again, which must not leave the first copy indexed
+    cache.store(service, "/", objects(), cache.getEpoch(), now);
+
+    // An invalidated property drops every entry holding the object
+    cache.updateProperties(cpuTemp, critical, {}, false, now);
+    EXPECT_EQ(cache.size(), 0U);
+
+    cache.store(service, "/", objects(), cache.getEpoch(), now);
+    cache.store(fans, "/", objects(), cache.getEpoch(), now);
+    // Removing the other service leaves this one indexed
+    cache.removeService(fans);
+    cache.updateProperties(cpuTemp, value, {{"Value", 50.0}}, true, now);
+    const SensorCache::Entry* entry = cache.find(service, "/", now);
+    ASSERT_NE(entry, nullptr);
+    const crow::sensor_cache::SensorVariant* reading =
+        property(*entry, value, "Value");
+    ASSERT_NE(reading, nullptr);
+    EXPECT_EQ(std::get<double>(*reading), 50.0);
+}
@@ -0,0 +1,98 @@
+#include <unistd.h>
+
+#include <gzip_helper.hpp>
+#include <static_asset.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using crow::webassets::MappedFile;
+
+class StaticAssetTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        dir = std::filesystem::temp_directory_path() /
+              ("static_asset_test_" + std::to_string(getpid()));
+        std::filesystem::create_directory(dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    std::filesystem::path writeFile(const std::string& name,
+                                    const std::string& contents)
+    {
+        std::filesystem::path path = dir / name;
+        std::ofstream file(path, std::ios::binary);
+        file << contents;
+        return path;
+    }
+
+    std::filesystem::path dir;
+};
+
+} // namespace
+
+TEST_F(StaticAssetTest, MapsFileContents)
+{
+    std::unique_ptr<MappedFile> file =
+        MappedFile::map(writeFile("index.html", "<html></html>"));
+    ASSERT_NE(file, nullptr);
+    EXPECT_EQ(file->data(), "<html></html>");
+
+    std::unique_ptr<MappedFile> empty = MappedFile::map(writeFile("e", ""));
+    ASSERT_NE(empty, nullptr);
+    EXPECT_TRUE(empty->data().empty());
+
+    EXPECT_EQ(MappedFile::map(dir / "missing"), nullptr);
+}
+
+TEST_F(StaticAssetTest, CompressesTextOnFirstUse)
+{
+    std::string text;
+    for (int i = 0; i < 200; i++)
+    {
+        text += "function f" + std::to_string(i) + "() { return 1; }\n";
+    }
+
+    crow::webassets::StaticAsset asset;
+    asset.identity = MappedFile::map(writeFile("app.js", text));
+    asset.compressible = true;
+    std::string_view gzip = asset.gzip();
+    ASSERT_FALSE(gzip.empty());
+    EXPECT_LT(gzip.size(), text.size());
+    // Kept for later requests
+    EXPECT_EQ(asset.gzip().data(), gzip.data());
+
+    std::string inflated;
+    ASSERT_TRUE(gzipInflate(std::string(gzip), inflated));
+    EXPECT_EQ(inflated, text);
+
+    crow::webassets::StaticAsset image;
+    image.identity = MappedFile::map(writeFile("logo.png", text));
+    EXPECT_TRUE(image.gzip().empty());
+}
+
+TEST(StaticAsset, HasContentHash)
+{
+    using crow::webassets::hasContentHash;
+    EXPECT_TRUE(hasContentHash("app.0a1b2c3d.js"));
+    EXPECT_TRUE(hasContentHash("chunk-vendors.5f4e3d2c1b0a.css"));
+    EXPECT_TRUE(hasContentHash("app.0a1b2c3d.js.map"));
+    EXPECT_FALSE(hasContentHash("app.js"));
+    EXPECT_FALSE(hasContentHash("jquery.min.js"));
+    EXPECT_FALSE(hasContentHash("0a1b2c3d.js"));
+    EXPECT_FALSE(hasContentHash("app.0a1b2c3.js"));
+    EXPECT_FALSE(hasContentHash("index.html"));
+}
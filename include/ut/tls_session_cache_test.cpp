@@ -0,0 +1,157 @@
+#include <openssl/bio.h>
+#include <openssl/ssl.h>
+#include <unistd.h>
+
+#include <ssl_key_handler.hpp>
+#include <tls_session_cache.hpp>
+
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+// Runs a client/server handshake over an in-memory BIO pair, then sends one
+// byte so the client processes any TLS 1.3 session tickets.  Resumes from
+// session when it is set, and replaces it with the new client session.
+// Returns true if the server reports the session was resumed.
+bool handshake(SSL_CTX* serverCtx, SSL_CTX* clientCtx, bool serverTickets,
+               SSL_SESSION*& session)
+{
+    std::unique_ptr<SSL, decltype(&SSL_free)> server(SSL_new(serverCtx),
+                                                     &SSL_free);
+    std::unique_ptr<SSL, decltype(&SSL_free)> client(SSL_new(clientCtx),
+                                                     &SSL_free);
+    BIO* serverBio = nullptr;
+    BIO* clientBio = nullptr;
+    EXPECT_EQ(BIO_new_bio_pair(&serverBio, 0, &clientBio, 0), 1);
+    SSL_set_bio(server.get(), serverBio, serverBio);
+    SSL_set_bio(client.get(), clientBio, clientBio);
+    SSL_set_accept_state(server.get());
+    SSL_set_connect_state(client.get());
+    if (!serverTickets)
+    {
+        SSL_set_options(server.get(), SSL_OP_NO_TICKET);
+    }
+    if (session != nullptr)
+    {
+        SSL_set_session(client.get(), session);
+    }
+
+    bool clientDone = false;
+    bool serverDone = false;
+    for (int i = 0; i < 100 && !(clientDone && serverDone); i++)
+    {
+        clientDone = clientDone || SSL_do_handshake(client.get()) == 1;
+        serverDone = serverDone || SSL_do_handshake(server.get()) == 1;
+    }
+    EXPECT_TRUE(clientDone);
+    EXPECT_TRUE(serverDone);
+
+    std::array<char, 1> buf{'x'};
+    EXPECT_EQ(SSL_write(server.get(), buf.data(), 1), 1);
+    EXPECT_EQ(SSL_read(client.get(), buf.data(), 1), 1);
+
+    ensuressl::keepSessionResumable(server.get());
+    ensuressl::keepSessionResumable(client.get());
+    bool reused = SSL_session_reused(server.get()) != 0;
+    SSL_SESSION_free(session);
+    session = SSL_get1_session(client.get());
+    return reused;
+}
+
+class TlsSessionResumption : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        pemFile = std::filesystem::temp_directory_path() /
+                  ("tls_session_cache_test_" + std::to_string(getpid()) +
+                   ".pem");
+        ensuressl::generateSslCertificate(pemFile, "localhost");
+        serverCtx = ensuressl::getSslContext(pemFile);
+        clientCtx.reset(SSL_CTX_new(TLS_client_method()));
+        SSL_CTX_set_verify(clientCtx.get(), SSL_VERIFY_NONE, nullptr);
+    }
+
+    void TearDown() override
+    {
+        SSL_SESSION_free(session);
+        std::filesystem::remove(pemFile);
+    }
+
+    std::string pemFile;
+    std::shared_ptr<boost::asio::ssl::context> serverCtx;
+    std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> clientCtx{nullptr,
+                                                               &SSL_CTX_free};
+    SSL_SESSION* session = nullptr;
+};
+
+} // namespace
+
+TEST(TicketKeyRing, RotatesAfterLifetime)
+{
+    ensuressl::TicketKeyRing ring(seconds(60));
+    steady_clock::time_point start = steady_clock::now();
+
+    const ensuressl::TicketKey* key = ring.currentKey(start);
+    ASSERT_NE(key, nullptr);
+    std::array<unsigned char, ensuressl::ticketKeyNameSize> first = key->name;
+    EXPECT_EQ(ring.currentKey(start + seconds(59))->name, first);
+
+    key = ring.currentKey(start + seconds(60));
+    ASSERT_NE(key, nullptr);
+    std::array<unsigned char, ensuressl::ticketKeyNameSize> second =
+        key->name;
+    EXPECT_NE(second, first);
+
+    // The previous key is still accepted, but isn't used for new tickets
+    key = ring.findKey(first, start + seconds(90));
+    ASSERT_NE(key, nullptr);
+    EXPECT_FALSE(ring.isCurrent(*key));
+    key = ring.findKey(second, start + seconds(90));
+    ASSERT_NE(key, nullptr);
+    EXPECT_TRUE(ring.isCurrent(*key));
+
+    // Until it is two lifetimes old
+    EXPECT_EQ(ring.findKey(first, start + seconds(120)), nullptr);
+
+    std::array<unsigned char, ensuressl::ticketKeyNameSize> unknown{};
+    EXPECT_EQ(ring.findKey(unknown, start), nullptr);
+}
+
+TEST_F(TlsSessionResumption, ResumesFromTicket)
+{
+    EXPECT_FALSE(handshake(serverCtx->native_handle(), clientCtx.get(), true,
+                           session));
+    EXPECT_TRUE(handshake(serverCtx->native_handle(), clientCtx.get(), true,
+                          session));
+}
+
+TEST_F(TlsSessionResumption, ResumesFromSessionCache)
+{
+    EXPECT_FALSE(handshake(serverCtx->native_handle(), clientCtx.get(), false,
+                           session));
+    EXPECT_TRUE(handshake(serverCtx->native_handle(), clientCtx.get(), false,
+                          session));
+}
+
+TEST_F(TlsSessionResumption, TicketsSurviveCertificateReload)
+{
+    EXPECT_FALSE(handshake(serverCtx->native_handle(), clientCtx.get(), true,
+                           session));
+    // A new server context, as after a certificate reload, still accepts
+    // tickets, since the keys are kept process wide
+    std::shared_ptr<boost::asio::ssl::context> reloaded =
+        ensuressl::getSslContext(pemFile);
+    EXPECT_TRUE(
+        handshake(reloaded->native_handle(), clientCtx.get(), true, session));
+}
@@ -0,0 +1,123 @@
+#include <user_info_cache.hpp>
+
+#include <chrono>
+#include <string>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using crow::user_info::UserInfoCache;
+using crow::user_info::UserInfoMap;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+UserInfoMap userInfo(const std::string& role)
+{
+    return {{"UserPrivilege", role}, {"RemoteUser", false}};
+}
+
+} // namespace
+
+TEST(UserInfoCache, HitAfterInsert)
+{
+    UserInfoCache cache(seconds(60), 8);
+    steady_clock::time_point now = steady_clock::now();
+
+    EXPECT_EQ(cache.find("alice", now), nullptr);
+    cache.insert("alice", userInfo("priv-admin"), now, cache.getGeneration());
+
+    const UserInfoMap* info = cache.find("alice", now + seconds(59));
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(std::get<std::string>(info->at("UserPrivilege")), "priv-admin");
+}
+
+TEST(UserInfoCache, ExpiresAfterTtl)
+{
+    UserInfoCache cache(seconds(60), 8);
+    steady_clock::time_point now = steady_clock::now();
+    cache.insert("alice", userInfo("priv-admin"), now, cache.getGeneration());
+    EXPECT_EQ(cache.find("alice", now + seconds(60)), nullptr);
+}
+
+TEST(UserInfoCache, UserSignalDropsOnlyThatUser)
+{
+    UserInfoCache cache(seconds(60), 8);
+    steady_clock::time_point now = steady_clock::now();
+    cache.insert("alice", userInfo("priv-admin"), now, cache.getGeneration());
+    cache.insert("bob", userInfo("priv-user"), now, cache.getGeneration());
+
+    // A role change on alice is seen on her next request
+    cache.invalidate("/xyz/openbmc_project/user/alice");
+    EXPECT_EQ(cache.find("alice", now), nullptr);
+    EXPECT_NE(cache.find("bob", now), nullptr);
+
+    cache.insert("alice", userInfo("priv-readonly"), now,
+                 cache.getGeneration());
+    const UserInfoMap* info = cache.find("alice", now);
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(std::get<std::string>(info->at("UserPrivilege")),
+              "priv-readonly");
+}
+
+TEST(UserInfoCache, OtherSignalsDropEverything)
+{
+    UserInfoCache cache(seconds(60), 8);
+    steady_clock::time_point now = steady_clock::now();
+
+    for (const char* path :
+         {"/xyz/openbmc_project/user", "/xyz/openbmc_project/user/ldap",
+          "/xyz/openbmc_project/user/ldap/openldap/role_map/1"})
+    {
+        cache.insert("alice", userInfo("priv-admin"), now,
+                     cache.getGeneration());
+        cache.insert("bob", userInfo("priv-user"), now, cache.getGeneration());
+        cache.invalidate(path);
+        EXPECT_EQ(cache.find("alice", now), nullptr) << path;
+        EXPECT_EQ(cache.find("bob", now), nullptr) << path;
+    }
+}
+
+TEST(UserInfoCache, StaleFetchIsNotCached)
+{
+    UserInfoCache cache(seconds(60), 8);
+    steady_clock::time_point now = steady_clock::now();
+
+    // The user changes while a fetch is in flight, so its result may predate
+    // the change
+    uint64_t generation = cache.getGeneration();
+    cache.invalidate("/xyz/openbmc_project/user/alice");
+    cache.insert("alice", userInfo("priv-admin"), now, generation);
+    EXPECT_EQ(cache.find("alice", now), nullptr);
+}
+
+TEST(UserInfoCache, EvictsOldestWhenFull)
+{
+    UserInfoCache cache(seconds(60), 2);
+    steady_clock::time_point now = steady_clock::now();
+    cache.insert("alice", userInfo("priv-admin"), now, cache.getGeneration());
+    cache.insert("bob", userInfo("priv-user"), now + seconds(1),
+                 cache.getGeneration());
+    cache.insert("carol", userInfo("priv-user"), now + seconds(2),
+                 cache.getGeneration());
+
+    EXPECT_EQ(cache.find("alice", now + seconds(2)), nullptr);
+    EXPECT_NE(cache.find("bob", now + seconds(2)), nullptr);
+    EXPECT_NE(cache.find("carol", now + seconds(2)), nullptr);
+}
+
+TEST(UserInfoCache, UserNameFromObjectPath)
+{
+    using crow::user_info::userNameFromObjectPath;
+    EXPECT_EQ(userNameFromObjectPath("/xyz/openbmc_project/user/alice"),
+              "alice");
+    EXPECT_EQ(userNameFromObjectPath("/xyz/openbmc_project/user"), "");
+    EXPECT_EQ(userNameFromObjectPath("/xyz/openbmc_project/user/"), "");
+    EXPECT_EQ(userNameFromObjectPath("/xyz/openbmc_project/user/ldap"), "");
+    EXPECT_EQ(
+        userNameFromObjectPath("/xyz/openbmc_project/user/ldap/openldap"),
+        "");
+    EXPECT_EQ(userNameFromObjectPath("/xyz/openbmc_project/users/alice"),
+              "");
+}
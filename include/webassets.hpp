@@ -4,14 +4,20 @@
 
 #include <app.hpp>
 #include <boost/algorithm/string/replace.hpp>
+#include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
 #include <http_request.hpp>
 #include <http_response.hpp>
+#include <http_utility.hpp>
 #include <routing.hpp>
+#include <static_asset.hpp>
 
+#include <algorithm>
+#include <array>
 #include <filesystem>
-#include <fstream>
+#include <memory>
 #include <string>
+#include <string_view>
 
 namespace crow
 {
@@ -50,6 +56,10 @@ inline void requestRoutes(App& app)
              // https://stackoverflow.com/questions/19911929/what-mime-type-should-i-use-for-javascript-source-map-files
              {".map", "application/json"}}};
 
+    // Text that is worth compressing when no .gz file is provided
+    constexpr static std::array<std::string_view, 7> compressibleExtensions{
+        ".css", ".html", ".js", ".svg", ".xml", ".json", ".map"};
+
     std::filesystem::path rootpath{"/usr/share/www/"};
 
     std::error_code ec;
@@ -62,15 +72,13 @@ inline void requestRoutes(App& app)
         return;
     }
 
-    // In certain cases, we might have both a gzipped version of the file AND a
-    // non-gzipped version.  To avoid duplicated routes, we need to make sure we
-    // get the gzipped version first.  Because the gzipped path should be longer
-    // than the non gzipped path, if we sort in descending order, we should be
-    // guaranteed to get the gzip version first.
     std::vector<std::filesystem::directory_entry> paths(
         std::filesystem::begin(dirIter), std::filesystem::end(dirIter));
-    std::sort(paths.rbegin(), paths.rend());
 
+    // Files are mapped once here, and every request is served from the
+    // mapping.  A file and its .gz variant make up one asset.
+    boost::container::flat_map<std::string, std::shared_ptr<StaticAsset>>
+        assets;
     for (const std::filesystem::directory_entry& dir : paths)
     {
         const std::filesystem::path& absolutePath = dir.path();
@@ -89,17 +97,18 @@ inline void requestRoutes(App& app)
         {
             std::string extension = relativePath.extension();
             std::filesystem::path webpath = relativePath;
-            const char* contentEncoding = nullptr;
+            bool gzip = false;
 
             if (extension == ".gz")
             {
                 webpath = webpath.replace_extension("");
                 // Use the non-gzip version for determining content type
                 extension = webpath.extension().string();
-                contentEncoding = "gzip";
+                gzip = true;
             }
+            std::string filename = webpath.filename().string();
 
-            if (boost::starts_with(webpath.filename().string(), "index."))
+            if (boost::starts_with(filename, "index."))
             {
                 webpath = webpath.parent_path();
                 if (webpath.string().size() == 0 ||
@@ -111,72 +120,121 @@ inline void requestRoutes(App& app)
                 }
             }
 
-            std::pair<boost::container::flat_set<std::string>::iterator, bool>
-                inserted = webroutes::routes.insert(webpath);
-
-            if (!inserted.second)
-            {
-                // Got a duplicated path.  This is expected in certain
-                // situations
-                BMCWEB_LOG_DEBUG << "Got duplicated path " << webpath;
-                continue;
-            }
-            const char* contentType = nullptr;
-
-            for (const std::pair<const char*, const char*>& ext : contentTypes)
+            std::shared_ptr<StaticAsset>& asset = assets[webpath.string()];
+            if (asset == nullptr)
             {
-                if (ext.first == nullptr || ext.second == nullptr)
+                asset = std::make_shared<StaticAsset>();
+                for (const std::pair<const char*, const char*>& ext :
+                     contentTypes)
                 {
-                    continue;
+                    if (ext.first == nullptr || ext.second == nullptr)
+                    {
+                        continue;
+                    }
+                    if (extension == ext.first)
+                    {
+                        asset->contentType = ext.second;
+                    }
                 }
-                if (extension == ext.first)
+                if (asset->contentType == nullptr)
                 {
-                    contentType = ext.second;
+                    BMCWEB_LOG_ERROR << "Cannot determine content-type for "
+                                     << absolutePath << " with extension "
+                                     << extension;
                 }
+                asset->compressible =
+                    std::find(compressibleExtensions.begin(),
+                              compressibleExtensions.end(),
+                              extension) != compressibleExtensions.end();
+                asset->immutable = hasContentHash(filename);
             }
 
-            if (contentType == nullptr)
-            {
-                BMCWEB_LOG_ERROR << "Cannot determine content-type for "
-                                 << absolutePath << " with extension "
-                                 << extension;
-            }
-
-            if (webpath == "/")
+            std::unique_ptr<MappedFile>& variant =
+                gzip ? asset->gzipFile : asset->identity;
+            if (variant != nullptr)
             {
-                forward_unauthorized::hasWebuiRoute = true;
+                // Got a duplicated path.  This is expected in certain
+                // situations
+                BMCWEB_LOG_DEBUG << "Got duplicated path " << webpath;
+                continue;
             }
+            variant = MappedFile::map(absolutePath);
+        }
+    }
 
-            app.routeDynamic(webpath)(
-                [absolutePath, contentType, contentEncoding](
-                    const crow::Request&,
-                    const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
-                    if (contentType != nullptr)
-                    {
-                        asyncResp->res.addHeader("Content-Type", contentType);
-                    }
+    for (const std::pair<std::string, std::shared_ptr<StaticAsset>>& entry :
+         assets)
+    {
+        const std::string& webpath = entry.first;
+        const std::shared_ptr<StaticAsset>& asset = entry.second;
+        if (asset->identity == nullptr && asset->gzipFile == nullptr)
+        {
+            continue;
+        }
+        asset->etag = http_helpers::getETag(
+            asset->identity != nullptr ? asset->identity->data()
+                                       : asset->gzipFile->data());
 
-                    if (contentEncoding != nullptr)
-                    {
-                        asyncResp->res.addHeader("Content-Encoding",
-                                                 contentEncoding);
-                    }
+        webroutes::routes.insert(webpath);
+        if (webpath == "/")
+        {
+            forward_unauthorized::hasWebuiRoute = true;
+        }
 
-                    // res.set_header("Cache-Control", "public, max-age=86400");
-                    std::ifstream inf(absolutePath);
-                    if (!inf)
-                    {
-                        BMCWEB_LOG_DEBUG << "failed to read file";
-                        asyncResp->res.result(
-                            boost::beast::http::status::internal_server_error);
-                        return;
-                    }
+        app.routeDynamic(webpath)(
+            [asset](const crow::Request& req,
+                    const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                crow::Response& res = asyncResp->res;
+                if (asset->contentType != nullptr)
+                {
+                    res.addHeader(boost::beast::http::field::content_type,
+                                  asset->contentType);
+                }
+                // Files named by their content never change, the rest are
+                // revalidated against the ETag
+                res.addHeader(boost::beast::http::field::cache_control,
+                              asset->immutable
+                                  ? "public, max-age=31536000, immutable"
+                                  : "no-cache");
+
+                if (asset->identity == nullptr)
+                {
+                    // Only the compressed file exists
+                    res.addHeader(boost::beast::http::field::content_encoding,
+                                  "gzip");
+                    res.addHeader(boost::beast::http::field::etag,
+                                  asset->etag);
+                    res.staticBody = asset->gzipFile->data();
+                    return;
+                }
 
-                    asyncResp->res.body() = {
-                        std::istreambuf_iterator<char>(inf),
-                        std::istreambuf_iterator<char>()};
-                });
-        }
+                std::string_view gzip;
+                std::string_view acceptEncoding = req.getHeaderValue(
+                    boost::beast::http::field::accept_encoding);
+                if (http_helpers::getPreferredContentEncoding(
+                        acceptEncoding) == http_helpers::ContentEncoding::Gzip)
+                {
+                    gzip = asset->gzip();
+                }
+                if (asset->gzipFile != nullptr || asset->compressible)
+                {
+                    res.addHeader(boost::beast::http::field::vary,
+                                  "Accept-Encoding");
+                }
+                if (gzip.empty())
+                {
+                    res.addHeader(boost::beast::http::field::etag,
+                                  asset->etag);
+                    res.staticBody = asset->identity->data();
+                    return;
+                }
+                std::string etag = asset->etag;
+                etag.insert(etag.size() - 1, "-gzip");
+                res.addHeader(boost::beast::http::field::content_encoding,
+                              "gzip");
+                res.addHeader(boost::beast::http::field::etag, etag);
+                res.staticBody = gzip;
+            });
     }
 }
 } // namespace webassets
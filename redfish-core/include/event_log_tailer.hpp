@@ -0,0 +1,171 @@
+#pragma once
+
+#include "logging.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+
+/**
+ * EventLogTailer
+ * Reads the lines appended to a log file since it last did, without reading
+ * the rest of it again.  The file is kept open, so that when the logger
+ * rotates it, what was written to the old file after the last read is still
+ * read before moving on to the new one.  A file that was truncated is read
+ * again from its start.
+ */
+class EventLogTailer
+{
+  public:
+    explicit EventLogTailer(std::string pathIn) : path(std::move(pathIn))
+    {}
+
+    ~EventLogTailer()
+    {
+        closeFile();
+    }
+
+    EventLogTailer(const EventLogTailer&) = delete;
+    EventLogTailer(EventLogTailer&&) = delete;
+    EventLogTailer& operator=(const EventLogTailer&) = delete;
+    EventLogTailer& operator=(EventLogTailer&&) = delete;
+
+    // Skips what the file holds now, so that only lines appended later are
+    // read.  If it doesn't exist, all of it is read once it does.
+    void seekToEnd()
+    {
+        closeFile();
+        if (!openFile())
+        {
+            return;
+        }
+        struct stat st = {};
+        if (fstat(fd, &st) == 0)
+        {
+            offset = st.st_size;
+        }
+    }
+
+    // The complete lines appended since the last call, in order.  A line
+    // still being written is held back until its newline is.
+    std::vector<std::string> readNewLines()
+    {
+        std::vector<std::string> lines;
+        if (fd < 0 && !openFile())
+        {
+            return lines;
+        }
+
+        struct stat st = {};
+        if (fstat(fd, &st) != 0)
+        {
+            BMCWEB_LOG_ERROR << "Failed to stat " << path;
+            closeFile();
+            return lines;
+        }
+        if (st.st_size < offset)
+        {
+            BMCWEB_LOG_DEBUG << path << " was truncated, reading it again";
+            offset = 0;
+            partial.clear();
+        }
+        readLines(lines);
+
+        // Once everything written to the old file is read, move on to the
+        // file that replaced it
+        struct stat current = {};
+        if (stat(path.c_str(), &current) != 0)
+        {
+            return lines;
+        }
+        if (current.st_dev == st.st_dev && current.st_ino == st.st_ino)
+        {
+            return lines;
+        }
+        BMCWEB_LOG_DEBUG << path << " was replaced, reading the new file";
+        if (!partial.empty())
+        {
+            // Nothing more is written to a rotated file
+            lines.push_back(std::move(partial));
+            partial.clear();
+        }
+        closeFile();
+        if (openFile())
+        {
+            readLines(lines);
+        }
+        return lines;
+    }
+
+  private:
+    bool openFile()
+    {
+        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        offset = 0;
+        partial.clear();
+        if (fd < 0)
+        {
+            BMCWEB_LOG_DEBUG << "Failed to open " << path;
+            return false;
+        }
+        return true;
+    }
+
+    void closeFile()
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    void readLines(std::vector<std::string>& lines)
+    {
+        std::array<char, 4096> buffer{};
+        while (true)
+        {
+            ssize_t bytes = pread(fd, buffer.data(), buffer.size(), offset);
+            if (bytes <= 0)
+            {
+                if (bytes < 0)
+                {
+                    BMCWEB_LOG_ERROR << "Failed to read " << path;
+                }
+                return;
+            }
+            offset += bytes;
+            const char* begin = buffer.data();
+            const char* end = begin + bytes;
+            for (const char* it = begin; it != end; it++)
+            {
+                if (*it != '\n')
+                {
+                    continue;
+                }
+                partial.append(begin, it);
+                lines.push_back(std::move(partial));
+                partial.clear();
+                begin = it + 1;
+            }
+            partial.append(begin, end);
+        }
+    }
+
+    std::string path;
+    int fd = -1;
+    // Where the next read starts
+    off_t offset = 0;
+    // The start of a line whose newline hasn't been read yet
+    std::string partial;
+};
+
+} // namespace redfish
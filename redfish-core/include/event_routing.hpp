@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+
+/**
+ * EventRoutingIndex
+ * The subscriptions each event goes to, by the filters they set, so that an
+ * event only visits the subscriptions it matches.  An empty filter list
+ * matches everything.  The index is rebuilt whenever subscriptions change.
+ */
+class EventRoutingIndex
+{
+  public:
+    void clear()
+    {
+        allResourceTypes.clear();
+        byResourceType.clear();
+        allRegistries.clear();
+        byRegistryPrefix.clear();
+        byMessageId.clear();
+        byPrefixAndMessageId.clear();
+    }
+
+    // A subscription that gets events, filtered by resourceTypes
+    void addEventSubscription(const std::string& id,
+                              const std::vector<std::string>& resourceTypes)
+    {
+        if (resourceTypes.empty())
+        {
+            allResourceTypes.push_back(id);
+            return;
+        }
+        for (const std::string& resourceType : unique(resourceTypes))
+        {
+            byResourceType[resourceType].push_back(id);
+        }
+    }
+
+    // A subscription that gets event log entries, filtered by the prefixes
+    // of their registries and by their message ids within the registry
+    void addLogSubscription(const std::string& id,
+                            const std::vector<std::string>& registryPrefixes,
+                            const std::vector<std::string>& messageIds)
+    {
+        if (registryPrefixes.empty() && messageIds.empty())
+        {
+            allRegistries.push_back(id);
+            return;
+        }
+        if (messageIds.empty())
+        {
+            for (const std::string& prefix : unique(registryPrefixes))
+            {
+                byRegistryPrefix[prefix].push_back(id);
+            }
+            return;
+        }
+        if (registryPrefixes.empty())
+        {
+            for (const std::string& messageId : unique(messageIds))
+            {
+                byMessageId[messageId].push_back(id);
+            }
+            return;
+        }
+        for (const std::string& prefix : unique(registryPrefixes))
+        {
+            for (const std::string& messageId : unique(messageIds))
+            {
+                byPrefixAndMessageId[{prefix, messageId}].push_back(id);
+            }
+        }
+    }
+
+    // Calls callback with the id of each subscription an event about
+    // resourceType goes to, once each
+    template <typename Callback>
+    void forEachEventSubscription(const std::string& resourceType,
+                                  Callback&& callback) const
+    {
+        visit(allResourceTypes, callback);
+        visit(byResourceType, resourceType, callback);
+    }
+
+    // Calls callback with the id of each subscription a log entry from the
+    // registry with registryPrefix and with messageId goes to, once each
+    template <typename Callback>
+    void forEachLogSubscription(const std::string& registryPrefix,
+                                const std::string& messageId,
+                                Callback&& callback) const
+    {
+        visit(allRegistries, callback);
+        visit(byRegistryPrefix, registryPrefix, callback);
+        visit(byMessageId, messageId, callback);
+        visit(byPrefixAndMessageId, std::make_pair(registryPrefix, messageId),
+              callback);
+    }
+
+  private:
+    static std::vector<std::string> unique(std::vector<std::string> values)
+    {
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        return values;
+    }
+
+    template <typename Callback>
+    static void visit(const std::vector<std::string>& ids, Callback& callback)
+    {
+        for (const std::string& id : ids)
+        {
+            callback(id);
+        }
+    }
+
+    template <typename Map, typename Key, typename Callback>
+    static void visit(const Map& map, const Key& key, Callback& callback)
+    {
+        auto it = map.find(key);
+        if (it != map.end())
+        {
+            visit(it->second, callback);
+        }
+    }
+
+    // A subscription is in exactly one list of each kind, and in at most one
+    // of the lists that match an event, so each match is visited once
+    std::vector<std::string> allResourceTypes;
+    std::map<std::string, std::vector<std::string>, std::less<>>
+        byResourceType;
+    std::vector<std::string> allRegistries;
+    std::map<std::string, std::vector<std::string>, std::less<>>
+        byRegistryPrefix;
+    std::map<std::string, std::vector<std::string>, std::less<>> byMessageId;
+    std::map<std::pair<std::string, std::string>, std::vector<std::string>>
+        byPrefixAndMessageId;
+};
+
+} // namespace redfish
@@ -25,17 +25,24 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/container/flat_map.hpp>
 #include <error_messages.hpp>
+#include <event_log_tailer.hpp>
+#include <event_routing.hpp>
 #include <event_service_store.hpp>
+#include <event_spool.hpp>
 #include <http_client.hpp>
 #include <persistent_data.hpp>
 #include <random.hpp>
 #include <server_sent_events.hpp>
+#include <stats.hpp>
 #include <utils/json_utils.hpp>
 
 #include <cstdlib>
 #include <ctime>
+#include <filesystem>
 #include <fstream>
+#include <map>
 #include <memory>
+#include <set>
 #include <variant>
 
 namespace redfish
@@ -50,6 +57,14 @@ static constexpr const char* metricReportFormatType = "MetricReport";
 static constexpr const char* eventServiceFile =
     "/var/lib/bmcweb/eventservice_config.json";
 
+// Holds a directory of undelivered events for each subscription
+static constexpr const char* eventSpoolDir = "/var/lib/bmcweb/event-spool";
+// Spooled events of a subscription handed to its connection at once
+static constexpr size_t maxSpooledInFlight = 32;
+// Spooled events are synced to disk once this many are written, or a second
+// after the first one was
+static constexpr size_t spoolSyncBatch = 32;
+
 namespace message_registries
 {
 inline boost::beast::span<const MessageEntry>
@@ -371,7 +386,17 @@ inline bool
     return true;
 }
 
-class Subscription : public persistent_data::UserSubscription
+// Serializes an event once, to be shared by every subscriber it goes to
+inline std::shared_ptr<const std::string>
+    serializeEvent(const nlohmann::json& event)
+{
+    bmcweb::stats::increment("event_service.serialized");
+    return std::make_shared<const std::string>(
+        event.dump(2, ' ', true, nlohmann::json::error_handler_t::replace));
+}
+
+class Subscription : public persistent_data::UserSubscription,
+                     public std::enable_shared_from_this<Subscription>
 {
   public:
     Subscription(const Subscription&) = delete;
@@ -393,39 +418,36 @@ class Subscription : public persistent_data::UserSubscription
         sseConn = std::make_shared<crow::ServerSentEvents>(adaptor);
     }
 
-    ~Subscription() = default;
+    ~Subscription()
+    {
+        if (spool != nullptr)
+        {
+            spool->sync();
+        }
+    }
 
-    void sendEvent(const std::string& msg)
+    void sendEvent(const std::shared_ptr<const std::string>& msg)
     {
         if (subscriptionType == "SNMPTrap")
         {
             return; // Don't need send SNMPTrap event.
         }
+        bmcweb::stats::increment("event_service.deliveries");
 
-        if (conn == nullptr)
-        {
-            // create the HttpClient connection
-            BMCWEB_LOG_ERROR
-                << "HttpClient connection is null. Create a conn for id:"
-                << subId << " destination: " << host << ":" << port;
-            conn = std::make_shared<crow::HttpClient>(
-                crow::connections::systemBus->get_io_context(), subId, host,
-                port, path, uriProto, httpHeaders);
-            uint32_t retryAttempts;
-            uint32_t retryTimeoutInterval;
-            persistent_data::EventServiceConfig eventServiceConfig =
-                persistent_data::EventServiceStore::getInstance()
-                    .getEventServiceConfig();
-
-            retryAttempts = eventServiceConfig.retryAttempts;
-            retryTimeoutInterval = eventServiceConfig.retryTimeoutInterval;
-
-            conn->setRetryPolicy(retryPolicy);
-            conn->setRetryConfig(retryAttempts, retryTimeoutInterval);
-        }
+        createConn();
         if (conn->getConnState() != crow::ConnState::terminated)
         {
-            conn->sendData(msg);
+            // A suspended subscription drops new events, as it would without
+            // the spool, rather than writing every one of them to disk
+            if (spool != nullptr &&
+                conn->getConnState() == crow::ConnState::active)
+            {
+                spoolEvent(msg);
+            }
+            else
+            {
+                conn->sendData(msg);
+            }
             this->eventSeqNum++;
         }
 
@@ -456,57 +478,20 @@ class Subscription : public persistent_data::UserSubscription
                               {"Name", "Event Log"},
                               {"Events", logEntryArray}};
 
-        this->sendEvent(
-            msg.dump(2, ' ', true, nlohmann::json::error_handler_t::replace));
+        this->sendEvent(serializeEvent(msg));
     }
 
 #ifndef BMCWEB_ENABLE_REDFISH_DBUS_LOG_ENTRIES
-    void filterAndSendEventLogs(
-        const std::vector<EventLogObjectsType>& eventRecords)
+    // Sends the log entries at indices, which the routing index matched to
+    // this subscription.  logEntries holds them formatted without Context.
+    void sendEventLogs(const std::vector<nlohmann::json>& logEntries,
+                       const std::vector<size_t>& indices)
     {
         nlohmann::json logEntryArray;
-        for (const EventLogObjectsType& logEntry : eventRecords)
-        {
-            const std::string& idStr = std::get<0>(logEntry);
-            const std::string& timestamp = std::get<1>(logEntry);
-            const std::string& messageID = std::get<2>(logEntry);
-            const std::string& registryName = std::get<3>(logEntry);
-            const std::string& messageKey = std::get<4>(logEntry);
-            const std::vector<std::string>& messageArgs = std::get<5>(logEntry);
-
-            // If registryPrefixes list is empty, don't filter events
-            // send everything.
-            if (registryPrefixes.size())
-            {
-                auto obj = std::find(registryPrefixes.begin(),
-                                     registryPrefixes.end(), registryName);
-                if (obj == registryPrefixes.end())
-                {
-                    continue;
-                }
-            }
-
-            // If registryMsgIds list is empty, don't filter events
-            // send everything.
-            if (registryMsgIds.size())
-            {
-                auto obj = std::find(registryMsgIds.begin(),
-                                     registryMsgIds.end(), messageKey);
-                if (obj == registryMsgIds.end())
-                {
-                    continue;
-                }
-            }
-
-            logEntryArray.push_back({});
-            nlohmann::json& bmcLogEntry = logEntryArray.back();
-            if (event_log::formatEventLogEntry(idStr, messageID, messageArgs,
-                                               timestamp, customText,
-                                               bmcLogEntry) != 0)
-            {
-                BMCWEB_LOG_DEBUG << "Read eventLog entry failed";
-                continue;
-            }
+        for (size_t index : indices)
+        {
+            logEntryArray.push_back(logEntries[index]);
+            logEntryArray.back()["Context"] = customText;
         }
 
         if (logEntryArray.size() < 1)
@@ -520,8 +505,7 @@ class Subscription : public persistent_data::UserSubscription
                               {"Name", "Event Log"},
                               {"Events", logEntryArray}};
 
-        this->sendEvent(
-            msg.dump(2, ' ', true, nlohmann::json::error_handler_t::replace));
+        this->sendEvent(serializeEvent(msg));
     }
 #endif
 
@@ -551,8 +535,7 @@ class Subscription : public persistent_data::UserSubscription
             return;
         }
 
-        this->sendEvent(
-            msg.dump(2, ' ', true, nlohmann::json::error_handler_t::replace));
+        this->sendEvent(serializeEvent(msg));
     }
 
     void updateRetryConfig(const uint32_t retryAttempts,
@@ -582,7 +565,237 @@ class Subscription : public persistent_data::UserSubscription
         subId = id;
     }
 
+    // Keeps the events of a subscription with a destination on disk until
+    // the destination takes them, and sends what a previous run left
+    // undelivered
+    void openSpool()
+    {
+        if (bmcwebEventSpoolSizeKb == 0 || sseConn != nullptr ||
+            subscriptionType == "SNMPTrap" || spool != nullptr ||
+            subId.empty() || subId == "." || subId == ".." ||
+            subId.find('/') != std::string::npos)
+        {
+            return;
+        }
+        spool = std::make_unique<EventSpool>(
+            std::filesystem::path(eventSpoolDir) / subId,
+            bmcwebEventSpoolSizeKb * 1024);
+        if (!spool->open())
+        {
+            spool.reset();
+            return;
+        }
+        nextSpooled = spool->getAckedThrough();
+        if (nextSpooled < spool->getNextSeq())
+        {
+            BMCWEB_LOG_INFO << "Replaying "
+                            << spool->getNextSeq() - nextSpooled
+                            << " spooled events for subscription " << subId;
+            createConn();
+            pumpSpool();
+        }
+    }
+
+    // Deletes the spooled events, once the subscription is deleted
+    void removeSpool()
+    {
+        if (spool != nullptr)
+        {
+            spool->remove();
+            spool.reset();
+        }
+        respool.clear();
+    }
+
   private:
+    void createConn()
+    {
+        if (conn != nullptr)
+        {
+            return;
+        }
+        // create the HttpClient connection
+        BMCWEB_LOG_ERROR
+            << "HttpClient connection is null. Create a conn for id:" << subId
+            << " destination: " << host << ":" << port;
+        conn = std::make_shared<crow::HttpClient>(
+            crow::connections::systemBus->get_io_context(), subId, host, port,
+            path, uriProto, httpHeaders);
+        uint32_t retryAttempts;
+        uint32_t retryTimeoutInterval;
+        persistent_data::EventServiceConfig eventServiceConfig =
+            persistent_data::EventServiceStore::getInstance()
+                .getEventServiceConfig();
+
+        retryAttempts = eventServiceConfig.retryAttempts;
+        retryTimeoutInterval = eventServiceConfig.retryTimeoutInterval;
+
+        conn->setRetryPolicy(retryPolicy);
+        conn->setRetryConfig(retryAttempts, retryTimeoutInterval);
+    }
+
+    void spoolEvent(const std::shared_ptr<const std::string>& msg)
+    {
+        std::optional<uint64_t> seq = spool->append(*msg);
+        if (!seq)
+        {
+            // Still sent, just not durably
+            conn->sendData(msg);
+            return;
+        }
+        bmcweb::stats::increment("event_service.spool.appended");
+        lastSpooled = msg;
+        lastSpooledSeq = *seq;
+        if (spool->getUnsynced() >= spoolSyncBatch)
+        {
+            spool->sync();
+        }
+        pumpSpool();
+        armSpoolTimer();
+    }
+
+    // Hands spooled events to the connection in order, starting with those
+    // that came back undelivered, as long as it takes them
+    void pumpSpool()
+    {
+        while (spool != nullptr && spoolInFlight < maxSpooledInFlight &&
+               conn->getConnState() == crow::ConnState::active)
+        {
+            bool resend = !respool.empty();
+            uint64_t seq = 0;
+            if (resend)
+            {
+                seq = *respool.begin();
+            }
+            else if (nextSpooled < spool->getNextSeq())
+            {
+                seq = nextSpooled;
+            }
+            else
+            {
+                return;
+            }
+
+            // Events dropped from a full spool count as acknowledged
+            if (!spool->isAcked(seq))
+            {
+                std::shared_ptr<const std::string> data;
+                if (lastSpooled != nullptr && seq == lastSpooledSeq)
+                {
+                    data = lastSpooled;
+                }
+                else if (std::optional<std::string> event = spool->read(seq))
+                {
+                    bmcweb::stats::increment("event_service.spool.replayed");
+                    data = std::make_shared<const std::string>(
+                        std::move(*event));
+                }
+
+                if (data == nullptr)
+                {
+                    BMCWEB_LOG_ERROR << "Failed to read spooled event " << seq
+                                     << " of subscription " << subId;
+                    spool->ack(seq);
+                }
+                else if (!conn->sendData(
+                             data, [weak(weak_from_this()),
+                                    seq](bool delivered) {
+                                 std::shared_ptr<Subscription> self =
+                                     weak.lock();
+                                 if (self != nullptr)
+                                 {
+                                     self->spooledEventDone(seq, delivered);
+                                 }
+                             }))
+                {
+                    // The queue of the destination is full, try again later
+                    armSpoolTimer();
+                    return;
+                }
+                else
+                {
+                    spoolInFlight++;
+                }
+            }
+
+            if (resend)
+            {
+                respool.erase(respool.begin());
+            }
+            else
+            {
+                nextSpooled++;
+            }
+        }
+    }
+
+    void spooledEventDone(uint64_t seq, bool delivered)
+    {
+        spoolInFlight--;
+        if (spool == nullptr)
+        {
+            return;
+        }
+        if (delivered)
+        {
+            spool->ack(seq);
+        }
+        else if (conn->getConnState() == crow::ConnState::terminated)
+        {
+            // TerminateAfterRetries gave up on the destination for good
+            removeSpool();
+            return;
+        }
+        else
+        {
+            // With RetryForever it goes out again.  A suspended subscription
+            // keeps it on disk, and sends it after a restart.
+            respool.insert(seq);
+        }
+        pumpSpool();
+        armSpoolTimer();
+    }
+
+    // Syncs the spool a little later, so that one fsync covers the events
+    // and acknowledgements until then, and resumes sending if the
+    // destination queue was full
+    void armSpoolTimer()
+    {
+        if (spool == nullptr || spoolTimerArmed)
+        {
+            return;
+        }
+        if (!spoolTimer)
+        {
+            spoolTimer.emplace(crow::connections::systemBus->get_io_context());
+        }
+        spoolTimerArmed = true;
+        spoolTimer->expires_after(std::chrono::seconds(1));
+        spoolTimer->async_wait([weak(weak_from_this())](
+                                   const boost::system::error_code& ec) {
+            std::shared_ptr<Subscription> self = weak.lock();
+            if (ec || self == nullptr)
+            {
+                return;
+            }
+            self->spoolTimerArmed = false;
+            if (self->spool == nullptr)
+            {
+                return;
+            }
+            self->spool->sync();
+            self->pumpSpool();
+            if (self->spoolInFlight == 0 &&
+                self->conn->getConnState() == crow::ConnState::active &&
+                (!self->respool.empty() ||
+                 self->nextSpooled < self->spool->getNextSeq()))
+            {
+                // Nothing in flight to resume sending once it's answered
+                self->armSpoolTimer();
+            }
+        });
+    }
+
     uint64_t eventSeqNum;
     std::string subId;
     std::string host;
@@ -591,6 +804,18 @@ class Subscription : public persistent_data::UserSubscription
     std::string uriProto;
     std::shared_ptr<crow::HttpClient> conn = nullptr;
     std::shared_ptr<crow::ServerSentEvents> sseConn = nullptr;
+
+    std::unique_ptr<EventSpool> spool;
+    // The next spooled event that was never handed to conn
+    uint64_t nextSpooled = 0;
+    // Spooled events handed to conn that came back undelivered
+    std::set<uint64_t> respool;
+    size_t spoolInFlight = 0;
+    // The last spooled event, which is usually sent without reading it back
+    std::shared_ptr<const std::string> lastSpooled;
+    uint64_t lastSpooledSeq = 0;
+    std::optional<boost::asio::steady_timer> spoolTimer;
+    bool spoolTimerArmed = false;
 };
 
 class EventServiceManager
@@ -607,7 +832,10 @@ class EventServiceManager
     }
 
     std::string snmpDbusId;
-    std::string lastEventTStr;
+#ifndef BMCWEB_ENABLE_REDFISH_DBUS_LOG_ENTRIES
+    // Where reading the redfish event log file left off
+    EventLogTailer eventLogTailer{redfishEventLogFile};
+#endif
     size_t noOfEventLogSubscribers{0};
     size_t noOfMetricReportSubscribers{0};
     std::shared_ptr<sdbusplus::bus::match::match> matchTelemetryMonitor;
@@ -616,6 +844,10 @@ class EventServiceManager
 
     uint64_t eventId{1};
 
+    // The subscriptions each event goes to, rebuilt whenever subscriptions
+    // are added, changed or deleted
+    EventRoutingIndex routingIndex;
+
   public:
     EventServiceManager(const EventServiceManager&) = delete;
     EventServiceManager& operator=(const EventServiceManager&) = delete;
@@ -683,20 +915,32 @@ class EventServiceManager
             subscriptionsMap.insert(std::pair(subValue->id, subValue));
 
             updateNoOfSubscribersCount();
-
-#ifndef BMCWEB_ENABLE_REDFISH_DBUS_LOG_ENTRIES
-            if (lastEventTStr.empty())
-            {
-                cacheLastEventTimestamp();
-            }
-#endif
+            updateRoutingIndex();
             // Update retry configuration.
             subValue->updateRetryConfig(retryAttempts, retryTimeoutInterval);
             subValue->updateRetryPolicy();
+            subValue->openSpool();
         }
+        removeOrphanedSpools();
         return;
     }
 
+    // Spools left by subscriptions that no longer exist
+    void removeOrphanedSpools()
+    {
+        std::error_code ec;
+        for (const auto& entry :
+             std::filesystem::directory_iterator(eventSpoolDir, ec))
+        {
+            if (subscriptionsMap.find(entry.path().filename().string()) ==
+                subscriptionsMap.end())
+            {
+                BMCWEB_LOG_INFO << "Removing event spool " << entry.path();
+                std::filesystem::remove_all(entry.path(), ec);
+            }
+        }
+    }
+
     void loadOldBehavior()
     {
         std::ifstream eventConfigFile(eventServiceFile);
@@ -871,6 +1115,24 @@ class EventServiceManager
         }
     }
 
+    void updateRoutingIndex()
+    {
+        routingIndex.clear();
+        for (const auto& [id, entry] : subscriptionsMap)
+        {
+            if (entry->subscriptionType == "SNMPTrap")
+            {
+                continue; // Don't need send SNMPTrap event.
+            }
+            routingIndex.addEventSubscription(id, entry->resourceTypes);
+            if (entry->eventFormatType == eventFormatType)
+            {
+                routingIndex.addLogSubscription(id, entry->registryPrefixes,
+                                                entry->registryMsgIds);
+            }
+        }
+    }
+
     std::shared_ptr<Subscription> getSubscription(const std::string& id)
     {
         auto obj = subscriptionsMap.find(id);
@@ -942,21 +1204,17 @@ class EventServiceManager
             .subscriptionsConfigMap.emplace(newSub->id, newSub);
 
         updateNoOfSubscribersCount();
+        updateRoutingIndex();
 
         if (updateFile)
         {
             updateSubscriptionData();
         }
-
-#ifndef BMCWEB_ENABLE_REDFISH_DBUS_LOG_ENTRIES
-        if (lastEventTStr.empty())
-        {
-            cacheLastEventTimestamp();
-        }
-#endif
         // Update retry configuration.
         subValue->updateRetryConfig(retryAttempts, retryTimeoutInterval);
         subValue->updateRetryPolicy();
+        subValue->setSubId(id);
+        subValue->openSpool();
 
         return id;
     }
@@ -976,12 +1234,14 @@ class EventServiceManager
         auto obj = subscriptionsMap.find(id);
         if (obj != subscriptionsMap.end())
         {
+            obj->second->removeSpool();
             subscriptionsMap.erase(obj);
             auto obj2 = persistent_data::EventServiceStore::getInstance()
                             .subscriptionsConfigMap.find(id);
             persistent_data::EventServiceStore::getInstance()
                 .subscriptionsConfigMap.erase(obj2);
             updateNoOfSubscribersCount();
+            updateRoutingIndex();
             updateSubscriptionData();
         }
     }
@@ -1049,124 +1309,68 @@ class EventServiceManager
         }
         eventRecord.push_back(eventMessage);
 
-        for (const auto& it : this->subscriptionsMap)
-        {
-            std::shared_ptr<Subscription> entry = it.second;
-            bool isSubscribed = false;
-            // Search the resourceTypes list for the subscription.
-            // If resourceTypes list is empty, don't filter events
-            // send everything.
-            if (entry->resourceTypes.size())
-            {
-                for (const auto& resource : entry->resourceTypes)
+        // Every subscriber gets the same event, serialized once
+        std::shared_ptr<const std::string> msg;
+        routingIndex.forEachEventSubscription(
+            resType, [this, &msg, &eventRecord](const std::string& id) {
+                auto entry = subscriptionsMap.find(id);
+                if (entry == subscriptionsMap.end())
                 {
-                    if (resType == resource)
-                    {
-                        BMCWEB_LOG_INFO << "ResourceType " << resource
-                                        << " found in the subscribed list";
-                        isSubscribed = true;
-                        break;
-                    }
+                    return;
                 }
-            }
-            else // resourceTypes list is empty.
-            {
-                isSubscribed = true;
-            }
-
-            if (entry->subscriptionType == "SNMPTrap")
-            {
-                isSubscribed = false; // Don't need send SNMPTrap event.
-            }
-
-            if (isSubscribed)
-            {
-                nlohmann::json msgJson = {
-                    {"@odata.type", "#Event.v1_4_0.Event"},
-                    {"Name", "Event Log"},
-                    {"Id", eventId},
-                    {"Events", eventRecord}};
-                entry->sendEvent(msgJson.dump(
-                    2, ' ', true, nlohmann::json::error_handler_t::replace));
-                eventId++; // increament the eventId
-            }
-            else
-            {
-                BMCWEB_LOG_INFO << "Not subscribed to this resource";
-            }
-        }
-    }
-    void sendBroadcastMsg(const std::string& broadcastMsg)
-    {
-        for (const auto& it : this->subscriptionsMap)
+                if (msg == nullptr)
+                {
+                    nlohmann::json msgJson = {
+                        {"@odata.type", "#Event.v1_4_0.Event"},
+                        {"Name", "Event Log"},
+                        {"Id", eventId},
+                        {"Events", eventRecord}};
+                    msg = serializeEvent(msgJson);
+                }
+                entry->second->sendEvent(msg);
+            });
+        if (msg != nullptr)
         {
-            std::shared_ptr<Subscription> entry = it.second;
-            nlohmann::json msgJson = {
-                {"Timestamp", crow::utility::getDateTimeOffsetNow().first},
-                {"OriginOfCondition", "/ibm/v1/HMC/BroadcastService"},
-                {"Name", "Broadcast Message"},
-                {"Message", broadcastMsg}};
-            entry->sendEvent(msgJson.dump(
-                2, ' ', true, nlohmann::json::error_handler_t::replace));
+            eventId++; // increament the eventId
         }
     }
-
-#ifndef BMCWEB_ENABLE_REDFISH_DBUS_LOG_ENTRIES
-    void cacheLastEventTimestamp()
+    void sendBroadcastMsg(const std::string& broadcastMsg)
     {
-        lastEventTStr.clear();
-        std::ifstream logStream(redfishEventLogFile);
-        if (!logStream.good())
+        if (subscriptionsMap.empty())
         {
-            BMCWEB_LOG_ERROR << " Redfish log file open failed \n";
             return;
         }
-        std::string logEntry;
-        while (std::getline(logStream, logEntry))
+        nlohmann::json msgJson = {
+            {"Timestamp", crow::utility::getDateTimeOffsetNow().first},
+            {"OriginOfCondition", "/ibm/v1/HMC/BroadcastService"},
+            {"Name", "Broadcast Message"},
+            {"Message", broadcastMsg}};
+        std::shared_ptr<const std::string> msg = serializeEvent(msgJson);
+        for (const auto& it : this->subscriptionsMap)
         {
-            size_t space = logEntry.find_first_of(' ');
-            if (space == std::string::npos)
-            {
-                // Shouldn't enter here but lets skip it.
-                BMCWEB_LOG_DEBUG << "Invalid log entry found.";
-                continue;
-            }
-            lastEventTStr = logEntry.substr(0, space);
+            std::shared_ptr<Subscription> entry = it.second;
+            entry->sendEvent(msg);
         }
-        BMCWEB_LOG_DEBUG << "Last Event time stamp set: " << lastEventTStr;
     }
 
+#ifndef BMCWEB_ENABLE_REDFISH_DBUS_LOG_ENTRIES
     void readEventLogsFromFile()
     {
+        // Always read what was appended, so that it isn't sent once there
+        // are subscribers
+        std::vector<std::string> logEntries = eventLogTailer.readNewLines();
         if (!serviceEnabled || !noOfEventLogSubscribers)
         {
             BMCWEB_LOG_DEBUG << "EventService disabled or no Subscriptions.";
             return;
         }
-        std::ifstream logStream(redfishEventLogFile);
-        if (!logStream.good())
-        {
-            BMCWEB_LOG_ERROR << " Redfish log file open failed";
-            return;
-        }
 
         std::vector<EventLogObjectsType> eventRecords;
 
-        bool startLogCollection = false;
         bool firstEntry = true;
 
-        std::string logEntry;
-        while (std::getline(logStream, logEntry))
+        for (const std::string& logEntry : logEntries)
         {
-            if (!startLogCollection && !lastEventTStr.empty())
-            {
-                if (boost::starts_with(logEntry, lastEventTStr))
-                {
-                    startLogCollection = true;
-                }
-                continue;
-            }
-
             std::string idStr;
             if (!event_log::getUniqueEntryID(logEntry, idStr, firstEntry))
             {
@@ -1193,17 +1397,48 @@ class EventServiceManager
                 continue;
             }
 
-            lastEventTStr = timestamp;
             eventRecords.emplace_back(idStr, timestamp, messageID, registryName,
                                       messageKey, messageArgs);
         }
 
-        for (const auto& it : this->subscriptionsMap)
+        // Each entry is formatted once for all subscribers, which only add
+        // their Context
+        std::vector<nlohmann::json> formatted(eventRecords.size());
+        for (size_t index = 0; index < eventRecords.size(); index++)
         {
-            std::shared_ptr<Subscription> entry = it.second;
-            if (entry->eventFormatType == "Event")
+            const auto& [idStr, timestamp, messageID, registryName,
+                         messageKey, messageArgs] = eventRecords[index];
+            if (event_log::formatEventLogEntry(idStr, messageID, messageArgs,
+                                               timestamp, "",
+                                               formatted[index]) != 0)
             {
-                entry->filterAndSendEventLogs(eventRecords);
+                BMCWEB_LOG_DEBUG << "Read eventLog entry failed";
+                formatted[index] = nullptr;
+            }
+        }
+
+        // The entries each subscription gets, by subscription id
+        std::map<std::string, std::vector<size_t>, std::less<>> routed;
+        for (size_t index = 0; index < eventRecords.size(); index++)
+        {
+            if (formatted[index].is_null())
+            {
+                continue;
+            }
+            routingIndex.forEachLogSubscription(
+                std::get<3>(eventRecords[index]),
+                std::get<4>(eventRecords[index]),
+                [&routed, index](const std::string& id) {
+                    routed[id].push_back(index);
+                });
+        }
+
+        for (const auto& [id, indices] : routed)
+        {
+            auto entry = subscriptionsMap.find(id);
+            if (entry != subscriptionsMap.end())
+            {
+                entry->second->sendEventLogs(formatted, indices);
             }
         }
     }
@@ -1274,8 +1509,8 @@ class EventServiceManager
                                 return;
                             }
 
-                            EventServiceManager::getInstance()
-                                .cacheLastEventTimestamp();
+                            // The tailer finishes the file this replaced
+                            // before reading the new one
                             EventServiceManager::getInstance()
                                 .readEventLogsFromFile();
                         }
@@ -1306,6 +1541,9 @@ class EventServiceManager
 
     static int startEventLogMonitor(boost::asio::io_context& ioc)
     {
+        // Only events logged from now on are sent
+        EventServiceManager::getInstance().eventLogTailer.seekToEnd();
+
         inotifyConn.emplace(ioc);
         inotifyFd = inotify_init1(IN_NONBLOCK);
         if (inotifyFd == -1)
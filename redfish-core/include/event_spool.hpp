@@ -0,0 +1,606 @@
+#pragma once
+
+#include "logging.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace redfish
+{
+
+/**
+ * EventSpool
+ * The events of one subscription, kept on disk until its destination
+ * acknowledges them, so they survive an outage of the destination and a
+ * restart of bmcweb.  Every event gets the next sequence number, and is
+ * appended to the newest segment file, which is named after the sequence
+ * number of its first event.  A segment is deleted once all of its events
+ * are acknowledged.  When the spool would outgrow maxBytes, its oldest
+ * segment is deleted, events and all.
+ *
+ * Writes are only made durable by sync(), so that one fsync covers a batch
+ * of events.  Acknowledgements are only recorded by sync() too, which means
+ * events acknowledged just before a crash are replayed after it.
+ */
+class EventSpool
+{
+  public:
+    // Segments are rolled over at this size, which is what the spool gives
+    // up at once when it is full
+    static constexpr size_t defaultSegmentSize = 64 * 1024;
+
+    EventSpool(std::filesystem::path dirIn, size_t maxBytesIn,
+               size_t segmentSizeIn = defaultSegmentSize) :
+        dir(std::move(dirIn)),
+        maxBytes(maxBytesIn), segmentSize(std::min(segmentSizeIn, maxBytesIn))
+    {}
+
+    ~EventSpool()
+    {
+        closeSegment();
+    }
+
+    EventSpool(const EventSpool&) = delete;
+    EventSpool(EventSpool&&) = delete;
+    EventSpool& operator=(const EventSpool&) = delete;
+    EventSpool& operator=(EventSpool&&) = delete;
+
+    // Loads what was spooled before a restart.  A segment whose end was cut
+    // short by a crash is truncated after its last complete event.  Returns
+    // false if the directory can't be used.
+    bool open()
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        if (ec)
+        {
+            BMCWEB_LOG_ERROR << "Failed to create event spool " << dir << ": "
+                             << ec.message();
+            return false;
+        }
+
+        std::vector<std::pair<uint64_t, std::filesystem::path>> files;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        {
+            std::optional<uint64_t> first =
+                parseSegmentName(entry.path().filename().string());
+            if (first)
+            {
+                files.emplace_back(*first, entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+
+        ackedThrough = readCursor();
+        std::optional<uint64_t> loadedEnd;
+        for (const auto& [first, path] : files)
+        {
+            if (loadedEnd && first < *loadedEnd)
+            {
+                // Overlaps the segment before it, which can only happen if
+                // the files were tampered with
+                BMCWEB_LOG_ERROR << "Removing overlapping event spool segment "
+                                 << path;
+                std::filesystem::remove(path, ec);
+                continue;
+            }
+            Segment& segment = segments.emplace_back();
+            segment.first = first;
+            if (!loadSegment(path, segment))
+            {
+                segments.pop_back();
+                continue;
+            }
+            // Events between segments were lost with a damaged segment
+            for (uint64_t seq = loadedEnd.value_or(first); seq < first; seq++)
+            {
+                acked.insert(seq);
+            }
+            loadedEnd = first + segment.offsets.size();
+            totalBytes += segment.size;
+        }
+        nextSeq = std::max(ackedThrough, loadedEnd.value_or(0));
+        advanceAcked();
+        dropAckedSegments();
+        return true;
+    }
+
+    // Appends event, returning its sequence number, or nothing if it can't
+    // be spooled
+    std::optional<uint64_t> append(std::string_view event)
+    {
+        // Empty records are what a zero-filled tail looks like
+        if (event.empty())
+        {
+            BMCWEB_LOG_ERROR << "Empty event isn't spooled";
+            return std::nullopt;
+        }
+        size_t recordSize = headerSize + event.size();
+        if (recordSize > maxBytes)
+        {
+            BMCWEB_LOG_ERROR << "Event of " << event.size()
+                             << " bytes doesn't fit the event spool";
+            return std::nullopt;
+        }
+        while (!segments.empty() && totalBytes + recordSize > maxBytes)
+        {
+            dropOldestSegment();
+        }
+        if (segments.empty() || writeFd < 0 ||
+            segments.back().size + recordSize > segmentSize)
+        {
+            if (!startSegment())
+            {
+                return std::nullopt;
+            }
+        }
+
+        std::array<unsigned char, headerSize> header{};
+        putUint32(header.data(), static_cast<uint32_t>(event.size()));
+        putUint32(header.data() + 4, checksum(event));
+        Segment& segment = segments.back();
+        if (!writeAll(header.data(), header.size()) ||
+            !writeAll(event.data(), event.size()))
+        {
+            BMCWEB_LOG_ERROR << "Failed to write to event spool " << dir;
+            // Whatever part of the event was written is cut off on the next
+            // open
+            closeSegment();
+            if (segment.offsets.empty())
+            {
+                // Started afresh by the next append
+                segments.pop_back();
+            }
+            return std::nullopt;
+        }
+        segment.offsets.push_back(static_cast<off_t>(segment.size));
+        segment.size += recordSize;
+        totalBytes += recordSize;
+        unsynced++;
+        return nextSeq++;
+    }
+
+    // The event with sequence number seq, if it's still spooled
+    std::optional<std::string> read(uint64_t seq) const
+    {
+        const Segment* segment = findSegment(seq);
+        if (segment == nullptr)
+        {
+            return std::nullopt;
+        }
+        int fd = ::open(segmentPath(segment->first).c_str(),
+                        O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return std::nullopt;
+        }
+        std::optional<std::string> event =
+            readRecord(fd, segment->offsets[seq - segment->first],
+                       static_cast<off_t>(segment->size));
+        close(fd);
+        return event;
+    }
+
+    // Marks the event with sequence number seq as delivered
+    void ack(uint64_t seq)
+    {
+        if (seq < ackedThrough || seq >= nextSeq)
+        {
+            return;
+        }
+        acked.insert(seq);
+        advanceAcked();
+        dropAckedSegments();
+    }
+
+    bool isAcked(uint64_t seq) const
+    {
+        return seq < ackedThrough || acked.contains(seq);
+    }
+
+    // Every event before this one was delivered, or dropped
+    uint64_t getAckedThrough() const
+    {
+        return ackedThrough;
+    }
+
+    // The sequence number the next event gets
+    uint64_t getNextSeq() const
+    {
+        return nextSeq;
+    }
+
+    size_t getUnsynced() const
+    {
+        return unsynced;
+    }
+
+    size_t getTotalBytes() const
+    {
+        return totalBytes;
+    }
+
+    // Events deleted with a segment before they were delivered
+    uint64_t getDropped() const
+    {
+        return dropped;
+    }
+
+    // Makes appended events and acknowledgements durable
+    void sync()
+    {
+        if (writeFd >= 0 && unsynced > 0 && fsync(writeFd) != 0)
+        {
+            BMCWEB_LOG_ERROR << "Failed to sync event spool " << dir;
+        }
+        unsynced = 0;
+        if (cursorDirty)
+        {
+            writeCursor();
+        }
+    }
+
+    // Deletes the spool and everything in it
+    void remove()
+    {
+        closeSegment();
+        segments.clear();
+        acked.clear();
+        totalBytes = 0;
+        unsynced = 0;
+        cursorDirty = false;
+        ackedThrough = nextSeq;
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+
+  private:
+    // Every event is preceded by its length and CRC-32
+    static constexpr size_t headerSize = 8;
+
+    struct Segment
+    {
+        // Sequence number of its first event
+        uint64_t first = 0;
+        // Where each event starts
+        std::vector<off_t> offsets;
+        size_t size = 0;
+    };
+
+    static void putUint32(unsigned char* out, uint32_t value)
+    {
+        for (size_t i = 0; i < 4; i++)
+        {
+            out[i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+    }
+
+    static uint32_t getUint32(const unsigned char* in)
+    {
+        uint32_t value = 0;
+        for (size_t i = 0; i < 4; i++)
+        {
+            value |= static_cast<uint32_t>(in[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    static uint32_t checksum(std::string_view data)
+    {
+        return static_cast<uint32_t>(
+            crc32(0L, reinterpret_cast<const Bytef*>(data.data()),
+                  static_cast<uInt>(data.size())));
+    }
+
+    static std::optional<uint64_t> parseSegmentName(const std::string& name)
+    {
+        constexpr std::string_view suffix = ".seg";
+        if (name.size() <= suffix.size() || !name.ends_with(suffix))
+        {
+            return std::nullopt;
+        }
+        uint64_t first = 0;
+        const char* end = name.data() + name.size() - suffix.size();
+        auto [ptr, ec] = std::from_chars(name.data(), end, first);
+        if (ec != std::errc() || ptr != end)
+        {
+            return std::nullopt;
+        }
+        return first;
+    }
+
+    std::filesystem::path segmentPath(uint64_t first) const
+    {
+        std::array<char, 32> name{};
+        std::snprintf(name.data(), name.size(), "%020llu.seg",
+                      static_cast<unsigned long long>(first));
+        return dir / name.data();
+    }
+
+    // Reads the event at offset of a file of fileSize bytes, checking its
+    // length and CRC.  The length is checked against the file before
+    // anything is allocated for it: a zero-filled tail would otherwise read
+    // as empty events, and a corrupted length as one of up to 4 GiB.
+    static std::optional<std::string> readRecord(int fd, off_t offset,
+                                                 off_t fileSize)
+    {
+        std::array<unsigned char, headerSize> header{};
+        if (pread(fd, header.data(), header.size(), offset) !=
+            static_cast<ssize_t>(header.size()))
+        {
+            return std::nullopt;
+        }
+        uint32_t length = getUint32(header.data());
+        off_t available = fileSize - offset - static_cast<off_t>(headerSize);
+        if (length == 0 || available < static_cast<off_t>(length))
+        {
+            return std::nullopt;
+        }
+        std::string event(length, '\0');
+        if (pread(fd, event.data(), length,
+                  offset + static_cast<off_t>(headerSize)) !=
+            static_cast<ssize_t>(length))
+        {
+            return std::nullopt;
+        }
+        if (checksum(event) != getUint32(header.data() + 4))
+        {
+            return std::nullopt;
+        }
+        return event;
+    }
+
+    bool loadSegment(const std::filesystem::path& path, Segment& segment)
+    {
+        int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0)
+        {
+            BMCWEB_LOG_ERROR << "Failed to open event spool segment " << path;
+            return false;
+        }
+        struct stat st = {};
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            return false;
+        }
+        off_t offset = 0;
+        while (offset < st.st_size)
+        {
+            std::optional<std::string> event =
+                readRecord(fd, offset, st.st_size);
+            if (!event)
+            {
+                BMCWEB_LOG_ERROR << "Truncating event spool segment " << path
+                                 << " after " << segment.offsets.size()
+                                 << " events";
+                if (ftruncate(fd, offset) != 0)
+                {
+                    BMCWEB_LOG_ERROR << "Failed to truncate " << path;
+                }
+                break;
+            }
+            segment.offsets.push_back(offset);
+            offset += static_cast<off_t>(headerSize + event->size());
+        }
+        close(fd);
+        segment.size = static_cast<size_t>(offset);
+        if (segment.offsets.empty())
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            return false;
+        }
+        return true;
+    }
+
+    const Segment* findSegment(uint64_t seq) const
+    {
+        for (const Segment& segment : segments)
+        {
+            if (seq >= segment.first &&
+                seq < segment.first + segment.offsets.size())
+            {
+                return &segment;
+            }
+        }
+        return nullptr;
+    }
+
+    bool startSegment()
+    {
+        closeSegment();
+        std::filesystem::path path = segmentPath(nextSeq);
+        writeFd = ::open(path.c_str(),
+                         O_WRONLY | O_CREAT | O_APPEND | O_TRUNC | O_CLOEXEC,
+                         0600);
+        if (writeFd < 0)
+        {
+            BMCWEB_LOG_ERROR << "Failed to create event spool segment "
+                             << path;
+            return false;
+        }
+        Segment& segment = segments.emplace_back();
+        segment.first = nextSeq;
+        return true;
+    }
+
+    void closeSegment()
+    {
+        if (writeFd >= 0)
+        {
+            if (unsynced > 0)
+            {
+                fsync(writeFd);
+                unsynced = 0;
+            }
+            close(writeFd);
+            writeFd = -1;
+        }
+    }
+
+    bool writeAll(const void* data, size_t size)
+    {
+        const char* begin = static_cast<const char*>(data);
+        while (size > 0)
+        {
+            ssize_t written = write(writeFd, begin, size);
+            if (written < 0)
+            {
+                return false;
+            }
+            begin += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    void advanceAcked()
+    {
+        uint64_t before = ackedThrough;
+        if (!segments.empty())
+        {
+            ackedThrough = std::max(ackedThrough, segments.front().first);
+        }
+        while (!acked.empty() && *acked.begin() <= ackedThrough)
+        {
+            if (*acked.begin() == ackedThrough)
+            {
+                ackedThrough++;
+            }
+            acked.erase(acked.begin());
+        }
+        if (segments.empty())
+        {
+            ackedThrough = nextSeq;
+        }
+        cursorDirty = cursorDirty || ackedThrough != before;
+    }
+
+    void dropAckedSegments()
+    {
+        while (!segments.empty())
+        {
+            const Segment& segment = segments.front();
+            if (segment.first + segment.offsets.size() > ackedThrough)
+            {
+                return;
+            }
+            if (segments.size() == 1)
+            {
+                // The segment being written to, which is started afresh
+                closeSegment();
+            }
+            deleteFrontSegment();
+        }
+    }
+
+    void dropOldestSegment()
+    {
+        const Segment& segment = segments.front();
+        uint64_t end = segment.first + segment.offsets.size();
+        for (uint64_t seq = std::max(segment.first, ackedThrough); seq < end;
+             seq++)
+        {
+            if (!acked.contains(seq))
+            {
+                dropped++;
+            }
+        }
+        BMCWEB_LOG_ERROR << "Event spool " << dir
+                         << " is full, dropping events up to " << end;
+        if (segments.size() == 1)
+        {
+            closeSegment();
+        }
+        deleteFrontSegment();
+        ackedThrough = std::max(ackedThrough, end);
+        advanceAcked();
+        cursorDirty = true;
+    }
+
+    void deleteFrontSegment()
+    {
+        std::error_code ec;
+        std::filesystem::remove(segmentPath(segments.front().first), ec);
+        totalBytes -= segments.front().size;
+        segments.pop_front();
+    }
+
+    uint64_t readCursor() const
+    {
+        std::ifstream file(dir / "acked");
+        uint64_t cursor = 0;
+        if (!(file >> cursor))
+        {
+            return 0;
+        }
+        return cursor;
+    }
+
+    // Written to a temporary file first, so a crash leaves the old cursor
+    // or the new one
+    void writeCursor()
+    {
+        std::filesystem::path tmp = dir / "acked.tmp";
+        int fd = ::open(tmp.c_str(),
+                        O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0)
+        {
+            BMCWEB_LOG_ERROR << "Failed to write event spool cursor " << tmp;
+            return;
+        }
+        std::string cursor = std::to_string(ackedThrough);
+        bool ok = ::write(fd, cursor.data(), cursor.size()) ==
+                      static_cast<ssize_t>(cursor.size()) &&
+                  fsync(fd) == 0;
+        close(fd);
+        std::error_code ec;
+        if (ok)
+        {
+            std::filesystem::rename(tmp, dir / "acked", ec);
+        }
+        if (!ok || ec)
+        {
+            BMCWEB_LOG_ERROR << "Failed to write event spool cursor " << tmp;
+            return;
+        }
+        cursorDirty = false;
+    }
+
+    std::filesystem::path dir;
+    size_t maxBytes;
+    size_t segmentSize;
+
+    std::deque<Segment> segments;
+    // Open on the newest segment, once something was appended to it
+    int writeFd = -1;
+    size_t totalBytes = 0;
+
+    uint64_t nextSeq = 0;
+    uint64_t ackedThrough = 0;
+    // Acknowledged events after ackedThrough
+    std::set<uint64_t> acked;
+    bool cursorDirty = false;
+    size_t unsynced = 0;
+    uint64_t dropped = 0;
+};
+
+} // namespace redfish
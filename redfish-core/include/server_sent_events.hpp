@@ -51,7 +51,9 @@ class ServerSentEvents : public std::enable_shared_from_this<ServerSentEvents>
 {
   private:
     std::shared_ptr<boost::beast::tcp_stream> sseConn;
-    std::queue<std::pair<uint64_t, std::string>> requestDataQueue;
+    // Events are shared by every subscriber they are sent to
+    std::queue<std::pair<uint64_t, std::shared_ptr<const std::string>>>
+        requestDataQueue;
     std::string outBuffer;
     SseConnState state{SseConnState::startInit};
     int retryCount{0};
@@ -243,9 +245,9 @@ class ServerSentEvents : public std::enable_shared_from_this<ServerSentEvents>
             case SseConnState::idle:
             case SseConnState::sendFailed:
             {
-                std::pair<uint64_t, std::string> reqData =
-                    requestDataQueue.front();
-                sendEvent(std::to_string(reqData.first), reqData.second);
+                const std::pair<uint64_t, std::shared_ptr<const std::string>>&
+                    reqData = requestDataQueue.front();
+                sendEvent(std::to_string(reqData.first), *reqData.second);
                 break;
             }
         }
@@ -268,7 +270,8 @@ class ServerSentEvents : public std::enable_shared_from_this<ServerSentEvents>
 
     ~ServerSentEvents() = default;
 
-    void sendData(const uint64_t& id, const std::string& data)
+    void sendData(const uint64_t& id,
+                  const std::shared_ptr<const std::string>& data)
     {
         if (state == SseConnState::suspended)
         {
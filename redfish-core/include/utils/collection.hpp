@@ -1,7 +1,10 @@
 #pragma once
 
 #include <boost/container/flat_map.hpp>
+#include <object_mapper_mirror.hpp>
+#include <utils/query_param.hpp>
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -12,12 +15,14 @@ namespace collection_util
 
 /**
  * @brief Populate the collection "Members" from a GetSubTreePaths search of
- *        inventory
+ *        inventory, limited to one page of those the filter of paging
+ *        keeps
  *
  * @param[i,o] aResp  Async response object
  * @param[i]   collectionPath  Redfish collection path which is used for the
  *             Members Redfish Path
  * @param[i]   interfaces  List of interfaces to constrain the GetSubTree search
+ * @param[i]   paging      The page of members to fill in
  * @param[in]  subtree     D-Bus base path to constrain search to.
  *
  * @return void
@@ -26,11 +31,13 @@ inline void
     getCollectionMembers(std::shared_ptr<bmcweb::AsyncResp> aResp,
                          const std::string& collectionPath,
                          const std::vector<const char*>& interfaces,
+                         const query_param::Paging& paging,
                          const char* subtree = "/xyz/openbmc_project/inventory")
 {
     BMCWEB_LOG_DEBUG << "Get collection members for: " << collectionPath;
-    crow::connections::systemBus->async_method_call(
-        [collectionPath,
+    crow::object_mapper::getSubTreePaths(
+        subtree, 0, interfaces,
+        [collectionPath, paging,
          aResp{std::move(aResp)}](const boost::system::error_code ec,
                                   const std::vector<std::string>& objects) {
             if (ec)
@@ -39,9 +46,8 @@ inline void
                 messages::internalError(aResp->res);
                 return;
             }
-            nlohmann::json& members = aResp->res.jsonValue["Members"];
-            members = nlohmann::json::array();
-
+            std::vector<std::string> uris;
+            uris.reserve(objects.size());
             for (const auto& object : objects)
             {
                 sdbusplus::message::object_path path(object);
@@ -53,14 +59,41 @@ inline void
                 std::string newPath = collectionPath;
                 newPath += '/';
                 newPath += leaf;
-                members.push_back({{"@odata.id", std::move(newPath)}});
+                uris.emplace_back(std::move(newPath));
             }
-            aResp->res.jsonValue["Members@odata.count"] = members.size();
-        },
-        "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths", subtree, 0,
-        interfaces);
+            query_param::setReferenceMembers(aResp->res, collectionPath, uris,
+                                             paging);
+        });
+}
+
+/**
+ * @brief Populate the collection "Members" from a GetSubTreePaths search of
+ *        inventory, limited to the page $skip, $top and $filter of req
+ *        ask for
+ *
+ * @param[i]   req    The request for the collection
+ * @param[i,o] aResp  Async response object
+ * @param[i]   collectionPath  Redfish collection path which is used for the
+ *             Members Redfish Path
+ * @param[i]   interfaces  List of interfaces to constrain the GetSubTree search
+ * @param[in]  subtree     D-Bus base path to constrain search to.
+ *
+ * @return void
+ */
+inline void
+    getCollectionMembers(const crow::Request& req,
+                         const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+                         const std::string& collectionPath,
+                         const std::vector<const char*>& interfaces,
+                         const char* subtree = "/xyz/openbmc_project/inventory")
+{
+    std::optional<query_param::Paging> paging =
+        query_param::getPaging(aResp, req);
+    if (!paging)
+    {
+        return;
+    }
+    getCollectionMembers(aResp, collectionPath, interfaces, *paging, subtree);
 }
 
 } // namespace collection_util
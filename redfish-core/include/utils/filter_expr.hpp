@@ -0,0 +1,496 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+
+namespace filter_expr
+{
+
+// Parentheses and "not" nest no deeper than this, so that a hostile $filter
+// can't run the parser out of stack
+constexpr size_t maxFilterDepth = 32;
+
+/**
+ * FilterExpr
+ * A parsed $filter expression: comparisons of a property with a literal,
+ * joined with and, or and not.
+ *
+ *   Severity eq 'Critical' and not (Created lt '2021-01-01T00:00:00+00:00')
+ *
+ * Comparison operators are eq, ne, gt, ge, lt and le.  Properties are names,
+ * or paths such as Status/Health.  Literals are 'strings' (with '' for a
+ * quote), numbers, true, false and null; unquoted date-times are taken as
+ * strings, which order correctly against Redfish timestamps with the same
+ * offset.
+ */
+class FilterExpr
+{
+  public:
+    // Returns std::nullopt if text isn't a valid expression
+    static std::optional<FilterExpr> parse(std::string_view text)
+    {
+        FilterExpr expr;
+        Parser parser{text, expr.nodes};
+        std::optional<size_t> root = parser.parseOr(0);
+        if (!root || !parser.atEnd())
+        {
+            return std::nullopt;
+        }
+        expr.root = *root;
+        return expr;
+    }
+
+    // Whether the filter selects member.  Missing properties compare as null.
+    bool matches(const nlohmann::json& member) const
+    {
+        return evaluate(root, member, false) == Result::True;
+    }
+
+    // Evaluates the filter against the properties known so far, for callers
+    // that can rule out a member before building all of it.  Returns
+    // std::nullopt if the result depends on properties missing from known.
+    std::optional<bool> evaluate(const nlohmann::json& known) const
+    {
+        Result result = evaluate(root, known, true);
+        if (result == Result::Unknown)
+        {
+            return std::nullopt;
+        }
+        return result == Result::True;
+    }
+
+  private:
+    enum class Op : uint8_t
+    {
+        And,
+        Or,
+        Not,
+        Eq,
+        Ne,
+        Gt,
+        Ge,
+        Lt,
+        Le,
+    };
+
+    enum class Result : uint8_t
+    {
+        False,
+        True,
+        Unknown,
+    };
+
+    struct Node
+    {
+        Op op;
+        // Operands of And, Or and Not
+        size_t lhs = 0;
+        size_t rhs = 0;
+        // Comparisons: the path to the property, and the literal
+        std::vector<std::string> property;
+        nlohmann::json value;
+    };
+
+    class Parser
+    {
+      public:
+        Parser(std::string_view textIn, std::vector<Node>& nodesIn) :
+            text(textIn), nodes(nodesIn)
+        {}
+
+        bool atEnd()
+        {
+            skipSpace();
+            return text.empty();
+        }
+
+        std::optional<size_t> parseOr(size_t depth)
+        {
+            std::optional<size_t> lhs = parseAnd(depth);
+            while (lhs && consumeWord("or"))
+            {
+                std::optional<size_t> rhs = parseAnd(depth);
+                if (!rhs)
+                {
+                    return std::nullopt;
+                }
+                lhs = addNode({Op::Or, *lhs, *rhs, {}, {}});
+            }
+            return lhs;
+        }
+
+      private:
+        std::optional<size_t> parseAnd(size_t depth)
+        {
+            std::optional<size_t> lhs = parseUnary(depth);
+            while (lhs && consumeWord("and"))
+            {
+                std::optional<size_t> rhs = parseUnary(depth);
+                if (!rhs)
+                {
+                    return std::nullopt;
+                }
+                lhs = addNode({Op::And, *lhs, *rhs, {}, {}});
+            }
+            return lhs;
+        }
+
+        std::optional<size_t> parseUnary(size_t depth)
+        {
+            if (depth >= maxFilterDepth)
+            {
+                return std::nullopt;
+            }
+            if (consumeWord("not"))
+            {
+                std::optional<size_t> operand = parseUnary(depth + 1);
+                if (!operand)
+                {
+                    return std::nullopt;
+                }
+                return addNode({Op::Not, *operand, 0, {}, {}});
+            }
+            skipSpace();
+            if (text.starts_with('('))
+            {
+                text.remove_prefix(1);
+                std::optional<size_t> inner = parseOr(depth + 1);
+                skipSpace();
+                if (!inner || !text.starts_with(')'))
+                {
+                    return std::nullopt;
+                }
+                text.remove_prefix(1);
+                return inner;
+            }
+            return parseComparison();
+        }
+
+        std::optional<size_t> parseComparison()
+        {
+            Node node{Op::Eq, 0, 0, {}, {}};
+            std::string_view path = nextWord();
+            if (path.empty() || std::isdigit(static_cast<unsigned char>(
+                                    path.front())) != 0)
+            {
+                return std::nullopt;
+            }
+            while (!path.empty())
+            {
+                size_t slash = path.find('/');
+                std::string_view segment = path.substr(0, slash);
+                if (segment.empty())
+                {
+                    return std::nullopt;
+                }
+                node.property.emplace_back(segment);
+                path.remove_prefix(slash == std::string_view::npos
+                                       ? path.size()
+                                       : slash + 1);
+                if (slash != std::string_view::npos && path.empty())
+                {
+                    return std::nullopt;
+                }
+            }
+
+            std::string_view op = nextWord();
+            if (op == "eq")
+            {
+                node.op = Op::Eq;
+            }
+            else if (op == "ne")
+            {
+                node.op = Op::Ne;
+            }
+            else if (op == "gt")
+            {
+                node.op = Op::Gt;
+            }
+            else if (op == "ge")
+            {
+                node.op = Op::Ge;
+            }
+            else if (op == "lt")
+            {
+                node.op = Op::Lt;
+            }
+            else if (op == "le")
+            {
+                node.op = Op::Le;
+            }
+            else
+            {
+                return std::nullopt;
+            }
+
+            std::optional<nlohmann::json> value = parseLiteral();
+            if (!value)
+            {
+                return std::nullopt;
+            }
+            node.value = std::move(*value);
+            return addNode(std::move(node));
+        }
+
+        std::optional<nlohmann::json> parseLiteral()
+        {
+            skipSpace();
+            if (text.starts_with('\''))
+            {
+                std::string value;
+                text.remove_prefix(1);
+                while (!text.empty())
+                {
+                    char c = text.front();
+                    text.remove_prefix(1);
+                    if (c != '\'')
+                    {
+                        value += c;
+                        continue;
+                    }
+                    if (!text.starts_with('\''))
+                    {
+                        return value;
+                    }
+                    // '' stands for one quote
+                    value += '\'';
+                    text.remove_prefix(1);
+                }
+                // Unterminated
+                return std::nullopt;
+            }
+
+            std::string_view word = nextWord();
+            if (word.empty())
+            {
+                return std::nullopt;
+            }
+            if (word == "true")
+            {
+                return true;
+            }
+            if (word == "false")
+            {
+                return false;
+            }
+            if (word == "null")
+            {
+                return nullptr;
+            }
+            char first = word.front();
+            if (std::isdigit(static_cast<unsigned char>(first)) == 0 &&
+                first != '-')
+            {
+                return std::nullopt;
+            }
+            const char* end = word.data() + word.size();
+            int64_t integer = 0;
+            auto [intEnd, intEc] =
+                std::from_chars(word.data(), end, integer);
+            if (intEc == std::errc() && intEnd == end)
+            {
+                return integer;
+            }
+            double number = 0;
+            auto [doubleEnd, doubleEc] =
+                std::from_chars(word.data(), end, number);
+            if (doubleEc == std::errc() && doubleEnd == end)
+            {
+                return number;
+            }
+            if (first == '-')
+            {
+                return std::nullopt;
+            }
+            // A date or time such as 2021-01-01T00:00:00Z
+            return std::string(word);
+        }
+
+        size_t addNode(Node&& node)
+        {
+            nodes.push_back(std::move(node));
+            return nodes.size() - 1;
+        }
+
+        void skipSpace()
+        {
+            while (!text.empty() &&
+                   std::isspace(static_cast<unsigned char>(text.front())) != 0)
+            {
+                text.remove_prefix(1);
+            }
+        }
+
+        // Names, paths, numbers, date-times and keywords
+        static bool isWordChar(char c)
+        {
+            return std::isalnum(static_cast<unsigned char>(c)) != 0 ||
+                   c == '_' || c == '@' || c == '#' || c == '.' || c == '/' ||
+                   c == ':' || c == '+' || c == '-';
+        }
+
+        std::string_view nextWord()
+        {
+            skipSpace();
+            size_t size = 0;
+            while (size < text.size() && isWordChar(text[size]))
+            {
+                size++;
+            }
+            std::string_view word = text.substr(0, size);
+            text.remove_prefix(size);
+            return word;
+        }
+
+        // Consumes word if it is next, as a whole word
+        bool consumeWord(std::string_view word)
+        {
+            skipSpace();
+            if (!text.starts_with(word) ||
+                (text.size() > word.size() && isWordChar(text[word.size()])))
+            {
+                return false;
+            }
+            text.remove_prefix(word.size());
+            return true;
+        }
+
+        std::string_view text;
+        std::vector<Node>& nodes;
+    };
+
+    static bool compare(Op op, const nlohmann::json& lhs,
+                        const nlohmann::json& rhs)
+    {
+        if (op == Op::Eq)
+        {
+            return lhs == rhs;
+        }
+        if (op == Op::Ne)
+        {
+            return lhs != rhs;
+        }
+        // Ordering is only defined between numbers, or between strings
+        if (!((lhs.is_number() && rhs.is_number()) ||
+              (lhs.is_string() && rhs.is_string())))
+        {
+            return false;
+        }
+        switch (op)
+        {
+            case Op::Gt:
+                return lhs > rhs;
+            case Op::Ge:
+                return lhs >= rhs;
+            case Op::Lt:
+                return lhs < rhs;
+            case Op::Le:
+                return lhs <= rhs;
+            default:
+                return false;
+        }
+    }
+
+    // Three valued, so that a partial member can still rule the member out:
+    // false and anything is false, and true or anything is true
+    Result evaluate(size_t index, const nlohmann::json& member,
+                    bool partial) const
+    {
+        const Node& node = nodes[index];
+        switch (node.op)
+        {
+            case Op::And:
+            {
+                Result lhs = evaluate(node.lhs, member, partial);
+                if (lhs == Result::False)
+                {
+                    return Result::False;
+                }
+                Result rhs = evaluate(node.rhs, member, partial);
+                if (rhs == Result::False)
+                {
+                    return Result::False;
+                }
+                return lhs == Result::True && rhs == Result::True
+                           ? Result::True
+                           : Result::Unknown;
+            }
+            case Op::Or:
+            {
+                Result lhs = evaluate(node.lhs, member, partial);
+                if (lhs == Result::True)
+                {
+                    return Result::True;
+                }
+                Result rhs = evaluate(node.rhs, member, partial);
+                if (rhs == Result::True)
+                {
+                    return Result::True;
+                }
+                return lhs == Result::False && rhs == Result::False
+                           ? Result::False
+                           : Result::Unknown;
+            }
+            case Op::Not:
+            {
+                Result operand = evaluate(node.lhs, member, partial);
+                if (operand == Result::Unknown)
+                {
+                    return Result::Unknown;
+                }
+                return operand == Result::True ? Result::False
+                                               : Result::True;
+            }
+            default:
+                break;
+        }
+
+        const nlohmann::json* value = &member;
+        for (const std::string& segment : node.property)
+        {
+            const nlohmann::json::object_t* object =
+                value->get_ptr<const nlohmann::json::object_t*>();
+            if (object == nullptr)
+            {
+                value = nullptr;
+                break;
+            }
+            auto it = object->find(segment);
+            if (it == object->end())
+            {
+                value = nullptr;
+                break;
+            }
+            value = &it->second;
+        }
+        if (value == nullptr)
+        {
+            if (partial)
+            {
+                return Result::Unknown;
+            }
+            return compare(node.op, nullptr, node.value) ? Result::True
+                                                         : Result::False;
+        }
+        return compare(node.op, *value, node.value) ? Result::True
+                                                    : Result::False;
+    }
+
+    std::vector<Node> nodes;
+    size_t root = 0;
+};
+
+} // namespace filter_expr
+} // namespace redfish
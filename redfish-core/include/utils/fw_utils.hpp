@@ -1,5 +1,6 @@
 #pragma once
 #include <async_resp.hpp>
+#include <object_mapper_mirror.hpp>
 
 #include <algorithm>
 #include <string>
@@ -78,7 +79,10 @@ inline void
                 functionalFwIds.push_back(leaf);
             }
 
-            crow::connections::systemBus->async_method_call(
+            crow::object_mapper::getSubTree(
+                "/xyz/openbmc_project/software", 0,
+                std::array<const char*, 1>{
+                    "xyz.openbmc_project.Software.Version"},
                 [aResp, fwVersionPurpose, activeVersionPropName,
                  populateLinkToImages, functionalFwIds](
                     const boost::system::error_code ec2,
@@ -253,13 +257,7 @@ inline void
                             "org.freedesktop.DBus.Properties", "GetAll",
                             "xyz.openbmc_project.Software.Version");
                     }
-                },
-                "xyz.openbmc_project.ObjectMapper",
-                "/xyz/openbmc_project/object_mapper",
-                "xyz.openbmc_project.ObjectMapper", "GetSubTree",
-                "/xyz/openbmc_project/software", static_cast<int32_t>(0),
-                std::array<const char*, 1>{
-                    "xyz.openbmc_project.Software.Version"});
+                });
         },
         "xyz.openbmc_project.ObjectMapper",
         "/xyz/openbmc_project/software/functional",
@@ -0,0 +1,367 @@
+#pragma once
+
+#include "logging.hpp"
+
+#include <boost/container/flat_map.hpp>
+#include <dbus_single_flight.hpp>
+#include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+#include <stats.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace redfish
+{
+namespace health_index
+{
+
+constexpr const char* mapperService = "xyz.openbmc_project.ObjectMapper";
+constexpr const char* associationInterface = "xyz.openbmc_project.Association";
+
+// The mapper's "critical" and "warning" association objects, by path, with
+// their endpoints
+using Statuses = std::map<std::string, std::vector<std::string>, std::less<>>;
+
+inline bool isStatusPath(std::string_view path)
+{
+    return path.ends_with("critical") || path.ends_with("warning");
+}
+
+// The endpoints of an association, or an empty list if it has none, which
+// matches nothing but the association's own path
+inline std::vector<std::string>
+    getEndpoints(const std::string& path,
+                 const dbus::utility::DBusPropertiesMap& properties)
+{
+    auto endpointsIt = properties.find("endpoints");
+    if (endpointsIt == properties.end())
+    {
+        BMCWEB_LOG_ERROR << "Illegal association at " << path;
+        return {};
+    }
+    const std::vector<std::string>* endpoints =
+        std::get_if<std::vector<std::string>>(&endpointsIt->second);
+    if (endpoints == nullptr)
+    {
+        BMCWEB_LOG_ERROR << "Illegal association at " << path;
+        return {};
+    }
+    return *endpoints;
+}
+
+// The statuses in the mapper's GetManagedObjects
+inline Statuses toStatuses(const dbus::utility::ManagedObjectType& objects)
+{
+    Statuses statuses;
+    for (const auto& [path, interfaces] : objects)
+    {
+        if (!isStatusPath(path.str))
+        {
+            continue;
+        }
+        auto assocIt = interfaces.find(associationInterface);
+        statuses.emplace(path.str,
+                         assocIt == interfaces.end()
+                             ? std::vector<std::string>()
+                             : getEndpoints(path.str, assocIt->second));
+    }
+    return statuses;
+}
+
+/**
+ * HealthIndex
+ * The statuses the health rollup is computed from, kept current from the
+ * mapper's association signals, so that a resource's health needs no D-Bus
+ * call.  Readers get a snapshot that later changes don't touch.
+ */
+class HealthIndex
+{
+  public:
+    static HealthIndex& getInstance()
+    {
+        static HealthIndex index;
+        return index;
+    }
+
+    bool isReady() const
+    {
+        return ready;
+    }
+
+    std::shared_ptr<const Statuses> getStatuses() const
+    {
+        return statuses;
+    }
+
+    void seed(Statuses seeded)
+    {
+        statuses = std::make_shared<Statuses>(std::move(seeded));
+        ready = true;
+    }
+
+    void invalidate()
+    {
+        ready = false;
+    }
+
+    void setEndpoints(const std::string& path,
+                      std::vector<std::string> endpoints)
+    {
+        if (!isStatusPath(path))
+        {
+            return;
+        }
+        mutableStatuses()[path] = std::move(endpoints);
+    }
+
+    void remove(const std::string& path)
+    {
+        if (statuses->find(path) == statuses->end())
+        {
+            return;
+        }
+        mutableStatuses().erase(path);
+    }
+
+    HealthIndex() = default;
+    ~HealthIndex() = default;
+    HealthIndex(const HealthIndex&) = delete;
+    HealthIndex& operator=(const HealthIndex&) = delete;
+    HealthIndex(HealthIndex&&) = delete;
+    HealthIndex& operator=(HealthIndex&&) = delete;
+
+  private:
+    // Copies the statuses first if a reader still holds them
+    Statuses& mutableStatuses()
+    {
+        if (statuses.use_count() > 1)
+        {
+            statuses = std::make_shared<Statuses>(*statuses);
+        }
+        return *statuses;
+    }
+
+    std::shared_ptr<Statuses> statuses = std::make_shared<Statuses>();
+    bool ready = false;
+};
+
+struct Health
+{
+    const char* health = "OK";
+    const char* rollup = "OK";
+};
+
+/**
+ * The health of a resource and the rollup of the items below it.
+ *
+ * @param statuses The mapper's status associations
+ * @param globalInventoryPath The path of the global inventory item
+ * @param selfPath The resource's own inventory path, if it has one
+ * @param inventory The inventory items below the resource
+ * @param isManagersHealth Whether all inventory counts towards the rollup
+ */
+inline Health getHealth(const Statuses& statuses,
+                        const std::string& globalInventoryPath,
+                        const std::optional<std::string>& selfPath,
+                        const std::vector<std::string>& inventory,
+                        bool isManagersHealth)
+{
+    Health result;
+    for (const auto& [path, endpoints] : statuses)
+    {
+        bool isChild = false;
+        bool isSelf = false;
+        if (selfPath)
+        {
+            if (path == *selfPath || path.starts_with(*selfPath + "/"))
+            {
+                isSelf = true;
+            }
+        }
+
+        // managers inventory is all the inventory, don't skip any
+        if (!isManagersHealth && !isSelf)
+        {
+            // We only want to look at this association if either the path
+            // of this association is an inventory item, or one of the
+            // endpoints in this association is a child
+            isChild = std::any_of(inventory.begin(), inventory.end(),
+                                  [&path](const std::string& child) {
+                                      return path.starts_with(child);
+                                  });
+            if (!isChild &&
+                std::none_of(endpoints.begin(), endpoints.end(),
+                             [&inventory](const std::string& endpoint) {
+                                 return std::find(inventory.begin(),
+                                                  inventory.end(),
+                                                  endpoint) != inventory.end();
+                             }))
+            {
+                continue;
+            }
+        }
+
+        if (path.starts_with(globalInventoryPath) &&
+            path.ends_with("critical"))
+        {
+            result.rollup = "Critical";
+            return result;
+        }
+        if (path.starts_with(globalInventoryPath) && path.ends_with("warning"))
+        {
+            result.health = "Warning";
+            if (std::string_view(result.rollup) != "Critical")
+            {
+                result.rollup = "Warning";
+            }
+        }
+        else if (path.ends_with("critical"))
+        {
+            result.rollup = "Critical";
+            if (isSelf)
+            {
+                result.health = "Critical";
+                return result;
+            }
+        }
+        else if (path.ends_with("warning"))
+        {
+            if (std::string_view(result.rollup) != "Critical")
+            {
+                result.rollup = "Warning";
+            }
+
+            if (isSelf)
+            {
+                result.health = "Warning";
+            }
+        }
+    }
+    return result;
+}
+
+static std::unique_ptr<sdbusplus::bus::match::match> associationsAddedMonitor;
+static std::unique_ptr<sdbusplus::bus::match::match>
+    associationsRemovedMonitor;
+static std::unique_ptr<sdbusplus::bus::match::match>
+    endpointsChangedMonitor;
+static std::unique_ptr<sdbusplus::bus::match::match> mapperOwnerMonitor;
+
+inline void seedHealthIndex()
+{
+    bmcweb::stats::increment("health_index.seeds");
+    crow::single_flight::asyncMethodCall<dbus::utility::ManagedObjectType>(
+        [](const boost::system::error_code ec,
+           const dbus::utility::ManagedObjectType& objects) {
+            if (ec)
+            {
+                BMCWEB_LOG_ERROR << "Health index seed failed: " << ec;
+                return;
+            }
+            HealthIndex::getInstance().seed(toStatuses(objects));
+        },
+        mapperService, "/", "org.freedesktop.DBus.ObjectManager",
+        "GetManagedObjects");
+}
+
+inline void onAssociationsAdded(sdbusplus::message::message& message)
+{
+    sdbusplus::message::object_path path;
+    dbus::utility::DBusInteracesMap interfaces;
+    message.read(path, interfaces);
+    auto assocIt = interfaces.find(associationInterface);
+    if (assocIt != interfaces.end())
+    {
+        HealthIndex::getInstance().setEndpoints(
+            path.str, getEndpoints(path.str, assocIt->second));
+    }
+}
+
+inline void onAssociationsRemoved(sdbusplus::message::message& message)
+{
+    sdbusplus::message::object_path path;
+    std::vector<std::string> interfaces;
+    message.read(path, interfaces);
+    if (std::find(interfaces.begin(), interfaces.end(),
+                  associationInterface) != interfaces.end())
+    {
+        HealthIndex::getInstance().remove(path.str);
+    }
+}
+
+inline void onEndpointsChanged(sdbusplus::message::message& message)
+{
+    std::string interface;
+    dbus::utility::DBusPropertiesMap changed;
+    message.read(interface, changed);
+    if (changed.find("endpoints") == changed.end())
+    {
+        return;
+    }
+    std::string path = message.get_path();
+    HealthIndex::getInstance().setEndpoints(path, getEndpoints(path, changed));
+}
+
+inline void onMapperOwnerChanged(sdbusplus::message::message& message)
+{
+    std::string name;
+    std::string oldOwner;
+    std::string newOwner;
+    message.read(name, oldOwner, newOwner);
+    // A new mapper signals the associations it makes, but not those it made
+    // before we matched its signals
+    HealthIndex::getInstance().invalidate();
+    if (!newOwner.empty())
+    {
+        seedHealthIndex();
+    }
+}
+
+// Seeds the index and keeps it current from then on.  The mapper sends its
+// signals and replies in order, so nothing is missed between the two.
+inline void registerHealthIndex()
+{
+    BMCWEB_LOG_INFO << "Register health rollup index";
+    sdbusplus::bus::bus& bus =
+        static_cast<sdbusplus::bus::bus&>(*crow::connections::systemBus);
+    associationsAddedMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',sender='xyz.openbmc_project.ObjectMapper',"
+        "interface='org.freedesktop.DBus.ObjectManager',"
+        "member='InterfacesAdded'",
+        onAssociationsAdded);
+    associationsRemovedMonitor =
+        std::make_unique<sdbusplus::bus::match::match>(
+            bus,
+            "type='signal',sender='xyz.openbmc_project.ObjectMapper',"
+            "interface='org.freedesktop.DBus.ObjectManager',"
+            "member='InterfacesRemoved'",
+            onAssociationsRemoved);
+    endpointsChangedMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',sender='xyz.openbmc_project.ObjectMapper',"
+        "interface='org.freedesktop.DBus.Properties',"
+        "member='PropertiesChanged',"
+        "arg0='xyz.openbmc_project.Association'",
+        onEndpointsChanged);
+    mapperOwnerMonitor = std::make_unique<sdbusplus::bus::match::match>(
+        bus,
+        "type='signal',sender='org.freedesktop.DBus',"
+        "interface='org.freedesktop.DBus',member='NameOwnerChanged',"
+        "arg0='xyz.openbmc_project.ObjectMapper'",
+        onMapperOwnerChanged);
+    seedHealthIndex();
+}
+
+} // namespace health_index
+} // namespace redfish
@@ -0,0 +1,411 @@
+#pragma once
+
+#include "logging.hpp"
+
+#include <boost/container/flat_map.hpp>
+#include <boost/system/error_code.hpp>
+#include <dbus_single_flight.hpp>
+#include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <object_mapper_mirror.hpp>
+#include <stats.hpp>
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+namespace property_plan
+{
+
+constexpr const char* objectManagerInterface =
+    "org.freedesktop.DBus.ObjectManager";
+
+// A GetManagedObjects returns every object below its ObjectManager, so it
+// is only made in place of at least this many GetAll calls
+constexpr size_t minGetAllsReplaced = 4;
+
+// ... and, where the objects below the ObjectManager can be counted, only
+// if it returns no more than this many objects per GetAll it replaces
+constexpr size_t maxObjectsPerGetAll = 4;
+
+// Without the mapper mirror, where the ObjectManagers are is asked of the
+// mapper, and kept for this long.  They only move when services restart.
+constexpr std::chrono::seconds objectManagersMaxAge{60};
+
+// Called as a GetAll callback would be: with an error if the interface
+// couldn't be read, and with its properties otherwise
+using InterfaceFiller =
+    std::function<void(const boost::system::error_code&,
+                       const dbus::utility::DBusPropertiesMap&)>;
+
+// Called with the value of a property, only if it was read
+using PropertyFiller =
+    std::function<void(const dbus::utility::DbusVariantType&)>;
+
+// Service name to the paths of its ObjectManagers
+using ObjectManagers = std::map<std::string, std::vector<std::string>>;
+
+// How many objects of a service GetManagedObjects on an ObjectManager path
+// returns, or nullopt if that isn't known
+using ObjectCounter = std::function<std::optional<size_t>(
+    const std::string& service, const std::string& objectManager)>;
+
+struct Key
+{
+    std::string service;
+    std::string path;
+    std::string interface;
+
+    auto operator<=>(const Key&) const = default;
+};
+
+// A call the plan makes: a GetManagedObjects on path when interface is
+// empty, and a GetAll of interface on path otherwise
+struct Call
+{
+    std::string service;
+    std::string path;
+    std::string interface;
+
+    bool operator==(const Call&) const = default;
+};
+
+// Whether GetManagedObjects on objectManager returns the object at path,
+// which it does for every object below it
+inline bool isManagedBy(const std::string& path,
+                        const std::string& objectManager)
+{
+    if (objectManager == "/")
+    {
+        return path != "/";
+    }
+    return path.size() > objectManager.size() &&
+           path.starts_with(objectManager) &&
+           path[objectManager.size()] == '/';
+}
+
+// What the interface fillers of an object get when a GetManagedObjects
+// leaves it or the interface out, as GetAll would have failed
+inline boost::system::error_code notReadError()
+{
+    return boost::system::errc::make_error_code(
+        boost::system::errc::no_such_file_or_directory);
+}
+
+/**
+ * PropertyPlan
+ * The properties a resource needs, read with as few calls as can be.  A
+ * resource adds the interfaces and properties it needs and runs the plan.
+ * The calls are then grouped by service: a service whose objects are all
+ * below one of its ObjectManagers is read with a single GetManagedObjects,
+ * and any other with a GetAll per object and interface.  Identical calls
+ * made by other requests at the same time are shared.
+ */
+class PropertyPlan : public std::enable_shared_from_this<PropertyPlan>
+{
+  public:
+    void addInterface(const std::string& service, const std::string& path,
+                      const std::string& interface, InterfaceFiller filler)
+    {
+        entries[{service, path, interface}].interfaceFillers.push_back(
+            std::move(filler));
+    }
+
+    void addProperty(const std::string& service, const std::string& path,
+                     const std::string& interface, const std::string& property,
+                     PropertyFiller filler)
+    {
+        entries[{service, path, interface}].propertyFillers.emplace_back(
+            property, std::move(filler));
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    // The calls that read everything added, given where the ObjectManagers
+    // are.  A GetManagedObjects is only made in place of minGetAllsReplaced
+    // or more GetAll, and only if countObjects doesn't say it returns more
+    // than maxObjectsPerGetAll objects for each.
+    std::vector<Call>
+        getCalls(const ObjectManagers& objectManagers,
+                 const ObjectCounter& countObjects = nullptr) const
+    {
+        std::vector<Call> calls;
+        auto serviceBegin = entries.begin();
+        while (serviceBegin != entries.end())
+        {
+            const std::string& service = serviceBegin->first.service;
+            auto serviceEnd = serviceBegin;
+            size_t count = 0;
+            while (serviceEnd != entries.end() &&
+                   serviceEnd->first.service == service)
+            {
+                serviceEnd++;
+                count++;
+            }
+
+            const std::string* best = nullptr;
+            auto managers = objectManagers.find(service);
+            if (count >= minGetAllsReplaced && managers != objectManagers.end())
+            {
+                for (const std::string& manager : managers->second)
+                {
+                    bool managesAll = true;
+                    for (auto it = serviceBegin; it != serviceEnd; it++)
+                    {
+                        if (!isManagedBy(it->first.path, manager))
+                        {
+                            managesAll = false;
+                            break;
+                        }
+                    }
+                    // The nearest one returns the fewest other objects
+                    if (managesAll &&
+                        (best == nullptr || manager.size() > best->size()))
+                    {
+                        best = &manager;
+                    }
+                }
+            }
+
+            if (best != nullptr && countObjects)
+            {
+                std::optional<size_t> objects = countObjects(service, *best);
+                if (objects && *objects > count * maxObjectsPerGetAll)
+                {
+                    best = nullptr;
+                }
+            }
+
+            if (best != nullptr)
+            {
+                calls.push_back({service, *best, ""});
+            }
+            else
+            {
+                for (auto it = serviceBegin; it != serviceEnd; it++)
+                {
+                    calls.push_back(
+                        {service, it->first.path, it->first.interface});
+                }
+            }
+            serviceBegin = serviceEnd;
+        }
+        return calls;
+    }
+
+    // Hands what a GetAll returned to the fillers of its object and interface
+    void dispatch(const Key& key, const boost::system::error_code& ec,
+                  const dbus::utility::DBusPropertiesMap& properties) const
+    {
+        auto it = entries.find(key);
+        if (it == entries.end())
+        {
+            return;
+        }
+        for (const InterfaceFiller& filler : it->second.interfaceFillers)
+        {
+            filler(ec, properties);
+        }
+        if (ec)
+        {
+            return;
+        }
+        for (const auto& [property, filler] : it->second.propertyFillers)
+        {
+            auto value = properties.find(property);
+            if (value != properties.end())
+            {
+                filler(value->second);
+            }
+        }
+    }
+
+    // Hands what a GetManagedObjects on call.path returned to the fillers of
+    // every object below it
+    void dispatch(const Call& call, const boost::system::error_code& ec,
+                  const dbus::utility::ManagedObjectType& objects) const
+    {
+        if (ec)
+        {
+            BMCWEB_LOG_DEBUG << "GetManagedObjects on " << call.service << " "
+                             << call.path << " failed: " << ec;
+        }
+        boost::container::flat_map<std::string_view,
+                                   const dbus::utility::DBusInteracesMap*>
+            byPath;
+        if (!ec)
+        {
+            byPath.reserve(objects.size());
+            for (const auto& [path, interfaces] : objects)
+            {
+                byPath.emplace(path.str, &interfaces);
+            }
+        }
+
+        const dbus::utility::DBusPropertiesMap empty;
+        for (auto it = entries.lower_bound({call.service, "", ""});
+             it != entries.end() && it->first.service == call.service; it++)
+        {
+            if (ec)
+            {
+                dispatch(it->first, ec, empty);
+                continue;
+            }
+            auto object = byPath.find(it->first.path);
+            if (object == byPath.end())
+            {
+                dispatch(it->first, notReadError(), empty);
+                continue;
+            }
+            auto found = object->second->find(it->first.interface);
+            if (found == object->second->end())
+            {
+                dispatch(it->first, notReadError(), empty);
+                continue;
+            }
+            dispatch(it->first, boost::system::error_code(), found->second);
+        }
+    }
+
+    // Finds the ObjectManagers, then makes the calls.  The plan is kept
+    // until the last reply is handed out.
+    void run()
+    {
+        if (entries.empty())
+        {
+            return;
+        }
+        crow::object_mapper::MapperMirror& mirror =
+            crow::object_mapper::MapperMirror::getInstance();
+        if (mirror.isReady())
+        {
+            // Everything is known without a D-Bus call, including how much
+            // each GetManagedObjects would return
+            dbus::utility::MapperGetSubTreeResponse subtree;
+            mirror.getSubTree("/", 0, {objectManagerInterface}, subtree);
+            makeCalls(getCalls(
+                toObjectManagers(subtree),
+                [&mirror](const std::string& service,
+                          const std::string& objectManager) {
+                    return std::optional<size_t>(
+                        mirror.countObjects(objectManager, service));
+                }));
+            return;
+        }
+
+        CachedObjectManagers& cached = getCachedObjectManagers();
+        std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+        if (cached.objectManagers &&
+            now - cached.fetched < objectManagersMaxAge)
+        {
+            bmcweb::stats::increment("property_plan.object_managers_cached");
+            makeCalls(getCalls(*cached.objectManagers));
+            return;
+        }
+        crow::connections::systemBus->async_method_call(
+            [self{shared_from_this()}](
+                const boost::system::error_code ec,
+                const dbus::utility::MapperGetSubTreeResponse& subtree) {
+                if (ec)
+                {
+                    // Every object can still be read on its own
+                    BMCWEB_LOG_DEBUG << "No ObjectManagers found: " << ec;
+                    self->makeCalls(self->getCalls({}));
+                    return;
+                }
+                CachedObjectManagers& cached = getCachedObjectManagers();
+                cached.objectManagers = toObjectManagers(subtree);
+                cached.fetched = std::chrono::steady_clock::now();
+                self->makeCalls(self->getCalls(*cached.objectManagers));
+            },
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetSubTree", "/", int32_t(0),
+            std::array<const char*, 1>{objectManagerInterface});
+    }
+
+  private:
+    struct CachedObjectManagers
+    {
+        std::optional<ObjectManagers> objectManagers;
+        std::chrono::steady_clock::time_point fetched;
+    };
+
+    static CachedObjectManagers& getCachedObjectManagers()
+    {
+        static CachedObjectManagers cached;
+        return cached;
+    }
+
+    static ObjectManagers
+        toObjectManagers(const dbus::utility::MapperGetSubTreeResponse& subtree)
+    {
+        ObjectManagers objectManagers;
+        for (const auto& [path, services] : subtree)
+        {
+            for (const auto& [service, interfaces] : services)
+            {
+                objectManagers[service].push_back(path);
+            }
+        }
+        return objectManagers;
+    }
+
+    struct Entry
+    {
+        std::vector<InterfaceFiller> interfaceFillers;
+        std::vector<std::pair<std::string, PropertyFiller>> propertyFillers;
+    };
+
+    void makeCalls(const std::vector<Call>& calls)
+    {
+        bmcweb::stats::increment("property_plan.runs");
+        for (const Call& call : calls)
+        {
+            if (call.interface.empty())
+            {
+                bmcweb::stats::increment("property_plan.managed_objects");
+                crow::single_flight::asyncMethodCall<
+                    dbus::utility::ManagedObjectType>(
+                    [self{shared_from_this()},
+                     call](const boost::system::error_code ec,
+                           const dbus::utility::ManagedObjectType& objects) {
+                        self->dispatch(call, ec, objects);
+                    },
+                    call.service, call.path, objectManagerInterface,
+                    "GetManagedObjects");
+                continue;
+            }
+            bmcweb::stats::increment("property_plan.get_all");
+            crow::single_flight::asyncMethodCall<
+                dbus::utility::DBusPropertiesMap>(
+                [self{shared_from_this()},
+                 key{Key{call.service, call.path, call.interface}}](
+                    const boost::system::error_code ec,
+                    const dbus::utility::DBusPropertiesMap& properties) {
+                    self->dispatch(key, ec, properties);
+                },
+                call.service, call.path, "org.freedesktop.DBus.Properties",
+                "GetAll", call.interface);
+        }
+    }
+
+    std::map<Key, Entry> entries;
+};
+
+} // namespace property_plan
+} // namespace redfish
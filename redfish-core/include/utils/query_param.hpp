@@ -0,0 +1,909 @@
+#pragma once
+
+#include "async_resp.hpp"
+#include "error_messages.hpp"
+#include "http_request.hpp"
+#include "http_response.hpp"
+#include "http_utility.hpp"
+#include "logging.hpp"
+#include "utils/filter_expr.hpp"
+
+#include <boost/beast/http/status.hpp>
+#include <nlohmann/json.hpp>
+#include <stats.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+
+namespace query_param
+{
+
+enum class ExpandType : uint8_t
+{
+    None,
+    // "~": only references under Links
+    Links,
+    // ".": only references outside of Links
+    NotLinks,
+    // "*": every reference
+    Both,
+};
+
+// Deepest $levels accepted, advertised as MaxLevels on the service root
+constexpr uint64_t maxExpandLevels = 6;
+
+// Subrequests of one $expand that may be outstanding at a time
+constexpr size_t maxExpandInFlight = 8;
+
+// Expansion stops once the response would grow past this many bytes
+constexpr size_t maxExpandResponseSize = 4 * 1024 * 1024;
+
+struct Query
+{
+    ExpandType expandType = ExpandType::None;
+    uint64_t expandLevel = 1;
+
+    // Property paths from $select, such as "Status/Health".  Empty selects
+    // everything.
+    std::vector<std::string> selectProperties;
+
+    // Members of a collection are limited to those $filter matches
+    std::optional<filter_expr::FilterExpr> filter;
+};
+
+// Parses a $expand value: ".", "*" or "~", optionally followed by
+// "($levels=n)".  Returns false if the value is malformed.
+inline bool parseExpand(std::string_view value, Query& query)
+{
+    if (value.empty())
+    {
+        return false;
+    }
+    switch (value.front())
+    {
+        case '*':
+            query.expandType = ExpandType::Both;
+            break;
+        case '.':
+            query.expandType = ExpandType::NotLinks;
+            break;
+        case '~':
+            query.expandType = ExpandType::Links;
+            break;
+        default:
+            return false;
+    }
+    value.remove_prefix(1);
+    if (value.empty())
+    {
+        query.expandLevel = 1;
+        return true;
+    }
+
+    constexpr std::string_view levelsPrefix = "($levels=";
+    if (!value.starts_with(levelsPrefix) || !value.ends_with(')'))
+    {
+        return false;
+    }
+    value.remove_prefix(levelsPrefix.size());
+    value.remove_suffix(1);
+    const char* end = value.data() + value.size();
+    auto [ptr, ec] = std::from_chars(value.data(), end, query.expandLevel);
+    return ec == std::errc() && ptr == end;
+}
+
+// Parses a $select value: a comma separated list of property paths, with
+// "/" between the levels of a path.  Returns false if the value is malformed.
+inline bool parseSelect(std::string_view value,
+                        std::vector<std::string>& properties)
+{
+    properties.clear();
+    while (true)
+    {
+        size_t comma = value.find(',');
+        std::string_view property = value.substr(0, comma);
+        if (property.empty() || property.front() == '/' ||
+            property.back() == '/' ||
+            property.find("//") != std::string_view::npos)
+        {
+            return false;
+        }
+        for (char c : property)
+        {
+            if (std::isalnum(static_cast<unsigned char>(c)) == 0 &&
+                c != '_' && c != '@' && c != '.' && c != '#' && c != '/')
+            {
+                return false;
+            }
+        }
+        properties.emplace_back(property);
+        if (comma == std::string_view::npos)
+        {
+            return true;
+        }
+        value.remove_prefix(comma + 1);
+    }
+}
+
+// Reads the query parameters of a Redfish GET.  If one is invalid, the error
+// is set on res and std::nullopt returned.
+inline std::optional<Query>
+    parseParameters(const boost::urls::query_params_view& urlParams,
+                    crow::Response& res)
+{
+    Query query;
+    boost::urls::query_params_view::iterator expand =
+        urlParams.find("$expand");
+    if (expand != urlParams.end())
+    {
+        std::string value = expand->value();
+        if (!parseExpand(value, query))
+        {
+            messages::queryParameterValueFormatError(res, value, "$expand");
+            return std::nullopt;
+        }
+        if (query.expandLevel < 1 || query.expandLevel > maxExpandLevels)
+        {
+            messages::queryParameterOutOfRange(
+                res, value, "$expand",
+                "1-" + std::to_string(maxExpandLevels));
+            return std::nullopt;
+        }
+    }
+    boost::urls::query_params_view::iterator select =
+        urlParams.find("$select");
+    if (select != urlParams.end())
+    {
+        std::string value = select->value();
+        if (!parseSelect(value, query.selectProperties))
+        {
+            messages::queryParameterValueFormatError(res, value, "$select");
+            return std::nullopt;
+        }
+    }
+    boost::urls::query_params_view::iterator filter =
+        urlParams.find("$filter");
+    if (filter != urlParams.end())
+    {
+        std::string value = filter->value();
+        query.filter = filter_expr::FilterExpr::parse(value);
+        if (!query.filter)
+        {
+            messages::queryParameterValueFormatError(res, value, "$filter");
+            return std::nullopt;
+        }
+    }
+    return query;
+}
+
+// Whether the response has to be processed after the handler completes it
+inline bool needsProcessing(const Query& query)
+{
+    return query.expandType != ExpandType::None ||
+           !query.selectProperties.empty() || query.filter;
+}
+
+// Whether property, a top level name or a path such as "Status/Health", is
+// part of what properties select
+inline bool isSelected(const std::vector<std::string>& properties,
+                       std::string_view property)
+{
+    if (properties.empty())
+    {
+        return true;
+    }
+    return std::any_of(properties.begin(), properties.end(),
+                       [property](std::string_view selected) {
+                           // One is the other, or a path below it
+                           std::string_view shorter = property;
+                           std::string_view longer = selected;
+                           if (longer.size() < shorter.size())
+                           {
+                               std::swap(shorter, longer);
+                           }
+                           return longer.starts_with(shorter) &&
+                                  (longer.size() == shorter.size() ||
+                                   longer[shorter.size()] == '/');
+                       });
+}
+
+// Whether a handler has to fill in property for req.  Handlers use this to
+// skip the D-Bus calls behind properties that $select leaves out; the
+// response is pruned to the selection afterwards either way.  The selection
+// is the one the router parsed, so this is cheap enough to ask per property.
+inline bool isSelected(const crow::Request& req, std::string_view property)
+{
+    return isSelected(req.selectProperties, property);
+}
+
+// Entries in one page of a collection, unless $top asks for fewer
+constexpr uint64_t maxEntriesPerPage = 1000;
+
+// The part of a collection that $skip, $top and $filter ask for
+struct Paging
+{
+    uint64_t skip = 0;
+    uint64_t top = maxEntriesPerPage;
+    // Parameters the link to the next page keeps, such as "&$top=10", so
+    // that every page is selected the same way
+    std::string linkParams;
+    // Members the filter rules out are left out before paging, so that the
+    // count and the pages are those of the filtered collection
+    std::optional<filter_expr::FilterExpr> filter;
+};
+
+inline bool getSkipParam(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                         const crow::Request& req, uint64_t& skip)
+{
+    boost::urls::query_params_view::iterator it = req.urlParams.find("$skip");
+    if (it != req.urlParams.end())
+    {
+        std::string skipParam = it->value();
+        char* ptr = nullptr;
+        skip = std::strtoul(skipParam.c_str(), &ptr, 10);
+        if (skipParam.empty() || *ptr != '\0')
+        {
+
+            messages::queryParameterValueTypeError(
+                asyncResp->res, std::string(skipParam), "$skip");
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool getTopParam(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                        const crow::Request& req, uint64_t& top)
+{
+    boost::urls::query_params_view::iterator it = req.urlParams.find("$top");
+    if (it != req.urlParams.end())
+    {
+        std::string topParam = it->value();
+        char* ptr = nullptr;
+        top = std::strtoul(topParam.c_str(), &ptr, 10);
+        if (topParam.empty() || *ptr != '\0')
+        {
+            messages::queryParameterValueTypeError(
+                asyncResp->res, std::string(topParam), "$top");
+            return false;
+        }
+        if (top < 1U || top > maxEntriesPerPage)
+        {
+
+            messages::queryParameterOutOfRange(
+                asyncResp->res, std::to_string(top), "$top",
+                "1-" + std::to_string(maxEntriesPerPage));
+            return false;
+        }
+    }
+    return true;
+}
+
+// Reads $skip, $top and $filter from req.  Returns std::nullopt, with the
+// error in the response, if $skip or $top is invalid.
+inline std::optional<Paging>
+    getPaging(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+              const crow::Request& req)
+{
+    Paging paging;
+    if (!getSkipParam(asyncResp, req, paging.skip) ||
+        !getTopParam(asyncResp, req, paging.top))
+    {
+        return std::nullopt;
+    }
+    if (req.urlParams.find("$top") != req.urlParams.end())
+    {
+        paging.linkParams += "&$top=";
+        paging.linkParams += std::to_string(paging.top);
+    }
+    boost::urls::query_params_view::iterator filter =
+        req.urlParams.find("$filter");
+    if (filter != req.urlParams.end())
+    {
+        paging.linkParams += "&$filter=";
+        paging.linkParams += http_helpers::urlEncode(filter->value());
+        // With $expand the members are filtered once they are expanded, as
+        // the filter may need more of them than their references
+        if (req.urlParams.find("$expand") == req.urlParams.end())
+        {
+            paging.filter = filter_expr::FilterExpr::parse(filter->value());
+        }
+    }
+    return paging;
+}
+
+// Whether the entry at index, counting from 0, is on the page
+inline bool onPage(const Paging& paging, uint64_t index)
+{
+    return index >= paging.skip && index - paging.skip < paging.top;
+}
+
+/**
+ * Reads the next entry of a collection that is read in order, such as a log.
+ * It is added to members if $filter keeps it and it is on the page, and is
+ * counted in count if $filter keeps it.
+ *
+ * getID(id) is called for every entry, kept or not, as the ID of an entry
+ * can depend on the entries read before it, and returns false for an entry
+ * to skip.  getSummary() returns the properties $filter can test without the
+ * entry being built, and build(id, json) builds it, returning false if it
+ * can't.  Returns false if the entry couldn't be built.
+ */
+template <typename GetID, typename GetSummary, typename Build>
+inline bool addEntry(const Paging& paging, nlohmann::json& members,
+                     uint64_t& count, GetID&& getID, GetSummary&& getSummary,
+                     Build&& build)
+{
+    std::string id;
+    if (!getID(id))
+    {
+        return true;
+    }
+    nlohmann::json entry;
+    if (paging.filter)
+    {
+        std::optional<bool> known = paging.filter->evaluate(getSummary());
+        if (known && !*known)
+        {
+            return true;
+        }
+        if (!known)
+        {
+            // The filter needs the whole entry
+            if (!build(id, entry))
+            {
+                return false;
+            }
+            if (!paging.filter->matches(entry))
+            {
+                return true;
+            }
+        }
+    }
+
+    count++;
+    if (!onPage(paging, count - 1))
+    {
+        return true;
+    }
+    if (entry.is_null() && !build(id, entry))
+    {
+        return false;
+    }
+    members.push_back(std::move(entry));
+    return true;
+}
+
+// Sets Members@odata.nextLink when the collection at collectionPath, of
+// count entries, goes on past the page
+inline void setNextLink(crow::Response& res, std::string_view collectionPath,
+                        const Paging& paging, uint64_t count)
+{
+    if (paging.skip >= count || count - paging.skip <= paging.top)
+    {
+        return;
+    }
+    std::string nextLink(collectionPath);
+    nextLink += "?$skip=";
+    nextLink += std::to_string(paging.skip + paging.top);
+    nextLink += paging.linkParams;
+    res.jsonValue["Members@odata.nextLink"] = std::move(nextLink);
+}
+
+// Fills in the Members of the collection at collectionPath, with their count
+// and next link, from the URIs of all its members.  The members are only
+// references, so the filter can only be applied to their @odata.id; a filter
+// on anything else is refused, as neither the page nor the count could be
+// right for it.
+inline void setReferenceMembers(crow::Response& res,
+                                std::string_view collectionPath,
+                                const std::vector<std::string>& uris,
+                                const Paging& paging)
+{
+    nlohmann::json::array_t members;
+    uint64_t count = 0;
+    for (const std::string& uri : uris)
+    {
+        nlohmann::json reference = {{"@odata.id", uri}};
+        if (paging.filter)
+        {
+            std::optional<bool> matches = paging.filter->evaluate(reference);
+            if (!matches)
+            {
+                BMCWEB_LOG_DEBUG << "$filter needs more than references of "
+                                 << collectionPath;
+                messages::queryNotSupported(res);
+                return;
+            }
+            if (!*matches)
+            {
+                continue;
+            }
+        }
+        if (onPage(paging, count++))
+        {
+            members.emplace_back(std::move(reference));
+        }
+    }
+    res.jsonValue["Members"] = std::move(members);
+    res.jsonValue["Members@odata.count"] = count;
+    setNextLink(res, collectionPath, paging, count);
+}
+
+namespace details
+{
+
+// The paths below key, from paths relative to the object holding key.  An
+// empty path selects all of key.
+inline std::vector<std::string_view>
+    selectedBelow(const std::vector<std::string_view>& paths,
+                  std::string_view key)
+{
+    std::vector<std::string_view> below;
+    for (std::string_view path : paths)
+    {
+        if (path == key)
+        {
+            below.emplace_back();
+        }
+        else if (path.starts_with(key) && path.size() > key.size() &&
+                 path[key.size()] == '/')
+        {
+            below.push_back(path.substr(key.size() + 1));
+        }
+    }
+    return below;
+}
+
+inline void selectProperties(nlohmann::json& value,
+                             const std::vector<std::string_view>& paths,
+                             bool isResource)
+{
+    if (std::find(paths.begin(), paths.end(), "") != paths.end())
+    {
+        return;
+    }
+    nlohmann::json::array_t* array = value.get_ptr<nlohmann::json::array_t*>();
+    if (array != nullptr)
+    {
+        for (nlohmann::json& element : *array)
+        {
+            selectProperties(element, paths, false);
+        }
+        return;
+    }
+    nlohmann::json::object_t* object =
+        value.get_ptr<nlohmann::json::object_t*>();
+    if (object == nullptr)
+    {
+        return;
+    }
+    for (auto it = object->begin(); it != object->end();)
+    {
+        if (isResource && it->first.starts_with("@odata."))
+        {
+            it++;
+            continue;
+        }
+        // Annotations such as Members@odata.count go with their property
+        std::string_view key = it->first;
+        size_t at = key.find('@');
+        if (at != 0 && at != std::string_view::npos)
+        {
+            key = key.substr(0, at);
+        }
+        std::vector<std::string_view> below = selectedBelow(paths, key);
+        if (below.empty())
+        {
+            it = object->erase(it);
+            continue;
+        }
+        selectProperties(it->second, below, false);
+        it++;
+    }
+}
+
+} // namespace details
+
+// Removes what properties don't select from a resource.  The @odata
+// annotations of the resource itself are always kept.
+inline void selectProperties(nlohmann::json& root,
+                             const std::vector<std::string>& properties)
+{
+    if (properties.empty())
+    {
+        return;
+    }
+    std::vector<std::string_view> paths(properties.begin(), properties.end());
+    details::selectProperties(root, paths, true);
+}
+
+// The top level properties of a selection, which can be applied before the
+// levels below are filled in
+inline std::vector<std::string>
+    topLevelProperties(const std::vector<std::string>& properties)
+{
+    std::vector<std::string> topLevel;
+    topLevel.reserve(properties.size());
+    for (const std::string& property : properties)
+    {
+        topLevel.emplace_back(property.substr(0, property.find('/')));
+    }
+    return topLevel;
+}
+
+// Whether member is only a reference, with nothing to filter on but its
+// @odata.id
+inline bool isReference(const nlohmann::json& member)
+{
+    const nlohmann::json::object_t* object =
+        member.get_ptr<const nlohmann::json::object_t*>();
+    return object != nullptr && object->size() == 1 &&
+           object->contains("@odata.id");
+}
+
+// Drops the Members of a collection that filter doesn't match, for handlers
+// that fill in the whole collection.  Handlers that page a collection apply
+// the filter before paging, as only they can count what it keeps.  If there
+// is still something to drop from a page, or a member is a reference the
+// filter needs more of, the query is refused rather than answered with a
+// count that doesn't match.  Returns false if it was refused.
+inline bool filterMembers(crow::Response& res,
+                          const filter_expr::FilterExpr& filter)
+{
+    nlohmann::json::object_t* object =
+        res.jsonValue.get_ptr<nlohmann::json::object_t*>();
+    if (object == nullptr)
+    {
+        return true;
+    }
+    auto members = object->find("Members");
+    if (members == object->end() || !members->second.is_array())
+    {
+        return true;
+    }
+    nlohmann::json::array_t& array =
+        members->second.get_ref<nlohmann::json::array_t&>();
+    auto count = object->find("Members@odata.count");
+    bool paged = object->contains("Members@odata.nextLink") ||
+                 (count != object->end() && count->second != array.size());
+
+    nlohmann::json::array_t kept;
+    for (nlohmann::json& member : array)
+    {
+        std::optional<bool> matches = isReference(member)
+                                          ? filter.evaluate(member)
+                                          : filter.matches(member);
+        if (!matches)
+        {
+            BMCWEB_LOG_DEBUG << "$filter needs more than a reference";
+            res.jsonValue.clear();
+            messages::queryNotSupported(res);
+            return false;
+        }
+        if (*matches)
+        {
+            kept.emplace_back(std::move(member));
+        }
+    }
+    if (kept.size() == array.size())
+    {
+        array = std::move(kept);
+        return true;
+    }
+    if (paged)
+    {
+        BMCWEB_LOG_DEBUG << "$filter left to a paged collection";
+        res.jsonValue.clear();
+        messages::queryNotSupported(res);
+        return false;
+    }
+    array = std::move(kept);
+    if (count != object->end())
+    {
+        count->second = array.size();
+    }
+    return true;
+}
+
+// Applies the parts of query that need the resource to be complete
+inline void filterAndSelect(crow::Response& res, const Query& query)
+{
+    if (query.filter && !filterMembers(res, *query.filter))
+    {
+        return;
+    }
+    selectProperties(res.jsonValue, query.selectProperties);
+}
+
+// A reference to be replaced with the resource it points to
+struct ExpandNode
+{
+    nlohmann::json::json_pointer location;
+    std::string uri;
+};
+
+namespace details
+{
+
+inline void
+    findNavigationReferences(ExpandType type, const nlohmann::json& value,
+                             const nlohmann::json::json_pointer& location,
+                             bool inLinks, std::vector<ExpandNode>& nodes)
+{
+    const nlohmann::json::array_t* array =
+        value.get_ptr<const nlohmann::json::array_t*>();
+    if (array != nullptr)
+    {
+        for (size_t index = 0; index < array->size(); index++)
+        {
+            findNavigationReferences(type, (*array)[index], location / index,
+                                     inLinks, nodes);
+        }
+        return;
+    }
+    const nlohmann::json::object_t* object =
+        value.get_ptr<const nlohmann::json::object_t*>();
+    if (object == nullptr)
+    {
+        return;
+    }
+    if (object->size() == 1)
+    {
+        auto odataId = object->find("@odata.id");
+        if (odataId != object->end())
+        {
+            const std::string* uri =
+                odataId->second.get_ptr<const std::string*>();
+            // References to part of a resource can't be fetched on their own
+            if (uri == nullptr || uri->find('#') != std::string::npos)
+            {
+                return;
+            }
+            if (type == ExpandType::Both ||
+                (type == ExpandType::Links) == inLinks)
+            {
+                nodes.push_back({location, *uri});
+            }
+            return;
+        }
+    }
+    for (const auto& [key, child] : *object)
+    {
+        findNavigationReferences(type, child, location / key,
+                                 inLinks || key == "Links", nodes);
+    }
+}
+
+} // namespace details
+
+// Finds the references below the top level of a resource that type selects.
+// A reference is an object holding nothing but an @odata.id.
+inline std::vector<ExpandNode>
+    findNavigationReferences(ExpandType type, const nlohmann::json& root)
+{
+    std::vector<ExpandNode> nodes;
+    const nlohmann::json::object_t* object =
+        root.get_ptr<const nlohmann::json::object_t*>();
+    if (type == ExpandType::None || object == nullptr)
+    {
+        return nodes;
+    }
+    for (const auto& [key, child] : *object)
+    {
+        details::findNavigationReferences(type, child,
+                                          nlohmann::json::json_pointer() / key,
+                                          key == "Links", nodes);
+    }
+    return nodes;
+}
+
+// Roughly the number of bytes value takes once serialized, without walking
+// it twice as dump() would
+inline size_t approximateSize(const nlohmann::json& value)
+{
+    const nlohmann::json::object_t* object =
+        value.get_ptr<const nlohmann::json::object_t*>();
+    if (object != nullptr)
+    {
+        size_t size = 2;
+        for (const auto& [key, child] : *object)
+        {
+            // Quotes, colon and comma
+            size += key.size() + 4 + approximateSize(child);
+        }
+        return size;
+    }
+    const nlohmann::json::array_t* array =
+        value.get_ptr<const nlohmann::json::array_t*>();
+    if (array != nullptr)
+    {
+        size_t size = 2;
+        for (const nlohmann::json& child : *array)
+        {
+            size += 1 + approximateSize(child);
+        }
+        return size;
+    }
+    const std::string* str = value.get_ptr<const std::string*>();
+    if (str != nullptr)
+    {
+        return str->size() + 2;
+    }
+    // Numbers, booleans and null
+    return 8;
+}
+
+// Runs a GET of uri on behalf of the request being expanded, and calls the
+// callback with the completed response
+using SubRequestHandler = std::function<void(
+    const std::string& uri, std::function<void(crow::Response&)>&& callback)>;
+
+/**
+ * ExpandHandler
+ * Replaces the references in a response with the resources they point to,
+ * each fetched with a subrequest.  At most maxExpandInFlight subrequests are
+ * outstanding at once.  Once the last subrequest returns, the handler is
+ * destroyed, which applies the rest of the query and completes the final
+ * response.
+ */
+class ExpandHandler : public std::enable_shared_from_this<ExpandHandler>
+{
+  public:
+    ExpandHandler(const std::shared_ptr<bmcweb::AsyncResp>& finalResIn,
+                  const Query& queryIn, SubRequestHandler&& subRequestIn) :
+        finalRes(finalResIn),
+        query(queryIn), subRequest(std::move(subRequestIn))
+    {}
+
+    ~ExpandHandler()
+    {
+        filterAndSelect(finalRes->res, query);
+    }
+
+    ExpandHandler(const ExpandHandler&) = delete;
+    ExpandHandler(ExpandHandler&&) = delete;
+    ExpandHandler& operator=(const ExpandHandler&) = delete;
+    ExpandHandler& operator=(ExpandHandler&&) = delete;
+
+    void start()
+    {
+        responseSize = approximateSize(finalRes->res.jsonValue);
+        addNodes(finalRes->res.jsonValue, nlohmann::json::json_pointer(),
+                 query.expandLevel);
+        sendNext();
+    }
+
+  private:
+    struct PendingNode
+    {
+        ExpandNode node;
+        // Levels left to expand, counting this one
+        uint64_t levels;
+    };
+
+    void addNodes(const nlohmann::json& value,
+                  const nlohmann::json::json_pointer& location,
+                  uint64_t levels)
+    {
+        for (ExpandNode& node :
+             findNavigationReferences(query.expandType, value))
+        {
+            node.location = location / node.location;
+            pending.push_back({std::move(node), levels});
+        }
+    }
+
+    void sendNext()
+    {
+        while (!truncated && inFlight < maxExpandInFlight && !pending.empty())
+        {
+            PendingNode next = std::move(pending.front());
+            pending.pop_front();
+            inFlight++;
+            std::string uri = next.node.uri;
+            subRequest(uri, [self = shared_from_this(),
+                             next{std::move(next)}](crow::Response& res) {
+                self->afterSubRequest(next, res);
+            });
+        }
+    }
+
+    void afterSubRequest(const PendingNode& next, crow::Response& res)
+    {
+        inFlight--;
+        if (truncated)
+        {
+            return;
+        }
+        if (res.result() != boost::beast::http::status::ok ||
+            !res.jsonValue.is_object())
+        {
+            // Left as a reference
+            BMCWEB_LOG_DEBUG << "Not expanding " << next.node.uri << ": "
+                             << res.resultInt();
+            sendNext();
+            return;
+        }
+
+        size_t size = approximateSize(res.jsonValue);
+        if (responseSize + size > maxExpandResponseSize)
+        {
+            BMCWEB_LOG_WARNING << "Expanded response passed "
+                               << maxExpandResponseSize
+                               << " bytes, leaving remaining references";
+            bmcweb::stats::increment("query.expand.truncated");
+            truncated = true;
+            pending.clear();
+            return;
+        }
+        responseSize += size;
+
+        nlohmann::json& slot = finalRes->res.jsonValue[next.node.location];
+        slot = std::move(res.jsonValue);
+        if (next.levels > 1)
+        {
+            addNodes(slot, next.node.location, next.levels - 1);
+        }
+        sendNext();
+    }
+
+    std::shared_ptr<bmcweb::AsyncResp> finalRes;
+    Query query;
+    SubRequestHandler subRequest;
+    std::deque<PendingNode> pending;
+    size_t inFlight = 0;
+    size_t responseSize = 0;
+    bool truncated = false;
+};
+
+// Moves the response a handler completed into finalRes, and applies query
+// to it
+inline void processAllParams(const Query& query,
+                             const std::shared_ptr<bmcweb::AsyncResp>& finalRes,
+                             crow::Response& intermediate,
+                             SubRequestHandler&& subRequest)
+{
+    // Not Response::operator=, which would also mark finalRes completed
+    crow::Response& res = finalRes->res;
+    res.stringResponse = std::move(intermediate.stringResponse);
+    intermediate.stringResponse.emplace(crow::Response::response_type{});
+    res.jsonValue = std::move(intermediate.jsonValue);
+    res.staticBody = intermediate.staticBody;
+    intermediate.staticBody = {};
+
+    if (res.result() != boost::beast::http::status::ok ||
+        !res.jsonValue.is_object())
+    {
+        return;
+    }
+    if (query.expandType == ExpandType::None)
+    {
+        filterAndSelect(res, query);
+        return;
+    }
+    // Dropping unselected top level properties first leaves fewer references
+    // to expand.  The rest waits for the expansion, as it may refer to what
+    // the expansion fills in.
+    selectProperties(res.jsonValue, topLevelProperties(query.selectProperties));
+    std::make_shared<ExpandHandler>(finalRes, query, std::move(subRequest))
+        ->start();
+}
+
+} // namespace query_param
+} // namespace redfish
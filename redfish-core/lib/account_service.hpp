@@ -16,6 +16,7 @@
 #pragma once
 
 #include <app.hpp>
+#include <credential_cache.hpp>
 #include <dbus_utility.hpp>
 #include <error_messages.hpp>
 #include <openbmc_dbus_rest.hpp>
@@ -1572,6 +1573,9 @@ inline void updateUserProperties(
 
             if (password)
             {
+                // The old password must stop working for Basic auth now
+                crow::authorization::CredentialCache::getInstance().erase(
+                    username);
                 int retval = pamUpdatePassword(username, *password);
 
                 if (retval == PAM_USER_UNKNOWN)
@@ -1977,6 +1981,7 @@ inline void requestAccountServiceRoutes(App& app)
 
     BMCWEB_ROUTE(app, "/redfish/v1/AccountService/")
         .privileges(redfish::privileges::patchAccountService)
+        .ifMatch()
         .methods(boost::beast::http::verb::patch)(
             [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) -> void {
@@ -2487,6 +2492,7 @@ inline void requestAccountServiceRoutes(App& app)
         // because of the special handling of ConfigureSelf, it's not able to
         // yet
         .privileges({{"ConfigureUsers"}, {"ConfigureSelf"}})
+        .ifMatch()
         .methods(boost::beast::http::verb::patch)(
             [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
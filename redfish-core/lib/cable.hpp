@@ -468,7 +468,7 @@ inline void requestRoutesCableCollection(App& app)
     BMCWEB_ROUTE(app, "/redfish/v1/Cables/")
         .privileges(redfish::privileges::getCableCollection)
         .methods(boost::beast::http::verb::get)(
-            [](const crow::Request&,
+            [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
                 asyncResp->res.jsonValue["@odata.type"] =
                     "#CableCollection.CableCollection";
@@ -478,7 +478,7 @@ inline void requestRoutesCableCollection(App& app)
                     "Collection of Cable Entries";
 
                 collection_util::getCollectionMembers(
-                    asyncResp, "/redfish/v1/Cables",
+                    req, asyncResp, "/redfish/v1/Cables",
                     {"xyz.openbmc_project.Inventory.Item.Cable"});
             });
 }
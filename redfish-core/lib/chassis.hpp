@@ -23,6 +23,7 @@
 #include <registries/privilege_registry.hpp>
 #include <utils/collection.hpp>
 #include <utils/name_utils.hpp>
+#include <utils/query_param.hpp>
 
 #include <variant>
 
@@ -157,6 +158,74 @@ inline void getPhysicalSecurityData(std::shared_ptr<bmcweb::AsyncResp> aResp)
         std::array<const char*, 1>{"xyz.openbmc_project.Chassis.Intrusion"});
 }
 
+/**
+ * @brief Rolls up the health of the sensors and inventory of a chassis into
+ *        its Status
+ *
+ * @param[in] asyncResp - Shared pointer for completing asynchronous calls.
+ * @param[in] path - D-Bus path of the chassis.
+ *
+ * @return None.
+ */
+inline void
+    populateChassisHealth(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                          const std::string& path)
+{
+    auto health = std::make_shared<HealthPopulate>(asyncResp);
+
+    crow::connections::systemBus->async_method_call(
+        [health](const boost::system::error_code ec2,
+                 std::variant<std::vector<std::string>>& resp) {
+            if (ec2)
+            {
+                return; // no sensors = no failures
+            }
+            std::vector<std::string>* data =
+                std::get_if<std::vector<std::string>>(&resp);
+            if (data == nullptr)
+            {
+                return;
+            }
+            health->inventory = std::move(*data);
+            constexpr const std::array<const char*, 13> inventoryForChassis = {
+                "xyz.openbmc_project.Inventory.Item.Dimm",
+                "xyz.openbmc_project.Inventory.Item.Cpu",
+                "xyz.openbmc_project.Inventory.Item.PowerSupply",
+                "xyz.openbmc_project.Inventory.Item.Fan",
+                "xyz.openbmc_project.Inventory.Item.PCIeSlot",
+                "xyz.openbmc_project.Inventory.Item.Vrm",
+                "xyz.openbmc_project.Inventory.Item.Tpm",
+                "xyz.openbmc_project.Inventory.Item.Panel",
+                "xyz.openbmc_project.Inventory.Item.Battery",
+                "xyz.openbmc_project.Inventory.Item.DiskBackplane",
+                "xyz.openbmc_project.Inventory.Item.Board",
+                "xyz.openbmc_project.Inventory.Item.Board.Motherboard",
+                "xyz.openbmc_project.Inventory.Item.Connector"};
+
+            crow::connections::systemBus->async_method_call(
+                [health](const boost::system::error_code ec,
+                         std::vector<std::string>& resp) {
+                    if (ec)
+                    {
+                        // no inventory
+                        return;
+                    }
+
+                    health->inventory.insert(health->inventory.end(),
+                                             resp.begin(), resp.end());
+                },
+                "xyz.openbmc_project.ObjectMapper",
+                "/xyz/openbmc_project/object_mapper",
+                "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths", "/",
+                int32_t(0), inventoryForChassis);
+        },
+        "xyz.openbmc_project.ObjectMapper", path + "/all_sensors",
+        "org.freedesktop.DBus.Properties", "Get",
+        "xyz.openbmc_project.Association", "endpoints");
+
+    health->populate();
+}
+
 /**
  * ChassisCollection derived class for delivering Chassis Collection Schema
  *  Functions triggers appropriate requests on DBus
@@ -166,7 +235,7 @@ inline void requestRoutesChassisCollection(App& app)
     BMCWEB_ROUTE(app, "/redfish/v1/Chassis/")
         .privileges(redfish::privileges::getChassisCollection)
         .methods(boost::beast::http::verb::get)(
-            [](const crow::Request&,
+            [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
                 asyncResp->res.jsonValue["@odata.type"] =
                     "#ChassisCollection.ChassisCollection";
@@ -174,7 +243,7 @@ inline void requestRoutesChassisCollection(App& app)
                 asyncResp->res.jsonValue["Name"] = "Chassis Collection";
 
                 collection_util::getCollectionMembers(
-                    asyncResp, "/redfish/v1/Chassis",
+                    req, asyncResp, "/redfish/v1/Chassis",
                     {"xyz.openbmc_project.Inventory.Item.Chassis"});
             });
 }
@@ -188,15 +257,20 @@ inline void requestRoutesChassis(App& app)
     BMCWEB_ROUTE(app, "/redfish/v1/Chassis/<str>/")
         .privileges(redfish::privileges::getChassis)
         .methods(
-            boost::beast::http::verb::get)([](const crow::Request&,
+            boost::beast::http::verb::get)([](const crow::Request& req,
                                               const std::shared_ptr<
                                                   bmcweb::AsyncResp>& asyncResp,
                                               const std::string& chassisId) {
             const std::array<const char*, 1> interfaces = {
                 "xyz.openbmc_project.Inventory.Item.Chassis"};
 
+            // Used to skip the D-Bus calls behind properties $select leaves
+            // out
+            std::vector<std::string> select = req.selectProperties;
+
             crow::connections::systemBus->async_method_call(
-                [asyncResp, chassisId(std::string(chassisId)), interfaces](
+                [asyncResp, chassisId(std::string(chassisId)), interfaces,
+                 select](
                     const boost::system::error_code ec,
                     const crow::openbmc_mapper::GetSubTreeType& subtree) {
                     if (ec)
@@ -222,79 +296,10 @@ inline void requestRoutesChassis(App& app)
                             continue;
                         }
 
-                        auto health =
-                            std::make_shared<HealthPopulate>(asyncResp);
-
-                        crow::connections::systemBus->async_method_call(
-                            [health](
-                                const boost::system::error_code ec2,
-                                std::variant<std::vector<std::string>>& resp) {
-                                if (ec2)
-                                {
-                                    return; // no sensors = no failures
-                                }
-                                std::vector<std::string>* data =
-                                    std::get_if<std::vector<std::string>>(
-                                        &resp);
-                                if (data == nullptr)
-                                {
-                                    return;
-                                }
-                                health->inventory = std::move(*data);
-                                constexpr const std::array<const char*, 13>
-                                    inventoryForChassis = {
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "Dimm",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "Cpu",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "PowerSupply",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "Fan",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "PCIeSlot",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "Vrm",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "Tpm",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "Panel",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "Battery",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "DiskBackplane",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "Board",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "Board.Motherboard",
-                                        "xyz.openbmc_project.Inventory.Item."
-                                        "Connector"};
-
-                                crow::connections::systemBus->async_method_call(
-                                    [health](const boost::system::error_code ec,
-                                             std::vector<std::string>& resp) {
-                                        if (ec)
-                                        {
-                                            // no inventory
-                                            return;
-                                        }
-
-                                        health->inventory.insert(
-                                            health->inventory.end(),
-                                            resp.begin(), resp.end());
-                                    },
-                                    "xyz.openbmc_project.ObjectMapper",
-                                    "/xyz/openbmc_project/object_mapper",
-                                    "xyz.openbmc_project.ObjectMapper",
-                                    "GetSubTreePaths", "/", int32_t(0),
-                                    inventoryForChassis);
-                            },
-                            "xyz.openbmc_project.ObjectMapper",
-                            path + "/all_sensors",
-                            "org.freedesktop.DBus.Properties", "Get",
-                            "xyz.openbmc_project.Association", "endpoints");
-
-                        health->populate();
+                        if (query_param::isSelected(select, "Status"))
+                        {
+                            populateChassisHealth(asyncResp, path);
+                        }
 
                         if (connectionNames.size() < 1)
                         {
@@ -329,7 +334,8 @@ inline void requestRoutesChassis(App& app)
                         const std::string assetTagInterface =
                             "xyz.openbmc_project.Inventory.Decorator."
                             "AssetTag";
-                        if (std::find(interfaces2.begin(), interfaces2.end(),
+                        if (query_param::isSelected(select, "AssetTag") &&
+                            std::find(interfaces2.begin(), interfaces2.end(),
                                       assetTagInterface) != interfaces2.end())
                         {
                             crow::connections::systemBus->async_method_call(
@@ -365,7 +371,9 @@ inline void requestRoutesChassis(App& app)
 
                         for (const char* interface : hasIndicatorLed)
                         {
-                            if (std::find(interfaces2.begin(),
+                            if (query_param::isSelected(
+                                    select, "LocationIndicatorActive") &&
+                                std::find(interfaces2.begin(),
                                           interfaces2.end(),
                                           interface) != interfaces2.end())
                             {
@@ -378,7 +386,8 @@ inline void requestRoutesChassis(App& app)
                         const std::string locationInterface =
                             "xyz.openbmc_project.Inventory.Decorator."
                             "LocationCode";
-                        if (std::find(interfaces2.begin(), interfaces2.end(),
+                        if (query_param::isSelected(select, "Location") &&
+                            std::find(interfaces2.begin(), interfaces2.end(),
                                       locationInterface) != interfaces2.end())
                         {
                             crow::connections::systemBus->async_method_call(
@@ -415,7 +424,8 @@ inline void requestRoutesChassis(App& app)
 
                         const std::string versionInterface =
                             "xyz.openbmc_project.Software.Version";
-                        if (std::find(interfaces2.begin(), interfaces2.end(),
+                        if (query_param::isSelected(select, "Oem") &&
+                            std::find(interfaces2.begin(), interfaces2.end(),
                                       versionInterface) != interfaces2.end())
                         {
                             crow::connections::systemBus->async_method_call(
@@ -455,7 +465,7 @@ inline void requestRoutesChassis(App& app)
 
                         crow::connections::systemBus->async_method_call(
                             [asyncResp, chassisId(std::string(chassisId)), path,
-                             connectionNames](
+                             connectionNames, select](
                                 const boost::system::error_code /*ec2*/,
                                 const std::vector<
                                     std::pair<std::string, VariantType>>&
@@ -554,7 +564,12 @@ inline void requestRoutesChassis(App& app)
                                 asyncResp->res.jsonValue["Links"]["ManagedBy"] =
                                     {{{"@odata.id",
                                        "/redfish/v1/Managers/bmc"}}};
-                                getChassisState(asyncResp);
+                                if (query_param::isSelected(select,
+                                                            "PowerState") ||
+                                    query_param::isSelected(select, "Status"))
+                                {
+                                    getChassisState(asyncResp);
+                                }
 
                                 asyncResp->res.jsonValue["Assembly"] = {
                                     {"@odata.id", "/redfish/v1/Chassis/" +
@@ -567,7 +582,8 @@ inline void requestRoutesChassis(App& app)
                         // Chassis UUID
                         const std::string uuidInterface =
                             "xyz.openbmc_project.Common.UUID";
-                        if (std::find(interfaces2.begin(), interfaces2.end(),
+                        if (query_param::isSelected(select, "UUID") &&
+                            std::find(interfaces2.begin(), interfaces2.end(),
                                       uuidInterface) != interfaces2.end())
                         {
                             crow::connections::systemBus->async_method_call(
@@ -610,7 +626,10 @@ inline void requestRoutesChassis(App& app)
                 "xyz.openbmc_project.ObjectMapper", "GetSubTree",
                 "/xyz/openbmc_project/inventory", 0, interfaces);
 
-            getPhysicalSecurityData(asyncResp);
+            if (query_param::isSelected(select, "PhysicalSecurity"))
+            {
+                getPhysicalSecurityData(asyncResp);
+            }
         });
 
     BMCWEB_ROUTE(app, "/redfish/v1/Chassis/<str>/")
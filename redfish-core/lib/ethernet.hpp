@@ -18,6 +18,7 @@
 #include <app.hpp>
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
+#include <dbus_single_flight.hpp>
 #include <dbus_singleton.hpp>
 #include <error_messages.hpp>
 #include <registries/privilege_registry.hpp>
@@ -201,7 +202,7 @@ inline std::string
 }
 
 inline bool extractEthernetInterfaceData(const std::string& ethifaceId,
-                                         GetManagedObjects& dbusData,
+                                         const GetManagedObjects& dbusData,
                                          EthernetInterfaceData& ethData)
 {
     bool idFound = false;
@@ -893,10 +894,10 @@ template <typename CallbackFunc>
 void getEthernetIfaceData(const std::string& ethifaceId,
                           CallbackFunc&& callback)
 {
-    crow::connections::systemBus->async_method_call(
+    crow::single_flight::asyncMethodCall<GetManagedObjects>(
         [ethifaceId{std::string{ethifaceId}}, callback{std::move(callback)}](
             const boost::system::error_code errorCode,
-            GetManagedObjects& resp) {
+            const GetManagedObjects& resp) {
             EthernetInterfaceData ethData{};
             boost::container::flat_set<IPv4AddressData> ipv4Data;
             boost::container::flat_set<IPv6AddressData> ipv6Data;
@@ -944,10 +945,10 @@ void getEthernetIfaceData(const std::string& ethifaceId,
 template <typename CallbackFunc>
 void getEthernetIfaceList(CallbackFunc&& callback)
 {
-    crow::connections::systemBus->async_method_call(
+    crow::single_flight::asyncMethodCall<GetManagedObjects>(
         [callback{std::move(callback)}](
             const boost::system::error_code errorCode,
-            GetManagedObjects& resp) {
+            const GetManagedObjects& resp) {
             // Callback requires vector<string> to retrieve all available
             // ethernet interfaces
             boost::container::flat_set<std::string> ifaceList;
@@ -18,9 +18,11 @@
 #include "async_resp.hpp"
 
 #include <app.hpp>
-#include <boost/algorithm/string/predicate.hpp>
 #include <boost/container/flat_set.hpp>
+#include <dbus_single_flight.hpp>
 #include <dbus_singleton.hpp>
+#include <object_mapper_mirror.hpp>
+#include <utils/health_index.hpp>
 
 #include <variant>
 
@@ -41,125 +43,17 @@ struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
 
     ~HealthPopulate()
     {
-        nlohmann::json& health = jsonStatus["Health"];
-        nlohmann::json& rollup = jsonStatus["HealthRollup"];
-
-        health = "OK";
-        rollup = "OK";
-
         for (const std::shared_ptr<HealthPopulate>& healthChild : children)
         {
             healthChild->globalInventoryPath = globalInventoryPath;
             healthChild->statuses = statuses;
         }
 
-        for (const auto& [path, interfaces] : statuses)
-        {
-            bool isChild = false;
-            bool isSelf = false;
-            if (selfPath)
-            {
-                if (boost::equals(path.str, *selfPath) ||
-                    boost::starts_with(path.str, *selfPath + "/"))
-                {
-                    isSelf = true;
-                }
-            }
-
-            // managers inventory is all the inventory, don't skip any
-            if (!isManagersHealth && !isSelf)
-            {
-
-                // We only want to look at this association if either the path
-                // of this association is an inventory item, or one of the
-                // endpoints in this association is a child
-
-                for (const std::string& child : inventory)
-                {
-                    if (boost::starts_with(path.str, child))
-                    {
-                        isChild = true;
-                        break;
-                    }
-                }
-                if (!isChild)
-                {
-                    auto assocIt =
-                        interfaces.find("xyz.openbmc_project.Association");
-                    if (assocIt == interfaces.end())
-                    {
-                        continue;
-                    }
-                    auto endpointsIt = assocIt->second.find("endpoints");
-                    if (endpointsIt == assocIt->second.end())
-                    {
-                        BMCWEB_LOG_ERROR << "Illegal association at "
-                                         << path.str;
-                        continue;
-                    }
-                    const std::vector<std::string>* endpoints =
-                        std::get_if<std::vector<std::string>>(
-                            &endpointsIt->second);
-                    if (endpoints == nullptr)
-                    {
-                        BMCWEB_LOG_ERROR << "Illegal association at "
-                                         << path.str;
-                        continue;
-                    }
-                    bool containsChild = false;
-                    for (const std::string& endpoint : *endpoints)
-                    {
-                        if (std::find(inventory.begin(), inventory.end(),
-                                      endpoint) != inventory.end())
-                        {
-                            containsChild = true;
-                            break;
-                        }
-                    }
-                    if (!containsChild)
-                    {
-                        continue;
-                    }
-                }
-            }
-
-            if (boost::starts_with(path.str, globalInventoryPath) &&
-                boost::ends_with(path.str, "critical"))
-            {
-                rollup = "Critical";
-                return;
-            }
-            if (boost::starts_with(path.str, globalInventoryPath) &&
-                boost::ends_with(path.str, "warning"))
-            {
-                health = "Warning";
-                if (rollup != "Critical")
-                {
-                    rollup = "Warning";
-                }
-            }
-            else if (boost::ends_with(path.str, "critical"))
-            {
-                rollup = "Critical";
-                if (isSelf)
-                {
-                    health = "Critical";
-                    return;
-                }
-            }
-            else if (boost::ends_with(path.str, "warning"))
-            {
-                if (rollup != "Critical")
-                {
-                    rollup = "Warning";
-                }
-
-                if (isSelf)
-                {
-                    health = "Warning";
-                }
-            }
-        }
+        health_index::Health result = health_index::getHealth(
+            *statuses, globalInventoryPath, selfPath, inventory,
+            isManagersHealth);
+        jsonStatus["Health"] = result.health;
+        jsonStatus["HealthRollup"] = result.rollup;
     }
 
     // this should only be called once per url, others should get updated by
@@ -178,7 +72,10 @@ struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
     void getGlobalPath()
     {
         std::shared_ptr<HealthPopulate> self = shared_from_this();
-        crow::connections::systemBus->async_method_call(
+        crow::object_mapper::getSubTreePaths(
+            "/", 0,
+            std::array<const char*, 1>{
+                "xyz.openbmc_project.Inventory.Item.Global"},
             [self](const boost::system::error_code ec,
                    std::vector<std::string>& resp) {
                 if (ec || resp.size() != 1)
@@ -187,35 +84,30 @@ struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
                     return;
                 }
                 self->globalInventoryPath = std::move(resp[0]);
-            },
-            "xyz.openbmc_project.ObjectMapper",
-            "/xyz/openbmc_project/object_mapper",
-            "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths", "/", 0,
-            std::array<const char*, 1>{
-                "xyz.openbmc_project.Inventory.Item.Global"});
+            });
     }
 
     void getAllStatusAssociations()
     {
+        health_index::HealthIndex& index =
+            health_index::HealthIndex::getInstance();
+        if (index.isReady())
+        {
+            bmcweb::stats::increment("health_index.hits");
+            statuses = index.getStatuses();
+            return;
+        }
+        bmcweb::stats::increment("health_index.dbus_calls");
         std::shared_ptr<HealthPopulate> self = shared_from_this();
-        crow::connections::systemBus->async_method_call(
+        crow::single_flight::asyncMethodCall<dbus::utility::ManagedObjectType>(
             [self](const boost::system::error_code ec,
-                   dbus::utility::ManagedObjectType& resp) {
+                   const dbus::utility::ManagedObjectType& resp) {
                 if (ec)
                 {
                     return;
                 }
-                for (auto it = resp.begin(); it != resp.end();)
-                {
-                    if (boost::ends_with(it->first.str, "critical") ||
-                        boost::ends_with(it->first.str, "warning"))
-                    {
-                        it++;
-                        continue;
-                    }
-                    it = resp.erase(it);
-                }
-                self->statuses = std::move(resp);
+                self->statuses = std::make_shared<health_index::Statuses>(
+                    health_index::toStatuses(resp));
             },
             "xyz.openbmc_project.ObjectMapper", "/",
             "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
@@ -235,7 +127,8 @@ struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
 
     std::vector<std::string> inventory;
     bool isManagersHealth = false;
-    dbus::utility::ManagedObjectType statuses;
+    std::shared_ptr<const health_index::Statuses> statuses =
+        std::make_shared<health_index::Statuses>();
     std::string globalInventoryPath = "-"; // default to illegal dbus path
     bool populated = false;
 };
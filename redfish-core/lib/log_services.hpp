@@ -34,6 +34,7 @@
 #include <error_messages.hpp>
 #include <registries/privilege_registry.hpp>
 #include <utils/error_log_utils.hpp>
+#include <utils/query_param.hpp>
 
 #include <charconv>
 #include <filesystem>
@@ -229,54 +230,6 @@ inline static bool getEntryTimestamp(sd_journal* journal,
     return true;
 }
 
-static bool getSkipParam(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
-                         const crow::Request& req, uint64_t& skip)
-{
-    boost::urls::query_params_view::iterator it = req.urlParams.find("$skip");
-    if (it != req.urlParams.end())
-    {
-        std::string skipParam = it->value();
-        char* ptr = nullptr;
-        skip = std::strtoul(skipParam.c_str(), &ptr, 10);
-        if (skipParam.empty() || *ptr != '\0')
-        {
-
-            messages::queryParameterValueTypeError(
-                asyncResp->res, std::string(skipParam), "$skip");
-            return false;
-        }
-    }
-    return true;
-}
-
-static constexpr const uint64_t maxEntriesPerPage = 1000;
-static bool getTopParam(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
-                        const crow::Request& req, uint64_t& top)
-{
-    boost::urls::query_params_view::iterator it = req.urlParams.find("$top");
-    if (it != req.urlParams.end())
-    {
-        std::string topParam = it->value();
-        char* ptr = nullptr;
-        top = std::strtoul(topParam.c_str(), &ptr, 10);
-        if (topParam.empty() || *ptr != '\0')
-        {
-            messages::queryParameterValueTypeError(
-                asyncResp->res, std::string(topParam), "$top");
-            return false;
-        }
-        if (top < 1U || top > maxEntriesPerPage)
-        {
-
-            messages::queryParameterOutOfRange(
-                asyncResp->res, std::to_string(top), "$top",
-                "1-" + std::to_string(maxEntriesPerPage));
-            return false;
-        }
-    }
-    return true;
-}
-
 inline static bool getUniqueEntryID(sd_journal* journal, std::string& entryID,
                                     const bool firstEntry = true)
 {
@@ -1512,6 +1465,47 @@ inline void requestRoutesJournalEventLogClear(App& app)
             });
 }
 
+// The log timestamp is in RFC3339 format which matches the Redfish format
+// except for the fractional seconds between the '.' and the '+', so just
+// remove them.
+static void removeFractionalSeconds(std::string& timestamp)
+{
+    std::size_t dot = timestamp.find_first_of('.');
+    std::size_t plus = timestamp.find_first_of('+');
+    if (dot != std::string::npos && plus != std::string::npos)
+    {
+        timestamp.erase(dot, plus - dot);
+    }
+}
+
+// The properties of an event log entry that $filter can test without the
+// message being built: MessageId, Severity and Created
+static nlohmann::json getEventLogEntrySummary(std::string_view logEntry)
+{
+    nlohmann::json summary = nlohmann::json::object();
+    size_t space = logEntry.find_first_of(' ');
+    if (space == std::string_view::npos)
+    {
+        return summary;
+    }
+    std::string timestamp(logEntry.substr(0, space));
+    removeFractionalSeconds(timestamp);
+    summary["Created"] = std::move(timestamp);
+
+    size_t entryStart = logEntry.find_first_not_of(' ', space);
+    if (entryStart == std::string_view::npos)
+    {
+        return summary;
+    }
+    std::string_view entry = logEntry.substr(entryStart);
+    std::string messageID(entry.substr(0, entry.find(',')));
+    const message_registries::Message* message =
+        message_registries::getMessage(messageID);
+    summary["Severity"] = message != nullptr ? message->severity : "";
+    summary["MessageId"] = std::move(messageID);
+    return summary;
+}
+
 static int fillEventLogEntryJson(const std::string& logEntryID,
                                  const std::string& logEntry,
                                  nlohmann::json& logEntryJson)
@@ -1582,15 +1576,8 @@ static int fillEventLogEntryJson(const std::string& logEntryID,
         }
     }
 
-    // Get the Created time from the timestamp. The log timestamp is in RFC3339
-    // format which matches the Redfish format except for the fractional seconds
-    // between the '.' and the '+', so just remove them.
-    std::size_t dot = timestamp.find_first_of('.');
-    std::size_t plus = timestamp.find_first_of('+');
-    if (dot != std::string::npos && plus != std::string::npos)
-    {
-        timestamp.erase(dot, plus - dot);
-    }
+    // Get the Created time from the timestamp
+    removeFractionalSeconds(timestamp);
 
     // Fill in the log entry with the gathered data
     logEntryJson = {
@@ -1617,13 +1604,9 @@ inline void requestRoutesJournalEventLogEntryCollection(App& app)
         .methods(boost::beast::http::verb::get)(
             [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
-                uint64_t skip = 0;
-                uint64_t top = maxEntriesPerPage; // Show max entries by default
-                if (!getSkipParam(asyncResp, req, skip))
-                {
-                    return;
-                }
-                if (!getTopParam(asyncResp, req, top))
+                std::optional<query_param::Paging> paging =
+                    query_param::getPaging(asyncResp, req);
+                if (!paging)
                 {
                     return;
                 }
@@ -1662,30 +1645,26 @@ inline void requestRoutesJournalEventLogEntryCollection(App& app)
                     bool firstEntry = true;
                     while (std::getline(logStream, logEntry))
                     {
-                        entryCount++;
-                        // Handle paging using skip (number of entries to skip
-                        // from the start) and top (number of entries to
-                        // display)
-                        if (entryCount <= skip || entryCount > skip + top)
-                        {
-                            continue;
-                        }
-
-                        std::string idStr;
-                        if (!getUniqueEntryID(logEntry, idStr, firstEntry))
-                        {
-                            continue;
-                        }
-
-                        if (firstEntry)
-                        {
-                            firstEntry = false;
-                        }
-
-                        logEntryArray.push_back({});
-                        nlohmann::json& bmcLogEntry = logEntryArray.back();
-                        if (fillEventLogEntryJson(idStr, logEntry,
-                                                  bmcLogEntry) != 0)
+                        bool built = query_param::addEntry(
+                            *paging, logEntryArray, entryCount,
+                            [&logEntry, &firstEntry](std::string& idStr) {
+                                if (!getUniqueEntryID(logEntry, idStr,
+                                                      firstEntry))
+                                {
+                                    return false;
+                                }
+                                firstEntry = false;
+                                return true;
+                            },
+                            [&logEntry]() {
+                                return getEventLogEntrySummary(logEntry);
+                            },
+                            [&logEntry](const std::string& idStr,
+                                        nlohmann::json& bmcLogEntry) {
+                                return fillEventLogEntryJson(
+                                           idStr, logEntry, bmcLogEntry) == 0;
+                            });
+                        if (!built)
                         {
                             messages::internalError(asyncResp->res);
                             return;
@@ -1693,13 +1672,10 @@ inline void requestRoutesJournalEventLogEntryCollection(App& app)
                     }
                 }
                 asyncResp->res.jsonValue["Members@odata.count"] = entryCount;
-                if (skip + top < entryCount)
-                {
-                    asyncResp->res.jsonValue["Members@odata.nextLink"] =
-                        "/redfish/v1/Systems/system/LogServices/EventLog/"
-                        "Entries?$skip=" +
-                        std::to_string(skip + top);
-                }
+                query_param::setNextLink(
+                    asyncResp->res,
+                    "/redfish/v1/Systems/system/LogServices/EventLog/Entries",
+                    *paging, entryCount);
             });
 }
 
@@ -2960,6 +2936,38 @@ inline void requestRoutesBMCJournalLogService(App& app)
             });
 }
 
+// Maps a syslog PRIORITY onto a Redfish Severity
+static const char* getJournalSeverity(long int priority)
+{
+    if (priority <= 2)
+    {
+        return "Critical";
+    }
+    if (priority <= 4)
+    {
+        return "Warning";
+    }
+    return "OK";
+}
+
+// The properties of the current journal entry that $filter can test without
+// the message being read: Severity and Created
+static nlohmann::json getBMCJournalLogEntrySummary(sd_journal* journal)
+{
+    nlohmann::json summary = nlohmann::json::object();
+    long int priority = 8; // Default to an invalid priority
+    if (getJournalMetadata(journal, "PRIORITY", 10, priority) >= 0)
+    {
+        summary["Severity"] = getJournalSeverity(priority);
+    }
+    std::string entryTimeStr;
+    if (getEntryTimestamp(journal, entryTimeStr))
+    {
+        summary["Created"] = std::move(entryTimeStr);
+    }
+    return summary;
+}
+
 static int fillBMCJournalLogEntryJson(const std::string& bmcJournalLogEntryID,
                                       sd_journal* journal,
                                       nlohmann::json& bmcJournalLogEntryJson)
@@ -3013,9 +3021,7 @@ static int fillBMCJournalLogEntryJson(const std::string& bmcJournalLogEntryID,
         {"Id", bmcJournalLogEntryID},
         {"Message", std::move(message)},
         {"EntryType", "Oem"},
-        {"Severity", severity <= 2   ? "Critical"
-                     : severity <= 4 ? "Warning"
-                                     : "OK"},
+        {"Severity", getJournalSeverity(severity)},
         {"OemRecordFormat", "BMC Journal Entry"},
         {"Created", std::move(entryTimeStr)}};
     return 0;
@@ -3028,14 +3034,9 @@ inline void requestRoutesBMCJournalLogEntryCollection(App& app)
         .methods(boost::beast::http::verb::get)(
             [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
-                static constexpr const long maxEntriesPerPage = 1000;
-                uint64_t skip = 0;
-                uint64_t top = maxEntriesPerPage; // Show max entries by default
-                if (!getSkipParam(asyncResp, req, skip))
-                {
-                    return;
-                }
-                if (!getTopParam(asyncResp, req, top))
+                std::optional<query_param::Paging> paging =
+                    query_param::getPaging(asyncResp, req);
+                if (!paging)
                 {
                     return;
                 }
@@ -3071,42 +3072,36 @@ inline void requestRoutesBMCJournalLogEntryCollection(App& app)
                 bool firstEntry = true;
                 SD_JOURNAL_FOREACH(journal.get())
                 {
-                    entryCount++;
-                    // Handle paging using skip (number of entries to skip from
-                    // the start) and top (number of entries to display)
-                    if (entryCount <= skip || entryCount > skip + top)
-                    {
-                        continue;
-                    }
-
-                    std::string idStr;
-                    if (!getUniqueEntryID(journal.get(), idStr, firstEntry))
-                    {
-                        continue;
-                    }
-
-                    if (firstEntry)
-                    {
-                        firstEntry = false;
-                    }
-
-                    logEntryArray.push_back({});
-                    nlohmann::json& bmcJournalLogEntry = logEntryArray.back();
-                    if (fillBMCJournalLogEntryJson(idStr, journal.get(),
-                                                   bmcJournalLogEntry) != 0)
+                    sd_journal* entry = journal.get();
+                    bool built = query_param::addEntry(
+                        *paging, logEntryArray, entryCount,
+                        [entry, &firstEntry](std::string& idStr) {
+                            if (!getUniqueEntryID(entry, idStr, firstEntry))
+                            {
+                                return false;
+                            }
+                            firstEntry = false;
+                            return true;
+                        },
+                        [entry]() {
+                            return getBMCJournalLogEntrySummary(entry);
+                        },
+                        [entry](const std::string& idStr,
+                                nlohmann::json& bmcJournalLogEntry) {
+                            return fillBMCJournalLogEntryJson(
+                                       idStr, entry, bmcJournalLogEntry) == 0;
+                        });
+                    if (!built)
                     {
                         messages::internalError(asyncResp->res);
                         return;
                     }
                 }
                 asyncResp->res.jsonValue["Members@odata.count"] = entryCount;
-                if (skip + top < entryCount)
-                {
-                    asyncResp->res.jsonValue["Members@odata.nextLink"] =
-                        "/redfish/v1/Managers/bmc/LogServices/Journal/"
-                        "Entries?$skip=" +
-                        std::to_string(skip + top);
-                }
+                query_param::setNextLink(
+                    asyncResp->res,
+                    "/redfish/v1/Managers/bmc/LogServices/Journal/Entries",
+                    *paging, entryCount);
             });
 }
 
@@ -4314,12 +4309,13 @@ inline void requestRoutesPostCodesEntryCollection(App& app)
                 asyncResp->res.jsonValue["Members@odata.count"] = 0;
 
                 uint64_t skip = 0;
-                uint64_t top = maxEntriesPerPage; // Show max entries by default
-                if (!getSkipParam(asyncResp, req, skip))
+                // Show max entries by default
+                uint64_t top = query_param::maxEntriesPerPage;
+                if (!query_param::getSkipParam(asyncResp, req, skip))
                 {
                     return;
                 }
-                if (!getTopParam(asyncResp, req, top))
+                if (!query_param::getTopParam(asyncResp, req, top))
                 {
                     return;
                 }
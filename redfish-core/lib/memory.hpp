@@ -1159,7 +1159,7 @@ inline void requestRoutesMemoryCollection(App& app)
     BMCWEB_ROUTE(app, "/redfish/v1/Systems/system/Memory/")
         .privileges(redfish::privileges::getMemoryCollection)
         .methods(boost::beast::http::verb::get)(
-            [](const crow::Request&,
+            [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
                 asyncResp->res.jsonValue["@odata.type"] =
                     "#MemoryCollection.MemoryCollection";
@@ -1168,7 +1168,7 @@ inline void requestRoutesMemoryCollection(App& app)
                     "/redfish/v1/Systems/system/Memory";
 
                 collection_util::getCollectionMembers(
-                    asyncResp, "/redfish/v1/Systems/system/Memory",
+                    req, asyncResp, "/redfish/v1/Systems/system/Memory",
                     {"xyz.openbmc_project.Inventory.Item.Dimm"});
             });
 }
@@ -3,6 +3,7 @@
 #include "led.hpp"
 
 #include <app.hpp>
+#include <object_mapper_mirror.hpp>
 #include <utils/chassis_utils.hpp>
 #include <utils/json_utils.hpp>
 #include <utils/pcie_util.hpp>
@@ -97,7 +98,10 @@ inline void
 {
     // Collect device associated with this slot and
     // populate it here
-    crow::connections::systemBus->async_method_call(
+    crow::object_mapper::getSubTree(
+        slotPath, 0,
+        std::array<const char*, 1>{
+            "xyz.openbmc_project.Inventory.Item.PCIeDevice"},
         [asyncResp, index](
             const boost::system::error_code ec,
             const std::vector<std::pair<
@@ -133,12 +137,7 @@ inline void
             asyncResp->res.jsonValue["Slots"][index]["Links"]["PCIeDevice"] = {
                 {{"@odata.id",
                   "/redfish/v1/Systems/system/PCIeDevices/" + devName}}};
-        },
-        "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTree", slotPath, 0,
-        std::array<const char*, 1>{
-            "xyz.openbmc_project.Inventory.Item.PCIeDevice"});
+        });
 }
 
 inline void
@@ -300,7 +299,10 @@ inline void getPCIeSlots(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
     asyncResp->res.jsonValue["Id"] = "PCIeSlots";
     asyncResp->res.jsonValue["Slots"] = nlohmann::json::array();
 
-    crow::connections::systemBus->async_method_call(
+    crow::object_mapper::getSubTree(
+        "/xyz/openbmc_project/inventory", 0,
+        std::array<const char*, 1>{
+            "xyz.openbmc_project.Inventory.Item.PCIeSlot"},
         [asyncResp, chassisID](
             const boost::system::error_code ec,
             const std::vector<std::pair<
@@ -556,13 +558,7 @@ inline void getPCIeSlots(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
                     "org.freedesktop.DBus.Properties", "Get",
                     "xyz.openbmc_project.Association", "endpoints");
             }
-        },
-        "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTree",
-        "/xyz/openbmc_project/inventory", int32_t(0),
-        std::array<const char*, 1>{
-            "xyz.openbmc_project.Inventory.Item.PCIeSlot"});
+        });
 }
 
 // We need a global variable to keep track of the actual number of slots,
@@ -585,7 +581,10 @@ void checkPCIeSlotsCount(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
     // chassisID
     static size_t slotsNotInChassis = 0;
 
-    crow::connections::systemBus->async_method_call(
+    crow::object_mapper::getSubTree(
+        "/xyz/openbmc_project/inventory", 0,
+        std::array<const char*, 1>{
+            "xyz.openbmc_project.Inventory.Item.PCIeSlot"},
         [asyncResp, chassisID, total, callback{std::move(callback)}](
             const boost::system::error_code ec,
             const std::vector<std::pair<
@@ -706,13 +705,7 @@ void checkPCIeSlotsCount(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
                     "org.freedesktop.DBus.Properties", "Get",
                     "xyz.openbmc_project.Association", "endpoints");
             }
-        },
-        "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTree",
-        "/xyz/openbmc_project/inventory", int32_t(0),
-        std::array<const char*, 1>{
-            "xyz.openbmc_project.Inventory.Item.PCIeSlot"});
+        });
 }
 inline void setPCIeSlotsLocationIndicator(
     const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
@@ -723,7 +716,10 @@ inline void setPCIeSlotsLocationIndicator(
         << "Set locationIndicatorActive for PCIeSlots associated to chassis = "
         << chassisID;
 
-    crow::connections::systemBus->async_method_call(
+    crow::object_mapper::getSubTree(
+        "/xyz/openbmc_project/inventory", 0,
+        std::array<const char*, 1>{
+            "xyz.openbmc_project.Inventory.Item.PCIeSlot"},
         [asyncResp, chassisID, locationIndicatorActiveMap](
             const boost::system::error_code ec,
             const std::vector<std::pair<
@@ -815,13 +811,7 @@ inline void setPCIeSlotsLocationIndicator(
                     "org.freedesktop.DBus.Properties", "Get",
                     "xyz.openbmc_project.Association", "endpoints");
             }
-        },
-        "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTree",
-        "/xyz/openbmc_project/inventory", int32_t(0),
-        std::array<const char*, 1>{
-            "xyz.openbmc_project.Inventory.Item.PCIeSlot"});
+        });
 }
 
 inline void requestRoutesPCIeSlots(App& app)
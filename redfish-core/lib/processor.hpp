@@ -1597,12 +1597,19 @@ inline void requestRoutesOperatingConfigCollection(App& app)
                 asyncResp->res.jsonValue["Name"] =
                     "Operating Config Collection";
 
+                std::optional<query_param::Paging> paging =
+                    query_param::getPaging(asyncResp, req);
+                if (!paging)
+                {
+                    return;
+                }
+
                 // First find the matching CPU object so we know how to
                 // constrain our search for related Config objects.
                 crow::connections::systemBus->async_method_call(
-                    [asyncResp,
-                     cpuName](const boost::system::error_code ec,
-                              const std::vector<std::string>& objects) {
+                    [asyncResp, cpuName, paging{std::move(*paging)}](
+                        const boost::system::error_code ec,
+                        const std::vector<std::string>& objects) {
                         if (ec)
                         {
                             BMCWEB_LOG_WARNING << "D-Bus error: " << ec << ", "
@@ -1632,7 +1639,7 @@ inline void requestRoutesOperatingConfigCollection(App& app)
                                     cpuName + "/OperatingConfigs",
                                 {"xyz.openbmc_project.Inventory.Item.Cpu."
                                  "OperatingConfig"},
-                                object.c_str());
+                                paging, object.c_str());
                             return;
                         }
                     },
@@ -20,9 +20,13 @@
 #include <boost/algorithm/string/split.hpp>
 #include <boost/container/flat_map.hpp>
 #include <boost/range/algorithm/replace_copy_if.hpp>
+#include <dbus_single_flight.hpp>
 #include <dbus_singleton.hpp>
+#include <object_mapper_mirror.hpp>
 #include <registries/privilege_registry.hpp>
+#include <sensor_cache.hpp>
 #include <utils/json_utils.hpp>
+#include <utils/query_param.hpp>
 
 #include <cmath>
 #include <regex>
@@ -36,13 +40,9 @@ using GetSubTreeType = std::vector<
     std::pair<std::string,
               std::vector<std::pair<std::string, std::vector<std::string>>>>>;
 
-using SensorVariant =
-    std::variant<int64_t, double, uint32_t, bool, std::string>;
+using SensorVariant = crow::sensor_cache::SensorVariant;
 
-using ManagedObjectsVectorType = std::vector<std::pair<
-    sdbusplus::message::object_path,
-    boost::container::flat_map<
-        std::string, boost::container::flat_map<std::string, SensorVariant>>>>;
+using ManagedObjectsVectorType = crow::sensor_cache::ManagedObjects;
 
 namespace sensors
 {
@@ -267,6 +267,10 @@ class SensorsAsyncResp
     const std::vector<const char*> types;
     const std::string chassisSubNode;
 
+    // False when $select leaves out everything that comes from the inventory
+    // items behind the sensors, so they need not be looked up
+    bool inventorySelected = true;
+
   private:
     std::optional<std::vector<SensorData>> metadata;
     DataCompleteCb dataComplete;
@@ -386,10 +390,8 @@ void getObjectsWithConnection(
         BMCWEB_LOG_DEBUG << "getObjectsWithConnection resp_handler exit";
     };
     // Make call to ObjectMapper to find all sensors objects
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTree", path, 2, interfaces);
+    crow::object_mapper::getSubTree(
+        path, 2, interfaces, std::move(respHandler));
     BMCWEB_LOG_DEBUG << "getObjectsWithConnection exit";
 }
 
@@ -507,11 +509,8 @@ void getValidChassisPath(const std::shared_ptr<SensorsAsyncResp>& asyncResp,
         };
 
     // Get the Chassis Collection
-    crow::connections::systemBus->async_method_call(
-        respHandler, "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths",
-        "/xyz/openbmc_project/inventory", 0, interfaces);
+    crow::object_mapper::getSubTreePaths(
+        "/xyz/openbmc_project/inventory", 0, interfaces, respHandler);
     BMCWEB_LOG_DEBUG << "checkChassisId exit";
 }
 
@@ -643,11 +642,8 @@ void getChassis(const std::shared_ptr<SensorsAsyncResp>& sensorsAsyncResp,
     };
 
     // Get the Chassis Collection
-    crow::connections::systemBus->async_method_call(
-        respHandler, "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths",
-        "/xyz/openbmc_project/inventory", 0, interfaces);
+    crow::object_mapper::getSubTreePaths(
+        "/xyz/openbmc_project/inventory", 0, interfaces, respHandler);
     BMCWEB_LOG_DEBUG << "getChassis exit";
 }
 
@@ -716,10 +712,8 @@ void getObjectManagerPaths(
     };
 
     // Query mapper for all DBus object paths that implement ObjectManager
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTree", "/", 0, interfaces);
+    crow::object_mapper::getSubTree(
+        "/", 0, interfaces, std::move(respHandler));
     BMCWEB_LOG_DEBUG << "getObjectManagerPaths exit";
 }
 
@@ -1681,7 +1675,7 @@ static void getInventoryItemsData(
                             objectMgrPaths, callback{std::move(callback)},
                             invConnectionsIndex](
                                const boost::system::error_code ec,
-                               ManagedObjectsVectorType& resp) {
+                               const ManagedObjectsVectorType& resp) {
             BMCWEB_LOG_DEBUG << "getInventoryItemsData respHandler enter";
             if (ec)
             {
@@ -1724,7 +1718,7 @@ static void getInventoryItemsData(
                          << objectMgrPath;
 
         // Get all object paths and their interfaces for current connection
-        crow::connections::systemBus->async_method_call(
+        crow::single_flight::asyncMethodCall<ManagedObjectsVectorType>(
             std::move(respHandler), invConnection, objectMgrPath,
             "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
     }
@@ -1810,10 +1804,8 @@ static void getInventoryItemsConnections(
     };
 
     // Make call to ObjectMapper to find all inventory items
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTree", path, 0, interfaces);
+    crow::object_mapper::getSubTree(
+        path, 0, interfaces, std::move(respHandler));
     BMCWEB_LOG_DEBUG << "getInventoryItemsConnections exit";
 }
 
@@ -1850,8 +1842,9 @@ static void getInventoryItemAssociations(
 
     // Response handler for GetManagedObjects
     auto respHandler = [callback{std::move(callback)}, sensorsAsyncResp,
-                        sensorNames](const boost::system::error_code ec,
-                                     dbus::utility::ManagedObjectType& resp) {
+                        sensorNames](
+                           const boost::system::error_code ec,
+                           const dbus::utility::ManagedObjectType& resp) {
         BMCWEB_LOG_DEBUG << "getInventoryItemAssociations respHandler enter";
         if (ec)
         {
@@ -1967,7 +1960,7 @@ static void getInventoryItemAssociations(
                      << objectMgrPath;
 
     // Call GetManagedObjects on the ObjectMapper to get all associations
-    crow::connections::systemBus->async_method_call(
+    crow::single_flight::asyncMethodCall<dbus::utility::ManagedObjectType>(
         std::move(respHandler), connection, objectMgrPath,
         "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
 
@@ -2170,10 +2163,8 @@ void getInventoryLeds(
         BMCWEB_LOG_DEBUG << "getInventoryLeds respHandler exit";
     };
     // Make call to ObjectMapper to find all inventory items
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTree", path, 0, interfaces);
+    crow::object_mapper::getSubTree(
+        path, 0, interfaces, std::move(respHandler));
     BMCWEB_LOG_DEBUG << "getInventoryLeds exit";
 }
 
@@ -2366,11 +2357,8 @@ void getPowerSupplyAttributes(
         BMCWEB_LOG_DEBUG << "getPowerSupplyAttributes respHandler exit";
     };
     // Make call to ObjectMapper to find the PowerSupplyAttributes service
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTree",
-        "/xyz/openbmc_project", 0, interfaces);
+    crow::object_mapper::getSubTree(
+        "/xyz/openbmc_project", 0, interfaces, std::move(respHandler));
     BMCWEB_LOG_DEBUG << "getPowerSupplyAttributes exit";
 }
 
@@ -2526,7 +2514,8 @@ inline nlohmann::json& getPowerSupply(nlohmann::json& powerSupplyArray,
  *
  * To minimize the number of DBus calls, the DBus method
  * org.freedesktop.DBus.ObjectManager.GetManagedObjects() is used to get the
- * values of all sensors provided by a connection (service).
+ * values of all sensors provided by a connection (service).  The sensor
+ * property cache answers it instead once it holds the connection.
  *
  * The connections set contains all the connections that provide sensor values.
  *
@@ -2559,7 +2548,7 @@ inline void getSensorData(
         auto getManagedObjectsCb = [sensorsAsyncResp, sensorNames,
                                     inventoryItems](
                                        const boost::system::error_code ec,
-                                       ManagedObjectsVectorType& resp) {
+                                       const ManagedObjectsVectorType& resp) {
             BMCWEB_LOG_DEBUG << "getManagedObjectsCb enter";
             if (ec)
             {
@@ -2720,9 +2709,8 @@ inline void getSensorData(
         BMCWEB_LOG_DEBUG << "ObjectManager path for " << connection << " is "
                          << objectMgrPath;
 
-        crow::connections::systemBus->async_method_call(
-            getManagedObjectsCb, connection, objectMgrPath,
-            "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+        crow::sensor_cache::getManagedObjects(connection, objectMgrPath,
+                                              getManagedObjectsCb);
     }
     BMCWEB_LOG_DEBUG << "getSensorData exit";
 }
@@ -2740,6 +2728,14 @@ inline void processSensorList(
                  connections](const std::shared_ptr<boost::container::flat_map<
                                   std::string, std::string>>& objectMgrPaths) {
                     BMCWEB_LOG_DEBUG << "getObjectManagerPathsCb enter";
+                    if (!sensorsAsyncResp->inventorySelected)
+                    {
+                        getSensorData(
+                            sensorsAsyncResp, sensorNames, connections,
+                            objectMgrPaths,
+                            std::make_shared<std::vector<InventoryItem>>());
+                        return;
+                    }
                     auto getInventoryItemsCb =
                         [sensorsAsyncResp, sensorNames, connections,
                          objectMgrPaths](
@@ -3210,11 +3206,8 @@ void getThermalMetrics(
     };
 
     // Get the Chassis Collection
-    crow::connections::systemBus->async_method_call(
-        respHandler, "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths",
-        "/xyz/openbmc_project/inventory", 0, interfaces);
+    crow::object_mapper::getSubTreePaths(
+        "/xyz/openbmc_project/inventory", 0, interfaces, respHandler);
 }
 
 /**
@@ -3229,7 +3222,8 @@ void getThermalMetrics(
  *
  * To minimize the number of DBus calls, the DBus method
  * org.freedesktop.DBus.ObjectManager.GetManagedObjects() is used to get the
- * values of all sensors provided by a connection (service).
+ * values of all sensors provided by a connection (service).  The sensor
+ * property cache answers it instead once it holds the connection.
  *
  * The connections set contains all the connections that provide sensor values.
  *
@@ -3261,7 +3255,7 @@ inline void getThermalSensorData(
         auto getManagedObjectsCb = [sensorsAsyncResp, sensorNames,
                                     inventoryItems](
                                        const boost::system::error_code ec,
-                                       ManagedObjectsVectorType& resp) {
+                                       const ManagedObjectsVectorType& resp) {
             if (ec)
             {
                 BMCWEB_LOG_ERROR << "getManagedObjectsCb DBUS error: " << ec;
@@ -3337,9 +3331,8 @@ inline void getThermalSensorData(
         BMCWEB_LOG_DEBUG << "ObjectManager path for " << connection << " is "
                          << objectMgrPath;
 
-        crow::connections::systemBus->async_method_call(
-            getManagedObjectsCb, connection, objectMgrPath,
-            "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+        crow::sensor_cache::getManagedObjects(connection, objectMgrPath,
+                                              getManagedObjectsCb);
     }
 }
 
@@ -3405,12 +3398,19 @@ inline void requestRoutesSensorCollection(App& app)
     BMCWEB_ROUTE(app, "/redfish/v1/Chassis/<str>/Sensors/")
         .privileges(redfish::privileges::getSensorCollection)
         .methods(
-            boost::beast::http::verb::get)([](const crow::Request&,
+            boost::beast::http::verb::get)([](const crow::Request& req,
                                               const std::shared_ptr<
                                                   bmcweb::AsyncResp>& aResp,
                                               const std::string& chassisId) {
             BMCWEB_LOG_DEBUG << "SensorCollection doGet enter";
 
+            std::optional<query_param::Paging> paging =
+                query_param::getPaging(aResp, req);
+            if (!paging)
+            {
+                return;
+            }
+
             std::shared_ptr<SensorsAsyncResp> asyncResp =
                 std::make_shared<SensorsAsyncResp>(
                     aResp, chassisId,
@@ -3418,17 +3418,18 @@ inline void requestRoutesSensorCollection(App& app)
                     sensors::node::sensors);
 
             auto getChassisCb =
-                [asyncResp](
+                [asyncResp, paging{std::move(*paging)}](
                     const std::shared_ptr<
                         boost::container::flat_set<std::string>>& sensorNames) {
                     BMCWEB_LOG_DEBUG << "getChassisCb enter";
 
-                    nlohmann::json& entriesArray =
-                        asyncResp->asyncResp->res.jsonValue["Members"];
-                    for (auto& sensor : *sensorNames)
+                    std::string collectionPath = "/redfish/v1/Chassis/" +
+                                                 asyncResp->chassisId + "/" +
+                                                 asyncResp->chassisSubNode;
+                    std::vector<std::string> uris;
+                    uris.reserve(sensorNames->size());
+                    for (const std::string& sensor : *sensorNames)
                     {
-                        BMCWEB_LOG_DEBUG << "Adding sensor: " << sensor;
-
                         sdbusplus::message::object_path path(sensor);
                         std::string sensorName = path.filename();
                         if (sensorName.empty())
@@ -3438,15 +3439,11 @@ inline void requestRoutesSensorCollection(App& app)
                             messages::internalError(asyncResp->asyncResp->res);
                             return;
                         }
-                        entriesArray.push_back(
-                            {{"@odata.id", "/redfish/v1/Chassis/" +
-                                               asyncResp->chassisId + "/" +
-                                               asyncResp->chassisSubNode + "/" +
-                                               sensorName}});
+                        uris.emplace_back(collectionPath + "/" + sensorName);
                     }
-
-                    asyncResp->asyncResp->res.jsonValue["Members@odata.count"] =
-                        entriesArray.size();
+                    query_param::setReferenceMembers(asyncResp->asyncResp->res,
+                                                     collectionPath, uris,
+                                                     paging);
                     BMCWEB_LOG_DEBUG << "getChassisCb exit";
                 };
 
@@ -3461,7 +3458,7 @@ inline void requestRoutesSensor(App& app)
     BMCWEB_ROUTE(app, "/redfish/v1/Chassis/<str>/Sensors/<str>/")
         .privileges(redfish::privileges::getSensor)
         .methods(
-            boost::beast::http::verb::get)([](const crow::Request&,
+            boost::beast::http::verb::get)([](const crow::Request& req,
                                               const std::shared_ptr<
                                                   bmcweb::AsyncResp>& aResp,
                                               const std::string& chassisId,
@@ -3471,13 +3468,17 @@ inline void requestRoutesSensor(App& app)
                 std::make_shared<SensorsAsyncResp>(aResp, chassisId,
                                                    std::vector<const char*>(),
                                                    sensors::node::sensors);
+            // Inventory items only feed the Status of a sensor
+            asyncResp->inventorySelected =
+                query_param::isSelected(req, "Status");
 
             const std::array<const char*, 1> interfaces = {
                 "xyz.openbmc_project.Sensor.Value"};
 
             // Get a list of all of the sensors that implement Sensor.Value
             // and get the path and service name associated with the sensor
-            crow::connections::systemBus->async_method_call(
+            crow::object_mapper::getSubTree(
+                "/xyz/openbmc_project/sensors", 2, interfaces,
                 [asyncResp, sensorName](const boost::system::error_code ec,
                                         const GetSubTreeType& subtree) {
                     BMCWEB_LOG_DEBUG << "respHandler1 enter";
@@ -3530,11 +3531,7 @@ inline void requestRoutesSensor(App& app)
                     sensorList->emplace(sensorPath);
                     processSensorList(asyncResp, sensorList);
                     BMCWEB_LOG_DEBUG << "respHandler1 exit";
-                },
-                "xyz.openbmc_project.ObjectMapper",
-                "/xyz/openbmc_project/object_mapper",
-                "xyz.openbmc_project.ObjectMapper", "GetSubTree",
-                "/xyz/openbmc_project/sensors", 2, interfaces);
+                });
         });
 }
 
@@ -18,6 +18,7 @@
 #include <app.hpp>
 #include <persistent_data.hpp>
 #include <registries/privilege_registry.hpp>
+#include <utils/query_param.hpp>
 #include <utils/systemd_utils.hpp>
 
 namespace redfish
@@ -243,6 +244,19 @@ inline void
 #endif
     asyncResp->res.jsonValue["Cables"] = {{"@odata.id", "/redfish/v1/Cables"}};
 
+    nlohmann::json& protocolFeatures =
+        asyncResp->res.jsonValue["ProtocolFeaturesSupported"];
+    protocolFeatures["ExcerptQuery"] = false;
+    protocolFeatures["ExpandQuery"]["ExpandAll"] = true;
+    protocolFeatures["ExpandQuery"]["Levels"] = true;
+    protocolFeatures["ExpandQuery"]["Links"] = true;
+    protocolFeatures["ExpandQuery"]["NoLinks"] = true;
+    protocolFeatures["ExpandQuery"]["MaxLevels"] =
+        query_param::maxExpandLevels;
+    protocolFeatures["FilterQuery"] = true;
+    protocolFeatures["OnlyMemberQuery"] = false;
+    protocolFeatures["SelectQuery"] = true;
+
     handleServiceRootOem(asyncResp);
 }
 
@@ -29,6 +29,8 @@
 #include <registries/privilege_registry.hpp>
 #include <utils/fw_utils.hpp>
 #include <utils/json_utils.hpp>
+#include <utils/property_plan.hpp>
+#include <utils/query_param.hpp>
 
 #include <variant>
 
@@ -45,7 +47,7 @@ namespace redfish
  */
 inline void
     updateDimmProperties(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
-                         const std::variant<bool>& dimmState)
+                         const dbus::utility::DbusVariantType& dimmState)
 {
     const bool* isDimmFunctional = std::get_if<bool>(&dimmState);
     if (isDimmFunctional == nullptr)
@@ -78,9 +80,9 @@ inline void
  *
  * @return None.
  */
-inline void
-    modifyCpuPresenceState(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
-                           const std::variant<bool>& cpuPresenceState)
+inline void modifyCpuPresenceState(
+    const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+    const dbus::utility::DbusVariantType& cpuPresenceState)
 {
     const bool* isCpuPresent = std::get_if<bool>(&cpuPresenceState);
 
@@ -116,7 +118,8 @@ inline void
  */
 inline void
     modifyCpuFunctionalState(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
-                             const std::variant<bool>& cpuFunctionalState)
+                             const dbus::utility::DbusVariantType&
+                                 cpuFunctionalState)
 {
     const bool* isCpuFunctional = std::get_if<bool>(&cpuFunctionalState);
 
@@ -147,56 +150,17 @@ inline void
  * @brief Get "ProcessorSummary" Properties
  *
  * @param[in] aResp Shared pointer for completing asynchronous calls
- * @param[in] service dbus service for Cpu Information
- * @param[in] path dbus path for Cpu
  * @param[in] properties from dbus Inventory.Item.Cpu interface
  *
  * @return None.
  */
-inline void getProcessorProperties(
-    const std::shared_ptr<bmcweb::AsyncResp>& aResp, const std::string& service,
-    const std::string& path,
-    const std::vector<std::pair<
-        std::string, std::variant<std::string, uint64_t, uint32_t, uint16_t>>>&
-        properties)
+inline void
+    getProcessorProperties(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+                           const dbus::utility::DBusPropertiesMap& properties)
 {
 
     BMCWEB_LOG_DEBUG << "Got " << properties.size() << " Cpu properties.";
 
-    auto getCpuPresenceState =
-        [aResp](const boost::system::error_code ec3,
-                const std::variant<bool>& cpuPresenceCheck) {
-            if (ec3)
-            {
-                BMCWEB_LOG_ERROR << "DBUS response error " << ec3;
-                return;
-            }
-            modifyCpuPresenceState(aResp, cpuPresenceCheck);
-        };
-
-    auto getCpuFunctionalState =
-        [aResp](const boost::system::error_code ec3,
-                const std::variant<bool>& cpuFunctionalCheck) {
-            if (ec3)
-            {
-                BMCWEB_LOG_ERROR << "DBUS response error " << ec3;
-                return;
-            }
-            modifyCpuFunctionalState(aResp, cpuFunctionalCheck);
-        };
-
-    // Get the Presence of CPU
-    crow::connections::systemBus->async_method_call(
-        std::move(getCpuPresenceState), service, path,
-        "org.freedesktop.DBus.Properties", "Get",
-        "xyz.openbmc_project.Inventory.Item", "Present");
-
-    // Get the Functional State
-    crow::connections::systemBus->async_method_call(
-        std::move(getCpuFunctionalState), service, path,
-        "org.freedesktop.DBus.Properties", "Get",
-        "xyz.openbmc_project.State.Decorator.OperationalStatus", "Functional");
-
     for (const auto& property : properties)
     {
 
@@ -267,32 +231,239 @@ inline void getProcessorProperties(
  * @brief Get ProcessorSummary fields
  *
  * @param[in] aResp Shared pointer for completing asynchronous calls
+ * @param[in] plan The properties read for the system
  * @param[in] service dbus service for Cpu Information
  * @param[in] path dbus path for Cpu
  *
  * @return None.
  */
-inline void getProcessorSummary(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
-                                const std::string& service,
-                                const std::string& path)
+inline void
+    getProcessorSummary(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+                        property_plan::PropertyPlan& plan,
+                        const std::string& service, const std::string& path)
 {
+    plan.addInterface(
+        service, path, "xyz.openbmc_project.Inventory.Item.Cpu",
+        [aResp](const boost::system::error_code& ec2,
+                const dbus::utility::DBusPropertiesMap& properties) {
+            if (ec2)
+            {
+                BMCWEB_LOG_ERROR << "DBUS response error " << ec2;
+                messages::internalError(aResp->res);
+                return;
+            }
+            getProcessorProperties(aResp, properties);
+        });
 
-    crow::connections::systemBus->async_method_call(
-        [aResp, service,
-         path](const boost::system::error_code ec2,
-               const std::vector<std::pair<
-                   std::string, std::variant<std::string, uint64_t, uint32_t,
-                                             uint16_t>>>& properties) {
+    // Get the Presence of CPU
+    plan.addProperty(service, path, "xyz.openbmc_project.Inventory.Item",
+                     "Present",
+                     [aResp](const dbus::utility::DbusVariantType& present) {
+                         modifyCpuPresenceState(aResp, present);
+                     });
+
+    // Get the Functional State
+    plan.addProperty(
+        service, path, "xyz.openbmc_project.State.Decorator.OperationalStatus",
+        "Functional",
+        [aResp](const dbus::utility::DbusVariantType& functional) {
+            modifyCpuFunctionalState(aResp, functional);
+        });
+}
+
+/*
+ * @brief Get "MemorySummary" fields from a DIMM
+ *
+ * @param[in] aResp Shared pointer for completing asynchronous calls
+ * @param[in] plan The properties read for the system
+ * @param[in] service dbus service for Dimm Information
+ * @param[in] path dbus path for Dimm
+ *
+ * @return None.
+ */
+inline void getDimmSummary(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+                           property_plan::PropertyPlan& plan,
+                           const std::string& service, const std::string& path)
+{
+    // The Functional state only counts for a DIMM without Dimm properties,
+    // and the two are read in the same plan, in no set order
+    struct DimmState
+    {
+        std::optional<bool> noDimmProperties;
+        std::optional<dbus::utility::DbusVariantType> functional;
+    };
+    auto dimmState = std::make_shared<DimmState>();
+    auto updateFunctional = [aResp, dimmState]() {
+        if (dimmState->noDimmProperties.value_or(false) &&
+            dimmState->functional)
+        {
+            updateDimmProperties(aResp, *dimmState->functional);
+        }
+    };
+
+    plan.addInterface(
+        service, path, "xyz.openbmc_project.Inventory.Item.Dimm",
+        [aResp, dimmState,
+         updateFunctional](const boost::system::error_code& ec2,
+                           const dbus::utility::DBusPropertiesMap& properties) {
             if (ec2)
             {
                 BMCWEB_LOG_ERROR << "DBUS response error " << ec2;
                 messages::internalError(aResp->res);
                 return;
             }
-            getProcessorProperties(aResp, service, path, properties);
-        },
-        service, path, "org.freedesktop.DBus.Properties", "GetAll",
-        "xyz.openbmc_project.Inventory.Item.Cpu");
+            BMCWEB_LOG_DEBUG << "Got " << properties.size()
+                             << " Dimm properties.";
+
+            dimmState->noDimmProperties = properties.empty();
+            if (properties.size() > 0)
+            {
+                auto property = properties.find("MemorySizeInKB");
+                if (property == properties.end())
+                {
+                    return;
+                }
+                const uint32_t* value =
+                    std::get_if<uint32_t>(&property->second);
+                if (value == nullptr)
+                {
+                    BMCWEB_LOG_DEBUG << "Find incorrect type of MemorySize";
+                    return;
+                }
+                nlohmann::json& totalMemory =
+                    aResp->res
+                        .jsonValue["MemorySummary"]["TotalSystemMemoryGiB"];
+                uint64_t* preValue = totalMemory.get_ptr<uint64_t*>();
+                if (preValue == nullptr)
+                {
+                    return;
+                }
+                aResp->res.jsonValue["MemorySummary"]["TotalSystemMemoryGiB"] =
+                    *value / (1024 * 1024) + *preValue;
+                aResp->res.jsonValue["MemorySummary"]["Status"]["State"] =
+                    "Enabled";
+            }
+            else
+            {
+                updateFunctional();
+            }
+        });
+
+    plan.addProperty(
+        service, path, "xyz.openbmc_project.State.Decorator.OperationalStatus",
+        "Functional",
+        [dimmState,
+         updateFunctional](const dbus::utility::DbusVariantType& functional) {
+            dimmState->functional = functional;
+            updateFunctional();
+        });
+}
+
+/*
+ * @brief Get the system UUID
+ *
+ * @param[in] aResp Shared pointer for completing asynchronous calls
+ * @param[in] plan The properties read for the system
+ * @param[in] service dbus service for the UUID
+ * @param[in] path dbus path for the UUID
+ *
+ * @return None.
+ */
+inline void getSystemUuid(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+                          property_plan::PropertyPlan& plan,
+                          const std::string& service, const std::string& path)
+{
+    plan.addInterface(
+        service, path, "xyz.openbmc_project.Common.UUID",
+        [aResp](const boost::system::error_code& ec3,
+                const dbus::utility::DBusPropertiesMap& properties) {
+            if (ec3)
+            {
+                BMCWEB_LOG_DEBUG << "DBUS response error " << ec3;
+                messages::internalError(aResp->res);
+                return;
+            }
+            BMCWEB_LOG_DEBUG << "Got " << properties.size()
+                             << " UUID properties.";
+            auto property = properties.find("UUID");
+            if (property == properties.end())
+            {
+                return;
+            }
+            const std::string* value =
+                std::get_if<std::string>(&property->second);
+            if (value != nullptr)
+            {
+                std::string valueStr = *value;
+                if (valueStr.size() == 32)
+                {
+                    valueStr.insert(8, 1, '-');
+                    valueStr.insert(13, 1, '-');
+                    valueStr.insert(18, 1, '-');
+                    valueStr.insert(23, 1, '-');
+                }
+                BMCWEB_LOG_DEBUG << "UUID = " << valueStr;
+                aResp->res.jsonValue["UUID"] = valueStr;
+            }
+        });
+}
+
+/*
+ * @brief Get the asset information of the system and its BIOS version
+ *
+ * @param[in] aResp Shared pointer for completing asynchronous calls
+ * @param[in] plan The properties read for the system
+ * @param[in] service dbus service for the system
+ * @param[in] path dbus path for the system
+ *
+ * @return None.
+ */
+inline void getSystemAsset(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+                           property_plan::PropertyPlan& plan,
+                           const std::string& service, const std::string& path)
+{
+    plan.addInterface(
+        service, path, "xyz.openbmc_project.Inventory.Decorator.Asset",
+        [aResp](const boost::system::error_code& ec2,
+                const dbus::utility::DBusPropertiesMap& propertiesList) {
+            if (ec2)
+            {
+                // doesn't have to include this
+                // interface
+                return;
+            }
+            BMCWEB_LOG_DEBUG << "Got " << propertiesList.size()
+                             << " properties for system";
+            for (const auto& [propertyName, property] : propertiesList)
+            {
+                if ((propertyName == "PartNumber") ||
+                    (propertyName == "SerialNumber") ||
+                    (propertyName == "Manufacturer") ||
+                    (propertyName == "Model") || (propertyName == "SubModel"))
+                {
+                    const std::string* value =
+                        std::get_if<std::string>(&property);
+                    if (value != nullptr)
+                    {
+                        aResp->res.jsonValue[propertyName] = *value;
+                    }
+                }
+            }
+
+            // Grab the bios version
+            fw_util::populateFirmwareInformation(aResp, fw_util::biosPurpose,
+                                                 "BiosVersion", false);
+        });
+
+    plan.addProperty(
+        service, path, "xyz.openbmc_project.Inventory.Decorator.AssetTag",
+        "AssetTag", [aResp](const dbus::utility::DbusVariantType& property) {
+            const std::string* value = std::get_if<std::string>(&property);
+            if (value != nullptr)
+            {
+                aResp->res.jsonValue["AssetTag"] = *value;
+            }
+        });
 }
 
 /*
@@ -319,6 +490,8 @@ inline void getComputerSystem(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
                 messages::internalError(aResp->res);
                 return;
             }
+            // The properties of every component, read together
+            auto plan = std::make_shared<property_plan::PropertyPlan>();
             // Iterate over all retrieved ObjectPaths.
             for (const std::pair<std::string,
                                  std::vector<std::pair<
@@ -346,104 +519,8 @@ inline void getComputerSystem(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
                         {
                             BMCWEB_LOG_DEBUG
                                 << "Found Dimm, now get its properties.";
-
-                            crow::connections::systemBus->async_method_call(
-                                [aResp, service{connection.first},
-                                 path](const boost::system::error_code ec2,
-                                       const std::vector<
-                                           std::pair<std::string, VariantType>>&
-                                           properties) {
-                                    if (ec2)
-                                    {
-                                        BMCWEB_LOG_ERROR
-                                            << "DBUS response error " << ec2;
-                                        messages::internalError(aResp->res);
-                                        return;
-                                    }
-                                    BMCWEB_LOG_DEBUG << "Got "
-                                                     << properties.size()
-                                                     << " Dimm properties.";
-
-                                    if (properties.size() > 0)
-                                    {
-                                        for (const std::pair<std::string,
-                                                             VariantType>&
-                                                 property : properties)
-                                        {
-                                            if (property.first !=
-                                                "MemorySizeInKB")
-                                            {
-                                                continue;
-                                            }
-                                            const uint32_t* value =
-                                                std::get_if<uint32_t>(
-                                                    &property.second);
-                                            if (value == nullptr)
-                                            {
-                                                BMCWEB_LOG_DEBUG
-                                                    << "Find incorrect type of "
-                                                       "MemorySize";
-                                                continue;
-                                            }
-                                            nlohmann::json& totalMemory =
-                                                aResp->res
-                                                    .jsonValue["MemorySummar"
-                                                               "y"]
-                                                              ["TotalSystemMe"
-                                                               "moryGiB"];
-                                            uint64_t* preValue =
-                                                totalMemory
-                                                    .get_ptr<uint64_t*>();
-                                            if (preValue == nullptr)
-                                            {
-                                                continue;
-                                            }
-                                            aResp->res
-                                                .jsonValue["MemorySummary"]
-                                                          ["TotalSystemMemoryGi"
-                                                           "B"] =
-                                                *value / (1024 * 1024) +
-                                                *preValue;
-                                            aResp->res
-                                                .jsonValue["MemorySummary"]
-                                                          ["Status"]["State"] =
-                                                "Enabled";
-                                        }
-                                    }
-                                    else
-                                    {
-                                        auto getDimmProperties =
-                                            [aResp](
-                                                const boost::system::error_code
-                                                    ec3,
-                                                const std::variant<bool>&
-                                                    dimmState) {
-                                                if (ec3)
-                                                {
-                                                    BMCWEB_LOG_ERROR
-                                                        << "DBUS response "
-                                                           "error "
-                                                        << ec3;
-                                                    return;
-                                                }
-                                                updateDimmProperties(aResp,
-                                                                     dimmState);
-                                            };
-                                        crow::connections::systemBus
-                                            ->async_method_call(
-                                                std::move(getDimmProperties),
-                                                service, path,
-                                                "org.freedesktop.DBus."
-                                                "Properties",
-                                                "Get",
-                                                "xyz.openbmc_project.State."
-                                                "Decorator.OperationalStatus",
-                                                "Functional");
-                                    }
-                                },
-                                connection.first, path,
-                                "org.freedesktop.DBus.Properties", "GetAll",
-                                "xyz.openbmc_project.Inventory.Item.Dimm");
+                            getDimmSummary(aResp, *plan, connection.first,
+                                           path);
                         }
                         else if (interfaceName ==
                                  "xyz.openbmc_project.Inventory.Item.Cpu")
@@ -451,141 +528,27 @@ inline void getComputerSystem(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
                             BMCWEB_LOG_DEBUG
                                 << "Found Cpu, now get its properties.";
 
-                            getProcessorSummary(aResp, connection.first, path);
+                            getProcessorSummary(aResp, *plan, connection.first,
+                                                path);
                         }
                         else if (interfaceName ==
                                  "xyz.openbmc_project.Common.UUID")
                         {
                             BMCWEB_LOG_DEBUG
                                 << "Found UUID, now get its properties.";
-                            crow::connections::systemBus->async_method_call(
-                                [aResp](
-                                    const boost::system::error_code ec3,
-                                    const std::vector<
-                                        std::pair<std::string, VariantType>>&
-                                        properties) {
-                                    if (ec3)
-                                    {
-                                        BMCWEB_LOG_DEBUG
-                                            << "DBUS response error " << ec3;
-                                        messages::internalError(aResp->res);
-                                        return;
-                                    }
-                                    BMCWEB_LOG_DEBUG << "Got "
-                                                     << properties.size()
-                                                     << " UUID properties.";
-                                    for (const std::pair<std::string,
-                                                         VariantType>&
-                                             property : properties)
-                                    {
-                                        if (property.first == "UUID")
-                                        {
-                                            const std::string* value =
-                                                std::get_if<std::string>(
-                                                    &property.second);
-
-                                            if (value != nullptr)
-                                            {
-                                                std::string valueStr = *value;
-                                                if (valueStr.size() == 32)
-                                                {
-                                                    valueStr.insert(8, 1, '-');
-                                                    valueStr.insert(13, 1, '-');
-                                                    valueStr.insert(18, 1, '-');
-                                                    valueStr.insert(23, 1, '-');
-                                                }
-                                                BMCWEB_LOG_DEBUG << "UUID = "
-                                                                 << valueStr;
-                                                aResp->res.jsonValue["UUID"] =
-                                                    valueStr;
-                                            }
-                                        }
-                                    }
-                                },
-                                connection.first, path,
-                                "org.freedesktop.DBus.Properties", "GetAll",
-                                "xyz.openbmc_project.Common.UUID");
+                            getSystemUuid(aResp, *plan, connection.first,
+                                          path);
                         }
                         else if (interfaceName ==
                                  "xyz.openbmc_project.Inventory.Item.System")
                         {
-                            crow::connections::systemBus->async_method_call(
-                                [aResp](
-                                    const boost::system::error_code ec2,
-                                    const std::vector<
-                                        std::pair<std::string, VariantType>>&
-                                        propertiesList) {
-                                    if (ec2)
-                                    {
-                                        // doesn't have to include this
-                                        // interface
-                                        return;
-                                    }
-                                    BMCWEB_LOG_DEBUG
-                                        << "Got " << propertiesList.size()
-                                        << " properties for system";
-                                    for (const std::pair<std::string,
-                                                         VariantType>&
-                                             property : propertiesList)
-                                    {
-                                        const std::string& propertyName =
-                                            property.first;
-                                        if ((propertyName == "PartNumber") ||
-                                            (propertyName == "SerialNumber") ||
-                                            (propertyName == "Manufacturer") ||
-                                            (propertyName == "Model") ||
-                                            (propertyName == "SubModel"))
-                                        {
-                                            const std::string* value =
-                                                std::get_if<std::string>(
-                                                    &property.second);
-                                            if (value != nullptr)
-                                            {
-                                                aResp->res
-                                                    .jsonValue[propertyName] =
-                                                    *value;
-                                            }
-                                        }
-                                    }
-
-                                    // Grab the bios version
-                                    fw_util::populateFirmwareInformation(
-                                        aResp, fw_util::biosPurpose,
-                                        "BiosVersion", false);
-                                },
-                                connection.first, path,
-                                "org.freedesktop.DBus.Properties", "GetAll",
-                                "xyz.openbmc_project.Inventory.Decorator."
-                                "Asset");
-
-                            crow::connections::systemBus->async_method_call(
-                                [aResp](
-                                    const boost::system::error_code ec2,
-                                    const std::variant<std::string>& property) {
-                                    if (ec2)
-                                    {
-                                        // doesn't have to include this
-                                        // interface
-                                        return;
-                                    }
-
-                                    const std::string* value =
-                                        std::get_if<std::string>(&property);
-                                    if (value != nullptr)
-                                    {
-                                        aResp->res.jsonValue["AssetTag"] =
-                                            *value;
-                                    }
-                                },
-                                connection.first, path,
-                                "org.freedesktop.DBus.Properties", "Get",
-                                "xyz.openbmc_project.Inventory.Decorator."
-                                "AssetTag",
-                                "AssetTag");
+                            getSystemAsset(aResp, *plan, connection.first,
+                                           path);
                         }
                     }
                 }
             }
+            plan->run();
         },
         "xyz.openbmc_project.ObjectMapper",
         "/xyz/openbmc_project/object_mapper",
@@ -2688,7 +2651,7 @@ inline void requestRoutesSystems(App& app)
         .privileges(redfish::privileges::getComputerSystem)
         .methods(
             boost::beast::http::verb::
-                get)([](const crow::Request&,
+                get)([](const crow::Request& req,
                         const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
             asyncResp->res.jsonValue["@odata.type"] =
                 "#ComputerSystem.v1_16_0.ComputerSystem";
@@ -2758,36 +2721,88 @@ inline void requestRoutesSystems(App& app)
             asyncResp->res.jsonValue["FabricAdapters"] = {
                 {"@odata.id", "/redfish/v1/Systems/system/FabricAdapters"}};
 
-            getMainChassisId(
-                asyncResp, [](const std::string& chassisId,
-                              const std::shared_ptr<bmcweb::AsyncResp>& aRsp) {
-                    aRsp->res.jsonValue["Links"]["Chassis"] = {
-                        {{"@odata.id", "/redfish/v1/Chassis/" + chassisId}}};
-                });
+            // Skip the D-Bus calls behind properties $select leaves out
+            auto selected = [&req](std::string_view property) {
+                return query_param::isSelected(req, property);
+            };
+            if (selected("Links"))
+            {
+                getMainChassisId(
+                    asyncResp,
+                    [](const std::string& chassisId,
+                       const std::shared_ptr<bmcweb::AsyncResp>& aRsp) {
+                        aRsp->res.jsonValue["Links"]["Chassis"] = {
+                            {{"@odata.id",
+                              "/redfish/v1/Chassis/" + chassisId}}};
+                    });
+            }
 
-            getLocationIndicatorActive(asyncResp);
+            if (selected("LocationIndicatorActive"))
+            {
+                getLocationIndicatorActive(asyncResp);
+            }
             // TODO (Gunnar): Remove IndicatorLED after enough time has passed
-            getIndicatorLedState(asyncResp);
-            getComputerSystem(asyncResp);
-            getHostState(asyncResp);
-            getBootProgress(asyncResp);
-            getPCIeDeviceList(asyncResp, "PCIeDevices");
-            getHostWatchdogTimer(asyncResp);
-            getPowerRestorePolicy(asyncResp);
-            getStopBootOnFault(asyncResp);
-            getAutomaticRetry(asyncResp);
-            getLastResetTime(asyncResp);
+            if (selected("IndicatorLED"))
+            {
+                getIndicatorLedState(asyncResp);
+            }
+            if (selected("ProcessorSummary") || selected("MemorySummary") ||
+                selected("UUID") || selected("AssetTag") ||
+                selected("PartNumber") || selected("SerialNumber") ||
+                selected("Manufacturer") || selected("Model") ||
+                selected("SubModel") || selected("BiosVersion"))
+            {
+                getComputerSystem(asyncResp);
+            }
+            if (selected("PowerState") || selected("Status"))
+            {
+                getHostState(asyncResp);
+            }
+            if (selected("BootProgress"))
+            {
+                getBootProgress(asyncResp);
+            }
+            if (selected("PCIeDevices"))
+            {
+                getPCIeDeviceList(asyncResp, "PCIeDevices");
+            }
+            if (selected("HostWatchdogTimer"))
+            {
+                getHostWatchdogTimer(asyncResp);
+            }
+            if (selected("PowerRestorePolicy"))
+            {
+                getPowerRestorePolicy(asyncResp);
+            }
+            if (selected("Boot"))
+            {
+                getStopBootOnFault(asyncResp);
+                getAutomaticRetry(asyncResp);
+                getTrustedModuleRequiredToBoot(asyncResp);
+            }
+            if (selected("LastResetTime"))
+            {
+                getLastResetTime(asyncResp);
+            }
+            if (selected("Oem"))
+            {
 #ifdef BMCWEB_ENABLE_IBM_LED_EXTENSIONS
-            getLampTestState(asyncResp);
-            getSAI(asyncResp, "PartitionSystemAttentionIndicator");
-            getSAI(asyncResp, "PlatformSystemAttentionIndicator");
+                getLampTestState(asyncResp);
+                getSAI(asyncResp, "PartitionSystemAttentionIndicator");
+                getSAI(asyncResp, "PlatformSystemAttentionIndicator");
 #endif
 #ifdef BMCWEB_ENABLE_REDFISH_PROVISIONING_FEATURE
-            getProvisioningStatus(asyncResp);
+                getProvisioningStatus(asyncResp);
 #endif
-            getTrustedModuleRequiredToBoot(asyncResp);
-            getPowerMode(asyncResp);
-            getIdlePowerSaver(asyncResp);
+            }
+            if (selected("PowerMode") || selected("Oem"))
+            {
+                getPowerMode(asyncResp);
+            }
+            if (selected("IdlePowerSaver"))
+            {
+                getIdlePowerSaver(asyncResp);
+            }
         });
     BMCWEB_ROUTE(app, "/redfish/v1/Systems/system/")
         .privileges(redfish::privileges::patchComputerSystem)
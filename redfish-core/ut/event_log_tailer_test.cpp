@@ -0,0 +1,103 @@
+#include <unistd.h>
+
+#include <event_log_tailer.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using redfish::EventLogTailer;
+using Lines = std::vector<std::string>;
+
+class EventLogTailerTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        dir = std::filesystem::temp_directory_path() /
+              ("event_log_tailer_test_" + std::to_string(getpid()));
+        std::filesystem::create_directory(dir);
+        log = dir / "redfish";
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    void append(const std::filesystem::path& path, const std::string& data)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file << data;
+    }
+
+    std::filesystem::path dir;
+    std::filesystem::path log;
+};
+
+} // namespace
+
+TEST_F(EventLogTailerTest, ReadsOnlyAppendedLines)
+{
+    append(log, "old 1\nold 2\n");
+    EventLogTailer tailer(log);
+    tailer.seekToEnd();
+    EXPECT_TRUE(tailer.readNewLines().empty());
+
+    append(log, "new 1\nnew ");
+    EXPECT_EQ(tailer.readNewLines(), Lines({"new 1"}));
+    append(log, "2\n");
+    EXPECT_EQ(tailer.readNewLines(), Lines({"new 2"}));
+    EXPECT_TRUE(tailer.readNewLines().empty());
+}
+
+TEST_F(EventLogTailerTest, FileThatDoesNotExistYetIsReadWhole)
+{
+    EventLogTailer tailer(log);
+    tailer.seekToEnd();
+    EXPECT_TRUE(tailer.readNewLines().empty());
+    append(log, "first\n");
+    EXPECT_EQ(tailer.readNewLines(), Lines({"first"}));
+}
+
+TEST_F(EventLogTailerTest, TruncatedFileIsReadFromStart)
+{
+    append(log, "a long line before truncation\n");
+    EventLogTailer tailer(log);
+    EXPECT_EQ(tailer.readNewLines(),
+              Lines({"a long line before truncation"}));
+
+    std::filesystem::resize_file(log, 0);
+    append(log, "after\n");
+    EXPECT_EQ(tailer.readNewLines(), Lines({"after"}));
+}
+
+TEST_F(EventLogTailerTest, RotationKeepsLinesWrittenBeforeIt)
+{
+    append(log, "one\n");
+    EventLogTailer tailer(log);
+    EXPECT_EQ(tailer.readNewLines(), Lines({"one"}));
+
+    // The logger writes more to the old file between the last read and the
+    // rotation, then writes to a new file
+    append(log, "two\nthr");
+    std::filesystem::rename(log, dir / "redfish.1");
+    append(dir / "redfish.1", "ee");
+    append(log, "four\n");
+    EXPECT_EQ(tailer.readNewLines(), Lines({"two", "three", "four"}));
+
+    // Rotated away with nothing new in the new file yet
+    std::filesystem::rename(log, dir / "redfish.2");
+    EXPECT_TRUE(tailer.readNewLines().empty());
+    append(dir / "redfish.2", "five\n");
+    append(log, "");
+    EXPECT_EQ(tailer.readNewLines(), Lines({"five"}));
+    append(log, "six\n");
+    EXPECT_EQ(tailer.readNewLines(), Lines({"six"}));
+}
@@ -0,0 +1,71 @@
+#include <event_routing.hpp>
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using redfish::EventRoutingIndex;
+using ::testing::UnorderedElementsAre;
+
+namespace
+{
+
+std::vector<std::string> eventSubscriptions(const EventRoutingIndex& index,
+                                            const std::string& resourceType)
+{
+    std::vector<std::string> ids;
+    index.forEachEventSubscription(
+        resourceType, [&ids](const std::string& id) { ids.push_back(id); });
+    return ids;
+}
+
+std::vector<std::string> logSubscriptions(const EventRoutingIndex& index,
+                                          const std::string& prefix,
+                                          const std::string& messageId)
+{
+    std::vector<std::string> ids;
+    index.forEachLogSubscription(
+        prefix, messageId,
+        [&ids](const std::string& id) { ids.push_back(id); });
+    return ids;
+}
+
+} // namespace
+
+TEST(EventRoutingIndex, RoutesEventsByResourceType)
+{
+    EventRoutingIndex index;
+    index.addEventSubscription("all", {});
+    index.addEventSubscription("chassis", {"Chassis", "Chassis"});
+    index.addEventSubscription("both", {"Chassis", "Systems"});
+
+    EXPECT_THAT(eventSubscriptions(index, "Chassis"),
+                UnorderedElementsAre("all", "chassis", "both"));
+    EXPECT_THAT(eventSubscriptions(index, "Systems"),
+                UnorderedElementsAre("all", "both"));
+    EXPECT_THAT(eventSubscriptions(index, "Task"), UnorderedElementsAre("all"));
+
+    index.clear();
+    EXPECT_TRUE(eventSubscriptions(index, "Chassis").empty());
+}
+
+TEST(EventRoutingIndex, RoutesLogEntriesByRegistryAndMessage)
+{
+    EventRoutingIndex index;
+    index.addLogSubscription("all", {}, {});
+    index.addLogSubscription("openbmc", {"OpenBMC"}, {});
+    index.addLogSubscription("powered", {}, {"PowerOn", "PowerOff"});
+    index.addLogSubscription("openbmcPowered", {"OpenBMC", "Task"},
+                             {"PowerOn"});
+
+    EXPECT_THAT(logSubscriptions(index, "OpenBMC", "PowerOn"),
+                UnorderedElementsAre("all", "openbmc", "powered",
+                                     "openbmcPowered"));
+    EXPECT_THAT(logSubscriptions(index, "OpenBMC", "PowerOff"),
+                UnorderedElementsAre("all", "openbmc", "powered"));
+    EXPECT_THAT(logSubscriptions(index, "Task", "PowerOn"),
+                UnorderedElementsAre("all", "powered", "openbmcPowered"));
+    EXPECT_THAT(logSubscriptions(index, "Base", "Success"),
+                UnorderedElementsAre("all"));
+}
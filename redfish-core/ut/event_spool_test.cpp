@@ -0,0 +1,201 @@
+#include <unistd.h>
+
+#include <event_spool.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using redfish::EventSpool;
+
+class EventSpoolTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        dir = std::filesystem::temp_directory_path() /
+              ("event_spool_test_" + std::to_string(getpid()));
+        std::filesystem::remove_all(dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    std::unique_ptr<EventSpool> openSpool(size_t maxBytes = 1024 * 1024,
+                                          size_t segmentSize = 1024)
+    {
+        auto spool = std::make_unique<EventSpool>(dir, maxBytes, segmentSize);
+        EXPECT_TRUE(spool->open());
+        return spool;
+    }
+
+    size_t segmentCount()
+    {
+        size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(dir))
+        {
+            if (entry.path().extension() == ".seg")
+            {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    std::filesystem::path dir;
+};
+
+} // namespace
+
+TEST_F(EventSpoolTest, AcknowledgedSegmentsAreDeleted)
+{
+    auto spool = openSpool(1024 * 1024, 64);
+    // 8 byte header and 32 bytes of event, so one per segment
+    std::string event(32, 'x');
+    EXPECT_EQ(spool->append(event), 0U);
+    EXPECT_EQ(spool->append(event), 1U);
+    EXPECT_EQ(spool->append(event), 2U);
+    EXPECT_EQ(segmentCount(), 3U);
+    EXPECT_EQ(spool->read(1), event);
+
+    // Out of order, so nothing can go until the first one is acknowledged
+    spool->ack(1);
+    EXPECT_EQ(segmentCount(), 3U);
+    EXPECT_TRUE(spool->isAcked(1));
+    EXPECT_FALSE(spool->isAcked(0));
+    spool->ack(0);
+    EXPECT_EQ(spool->getAckedThrough(), 2U);
+    EXPECT_EQ(segmentCount(), 1U);
+    EXPECT_EQ(spool->read(0), std::nullopt);
+    spool->ack(2);
+    EXPECT_EQ(segmentCount(), 0U);
+    EXPECT_EQ(spool->getTotalBytes(), 0U);
+
+    // Sequence numbers carry on
+    EXPECT_EQ(spool->append("next"), 3U);
+    EXPECT_EQ(spool->read(3), "next");
+}
+
+TEST_F(EventSpoolTest, UnacknowledgedEventsSurviveReopen)
+{
+    {
+        auto spool = openSpool();
+        spool->append("a");
+        spool->append("b");
+        spool->append("c");
+        spool->ack(0);
+        spool->sync();
+        // Not synced, so replayed
+        spool->ack(1);
+    }
+    auto spool = openSpool();
+    EXPECT_EQ(spool->getAckedThrough(), 1U);
+    EXPECT_EQ(spool->getNextSeq(), 3U);
+    EXPECT_EQ(spool->read(1), "b");
+    EXPECT_EQ(spool->read(2), "c");
+    EXPECT_EQ(spool->append("d"), 3U);
+}
+
+TEST_F(EventSpoolTest, FullyAcknowledgedSpoolKeepsSequence)
+{
+    {
+        auto spool = openSpool();
+        spool->append("a");
+        spool->append("b");
+        spool->ack(0);
+        spool->ack(1);
+        spool->sync();
+    }
+    auto spool = openSpool();
+    EXPECT_EQ(spool->getAckedThrough(), 2U);
+    EXPECT_EQ(spool->append("c"), 2U);
+}
+
+TEST_F(EventSpoolTest, TornWriteIsCutOff)
+{
+    {
+        auto spool = openSpool();
+        spool->append("a");
+        spool->append("b");
+        spool->sync();
+    }
+    // A crash in the middle of writing the next event
+    std::filesystem::path segment;
+    for (const auto& entry : std::filesystem::directory_iterator(dir))
+    {
+        if (entry.path().extension() == ".seg")
+        {
+            segment = entry.path();
+        }
+    }
+    {
+        std::ofstream file(segment, std::ios::binary | std::ios::app);
+        file.write("\x10\x00\x00\x00\x01", 5);
+    }
+
+    auto spool = openSpool();
+    EXPECT_EQ(spool->getNextSeq(), 2U);
+    EXPECT_EQ(spool->read(1), "b");
+    EXPECT_EQ(spool->append("c"), 2U);
+    EXPECT_EQ(spool->read(2), "c");
+    spool->sync();
+    spool.reset();
+
+    // A crash that left the file extended but never written, which reads as
+    // zeros: length 0 with a matching CRC
+    {
+        std::ofstream file(segment, std::ios::binary | std::ios::app);
+        file.write(std::string(64, '\0').data(), 64);
+    }
+    spool = openSpool();
+    EXPECT_EQ(spool->getNextSeq(), 3U);
+    EXPECT_EQ(spool->read(2), "c");
+    EXPECT_EQ(spool->append("d"), 3U);
+    EXPECT_EQ(spool->read(3), "d");
+    spool->sync();
+    spool.reset();
+
+    // A corrupted length is not taken for an event larger than the file
+    {
+        std::ofstream file(segment, std::ios::binary | std::ios::app);
+        file.write("\xff\xff\xff\xff\x00\x00\x00\x00", 8);
+    }
+    spool = openSpool();
+    EXPECT_EQ(spool->getNextSeq(), 4U);
+    EXPECT_EQ(spool->read(3), "d");
+}
+
+TEST_F(EventSpoolTest, OldestSegmentIsDroppedWhenFull)
+{
+    // Room for three segments of two events each
+    auto spool = openSpool(3 * 80, 80);
+    std::string event(32, 'x');
+    for (int i = 0; i < 10; i++)
+    {
+        spool->append(event);
+    }
+    EXPECT_LE(spool->getTotalBytes(), 3U * 80U);
+    EXPECT_EQ(spool->getDropped(), 4U);
+    EXPECT_TRUE(spool->isAcked(3));
+    EXPECT_EQ(spool->read(3), std::nullopt);
+    EXPECT_EQ(spool->read(4), event);
+    EXPECT_EQ(spool->read(9), event);
+    EXPECT_THAT(spool->append(std::string(300, 'x')), std::nullopt);
+}
+
+TEST_F(EventSpoolTest, RemoveDeletesEverything)
+{
+    auto spool = openSpool();
+    spool->append("a");
+    spool->sync();
+    spool->remove();
+    EXPECT_FALSE(std::filesystem::exists(dir));
+}
@@ -0,0 +1,111 @@
+#include "utils/filter_expr.hpp"
+
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using redfish::filter_expr::FilterExpr;
+
+bool matches(const std::string& filter, const nlohmann::json& member)
+{
+    std::optional<FilterExpr> expr = FilterExpr::parse(filter);
+    EXPECT_TRUE(expr) << filter;
+    return expr && expr->matches(member);
+}
+
+} // namespace
+
+TEST(FilterExpr, Parse)
+{
+    EXPECT_TRUE(FilterExpr::parse("Severity eq 'Critical'"));
+    EXPECT_TRUE(FilterExpr::parse("Status/Health ne 'OK'"));
+    EXPECT_TRUE(FilterExpr::parse("Reading gt -1.5 and Reading le 10"));
+    EXPECT_TRUE(FilterExpr::parse("not (A eq true or B eq null)"));
+    EXPECT_TRUE(FilterExpr::parse("Created gt 2021-01-01T00:00:00+00:00"));
+    EXPECT_TRUE(FilterExpr::parse("Message eq 'it''s'"));
+
+    EXPECT_FALSE(FilterExpr::parse(""));
+    EXPECT_FALSE(FilterExpr::parse("Severity"));
+    EXPECT_FALSE(FilterExpr::parse("Severity eq"));
+    EXPECT_FALSE(FilterExpr::parse("Severity is 'OK'"));
+    EXPECT_FALSE(FilterExpr::parse("Severity eq 'OK"));
+    EXPECT_FALSE(FilterExpr::parse("Severity eq OK"));
+    EXPECT_FALSE(FilterExpr::parse("Severity eq 'OK' and"));
+    EXPECT_FALSE(FilterExpr::parse("(Severity eq 'OK'"));
+    EXPECT_FALSE(FilterExpr::parse("Severity eq 'OK')"));
+    EXPECT_FALSE(FilterExpr::parse("Status/ eq 'OK'"));
+    EXPECT_FALSE(FilterExpr::parse("1 eq 1"));
+    EXPECT_FALSE(FilterExpr::parse("Reading eq -x"));
+}
+
+TEST(FilterExpr, ParseLimitsDepth)
+{
+    std::string deep;
+    for (size_t i = 0; i < redfish::filter_expr::maxFilterDepth + 1; i++)
+    {
+        deep += "not ";
+    }
+    EXPECT_FALSE(FilterExpr::parse(deep + "A eq 1"));
+    EXPECT_FALSE(
+        FilterExpr::parse(std::string(1000, '(') + "A eq 1" +
+                          std::string(1000, ')')));
+}
+
+TEST(FilterExpr, Matches)
+{
+    nlohmann::json member = {{"Severity", "Critical"},
+                             {"Reading", 42},
+                             {"Enabled", true},
+                             {"Status", {{"Health", "Warning"}}},
+                             {"Created", "2021-06-01T12:00:00+00:00"},
+                             {"Message", "it's"}};
+
+    EXPECT_TRUE(matches("Severity eq 'Critical'", member));
+    EXPECT_FALSE(matches("Severity ne 'Critical'", member));
+    EXPECT_TRUE(matches("Reading gt 41 and Reading lt 42.5", member));
+    EXPECT_TRUE(matches("Reading ge 42 and Reading le 42", member));
+    EXPECT_FALSE(matches("Reading gt 42", member));
+    EXPECT_TRUE(matches("Enabled eq true", member));
+    EXPECT_TRUE(matches("Status/Health eq 'Warning'", member));
+    EXPECT_TRUE(matches("Severity eq 'OK' or Reading eq 42", member));
+    EXPECT_TRUE(matches("not (Severity eq 'OK')", member));
+    EXPECT_TRUE(matches("Created gt 2021-01-01T00:00:00+00:00", member));
+    EXPECT_FALSE(matches("Created lt '2021-01-01T00:00:00+00:00'", member));
+    EXPECT_TRUE(matches("Message eq 'it''s'", member));
+    // "and" binds tighter than "or"
+    EXPECT_TRUE(
+        matches("Reading eq 42 or Severity eq 'OK' and Enabled eq false",
+                member));
+
+    // Missing properties compare as null, and order against nothing
+    EXPECT_TRUE(matches("Missing eq null", member));
+    EXPECT_TRUE(matches("Missing ne 'OK'", member));
+    EXPECT_FALSE(matches("Missing gt 0", member));
+    // Ordering across types is never true
+    EXPECT_FALSE(matches("Severity gt 0", member));
+}
+
+TEST(FilterExpr, EvaluatePartial)
+{
+    std::optional<FilterExpr> expr =
+        FilterExpr::parse("Severity eq 'Critical' and Message ne 'x'");
+    ASSERT_TRUE(expr);
+    EXPECT_EQ(expr->evaluate({{"Severity", "OK"}}), false);
+    EXPECT_EQ(expr->evaluate({{"Severity", "Critical"}}), std::nullopt);
+    EXPECT_EQ(expr->evaluate({{"Severity", "Critical"}, {"Message", "y"}}),
+              true);
+
+    expr = FilterExpr::parse("Severity eq 'Critical' or Message ne 'x'");
+    ASSERT_TRUE(expr);
+    EXPECT_EQ(expr->evaluate({{"Severity", "Critical"}}), true);
+    EXPECT_EQ(expr->evaluate({{"Severity", "OK"}}), std::nullopt);
+
+    expr = FilterExpr::parse("not (Severity eq 'OK')");
+    ASSERT_TRUE(expr);
+    EXPECT_EQ(expr->evaluate({{"Severity", "OK"}}), false);
+    EXPECT_EQ(expr->evaluate(nlohmann::json::object()), std::nullopt);
+}
@@ -0,0 +1,95 @@
+#include "utils/health_index.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using redfish::health_index::getHealth;
+using redfish::health_index::Health;
+using redfish::health_index::HealthIndex;
+using redfish::health_index::Statuses;
+
+constexpr const char* chassis = "/xyz/openbmc_project/inventory/system/chassis";
+constexpr const char* fan =
+    "/xyz/openbmc_project/inventory/system/chassis/fan0";
+constexpr const char* global = "/xyz/openbmc_project/inventory/bmc";
+
+std::pair<std::string, std::string>
+    health(const Statuses& statuses, const std::optional<std::string>& self,
+           bool isManagersHealth = false)
+{
+    Health result = getHealth(statuses, global, self, {fan}, isManagersHealth);
+    return {result.health, result.rollup};
+}
+
+} // namespace
+
+TEST(HealthIndex, ToStatusesKeepsStatusAssociations)
+{
+    dbus::utility::ManagedObjectType objects;
+    objects.push_back(
+        {{std::string(fan) + "/critical"},
+         {{"xyz.openbmc_project.Association",
+           {{"endpoints",
+             std::vector<std::string>{"/xyz/openbmc_project/sensors/a"}}}}}});
+    objects.push_back(
+        {{std::string(fan) + "/chassis"},
+         {{"xyz.openbmc_project.Association",
+           {{"endpoints", std::vector<std::string>{chassis}}}}}});
+    objects.push_back({{std::string(chassis) + "/warning"}, {}});
+
+    Statuses statuses = redfish::health_index::toStatuses(objects);
+    EXPECT_EQ(statuses,
+              Statuses({{std::string(chassis) + "/warning", {}},
+                        {std::string(fan) + "/critical",
+                         {"/xyz/openbmc_project/sensors/a"}}}));
+}
+
+TEST(HealthIndex, Rollup)
+{
+    using Result = std::pair<std::string, std::string>;
+    EXPECT_EQ(health({}, std::nullopt), Result("OK", "OK"));
+
+    // A child's status only rolls up
+    Statuses statuses = {{std::string(fan) + "/warning", {}}};
+    EXPECT_EQ(health(statuses, std::nullopt), Result("OK", "Warning"));
+    EXPECT_EQ(health(statuses, std::string(fan)), Result("Warning", "Warning"));
+
+    // As does one associated with a child
+    statuses = {{"/xyz/openbmc_project/sensors/a/critical", {fan}}};
+    EXPECT_EQ(health(statuses, std::nullopt), Result("OK", "Critical"));
+    statuses = {{"/xyz/openbmc_project/sensors/a/critical", {chassis}}};
+    EXPECT_EQ(health(statuses, std::nullopt), Result("OK", "OK"));
+    EXPECT_EQ(health(statuses, std::nullopt, true), Result("OK", "Critical"));
+
+    // The global item's warnings are everyone's
+    statuses = {{std::string(global) + "/warning", {fan}}};
+    EXPECT_EQ(health(statuses, std::nullopt), Result("Warning", "Warning"));
+}
+
+TEST(HealthIndex, SignalsUpdateSnapshots)
+{
+    HealthIndex index;
+    EXPECT_FALSE(index.isReady());
+    index.seed({{std::string(fan) + "/warning", {}}});
+    EXPECT_TRUE(index.isReady());
+
+    std::shared_ptr<const Statuses> before = index.getStatuses();
+    index.setEndpoints(std::string(chassis) + "/critical", {fan});
+    index.setEndpoints(std::string(chassis) + "/inventory", {fan});
+    index.remove(std::string(fan) + "/warning");
+
+    // Readers keep what they were given
+    EXPECT_EQ(before->size(), 1U);
+    EXPECT_EQ(*index.getStatuses(),
+              Statuses({{std::string(chassis) + "/critical", {fan}}}));
+
+    index.invalidate();
+    EXPECT_FALSE(index.isReady());
+}
@@ -0,0 +1,161 @@
+#include <boost/container/flat_map.hpp>
+#include <utils/property_plan.hpp>
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using redfish::property_plan::Call;
+using redfish::property_plan::ObjectManagers;
+using redfish::property_plan::PropertyPlan;
+
+constexpr const char* inventory = "xyz.openbmc_project.Inventory.Manager";
+constexpr const char* cpuPath = "/xyz/openbmc_project/inventory/system/cpu0";
+constexpr const char* dimmPath = "/xyz/openbmc_project/inventory/system/dimm0";
+constexpr const char* cpu = "xyz.openbmc_project.Inventory.Item.Cpu";
+constexpr const char* item = "xyz.openbmc_project.Inventory.Item";
+constexpr const char* dimm = "xyz.openbmc_project.Inventory.Item.Dimm";
+
+void ignoreInterface(const boost::system::error_code&,
+                     const dbus::utility::DBusPropertiesMap&)
+{}
+
+} // namespace
+
+TEST(PropertyPlan, GroupsCallsByService)
+{
+    PropertyPlan plan;
+    plan.addInterface(inventory, cpuPath, cpu, ignoreInterface);
+    plan.addInterface(inventory, cpuPath, item, ignoreInterface);
+    plan.addProperty(inventory, dimmPath, item, "Present",
+                     [](const dbus::utility::DbusVariantType&) {});
+    plan.addInterface(inventory, dimmPath, dimm, ignoreInterface);
+    plan.addInterface("xyz.openbmc_project.Settings", "/settings/uuid",
+                      "xyz.openbmc_project.Common.UUID", ignoreInterface);
+    plan.addInterface("xyz.openbmc_project.Pldm", "/a/one", cpu,
+                      ignoreInterface);
+    plan.addInterface("xyz.openbmc_project.Pldm", "/b/two", cpu,
+                      ignoreInterface);
+    EXPECT_EQ(plan.size(), 7U);
+
+    ObjectManagers objectManagers{
+        {inventory, {"/", "/xyz/openbmc_project/inventory"}},
+        {"xyz.openbmc_project.Settings", {"/"}},
+        {"xyz.openbmc_project.Pldm", {"/a"}}};
+    std::vector<Call> calls = plan.getCalls(objectManagers);
+    // The nearest ObjectManager is used, a lone interface is read on its
+    // own, and objects that no one ObjectManager returns are too
+    EXPECT_EQ(calls,
+              std::vector<Call>(
+                  {{inventory, "/xyz/openbmc_project/inventory", ""},
+                   {"xyz.openbmc_project.Pldm", "/a/one", cpu},
+                   {"xyz.openbmc_project.Pldm", "/b/two", cpu},
+                   {"xyz.openbmc_project.Settings", "/settings/uuid",
+                    "xyz.openbmc_project.Common.UUID"}}));
+
+    // An ObjectManager doesn't return its own object
+    std::vector<Call> alone = plan.getCalls({{inventory, {cpuPath}}});
+    ASSERT_EQ(alone.size(), 7U);
+    EXPECT_EQ(alone[0], Call({inventory, cpuPath, item}));
+    EXPECT_EQ(plan.getCalls({}), alone);
+}
+
+TEST(PropertyPlan, ManagedObjectsOnlyReplaceEnoughSmallGetAlls)
+{
+    PropertyPlan plan;
+    plan.addInterface(inventory, cpuPath, cpu, ignoreInterface);
+    plan.addInterface(inventory, cpuPath, item, ignoreInterface);
+    plan.addInterface(inventory, dimmPath, item, ignoreInterface);
+    ObjectManagers objectManagers{{inventory, {"/"}}};
+    EXPECT_EQ(plan.getCalls(objectManagers).size(), 3U);
+
+    plan.addInterface(inventory, dimmPath, dimm, ignoreInterface);
+    std::vector<Call> managed({{inventory, "/", ""}});
+    EXPECT_EQ(plan.getCalls(objectManagers), managed);
+
+    // Not when it returns more than a few objects for each GetAll
+    size_t objects = 16;
+    auto countObjects = [&objects](const std::string& service,
+                                   const std::string& objectManager) {
+        EXPECT_EQ(service, inventory);
+        EXPECT_EQ(objectManager, "/");
+        return std::optional<size_t>(objects);
+    };
+    EXPECT_EQ(plan.getCalls(objectManagers, countObjects), managed);
+    objects = 17;
+    EXPECT_EQ(plan.getCalls(objectManagers, countObjects).size(), 4U);
+}
+
+TEST(PropertyPlan, DispatchesManagedObjects)
+{
+    PropertyPlan plan;
+    std::vector<std::string> filled;
+    plan.addInterface(
+        inventory, cpuPath, cpu,
+        [&filled](const boost::system::error_code& ec,
+                  const dbus::utility::DBusPropertiesMap& properties) {
+            ASSERT_FALSE(ec);
+            filled.push_back("cpu " + std::to_string(properties.size()));
+        });
+    plan.addProperty(inventory, cpuPath, item, "Present",
+                     [&filled](const dbus::utility::DbusVariantType& value) {
+                         ASSERT_TRUE(std::get<bool>(value));
+                         filled.emplace_back("present");
+                     });
+    plan.addProperty(inventory, cpuPath, item, "PrettyName",
+                     [&filled](const dbus::utility::DbusVariantType&) {
+                         filled.emplace_back("name");
+                     });
+    plan.addInterface(inventory, dimmPath, item,
+                      [&filled](const boost::system::error_code& ec,
+                                const dbus::utility::DBusPropertiesMap&) {
+                          EXPECT_TRUE(ec);
+                          filled.emplace_back("dimm");
+                      });
+
+    dbus::utility::ManagedObjectType objects;
+    objects.push_back(
+        {{cpuPath},
+         {{cpu, {{"Family", std::string("POWER10")},
+                 {"CoreCount", uint16_t{15}}}},
+          {item, {{"Present", true}}}}});
+    plan.dispatch(Call{inventory, "/xyz/openbmc_project/inventory", ""},
+                  boost::system::error_code(), objects);
+    // Properties that weren't returned aren't filled, and interfaces that
+    // weren't are told so
+    EXPECT_EQ(filled,
+              std::vector<std::string>({"present", "cpu 2", "dimm"}));
+}
+
+TEST(PropertyPlan, FailedCallsOnlyReachInterfaceFillers)
+{
+    PropertyPlan plan;
+    int interfaceCalls = 0;
+    int propertyCalls = 0;
+    plan.addInterface(
+        inventory, cpuPath, item,
+        [&interfaceCalls](const boost::system::error_code& ec,
+                          const dbus::utility::DBusPropertiesMap&) {
+            EXPECT_TRUE(ec);
+            interfaceCalls++;
+        });
+    plan.addProperty(inventory, cpuPath, item, "Present",
+                     [&propertyCalls](const dbus::utility::DbusVariantType&) {
+                         propertyCalls++;
+                     });
+    dbus::utility::DBusPropertiesMap properties{{"Present", true}};
+    plan.dispatch({inventory, cpuPath, item},
+                  boost::system::errc::make_error_code(
+                      boost::system::errc::io_error),
+                  properties);
+    plan.dispatch(Call{inventory, "/", ""},
+                  boost::system::errc::make_error_code(
+                      boost::system::errc::io_error),
+                  dbus::utility::ManagedObjectType());
+    EXPECT_EQ(interfaceCalls, 2);
+    EXPECT_EQ(propertyCalls, 0);
+}
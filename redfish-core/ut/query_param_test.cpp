@@ -0,0 +1,488 @@
+#include "utils/query_param.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+using redfish::query_param::ExpandType;
+using redfish::query_param::Query;
+
+std::vector<std::string> findUris(ExpandType type, const nlohmann::json& root)
+{
+    std::vector<std::string> uris;
+    for (const redfish::query_param::ExpandNode& node :
+         redfish::query_param::findNavigationReferences(type, root))
+    {
+        uris.push_back(node.uri);
+    }
+    return uris;
+}
+
+// Subrequests that are answered when the test says so
+struct FakeSubRequests
+{
+    std::vector<std::pair<std::string, std::function<void(crow::Response&)>>>
+        outstanding;
+
+    redfish::query_param::SubRequestHandler handler()
+    {
+        return [this](const std::string& uri,
+                      std::function<void(crow::Response&)>&& callback) {
+            outstanding.emplace_back(uri, std::move(callback));
+        };
+    }
+
+    // Answers every outstanding subrequest with a resource named by its uri,
+    // linking to uri/Child
+    void answerAll()
+    {
+        while (!outstanding.empty())
+        {
+            auto [uri, callback] = std::move(outstanding.front());
+            outstanding.erase(outstanding.begin());
+            crow::Response res;
+            res.jsonValue["@odata.id"] = uri;
+            res.jsonValue["Child"]["@odata.id"] = uri + "/Child";
+            callback(res);
+        }
+    }
+};
+
+} // namespace
+
+TEST(QueryParam, ParseExpand)
+{
+    Query query;
+    EXPECT_TRUE(redfish::query_param::parseExpand(".", query));
+    EXPECT_EQ(query.expandType, ExpandType::NotLinks);
+    EXPECT_EQ(query.expandLevel, 1U);
+    EXPECT_TRUE(redfish::query_param::parseExpand("~", query));
+    EXPECT_EQ(query.expandType, ExpandType::Links);
+    EXPECT_TRUE(redfish::query_param::parseExpand("*($levels=3)", query));
+    EXPECT_EQ(query.expandType, ExpandType::Both);
+    EXPECT_EQ(query.expandLevel, 3U);
+
+    EXPECT_FALSE(redfish::query_param::parseExpand("", query));
+    EXPECT_FALSE(redfish::query_param::parseExpand("x", query));
+    EXPECT_FALSE(redfish::query_param::parseExpand("*(", query));
+    EXPECT_FALSE(redfish::query_param::parseExpand("*($levels=)", query));
+    EXPECT_FALSE(redfish::query_param::parseExpand("*($levels=2", query));
+    EXPECT_FALSE(redfish::query_param::parseExpand("*($levels=2x)", query));
+    EXPECT_FALSE(redfish::query_param::parseExpand("*($levels=-1)", query));
+}
+
+TEST(QueryParam, FindNavigationReferences)
+{
+    nlohmann::json root = {
+        {"@odata.id", "/redfish/v1/Chassis/c"},
+        {"Name", "c"},
+        {"Power", {{"@odata.id", "/redfish/v1/Chassis/c/Power"}}},
+        {"Members", {{{"@odata.id", "/a"}}, {{"@odata.id", "/b"}}}},
+        {"PowerSupply",
+         {{"@odata.id", "/redfish/v1/Chassis/c/Power#/PowerSupplies/0"}}},
+        {"Links",
+         {{"ComputerSystems", {{{"@odata.id", "/redfish/v1/Systems/s"}}}}}}};
+
+    EXPECT_THAT(findUris(ExpandType::NotLinks, root),
+                testing::ElementsAre("/a", "/b",
+                                     "/redfish/v1/Chassis/c/Power"));
+    EXPECT_THAT(findUris(ExpandType::Links, root),
+                testing::ElementsAre("/redfish/v1/Systems/s"));
+    EXPECT_THAT(findUris(ExpandType::Both, root),
+                testing::ElementsAre("/redfish/v1/Systems/s", "/a", "/b",
+                                     "/redfish/v1/Chassis/c/Power"));
+    EXPECT_TRUE(findUris(ExpandType::None, root).empty());
+
+    std::vector<redfish::query_param::ExpandNode> nodes =
+        redfish::query_param::findNavigationReferences(ExpandType::NotLinks,
+                                                       root);
+    ASSERT_EQ(nodes.size(), 3U);
+    EXPECT_EQ(nodes[1].location.to_string(), "/Members/1");
+}
+
+TEST(QueryParam, ApproximateSize)
+{
+    nlohmann::json value = {{"Name", "name"},
+                            {"Members", {{{"@odata.id", "/a"}}, "b"}}};
+    size_t size = redfish::query_param::approximateSize(value);
+    EXPECT_GE(size, value.dump().size());
+    EXPECT_LE(size, value.dump().size() * 2);
+}
+
+TEST(QueryParam, ExpandLevels)
+{
+    FakeSubRequests subRequests;
+    crow::Response res;
+    bool completed = false;
+    res.setCompleteRequestHandler([&completed] { completed = true; });
+    res.jsonValue["Members"] = {{{"@odata.id", "/a"}}, {{"@odata.id", "/b"}}};
+
+    Query query;
+    query.expandType = ExpandType::NotLinks;
+    query.expandLevel = 2;
+    std::make_shared<redfish::query_param::ExpandHandler>(
+        std::make_shared<bmcweb::AsyncResp>(res), query,
+        subRequests.handler())
+        ->start();
+    EXPECT_EQ(subRequests.outstanding.size(), 2U);
+    EXPECT_FALSE(completed);
+
+    subRequests.answerAll();
+    EXPECT_TRUE(completed);
+    EXPECT_EQ(res.jsonValue["Members"][1]["@odata.id"], "/b");
+    EXPECT_EQ(res.jsonValue["Members"][1]["Child"]["@odata.id"], "/b/Child");
+    // The third level is left as a reference
+    EXPECT_EQ(res.jsonValue["Members"][1]["Child"]["Child"],
+              nlohmann::json({{"@odata.id", "/b/Child/Child"}}));
+}
+
+TEST(QueryParam, ExpandLimitsInFlight)
+{
+    FakeSubRequests subRequests;
+    crow::Response res;
+    nlohmann::json& members = res.jsonValue["Members"];
+    for (size_t i = 0; i < 20; i++)
+    {
+        members.push_back({{"@odata.id", "/m/" + std::to_string(i)}});
+    }
+
+    Query query;
+    query.expandType = ExpandType::Both;
+    std::make_shared<redfish::query_param::ExpandHandler>(
+        std::make_shared<bmcweb::AsyncResp>(res), query,
+        subRequests.handler())
+        ->start();
+    EXPECT_EQ(subRequests.outstanding.size(),
+              redfish::query_param::maxExpandInFlight);
+
+    subRequests.answerAll();
+    EXPECT_EQ(res.jsonValue["Members"][19]["Child"]["@odata.id"],
+              "/m/19/Child");
+}
+
+TEST(QueryParam, ExpandFailureLeavesReference)
+{
+    FakeSubRequests subRequests;
+    crow::Response res;
+    res.jsonValue["Members"] = {{{"@odata.id", "/a"}}};
+
+    Query query;
+    query.expandType = ExpandType::Both;
+    std::make_shared<redfish::query_param::ExpandHandler>(
+        std::make_shared<bmcweb::AsyncResp>(res), query,
+        subRequests.handler())
+        ->start();
+    ASSERT_EQ(subRequests.outstanding.size(), 1U);
+
+    crow::Response notFound;
+    notFound.result(boost::beast::http::status::not_found);
+    subRequests.outstanding.front().second(notFound);
+    subRequests.outstanding.clear();
+    EXPECT_EQ(res.jsonValue["Members"][0],
+              nlohmann::json({{"@odata.id", "/a"}}));
+}
+
+TEST(QueryParam, ParseSelect)
+{
+    std::vector<std::string> properties;
+    EXPECT_TRUE(redfish::query_param::parseSelect("Status", properties));
+    EXPECT_THAT(properties, testing::ElementsAre("Status"));
+    EXPECT_TRUE(redfish::query_param::parseSelect(
+        "Reading,Status/Health,Members@odata.count", properties));
+    EXPECT_THAT(properties, testing::ElementsAre("Reading", "Status/Health",
+                                                 "Members@odata.count"));
+
+    EXPECT_FALSE(redfish::query_param::parseSelect("", properties));
+    EXPECT_FALSE(redfish::query_param::parseSelect("Status,", properties));
+    EXPECT_FALSE(redfish::query_param::parseSelect("Status/", properties));
+    EXPECT_FALSE(redfish::query_param::parseSelect("/Status", properties));
+    EXPECT_FALSE(redfish::query_param::parseSelect("A//B", properties));
+    EXPECT_FALSE(redfish::query_param::parseSelect("Sta tus", properties));
+}
+
+TEST(QueryParam, IsSelected)
+{
+    std::vector<std::string> properties{"Status/Health", "Reading"};
+    EXPECT_TRUE(redfish::query_param::isSelected(properties, "Reading"));
+    EXPECT_TRUE(redfish::query_param::isSelected(properties, "Status"));
+    EXPECT_TRUE(
+        redfish::query_param::isSelected(properties, "Status/Health"));
+    EXPECT_FALSE(
+        redfish::query_param::isSelected(properties, "Status/State"));
+    EXPECT_FALSE(redfish::query_param::isSelected(properties, "Read"));
+    EXPECT_FALSE(redfish::query_param::isSelected(properties, "PowerState"));
+    EXPECT_TRUE(redfish::query_param::isSelected(std::vector<std::string>(),
+                                                 "PowerState"));
+}
+
+TEST(QueryParam, SelectProperties)
+{
+    nlohmann::json root = {
+        {"@odata.id", "/redfish/v1/Chassis/c/Sensors/s"},
+        {"@odata.type", "#Sensor.v1_0_0.Sensor"},
+        {"Name", "s"},
+        {"Reading", 42},
+        {"Status", {{"Health", "OK"}, {"State", "Enabled"}}},
+        {"Members", {{{"Name", "a"}, {"Id", "a"}}}},
+        {"Members@odata.count", 1}};
+
+    redfish::query_param::selectProperties(
+        root, {"Reading", "Status/Health", "Members/Name"});
+    EXPECT_EQ(root, nlohmann::json({
+                        {"@odata.id", "/redfish/v1/Chassis/c/Sensors/s"},
+                        {"@odata.type", "#Sensor.v1_0_0.Sensor"},
+                        {"Reading", 42},
+                        {"Status", {{"Health", "OK"}}},
+                        {"Members", {{{"Name", "a"}}}},
+                        {"Members@odata.count", 1},
+                    }));
+}
+
+TEST(QueryParam, FilterMembers)
+{
+    std::optional<redfish::filter_expr::FilterExpr> filter =
+        redfish::filter_expr::FilterExpr::parse("Severity eq 'Critical'");
+    ASSERT_TRUE(filter);
+
+    crow::Response res;
+    res.jsonValue = {
+        {"Members",
+         {{{"Id", "1"}, {"Severity", "OK"}},
+          {{"Id", "2"}, {"Severity", "Critical"}},
+          {{"Id", "3"}, {"Severity", "Warning"}}}},
+        {"Members@odata.count", 3}};
+    EXPECT_TRUE(redfish::query_param::filterMembers(res, *filter));
+    EXPECT_EQ(res.jsonValue,
+              nlohmann::json({
+                  {"Members", {{{"Id", "2"}, {"Severity", "Critical"}}}},
+                  {"Members@odata.count", 1},
+              }));
+
+    // A page can't be filtered after the fact, as the count and the other
+    // pages would be wrong
+    crow::Response paged;
+    paged.jsonValue = {
+        {"Members", {{{"Severity", "OK"}}, {{"Severity", "Critical"}}}},
+        {"Members@odata.count", 10}};
+    EXPECT_FALSE(redfish::query_param::filterMembers(paged, *filter));
+    EXPECT_EQ(paged.result(), boost::beast::http::status::bad_request);
+    EXPECT_FALSE(paged.jsonValue.contains("Members"));
+
+    // Nor can references, which don't have the property
+    crow::Response references;
+    references.jsonValue = {{"Members", {{{"@odata.id", "/a"}}}},
+                            {"Members@odata.count", 1}};
+    EXPECT_FALSE(redfish::query_param::filterMembers(references, *filter));
+    EXPECT_EQ(references.result(), boost::beast::http::status::bad_request);
+}
+
+TEST(QueryParam, SetReferenceMembers)
+{
+    std::vector<std::string> uris = {"/c/a1", "/c/b1", "/c/a2",
+                                     "/c/b2", "/c/a3", "/c/a4"};
+    redfish::query_param::Paging paging{
+        1, 2, "&$top=2",
+        redfish::filter_expr::FilterExpr::parse(
+            "@odata.id ne '/c/b1' and @odata.id ne '/c/b2'")};
+    ASSERT_TRUE(paging.filter);
+
+    // $skip and $top count only the members the filter keeps
+    crow::Response res;
+    redfish::query_param::setReferenceMembers(res, "/c", uris, paging);
+    EXPECT_EQ(res.jsonValue["Members"],
+              nlohmann::json({{{"@odata.id", "/c/a2"}},
+                              {{"@odata.id", "/c/a3"}}}));
+    EXPECT_EQ(res.jsonValue["Members@odata.count"], 4);
+    EXPECT_EQ(res.jsonValue["Members@odata.nextLink"], "/c?$skip=3&$top=2");
+
+    // The last page has no next link
+    paging.skip = 2;
+    crow::Response last;
+    redfish::query_param::setReferenceMembers(last, "/c", uris, paging);
+    EXPECT_EQ(last.jsonValue["Members"],
+              nlohmann::json({{{"@odata.id", "/c/a3"}},
+                              {{"@odata.id", "/c/a4"}}}));
+    EXPECT_EQ(last.jsonValue["Members@odata.count"], 4);
+    EXPECT_FALSE(last.jsonValue.contains("Members@odata.nextLink"));
+
+    // A filter on what references don't have is refused
+    paging.filter = redfish::filter_expr::FilterExpr::parse("Name eq 'a'");
+    ASSERT_TRUE(paging.filter);
+    crow::Response refused;
+    redfish::query_param::setReferenceMembers(refused, "/c", uris, paging);
+    EXPECT_EQ(refused.result(), boost::beast::http::status::bad_request);
+    EXPECT_FALSE(refused.jsonValue.contains("Members"));
+}
+
+TEST(QueryParam, ExpandThenSelect)
+{
+    FakeSubRequests subRequests;
+    crow::Response res;
+    res.jsonValue["Name"] = "root";
+    res.jsonValue["Members"] = {{{"@odata.id", "/a"}}};
+
+    Query query;
+    query.expandType = ExpandType::NotLinks;
+    query.selectProperties = {"Members/Child"};
+    std::make_shared<redfish::query_param::ExpandHandler>(
+        std::make_shared<bmcweb::AsyncResp>(res), query,
+        subRequests.handler())
+        ->start();
+    subRequests.answerAll();
+    // Selection below the top level waits for the members to be expanded
+    EXPECT_EQ(res.jsonValue,
+              nlohmann::json({{"Members",
+                               {{{"Child", {{"@odata.id", "/a/Child"}}}}}}}));
+}
+
+TEST(QueryParam, GetPaging)
+{
+    boost::beast::http::request<boost::beast::http::string_body> req{
+        boost::beast::http::verb::get,
+        "/redfish/v1/Chassis?$skip=20&$top=10&$filter=Name%20eq%20'a'", 11};
+    std::error_code ec;
+    crow::Request reqIn(req, ec);
+    ASSERT_FALSE(ec);
+    crow::Response res;
+    std::optional<redfish::query_param::Paging> paging =
+        redfish::query_param::getPaging(
+            std::make_shared<bmcweb::AsyncResp>(res), reqIn);
+    ASSERT_TRUE(paging);
+    EXPECT_EQ(paging->skip, 20U);
+    EXPECT_EQ(paging->top, 10U);
+    EXPECT_EQ(paging->linkParams, "&$top=10&$filter=Name%20eq%20%27a%27");
+    EXPECT_TRUE(paging->filter);
+
+    req.target("/redfish/v1/Chassis?$top=0");
+    crow::Request badIn(req, ec);
+    crow::Response badRes;
+    EXPECT_FALSE(redfish::query_param::getPaging(
+        std::make_shared<bmcweb::AsyncResp>(badRes), badIn));
+    EXPECT_EQ(badRes.result(), boost::beast::http::status::bad_request);
+}
+
+TEST(QueryParam, FilterExpandedReferences)
+{
+    boost::beast::http::request<boost::beast::http::string_body> req{
+        boost::beast::http::verb::get,
+        "/c?$expand=.&$filter=Status/Health%20eq%20'OK'", 11};
+    std::error_code ec;
+    crow::Request reqIn(req, ec);
+    ASSERT_FALSE(ec);
+
+    crow::Response res;
+    bool completed = false;
+    res.setCompleteRequestHandler([&completed] { completed = true; });
+    auto asyncResp = std::make_shared<bmcweb::AsyncResp>(res);
+    std::optional<redfish::query_param::Query> query =
+        redfish::query_param::parseParameters(reqIn.urlParams, res);
+    ASSERT_TRUE(query);
+    std::optional<redfish::query_param::Paging> paging =
+        redfish::query_param::getPaging(asyncResp, reqIn);
+    ASSERT_TRUE(paging);
+    // The references alone can't be filtered on Status/Health
+    EXPECT_FALSE(paging->filter);
+
+    redfish::query_param::setReferenceMembers(res, "/c", {"/c/a", "/c/b"},
+                                              *paging);
+    EXPECT_EQ(res.result(), boost::beast::http::status::ok);
+    EXPECT_EQ(res.jsonValue["Members@odata.count"], 2);
+
+    FakeSubRequests subRequests;
+    std::make_shared<redfish::query_param::ExpandHandler>(
+        asyncResp, *query, subRequests.handler())
+        ->start();
+    asyncResp.reset();
+    ASSERT_EQ(subRequests.outstanding.size(), 2U);
+    for (auto& [uri, callback] : subRequests.outstanding)
+    {
+        crow::Response member;
+        member.jsonValue["@odata.id"] = uri;
+        member.jsonValue["Status"]["Health"] =
+            uri == "/c/a" ? "OK" : "Critical";
+        callback(member);
+    }
+    subRequests.outstanding.clear();
+
+    EXPECT_TRUE(completed);
+    EXPECT_EQ(res.result(), boost::beast::http::status::ok);
+    EXPECT_EQ(res.jsonValue["Members"],
+              nlohmann::json({{{"@odata.id", "/c/a"},
+                               {"Status", {{"Health", "OK"}}}}}));
+    EXPECT_EQ(res.jsonValue["Members@odata.count"], 1);
+}
+
+TEST(QueryParam, Paging)
+{
+    redfish::query_param::Paging paging{2, 3, "&$top=3", std::nullopt};
+    EXPECT_FALSE(redfish::query_param::onPage(paging, 1));
+    EXPECT_TRUE(redfish::query_param::onPage(paging, 2));
+    EXPECT_TRUE(redfish::query_param::onPage(paging, 4));
+    EXPECT_FALSE(redfish::query_param::onPage(paging, 5));
+
+    crow::Response res;
+    redfish::query_param::setNextLink(res, "/redfish/v1/Chassis", paging, 5);
+    EXPECT_FALSE(res.jsonValue.contains("Members@odata.nextLink"));
+    redfish::query_param::setNextLink(res, "/redfish/v1/Chassis", paging, 6);
+    EXPECT_EQ(res.jsonValue["Members@odata.nextLink"],
+              "/redfish/v1/Chassis?$skip=5&$top=3");
+}
+
+TEST(QueryParam, EntriesRuledOutStillTakeTheirIds)
+{
+    // Two entries logged in the same second, numbered as log entries are
+    const std::vector<std::pair<std::string, std::string>> log = {
+        {"1600000000", "Warning"}, {"1600000000", "Critical"}};
+    auto readAll = [&log](const redfish::query_param::Paging& paging,
+                          uint64_t expectedCount) {
+        nlohmann::json members = nlohmann::json::array();
+        uint64_t count = 0;
+        std::string prevTs;
+        int index = 0;
+        for (const auto& [ts, severity] : log)
+        {
+            EXPECT_TRUE(redfish::query_param::addEntry(
+                paging, members, count,
+                [&ts = ts, &prevTs, &index](std::string& id) {
+                    index = ts == prevTs ? index + 1 : 0;
+                    prevTs = ts;
+                    id = ts;
+                    if (index > 0)
+                    {
+                        id += "_" + std::to_string(index);
+                    }
+                    return true;
+                },
+                [&severity = severity]() {
+                    return nlohmann::json{{"Severity", severity}};
+                },
+                [&severity = severity](const std::string& id,
+                                       nlohmann::json& entry) {
+                    entry = {{"Id", id}, {"Severity", severity}};
+                    return true;
+                }));
+        }
+        EXPECT_EQ(count, expectedCount);
+        return members;
+    };
+
+    redfish::query_param::Paging filtered;
+    filtered.filter =
+        redfish::filter_expr::FilterExpr::parse("Severity eq 'Critical'");
+    ASSERT_TRUE(filtered.filter);
+    EXPECT_EQ(readAll(filtered, 1),
+              nlohmann::json::parse(
+                  R"([{"Id": "1600000000_1", "Severity": "Critical"}])"));
+
+    redfish::query_param::Paging skipped{1, 1, "", std::nullopt};
+    nlohmann::json members = readAll(skipped, 2);
+    ASSERT_EQ(members.size(), 1U);
+    EXPECT_EQ(members[0]["Id"], "1600000000_1");
+}
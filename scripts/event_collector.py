@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+
+# A stand-in for a Redfish event destination, to measure event delivery.
+# Point a subscription at it, for example with
+#   curl -k -u root:0penBmc -X POST \
+#     https://${bmc}/redfish/v1/EventService/Subscriptions \
+#     -d '{"Destination": "http://<this host>:8080/events", "Protocol": "Redfish"}'
+# It counts the events it receives, and the ones it received more than once,
+# which the event spool may resend after an outage or a restart of bmcweb.
+#
+# Sending SIGUSR1 pauses or resumes it.  While paused it answers every event
+# with 503, so bmcweb keeps it queued and retries it as per the retry policy
+# of the subscription.  --pause-after and --pause-for pause it on a schedule.
+
+import argparse
+import hashlib
+import http.server
+import json
+import signal
+import ssl
+import threading
+import time
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--port", type=int, default=8080)
+parser.add_argument("--cert", help="PEM certificate and key to serve https")
+parser.add_argument(
+    "--pause-after", type=float, default=0,
+    help="Seconds after the first event to pause for --pause-for seconds")
+parser.add_argument("--pause-for", type=float, default=0)
+parser.add_argument(
+    "--interval", type=float, default=5,
+    help="Seconds between reports")
+parser.add_argument(
+    "--verbose", action="store_true", help="Print every event received")
+
+args = parser.parse_args()
+
+lock = threading.Lock()
+paused = False
+first_event_time = None
+received = 0
+rejected = 0
+duplicates = 0
+# Events are told apart by their body, since their Id starts again from 1
+# when bmcweb restarts
+seen = set()
+
+
+def toggle_pause(signum=None, frame=None):
+    global paused
+    with lock:
+        paused = not paused
+        print("Paused" if paused else "Resumed", flush=True)
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def do_POST(self):
+        global first_event_time, received, rejected, duplicates
+        length = int(self.headers.get("Content-Length", 0))
+        body = self.rfile.read(length)
+
+        with lock:
+            if first_event_time is None:
+                first_event_time = time.monotonic()
+            if paused:
+                rejected += 1
+                status = 503
+            else:
+                received += 1
+                digest = hashlib.sha256(body).digest()
+                if digest in seen:
+                    duplicates += 1
+                seen.add(digest)
+                status = 204
+
+        if args.verbose and status == 204:
+            try:
+                event = json.loads(body)
+                print("Event {} with {} entries".format(
+                    event.get("Id"), len(event.get("Events", []))),
+                    flush=True)
+            except ValueError:
+                print("Event that isn't JSON", flush=True)
+
+        self.send_response(status)
+        self.send_header("Content-Length", "0")
+        self.end_headers()
+
+    def log_message(self, format, *args):
+        pass
+
+
+def report():
+    last = 0
+    while True:
+        time.sleep(args.interval)
+        with lock:
+            rate = (received - last) / args.interval
+            last = received
+            print("received {} unique {} duplicates {} rejected {} "
+                  "rate {:.1f}/s{}".format(
+                      received, len(seen), duplicates, rejected, rate,
+                      " paused" if paused else ""),
+                  flush=True)
+
+
+def scheduled_pause():
+    while first_event_time is None:
+        time.sleep(0.1)
+    time.sleep(args.pause_after)
+    toggle_pause()
+    time.sleep(args.pause_for)
+    toggle_pause()
+
+
+signal.signal(signal.SIGUSR1, toggle_pause)
+
+server = http.server.ThreadingHTTPServer(("", args.port), Handler)
+if args.cert:
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.load_cert_chain(args.cert)
+    server.socket = context.wrap_socket(server.socket, server_side=True)
+
+threading.Thread(target=report, daemon=True).start()
+if args.pause_for > 0:
+    threading.Thread(target=scheduled_pause, daemon=True).start()
+
+print("Listening on port {}".format(args.port), flush=True)
+server.serve_forever()
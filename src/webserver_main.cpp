@@ -11,8 +11,10 @@
 #include <hostname_monitor.hpp>
 #include <ibm/management_console_rest.hpp>
 #include <image_upload.hpp>
+#include <introspection_cache.hpp>
 #include <kvm_websocket.hpp>
 #include <login_routes.hpp>
+#include <object_mapper_mirror.hpp>
 #include <obmc_console.hpp>
 #include <obmc_hypervisor.hpp>
 #include <obmc_shell.hpp>
@@ -28,7 +30,11 @@
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/server.hpp>
 #include <security_headers.hpp>
+#include <sensor_cache.hpp>
 #include <ssl_key_handler.hpp>
+#include <stats_routes.hpp>
+#include <user_info_cache.hpp>
+#include <utils/health_index.hpp>
 #include <vm_websocket.hpp>
 #include <webassets.hpp>
 
@@ -142,6 +148,10 @@ int main(int /*argc*/, char** /*argv*/)
 
     crow::login_routes::requestRoutes(app);
 
+#ifdef BMCWEB_ENABLE_DEBUG_STATS
+    crow::stats_routes::requestRoutes(app);
+#endif
+
     setupSocket(app);
 
 #ifdef BMCWEB_ENABLE_VM_NBDPROXY
@@ -157,6 +167,23 @@ int main(int /*argc*/, char** /*argv*/)
     }
 #endif
 
+    // Drop cached user info when the user manager changes it
+    crow::user_info::registerUserInfoSignals();
+
+    // Answer ObjectMapper queries from memory
+    crow::object_mapper::registerMapperMirror();
+
+    // Serve sensor readings from memory, kept current by signals
+    crow::sensor_cache::registerSensorCache();
+
+    // Compute health rollups from memory, kept current by signals
+    redfish::health_index::registerHealthIndex();
+
+#ifdef BMCWEB_ENABLE_DBUS_REST
+    // Keep introspection data for the REST API until objects change
+    crow::introspection::registerIntrospectionSignals();
+#endif
+
 #ifdef BMCWEB_ENABLE_SSL
     BMCWEB_LOG_INFO << "Start Hostname Monitor Service...";
     crow::hostname_monitor::registerHostnameSignal();